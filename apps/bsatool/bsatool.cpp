@@ -8,6 +8,9 @@
 #include <boost/filesystem/fstream.hpp>
 
 #include <components/bsa/bsa_file.hpp>
+#include <components/bsa/bsa_archive.hpp>
+#include <components/bsa/hashindex.hpp>
+#include <components/bsa/vfs.hpp>
 
 #define BSATOOL_VERSION 1.1
 
@@ -19,6 +22,7 @@ struct Arguments
 {
     std::string mode;
     std::string filename;
+    std::vector<std::string> locations;
     std::string extractfile;
     std::string outdir;
 
@@ -46,6 +50,9 @@ bool parseOptions (int argc, char** argv, Arguments &info)
             "      Extract a file from the input archive.\n\n"
             "  bsatool extractall archivefile [output_directory]\n"
             "      Extract all files from the input archive.\n\n"
+            "  bsatool vfs [-l] location...\n"
+            "      Merge data directories and TES3/TES4 archives the way the game does (later\n"
+            "      locations have higher priority) and dump the resolved resource table.\n\n"
             "Allowed options");
 
     desc.add_options()
@@ -65,7 +72,7 @@ bool parseOptions (int argc, char** argv, Arguments &info)
         ;
 
     bpo::positional_options_description p;
-    p.add("mode", 1).add("input-file", 3);
+    p.add("mode", 1).add("input-file", -1);
 
     // there might be a better way to do this
     bpo::options_description all;
@@ -105,7 +112,7 @@ bool parseOptions (int argc, char** argv, Arguments &info)
     }
 
     info.mode = variables["mode"].as<std::string>();
-    if (!(info.mode == "list" || info.mode == "extract" || info.mode == "extractall"))
+    if (!(info.mode == "list" || info.mode == "extract" || info.mode == "extractall" || info.mode == "vfs"))
     {
         std::cout << std::endl << "ERROR: invalid mode \"" << info.mode << "\"\n\n"
             << desc << std::endl;
@@ -119,6 +126,7 @@ bool parseOptions (int argc, char** argv, Arguments &info)
         return false;
     }
     info.filename = variables["input-file"].as< std::vector<std::string> >()[0];
+    info.locations = variables["input-file"].as< std::vector<std::string> >();
 
     // Default output to the working directory
     info.outdir = ".";
@@ -148,6 +156,7 @@ bool parseOptions (int argc, char** argv, Arguments &info)
 int list(Bsa::BSAFile& bsa, Arguments& info);
 int extract(Bsa::BSAFile& bsa, Arguments& info);
 int extractAll(Bsa::BSAFile& bsa, Arguments& info);
+int dumpVFS(Arguments& info);
 
 int main(int argc, char** argv)
 {
@@ -157,6 +166,9 @@ int main(int argc, char** argv)
         if(!parseOptions (argc, argv, info))
             return 1;
 
+        if (info.mode == "vfs")
+            return dumpVFS(info);
+
         // Open file
         Bsa::BSAFile bsa;
         bsa.open(info.filename);
@@ -288,3 +300,39 @@ int extractAll(Bsa::BSAFile& bsa, Arguments& info)
 
     return 0;
 }
+
+int dumpVFS(Arguments& info)
+{
+    Bsa::VFS vfs;
+
+    for (std::vector<std::string>::const_iterator it = info.locations.begin(); it != info.locations.end(); ++it)
+    {
+        vfs.addArchive(Bsa::createArchive(*it, false));
+    }
+
+    vfs.build();
+
+    const std::vector<Bsa::VFS::Entry>& entries = vfs.getEntries();
+    for (std::vector<Bsa::VFS::Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        if (info.longformat)
+        {
+            std::cout << std::setw(60) << std::left << it->mName;
+            std::cout << vfs.getArchives()[it->mArchive]->getName() << std::endl;
+        }
+        else
+            std::cout << it->mName << std::endl;
+    }
+
+    // resolve every name once more to show the cost of a lookup
+    Bsa::HashIndex::resetCounters();
+    for (std::vector<Bsa::VFS::Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+        vfs.lookup(it->mArchiveName);
+
+    std::cout << std::endl
+        << entries.size() << " resources from " << vfs.getArchives().size() << " locations, table built in "
+        << vfs.getBuildTime() * 1000 << " ms" << std::endl
+        << Bsa::HashIndex::getLookupCount() << " lookups, " << Bsa::HashIndex::getProbeCount() << " probes" << std::endl;
+
+    return 0;
+}
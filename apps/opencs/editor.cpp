@@ -47,11 +47,8 @@ CS::Editor::Editor (OgreInit::OgreInit& ogreInit)
 
     mOverlaySystem.reset (new CSVRender::OverlaySystem);
 
-    Bsa::registerResources (Files::Collections (config.first, !mFsStrict), config.second, true,
-        mFsStrict);
-    // useLooseFiles is set false, since it is already done above
-    Bsa::registerResources (Files::Collections (config.first, !mFsStrict), tes4config, /*useLooseFiles*/false,
-        mFsStrict, /*isTes4*/true);
+    Bsa::registerResources (Files::Collections (config.first, !mFsStrict), config.second, tes4config,
+        true, mFsStrict);
 
     mDocumentManager.listResources();
 
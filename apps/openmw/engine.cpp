@@ -3,6 +3,7 @@
 #include <stdexcept>
 #include <iomanip>
 #include <ctime>
+#include <set>
 
 #include <OgreRoot.h>
 #include <OgreTimer.h>
@@ -53,6 +54,29 @@
 void OMW::Engine::executeLocalScripts()
 {
     MWWorld::LocalScripts& localScripts = MWBase::Environment::get().getWorld()->getLocalScripts();
+    MWBase::ScriptManager *scriptManager = MWBase::Environment::get().getScriptManager();
+
+    // Scripts that use nothing but their own locals do not depend on the others and are run
+    // first, on worker threads.
+    std::set<const MWWorld::RefData *> ranInParallel;
+
+    if (mParallelScripts)
+    {
+        std::vector<std::pair<std::string, MWWorld::Ptr> > scripts;
+
+        localScripts.startIteration();
+
+        while (!localScripts.isFinished())
+        {
+            std::pair<std::string, MWWorld::Ptr> script = localScripts.getNext();
+
+            if (scriptManager->canRunInParallel (script.first) &&
+                ranInParallel.insert (&script.second.getRefData()).second)
+                scripts.push_back (script);
+        }
+
+        scriptManager->runInParallel (scripts);
+    }
 
     localScripts.startIteration();
 
@@ -60,9 +84,17 @@ void OMW::Engine::executeLocalScripts()
     {
         std::pair<std::string, MWWorld::Ptr> script = localScripts.getNext();
 
+        std::set<const MWWorld::RefData *>::iterator ran = ranInParallel.find (&script.second.getRefData());
+
+        if (ran!=ranInParallel.end())
+        {
+            ranInParallel.erase (ran);
+            continue;
+        }
+
         MWScript::InterpreterContext interpreterContext (
             &script.second.getRefData().getLocals(), script.second);
-        MWBase::Environment::get().getScriptManager()->run (script.first, interpreterContext);
+        scriptManager->run (script.first, interpreterContext);
     }
 
     localScripts.setIgnore (MWWorld::Ptr());
@@ -193,6 +225,7 @@ OMW::Engine::Engine(Files::ConfigurationManager& configurationManager)
   , mFSStrict (false)
   , mScriptBlacklistUse (true)
   , mNewGame (false)
+  , mParallelScripts (false)
   , mCfgMgr(configurationManager)
 {
     Misc::Rng::init();
@@ -215,6 +248,12 @@ OMW::Engine::~Engine()
     if (mOgre)
         mOgre->restoreWindowGammaRamp();
     mEnvironment.cleanup();
+
+    // Written while the resources they were read from are still there
+    mNifCache.setDiskCache (0);
+    NifBullet::ManualBulletShapeLoader::setDiskCache (0);
+    mShapeDiskCache.reset();
+
     delete mScriptContext;
     delete mOgre;
     SDL_Quit();
@@ -369,9 +408,16 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
 
     mOgre->createWindow("OpenMW", windowSettings);
 
-    Bsa::registerResources (mFileCollections, mArchives, true, mFSStrict);
-    // useLooseFiles is set false, since it is already done above
-    Bsa::registerResources (mFileCollections, mTES4Archives, /*useLooseFiles*/false, mFSStrict, /*isTes4*/true);
+    Bsa::VFS *vfs = Bsa::registerResources (mFileCollections, mArchives, mTES4Archives, true, mFSStrict);
+
+    if (settings.getBool("model disk cache", "Objects"))
+        mNifCache.setDiskCache (new Nif::DiskCache ((mCfgMgr.getCachePath() / "nifcache.bin").string(), *vfs));
+
+    if (settings.getBool("collision disk cache", "Objects"))
+    {
+        mShapeDiskCache.reset (new Nif::DiskCache ((mCfgMgr.getCachePath() / "shapecache.bin").string(), *vfs));
+        NifBullet::ManualBulletShapeLoader::setDiskCache (mShapeDiskCache.get());
+    }
 
     // Create input and UI first to set up a bootstrapping environment for
     // showing a loading screen and keeping the window responsive while doing so
@@ -436,6 +482,8 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     Compiler::registerExtensions (mExtensions);
 
     // Create script system
+    mParallelScripts = Settings::Manager::getBool ("parallel local scripts", "Game");
+
     mScriptContext = new MWScript::CompilerContext (MWScript::CompilerContext::Type_Full);
     mScriptContext->setExtensions (&mExtensions);
 
@@ -3,6 +3,8 @@
 
 #include <OgreFrameListener.h>
 
+#include <boost/scoped_ptr.hpp>
+
 #include <components/compiler/extensions.hpp>
 #include <components/files/collections.hpp>
 #include <components/translation/translation.hpp>
@@ -98,8 +100,10 @@ namespace OMW
             std::vector<std::string> mScriptBlacklist;
             bool mScriptBlacklistUse;
             bool mNewGame;
+            bool mParallelScripts;
 
             Nif::Cache mNifCache;
+            boost::scoped_ptr<Nif::DiskCache> mShapeDiskCache;
 
             // not implemented
             Engine (const Engine&);
@@ -56,6 +56,9 @@ namespace MWBase
             virtual void updateCell(const MWWorld::Ptr &old, const MWWorld::Ptr &ptr) = 0;
             ///< Moves an object to a new cell
 
+            virtual void updatePosition(const MWWorld::Ptr& ptr) = 0;
+            ///< Moves an object to its new position within its cell
+
             virtual void drop (const MWWorld::CellStore *cellStore) = 0;
             ///< Deregister all objects in the given cell.
 
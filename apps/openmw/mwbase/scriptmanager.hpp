@@ -1,7 +1,13 @@
 #ifndef GAME_MWBASE_SCRIPTMANAGER_H
 #define GAME_MWBASE_SCRIPTMANAGER_H
 
+#include <cstddef>
+#include <iosfwd>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "../mwworld/ptr.hpp"
 
 namespace Interpreter
 {
@@ -50,6 +56,29 @@ namespace MWBase
             ///< Return locals for script \a name.
 
             virtual MWScript::GlobalScripts& getGlobalScripts() = 0;
+
+            virtual bool canRunInParallel (const std::string& name) = 0;
+            ///< Does the script with the given name use nothing but its own local variables,
+            /// so that it can be run by runInParallel? (compile first, if not compiled yet)
+
+            virtual void runInParallel (const std::vector<std::pair<std::string, MWWorld::Ptr> >& scripts) = 0;
+            ///< Run local scripts that passed canRunInParallel on worker threads. The effect is
+            /// the same as running them one after the other.
+
+            virtual std::size_t getSlowPathCount (const std::string& name) const = 0;
+            ///< Number of times script \a name had to look up a global variable, reference or
+            /// member variable by name.
+
+            virtual bool toggleProfiling() = 0;
+            ///< Start or stop counting and timing the runs of scripts and the opcodes they
+            /// execute. Starting discards what has been collected before.
+            /// \return Is the profiling enabled now?
+
+            virtual void writeProfile (std::ostream& stream, std::size_t limit) const = 0;
+            ///< Write a summary of the \a limit scripts and opcodes that took the most time.
+
+            virtual void writeProfileCsv (std::ostream& stream) const = 0;
+            ///< Write everything collected as comma separated values.
    };
 }
 
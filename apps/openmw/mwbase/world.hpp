@@ -40,6 +40,7 @@ namespace ESM
     struct EffectList;
     struct CreatureLevList;
     struct ItemLevList;
+    class Variant;
 }
 
 namespace MWRender
@@ -175,6 +176,20 @@ namespace MWBase
             virtual char getGlobalVariableType (const std::string& name) const = 0;
             ///< Return ' ', if there is no global variable with this name.
 
+            virtual ESM::Variant& getGlobalVariable (const std::string& name) = 0;
+            ///< Throws an exception, if there is no global variable with this name. The variable
+            /// stays valid until getReferenceGeneration changes.
+            ///
+            /// \note Changing gamehour, day or month this way does not update the sky.
+
+            virtual unsigned int getReferenceGeneration() const = 0;
+            ///< Changes whenever the references returned by searchPtr may have been deleted or
+            /// moved to another cell, cells have been made active or inactive, or the global
+            /// variables have been replaced.
+
+            virtual void invalidateReferences() = 0;
+            ///< Change the reference generation.
+
             virtual std::string getCellName (const MWWorld::CellStore *cell = 0) const = 0;
             ///< Return name of the cell.
             ///
@@ -61,30 +61,9 @@ namespace
 
 namespace MWClass
 {
-    const Creature::GMST& Creature::getGmst()
+    const MWWorld::GameSettingCache& Creature::getGmst()
     {
-        static GMST gmst;
-        static bool inited = false;
-        if (!inited)
-        {
-            const MWBase::World *world = MWBase::Environment::get().getWorld();
-            const MWWorld::Store<ESM::GameSetting> &store = world->getStore().get<ESM::GameSetting>();
-            gmst.fMinWalkSpeedCreature = store.find("fMinWalkSpeedCreature");
-            gmst.fMaxWalkSpeedCreature = store.find("fMaxWalkSpeedCreature");
-            gmst.fEncumberedMoveEffect = store.find("fEncumberedMoveEffect");
-            gmst.fSneakSpeedMultiplier = store.find("fSneakSpeedMultiplier");
-            gmst.fAthleticsRunBonus = store.find("fAthleticsRunBonus");
-            gmst.fBaseRunMultiplier = store.find("fBaseRunMultiplier");
-            gmst.fMinFlySpeed = store.find("fMinFlySpeed");
-            gmst.fMaxFlySpeed = store.find("fMaxFlySpeed");
-            gmst.fSwimRunBase = store.find("fSwimRunBase");
-            gmst.fSwimRunAthleticsMult = store.find("fSwimRunAthleticsMult");
-            gmst.fKnockDownMult = store.find("fKnockDownMult");
-            gmst.iKnockDownOddsMult = store.find("iKnockDownOddsMult");
-            gmst.iKnockDownOddsBase = store.find("iKnockDownOddsBase");
-            inited = true;
-        }
-        return gmst;
+        return MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
     }
 
     void Creature::ensureCustomData (const MWWorld::Ptr& ptr) const
@@ -212,7 +191,7 @@ namespace MWClass
     {
         MWWorld::LiveCellRef<ESM::Creature> *ref =
             ptr.get<ESM::Creature>();
-        const MWWorld::Store<ESM::GameSetting> &gmst = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = getGmst();
         MWMechanics::CreatureStats &stats = getCreatureStats(ptr);
 
         if (stats.getDrawState() != MWMechanics::DrawState_Weapon)
@@ -234,7 +213,7 @@ namespace MWClass
         float dist = 200.f;
         if (!weapon.isEmpty())
         {
-            const float fCombatDistance = gmst.find("fCombatDistance")->getFloat();
+            const float fCombatDistance = gmst.fCombatDistance;
             dist = fCombatDistance * weapon.get<ESM::Weapon>()->mBase->mData.mReach;
         }
         std::pair<MWWorld::Ptr, Ogre::Vector3> result = MWBase::Environment::get().getWorld()->getHitContact(ptr, dist);
@@ -373,9 +352,9 @@ namespace MWClass
             if (!attacker.isEmpty())
             {
                 // Check for knockdown
-                float agilityTerm = getCreatureStats(ptr).getAttribute(ESM::Attribute::Agility).getModified() * getGmst().fKnockDownMult->getFloat();
+                float agilityTerm = getCreatureStats(ptr).getAttribute(ESM::Attribute::Agility).getModified() * getGmst().fKnockDownMult;
                 float knockdownTerm = getCreatureStats(ptr).getAttribute(ESM::Attribute::Agility).getModified()
-                        * getGmst().iKnockDownOddsMult->getInt() * 0.01f + getGmst().iKnockDownOddsBase->getInt();
+                        * getGmst().iKnockDownOddsMult * 0.01f + getGmst().iKnockDownOddsBase;
                 if (ishealth && agilityTerm <= damage && knockdownTerm <= Misc::Rng::roll0to99())
                 {
                     getCreatureStats(ptr).setKnockedDown(true);
@@ -524,10 +503,10 @@ namespace MWClass
     float Creature::getSpeed(const MWWorld::Ptr &ptr) const
     {
         MWMechanics::CreatureStats& stats = getCreatureStats(ptr);
-        const GMST& gmst = getGmst();
+        const MWWorld::GameSettingCache& gmst = getGmst();
 
-        float walkSpeed = gmst.fMinWalkSpeedCreature->getFloat() + 0.01f * stats.getAttribute(ESM::Attribute::Speed).getModified()
-                * (gmst.fMaxWalkSpeedCreature->getFloat() - gmst.fMinWalkSpeedCreature->getFloat());
+        float walkSpeed = gmst.fMinWalkSpeedCreature + 0.01f * stats.getAttribute(ESM::Attribute::Speed).getModified()
+                * (gmst.fMaxWalkSpeedCreature - gmst.fMinWalkSpeedCreature);
 
         const MWBase::World *world = MWBase::Environment::get().getWorld();
         const MWMechanics::MagicEffects &mageffects = stats.getMagicEffects();
@@ -546,9 +525,9 @@ namespace MWClass
         {
             float flySpeed = 0.01f*(stats.getAttribute(ESM::Attribute::Speed).getModified() +
                                     mageffects.get(ESM::MagicEffect::Levitate).getMagnitude());
-            flySpeed = gmst.fMinFlySpeed->getFloat() + flySpeed*(gmst.fMaxFlySpeed->getFloat() - gmst.fMinFlySpeed->getFloat());
+            flySpeed = gmst.fMinFlySpeed + flySpeed*(gmst.fMaxFlySpeed - gmst.fMinFlySpeed);
             const float normalizedEncumbrance = getNormalizedEncumbrance(ptr);
-            flySpeed *= 1.0f - gmst.fEncumberedMoveEffect->getFloat() * normalizedEncumbrance;
+            flySpeed *= 1.0f - gmst.fEncumberedMoveEffect * normalizedEncumbrance;
             flySpeed = std::max(0.0f, flySpeed);
             moveSpeed = flySpeed;
         }
@@ -558,8 +537,8 @@ namespace MWClass
             if(running)
                 swimSpeed = runSpeed;
             swimSpeed *= 1.0f + 0.01f * mageffects.get(ESM::MagicEffect::SwiftSwim).getMagnitude();
-            swimSpeed *= gmst.fSwimRunBase->getFloat() + 0.01f*getSkill(ptr, ESM::Skill::Athletics) *
-                                                    gmst.fSwimRunAthleticsMult->getFloat();
+            swimSpeed *= gmst.fSwimRunBase + 0.01f*getSkill(ptr, ESM::Skill::Athletics) *
+                                                    gmst.fSwimRunAthleticsMult;
             moveSpeed = swimSpeed;
         }
         else if(running)
@@ -3,9 +3,9 @@
 
 #include "../mwworld/class.hpp"
 
-namespace ESM
+namespace MWWorld
 {
-    struct GameSetting;
+    struct GameSettingCache;
 }
 
 namespace MWClass
@@ -19,25 +19,7 @@ namespace MWClass
 
             static int getSndGenTypeFromName(const MWWorld::Ptr &ptr, const std::string &name);
 
-            // cached GMSTs
-            struct GMST
-            {
-                const ESM::GameSetting *fMinWalkSpeedCreature;
-                const ESM::GameSetting *fMaxWalkSpeedCreature;
-                const ESM::GameSetting *fEncumberedMoveEffect;
-                const ESM::GameSetting *fSneakSpeedMultiplier;
-                const ESM::GameSetting *fAthleticsRunBonus;
-                const ESM::GameSetting *fBaseRunMultiplier;
-                const ESM::GameSetting *fMinFlySpeed;
-                const ESM::GameSetting *fMaxFlySpeed;
-                const ESM::GameSetting *fSwimRunBase;
-                const ESM::GameSetting *fSwimRunAthleticsMult;
-                const ESM::GameSetting *fKnockDownMult;
-                const ESM::GameSetting *iKnockDownOddsMult;
-                const ESM::GameSetting *iKnockDownOddsBase;
-            };
-
-            static const GMST& getGmst();
+            static const MWWorld::GameSettingCache& getGmst();
 
         public:
 
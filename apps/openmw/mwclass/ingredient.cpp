@@ -153,8 +153,7 @@ namespace MWClass
         MWMechanics::NpcStats& npcStats = player.getClass().getNpcStats (player);
         int alchemySkill = npcStats.getSkill (ESM::Skill::Alchemy).getBase();
 
-        static const float fWortChanceValue =
-                MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fWortChanceValue")->getFloat();
+        const float fWortChanceValue = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fWortChanceValue;
 
         MWGui::Widgets::SpellEffectList list;
         for (int i=0; i<4; ++i)
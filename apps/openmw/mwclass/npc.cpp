@@ -118,39 +118,9 @@ namespace
 
 namespace MWClass
 {
-    const Npc::GMST& Npc::getGmst()
+    const MWWorld::GameSettingCache& Npc::getGmst()
     {
-        static GMST gmst;
-        static bool inited = false;
-        if(!inited)
-        {
-            const MWBase::World *world = MWBase::Environment::get().getWorld();
-            const MWWorld::Store<ESM::GameSetting> &store = world->getStore().get<ESM::GameSetting>();
-
-            gmst.fMinWalkSpeed = store.find("fMinWalkSpeed");
-            gmst.fMaxWalkSpeed = store.find("fMaxWalkSpeed");
-            gmst.fEncumberedMoveEffect = store.find("fEncumberedMoveEffect");
-            gmst.fSneakSpeedMultiplier = store.find("fSneakSpeedMultiplier");
-            gmst.fAthleticsRunBonus = store.find("fAthleticsRunBonus");
-            gmst.fBaseRunMultiplier = store.find("fBaseRunMultiplier");
-            gmst.fMinFlySpeed = store.find("fMinFlySpeed");
-            gmst.fMaxFlySpeed = store.find("fMaxFlySpeed");
-            gmst.fSwimRunBase = store.find("fSwimRunBase");
-            gmst.fSwimRunAthleticsMult = store.find("fSwimRunAthleticsMult");
-            gmst.fJumpEncumbranceBase = store.find("fJumpEncumbranceBase");
-            gmst.fJumpEncumbranceMultiplier = store.find("fJumpEncumbranceMultiplier");
-            gmst.fJumpAcrobaticsBase = store.find("fJumpAcrobaticsBase");
-            gmst.fJumpAcroMultiplier = store.find("fJumpAcroMultiplier");
-            gmst.fJumpRunMultiplier = store.find("fJumpRunMultiplier");
-            gmst.fWereWolfRunMult = store.find("fWereWolfRunMult");
-            gmst.fKnockDownMult = store.find("fKnockDownMult");
-            gmst.iKnockDownOddsMult = store.find("iKnockDownOddsMult");
-            gmst.iKnockDownOddsBase = store.find("iKnockDownOddsBase");
-            gmst.fCombatArmorMinMult = store.find("fCombatArmorMinMult");
-
-            inited = true;
-        }
-        return gmst;
+        return MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
     }
 
     void Npc::ensureCustomData (const MWWorld::Ptr& ptr) const
@@ -219,10 +189,8 @@ namespace MWClass
 
             if (!ref->mBase->mFaction.empty())
             {
-                static const int iAutoRepFacMod = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("iAutoRepFacMod")->getInt();
-                static const int iAutoRepLevMod = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("iAutoRepLevMod")->getInt();
+                const int iAutoRepFacMod = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().iAutoRepFacMod;
+                const int iAutoRepLevMod = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().iAutoRepLevMod;
                 int rank = ref->mBase->getFactionRank();
 
                 data->mNpcStats.setReputation(iAutoRepFacMod * (rank+1) + iAutoRepLevMod * (data->mNpcStats.getLevel()-1));
@@ -341,7 +309,7 @@ namespace MWClass
     {
         MWBase::World *world = MWBase::Environment::get().getWorld();
 
-        const MWWorld::Store<ESM::GameSetting> &store = world->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = getGmst();
 
         // Get the weapon used (if hand-to-hand, weapon = inv.end())
         MWWorld::InventoryStore &inv = getInventoryStore(ptr);
@@ -352,10 +320,10 @@ namespace MWClass
 
         MWMechanics::applyFatigueLoss(ptr, weapon);
 
-        const float fCombatDistance = store.find("fCombatDistance")->getFloat();
+        const float fCombatDistance = gmst.fCombatDistance;
         float dist = fCombatDistance * (!weapon.isEmpty() ?
                                weapon.get<ESM::Weapon>()->mBase->mData.mReach :
-                               store.find("fHandToHandReach")->getFloat());
+                               gmst.fHandToHandReach);
 
         // TODO: Use second to work out the hit angle
         std::pair<MWWorld::Ptr, Ogre::Vector3> result = world->getHitContact(ptr, dist);
@@ -421,14 +389,14 @@ namespace MWClass
                     && !MWBase::Environment::get().getMechanicsManager()->awarenessCheck(ptr, victim);
             if(unaware)
             {
-                damage *= store.find("fCombatCriticalStrikeMult")->getFloat();
+                damage *= gmst.fCombatCriticalStrikeMult;
                 MWBase::Environment::get().getWindowManager()->messageBox("#{sTargetCriticalStrike}");
                 MWBase::Environment::get().getSoundManager()->playSound3D(victim, "critical damage", 1.0f, 1.0f);
             }
         }
 
         if (othercls.getCreatureStats(victim).getKnockedDown())
-            damage *= store.find("fCombatKODamageMult")->getFloat();
+            damage *= gmst.fCombatKODamageMult;
 
         // Apply "On hit" enchanted weapons
         std::string enchantmentName = !weapon.isEmpty() ? weapon.getClass().getEnchantment(weapon) : "";
@@ -506,19 +474,18 @@ namespace MWClass
             // 'ptr' is losing health. Play a 'hit' voiced dialog entry if not already saying
             // something, alert the character controller, scripts, etc.
 
-            const MWWorld::ESMStore &store = MWBase::Environment::get().getWorld()->getStore();
-            const GMST& gmst = getGmst();
+            const MWWorld::GameSettingCache& gmst = getGmst();
 
-            int chance = store.get<ESM::GameSetting>().find("iVoiceHitOdds")->getInt();
+            int chance = gmst.iVoiceHitOdds;
             if (Misc::Rng::roll0to99() < chance)
             {
                 MWBase::Environment::get().getDialogueManager()->say(ptr, "hit");
             }
 
             // Check for knockdown
-            float agilityTerm = getCreatureStats(ptr).getAttribute(ESM::Attribute::Agility).getModified() * gmst.fKnockDownMult->getFloat();
+            float agilityTerm = getCreatureStats(ptr).getAttribute(ESM::Attribute::Agility).getModified() * gmst.fKnockDownMult;
             float knockdownTerm = getCreatureStats(ptr).getAttribute(ESM::Attribute::Agility).getModified()
-                    * gmst.iKnockDownOddsMult->getInt() * 0.01f + gmst.iKnockDownOddsBase->getInt();
+                    * gmst.iKnockDownOddsMult * 0.01f + gmst.iKnockDownOddsBase;
             if (ishealth && agilityTerm <= damage && knockdownTerm <= Misc::Rng::roll0to99())
             {
                 getCreatureStats(ptr).setKnockedDown(true);
@@ -549,7 +516,7 @@ namespace MWClass
 
                 float unmitigatedDamage = damage;
                 float x = damage / (damage + getArmorRating(ptr));
-                damage *= std::max(gmst.fCombatArmorMinMult->getFloat(), x);
+                damage *= std::max(gmst.fCombatArmorMinMult, x);
                 int damageDiff = static_cast<int>(unmitigatedDamage - damage);
                 if (damage < 1)
                     damage = 1;
@@ -730,7 +697,7 @@ namespace MWClass
     float Npc::getSpeed(const MWWorld::Ptr& ptr) const
     {
         const MWBase::World *world = MWBase::Environment::get().getWorld();
-        const GMST& gmst = getGmst();
+        const MWWorld::GameSettingCache& gmst = getGmst();
 
         const NpcCustomData *npcdata = static_cast<const NpcCustomData*>(ptr.getRefData().getCustomData());
         const MWMechanics::MagicEffects &mageffects = npcdata->mNpcStats.getMagicEffects();
@@ -740,15 +707,15 @@ namespace MWClass
         bool sneaking = ptr.getClass().getCreatureStats(ptr).getStance(MWMechanics::CreatureStats::Stance_Sneak);
         bool running = ptr.getClass().getCreatureStats(ptr).getStance(MWMechanics::CreatureStats::Stance_Run);
 
-        float walkSpeed = gmst.fMinWalkSpeed->getFloat() + 0.01f*npcdata->mNpcStats.getAttribute(ESM::Attribute::Speed).getModified()*
-                                                      (gmst.fMaxWalkSpeed->getFloat() - gmst.fMinWalkSpeed->getFloat());
-        walkSpeed *= 1.0f - gmst.fEncumberedMoveEffect->getFloat()*normalizedEncumbrance;
+        float walkSpeed = gmst.fMinWalkSpeed + 0.01f*npcdata->mNpcStats.getAttribute(ESM::Attribute::Speed).getModified()*
+                                                      (gmst.fMaxWalkSpeed - gmst.fMinWalkSpeed);
+        walkSpeed *= 1.0f - gmst.fEncumberedMoveEffect*normalizedEncumbrance;
         walkSpeed = std::max(0.0f, walkSpeed);
         if(sneaking)
-            walkSpeed *= gmst.fSneakSpeedMultiplier->getFloat();
+            walkSpeed *= gmst.fSneakSpeedMultiplier;
 
         float runSpeed = walkSpeed*(0.01f * npcdata->mNpcStats.getSkill(ESM::Skill::Athletics).getModified() *
-                                    gmst.fAthleticsRunBonus->getFloat() + gmst.fBaseRunMultiplier->getFloat());
+                                    gmst.fAthleticsRunBonus + gmst.fBaseRunMultiplier);
 
         float moveSpeed;
         if(getEncumbrance(ptr) > getCapacity(ptr))
@@ -758,8 +725,8 @@ namespace MWClass
         {
             float flySpeed = 0.01f*(npcdata->mNpcStats.getAttribute(ESM::Attribute::Speed).getModified() +
                                     mageffects.get(ESM::MagicEffect::Levitate).getMagnitude());
-            flySpeed = gmst.fMinFlySpeed->getFloat() + flySpeed*(gmst.fMaxFlySpeed->getFloat() - gmst.fMinFlySpeed->getFloat());
-            flySpeed *= 1.0f - gmst.fEncumberedMoveEffect->getFloat() * normalizedEncumbrance;
+            flySpeed = gmst.fMinFlySpeed + flySpeed*(gmst.fMaxFlySpeed - gmst.fMinFlySpeed);
+            flySpeed *= 1.0f - gmst.fEncumberedMoveEffect * normalizedEncumbrance;
             flySpeed = std::max(0.0f, flySpeed);
             moveSpeed = flySpeed;
         }
@@ -769,8 +736,8 @@ namespace MWClass
             if(running)
                 swimSpeed = runSpeed;
             swimSpeed *= 1.0f + 0.01f * mageffects.get(ESM::MagicEffect::SwiftSwim).getMagnitude();
-            swimSpeed *= gmst.fSwimRunBase->getFloat() + 0.01f*npcdata->mNpcStats.getSkill(ESM::Skill::Athletics).getModified()*
-                                                    gmst.fSwimRunAthleticsMult->getFloat();
+            swimSpeed *= gmst.fSwimRunBase + 0.01f*npcdata->mNpcStats.getSkill(ESM::Skill::Athletics).getModified()*
+                                                    gmst.fSwimRunAthleticsMult;
             moveSpeed = swimSpeed;
         }
         else if(running && !sneaking)
@@ -781,7 +748,7 @@ namespace MWClass
             moveSpeed *= 0.75f;
 
         if(npcdata->mNpcStats.isWerewolf() && running && npcdata->mNpcStats.getDrawState() == MWMechanics::DrawState_Nothing)
-            moveSpeed *= gmst.fWereWolfRunMult->getFloat();
+            moveSpeed *= gmst.fWereWolfRunMult;
 
         return moveSpeed;
     }
@@ -792,10 +759,10 @@ namespace MWClass
             return 0.f;
 
         const NpcCustomData *npcdata = static_cast<const NpcCustomData*>(ptr.getRefData().getCustomData());
-        const GMST& gmst = getGmst();
+        const MWWorld::GameSettingCache& gmst = getGmst();
         const MWMechanics::MagicEffects &mageffects = npcdata->mNpcStats.getMagicEffects();
-        const float encumbranceTerm = gmst.fJumpEncumbranceBase->getFloat() +
-                                          gmst.fJumpEncumbranceMultiplier->getFloat() *
+        const float encumbranceTerm = gmst.fJumpEncumbranceBase +
+                                          gmst.fJumpEncumbranceMultiplier *
                                           (1.0f - Npc::getEncumbrance(ptr)/Npc::getCapacity(ptr));
 
         float a = static_cast<float>(npcdata->mNpcStats.getSkill(ESM::Skill::Acrobatics).getModified());
@@ -806,14 +773,14 @@ namespace MWClass
             a = 50.0f;
         }
 
-        float x = gmst.fJumpAcrobaticsBase->getFloat() +
-                  std::pow(a / 15.0f, gmst.fJumpAcroMultiplier->getFloat());
-        x += 3.0f * b * gmst.fJumpAcroMultiplier->getFloat();
+        float x = gmst.fJumpAcrobaticsBase +
+                  std::pow(a / 15.0f, gmst.fJumpAcroMultiplier);
+        x += 3.0f * b * gmst.fJumpAcroMultiplier;
         x += mageffects.get(ESM::MagicEffect::Jump).getMagnitude() * 64;
         x *= encumbranceTerm;
 
         if(ptr.getClass().getCreatureStats(ptr).getStance(MWMechanics::CreatureStats::Stance_Run))
-            x *= gmst.fJumpRunMultiplier->getFloat();
+            x *= gmst.fJumpRunMultiplier;
         x *= npcdata->mNpcStats.getFatigueTerm();
         x -= -627.2f;/*gravity constant*/
         x /= 3.0f;
@@ -891,7 +858,7 @@ namespace MWClass
     float Npc::getCapacity (const MWWorld::Ptr& ptr) const
     {
         const MWMechanics::CreatureStats& stats = getCreatureStats (ptr);
-        static const float fEncumbranceStrMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fEncumbranceStrMult")->getFloat();
+        const float fEncumbranceStrMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fEncumbranceStrMult;
         return stats.getAttribute(0).getModified()*fEncumbranceStrMult;
     }
 
@@ -940,14 +907,13 @@ namespace MWClass
 
     float Npc::getArmorRating (const MWWorld::Ptr& ptr) const
     {
-        const MWBase::World *world = MWBase::Environment::get().getWorld();
-        const MWWorld::Store<ESM::GameSetting> &store = world->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = getGmst();
 
         MWMechanics::NpcStats &stats = getNpcStats(ptr);
         MWWorld::InventoryStore &invStore = getInventoryStore(ptr);
 
-        float fUnarmoredBase1 = store.find("fUnarmoredBase1")->getFloat();
-        float fUnarmoredBase2 = store.find("fUnarmoredBase2")->getFloat();
+        float fUnarmoredBase1 = gmst.fUnarmoredBase1;
+        float fUnarmoredBase2 = gmst.fUnarmoredBase2;
         int unarmoredSkill = stats.getSkill(ESM::Skill::Unarmored).getModified();
 
         int ratings[MWWorld::InventoryStore::Slots];
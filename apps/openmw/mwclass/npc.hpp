@@ -3,9 +3,9 @@
 
 #include "../mwworld/class.hpp"
 
-namespace ESM
+namespace MWWorld
 {
-    struct GameSetting;
+    struct GameSettingCache;
 }
 
 namespace MWClass
@@ -17,31 +17,7 @@ namespace MWClass
             virtual MWWorld::Ptr
             copyToCellImpl(const MWWorld::Ptr &ptr, MWWorld::CellStore &cell) const;
 
-            struct GMST
-            {
-                const ESM::GameSetting *fMinWalkSpeed;
-                const ESM::GameSetting *fMaxWalkSpeed;
-                const ESM::GameSetting *fEncumberedMoveEffect;
-                const ESM::GameSetting *fSneakSpeedMultiplier;
-                const ESM::GameSetting *fAthleticsRunBonus;
-                const ESM::GameSetting *fBaseRunMultiplier;
-                const ESM::GameSetting *fMinFlySpeed;
-                const ESM::GameSetting *fMaxFlySpeed;
-                const ESM::GameSetting *fSwimRunBase;
-                const ESM::GameSetting *fSwimRunAthleticsMult;
-                const ESM::GameSetting *fJumpEncumbranceBase;
-                const ESM::GameSetting *fJumpEncumbranceMultiplier;
-                const ESM::GameSetting *fJumpAcrobaticsBase;
-                const ESM::GameSetting *fJumpAcroMultiplier;
-                const ESM::GameSetting *fJumpRunMultiplier;
-                const ESM::GameSetting *fWereWolfRunMult;
-                const ESM::GameSetting *fKnockDownMult;
-                const ESM::GameSetting *iKnockDownOddsMult;
-                const ESM::GameSetting *iKnockDownOddsBase;
-                const ESM::GameSetting *fCombatArmorMinMult;
-            };
-
-            static const GMST& getGmst();
+            static const MWWorld::GameSettingCache& getGmst();
 
         public:
 
@@ -139,8 +139,7 @@ namespace MWClass
         MWMechanics::NpcStats& npcStats = player.getClass().getNpcStats (player);
         int alchemySkill = npcStats.getSkill (ESM::Skill::Alchemy).getBase();
         int i=0;
-        static const float fWortChanceValue =
-                MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fWortChanceValue")->getFloat();
+        const float fWortChanceValue = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fWortChanceValue;
         for (MWGui::Widgets::SpellEffectList::iterator it = info.effects.begin(); it != info.effects.end(); ++it)
         {
             it->mKnown = (i <= 1 && alchemySkill >= fWortChanceValue)
@@ -74,7 +74,7 @@ namespace MWGui
 
             std::string sourcesDescription;
 
-            static const float fadeTime = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fMagicStartIconBlink")->getFloat();
+            const float fadeTime = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fMagicStartIconBlink;
 
             for (std::vector<MagicEffectInfo>::const_iterator effectIt = it->second.begin();
                  effectIt != it->second.end(); ++effectIt)
@@ -1114,8 +1114,7 @@ namespace MWInput
 
     void InputManager::updateIdleTime(float dt)
     {
-        static const float vanityDelay = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                .find("fVanityDelay")->getFloat();
+        const float vanityDelay = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fVanityDelay;
         if (mTimeIdle >= 0.f)
             mTimeIdle += dt;
         if (mTimeIdle > vanityDelay) {
@@ -0,0 +1,121 @@
+#include "actorgrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MWMechanics
+{
+    ActorGrid::ActorGrid (float cellSize)
+    : mCellSize (cellSize)
+    {}
+
+    int ActorGrid::getIndex (float coordinate) const
+    {
+        return static_cast<int> (std::floor (coordinate / mCellSize));
+    }
+
+    void ActorGrid::removeFromCell (Entries::iterator entry)
+    {
+        std::map<Cell, Bucket>::iterator cell = mCells.find (entry->second.mCell);
+
+        if (cell==mCells.end())
+            return;
+
+        Bucket& bucket = cell->second;
+        Bucket::iterator iter = std::find (bucket.begin(), bucket.end(), entry);
+
+        if (iter!=bucket.end())
+        {
+            *iter = bucket.back();
+            bucket.pop_back();
+        }
+
+        if (bucket.empty())
+            mCells.erase (cell);
+    }
+
+    void ActorGrid::update (const MWWorld::Ptr& actor, const Ogre::Vector3& position)
+    {
+        Cell cell (getIndex (position.x), getIndex (position.y));
+
+        std::pair<Entries::iterator, bool> inserted =
+            mEntries.insert (std::make_pair (actor, Entry()));
+
+        Entries::iterator entry = inserted.first;
+        entry->second.mPosition = position;
+
+        if (!inserted.second)
+        {
+            if (entry->second.mCell==cell)
+                return;
+
+            removeFromCell (entry);
+        }
+
+        entry->second.mCell = cell;
+        mCells[cell].push_back (entry);
+    }
+
+    void ActorGrid::remove (const MWWorld::Ptr& actor)
+    {
+        Entries::iterator entry = mEntries.find (actor);
+
+        if (entry!=mEntries.end())
+        {
+            removeFromCell (entry);
+            mEntries.erase (entry);
+        }
+    }
+
+    void ActorGrid::clear()
+    {
+        mCells.clear();
+        mEntries.clear();
+    }
+
+    void ActorGrid::getActorsInRange (const Ogre::Vector3& position, float radius,
+        std::vector<MWWorld::Ptr>& out) const
+    {
+        float sqrRadius = radius*radius;
+
+        // With a radius that reaches more grid cells than there are occupied ones, looking at
+        // every actor is cheaper (and already in the right order).
+        float span = 2*radius/mCellSize + 2;
+
+        if (span*span>=mCells.size())
+        {
+            for (Entries::const_iterator iter (mEntries.begin()); iter!=mEntries.end(); ++iter)
+                if (iter->second.mPosition.squaredDistance (position)<=sqrRadius)
+                    out.push_back (iter->first);
+
+            return;
+        }
+
+        std::size_t first = out.size();
+
+        int minX = getIndex (position.x - radius);
+        int maxX = getIndex (position.x + radius);
+        int minY = getIndex (position.y - radius);
+        int maxY = getIndex (position.y + radius);
+
+        for (int x = minX; x<=maxX; ++x)
+            for (int y = minY; y<=maxY; ++y)
+            {
+                std::map<Cell, Bucket>::const_iterator cell = mCells.find (Cell (x, y));
+
+                if (cell==mCells.end())
+                    continue;
+
+                for (Bucket::const_iterator iter (cell->second.begin()); iter!=cell->second.end(); ++iter)
+                    if ((*iter)->second.mPosition.squaredDistance (position)<=sqrRadius)
+                        out.push_back ((*iter)->first);
+            }
+
+        std::sort (out.begin()+first, out.end());
+    }
+
+    std::size_t ActorGrid::getSize() const
+    {
+        return mEntries.size();
+    }
+}
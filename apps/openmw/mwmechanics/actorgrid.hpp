@@ -0,0 +1,64 @@
+#ifndef OPENMW_MECHANICS_ACTORGRID_H
+#define OPENMW_MECHANICS_ACTORGRID_H
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "../mwworld/ptr.hpp"
+
+namespace MWMechanics
+{
+    /// \brief Uniform grid over the horizontal positions of the actors
+    ///
+    /// Finds the actors within a distance of a point by only looking at the grid cells that
+    /// distance reaches. Updating the position of an actor only touches the grid cells when it
+    /// has moved into another one.
+    class ActorGrid
+    {
+        public:
+
+            explicit ActorGrid (float cellSize = 2048);
+
+            void update (const MWWorld::Ptr& actor, const Ogre::Vector3& position);
+            ///< Add \a actor at \a position or move it there.
+
+            void remove (const MWWorld::Ptr& actor);
+            ///< \note Ignored, if \a actor has not been added.
+
+            void clear();
+
+            void getActorsInRange (const Ogre::Vector3& position, float radius,
+                std::vector<MWWorld::Ptr>& out) const;
+            ///< Append the actors whose last updated position is within \a radius of \a position,
+            /// ordered like Actors::PtrActorMap.
+
+            std::size_t getSize() const;
+
+        private:
+
+            typedef std::pair<int, int> Cell;
+
+            struct Entry
+            {
+                Ogre::Vector3 mPosition;
+                Cell mCell;
+            };
+
+            typedef std::map<MWWorld::Ptr, Entry> Entries;
+            typedef std::vector<Entries::iterator> Bucket;
+
+            float mCellSize;
+            Entries mEntries;
+            std::map<Cell, Bucket> mCells;
+
+            int getIndex (float coordinate) const;
+
+            void removeFromCell (Entries::iterator entry);
+    };
+}
+
+#endif
@@ -42,6 +42,21 @@
 namespace
 {
 
+/// AI processing is only done within this distance of the player, and actors only start combat
+/// with each other within it
+const float sActorsProcessingDistance = 7168;
+
+float getMaxHeadTrackDistance(const MWWorld::Ptr& actor)
+{
+    const float fMaxHeadTrackDistance = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fMaxHeadTrackDistance;
+    const float fInteriorHeadTrackMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fInteriorHeadTrackMult;
+    float maxDistance = fMaxHeadTrackDistance;
+    const ESM::Cell* currentCell = actor.getCell()->getCell();
+    if (!currentCell->isExterior() && !(currentCell->mData.mFlags & ESM::Cell::QuasiEx))
+        maxDistance *= fInteriorHeadTrackMult;
+    return maxDistance;
+}
+
 bool isConscious(const MWWorld::Ptr& ptr)
 {
     const MWMechanics::CreatureStats& stats = ptr.getClass().getCreatureStats(ptr);
@@ -167,7 +182,7 @@ void adjustCommandedActor (const MWWorld::Ptr& actor)
 void getRestorationPerHourOfSleep (const MWWorld::Ptr& ptr, float& health, float& magicka)
 {
     MWMechanics::CreatureStats& stats = ptr.getClass().getCreatureStats (ptr);
-    const MWWorld::Store<ESM::GameSetting>& settings = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
+    const MWWorld::GameSettingCache& settings = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
 
     bool stunted = stats.getMagicEffects ().get(ESM::MagicEffect::StuntedMagicka).getMagnitude() > 0;
     int endurance = stats.getAttribute (ESM::Attribute::Endurance).getModified ();
@@ -177,7 +192,7 @@ void getRestorationPerHourOfSleep (const MWWorld::Ptr& ptr, float& health, float
     magicka = 0;
     if (!stunted)
     {
-        float fRestMagicMult = settings.find("fRestMagicMult")->getFloat ();
+        float fRestMagicMult = settings.fRestMagicMult;
         magicka = fRestMagicMult * stats.getAttribute(ESM::Attribute::Intelligence).getModified();
     }
 }
@@ -210,7 +225,7 @@ namespace MWMechanics
             if (caster.isEmpty() || !caster.getClass().isActor())
                 return;
 
-            static const float fSoulgemMult = world->getStore().get<ESM::GameSetting>().find("fSoulgemMult")->getFloat();
+            const float fSoulgemMult = world->getStore().getGameSettingCache().fSoulgemMult;
 
             int creatureSoulValue = mCreature.get<ESM::Creature>()->mBase->mData.mSoul;
             if (creatureSoulValue == 0)
@@ -274,14 +289,7 @@ namespace MWMechanics
     void Actors::updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
                                     MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance)
     {
-        static const float fMaxHeadTrackDistance = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                .find("fMaxHeadTrackDistance")->getFloat();
-        static const float fInteriorHeadTrackMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                .find("fInteriorHeadTrackMult")->getFloat();
-        float maxDistance = fMaxHeadTrackDistance;
-        const ESM::Cell* currentCell = actor.getCell()->getCell();
-        if (!currentCell->isExterior() && !(currentCell->mData.mFlags & ESM::Cell::QuasiEx))
-            maxDistance *= fInteriorHeadTrackMult;
+        float maxDistance = getMaxHeadTrackDistance(actor);
 
         const ESM::Position& actor1Pos = actor.getRefData().getPosition();
         const ESM::Position& actor2Pos = targetActor.getRefData().getPosition();
@@ -319,7 +327,7 @@ namespace MWMechanics
         const ESM::Position& actor1Pos = actor1.getRefData().getPosition();
         const ESM::Position& actor2Pos = actor2.getRefData().getPosition();
         float sqrDist = Ogre::Vector3(actor1Pos.pos).squaredDistance(Ogre::Vector3(actor2Pos.pos));
-        if (sqrDist > 7168*7168)
+        if (sqrDist > sActorsProcessingDistance*sActorsProcessingDistance)
             return;
 
         // pure water creatures won't try to fight with the target on the ground
@@ -414,14 +422,13 @@ namespace MWMechanics
         if (creatureStats.isDead())
             return;
 
-        MagicEffects now = creatureStats.getSpells().getMagicEffects();
+        const MWWorld::InventoryStore *equipment = 0;
 
         if (creature.getTypeName()==typeid (ESM::NPC).name())
-        {
-            MWWorld::InventoryStore& store = creature.getClass().getInventoryStore (creature);
-            now += store.getMagicEffects();
-        }
+            equipment = &creature.getClass().getInventoryStore (creature);
 
+        // Only the active spells change from frame to frame
+        MagicEffects now = creatureStats.getPermanentEffects (equipment);
         now += creatureStats.getActiveSpells().getMagicEffects();
 
         creatureStats.modifyMagicEffects(now);
@@ -435,9 +442,9 @@ namespace MWMechanics
 
         float base = 1.f;
         if (ptr == MWBase::Environment::get().getWorld()->getPlayerPtr())
-            base = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fPCbaseMagickaMult")->getFloat();
+            base = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fPCbaseMagickaMult;
         else
-            base = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fNPCbaseMagickaMult")->getFloat();
+            base = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fNPCbaseMagickaMult;
 
         double magickaFactor = base +
             creatureStats.getMagicEffects().get (EffectKey (ESM::MagicEffect::FortifyMaximumMagicka)).getMagnitude() * 0.1;
@@ -454,7 +461,7 @@ namespace MWMechanics
             return;
 
         MWMechanics::CreatureStats& stats = ptr.getClass().getCreatureStats (ptr);
-        const MWWorld::Store<ESM::GameSetting>& settings = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& settings = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
 
         if (sleep)
         {
@@ -477,9 +484,9 @@ namespace MWMechanics
             normalizedEncumbrance = 1;
 
         // restore fatigue
-        float fFatigueReturnBase = settings.find("fFatigueReturnBase")->getFloat ();
-        float fFatigueReturnMult = settings.find("fFatigueReturnMult")->getFloat ();
-        float fEndFatigueMult = settings.find("fEndFatigueMult")->getFloat ();
+        float fFatigueReturnBase = settings.fFatigueReturnBase;
+        float fFatigueReturnMult = settings.fFatigueReturnMult;
+        float fEndFatigueMult = settings.fEndFatigueMult;
 
         float x = fFatigueReturnBase + fFatigueReturnMult * (1 - normalizedEncumbrance);
         x *= fEndFatigueMult * endurance;
@@ -499,9 +506,9 @@ namespace MWMechanics
         int endurance = stats.getAttribute (ESM::Attribute::Endurance).getModified ();
 
         // restore fatigue
-        const MWWorld::Store<ESM::GameSetting>& settings = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        static const float fFatigueReturnBase = settings.find("fFatigueReturnBase")->getFloat ();
-        static const float fFatigueReturnMult = settings.find("fFatigueReturnMult")->getFloat ();
+        const MWWorld::GameSettingCache& settings = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
+        const float fFatigueReturnBase = settings.fFatigueReturnBase;
+        const float fFatigueReturnMult = settings.fFatigueReturnMult;
 
         float x = fFatigueReturnBase + fFatigueReturnMult * endurance;
 
@@ -646,8 +653,7 @@ namespace MWMechanics
                 float timeDiff = std::min(7.f, std::max(0.f, std::abs(time - 13)));
                 float damageScale = 1.f - timeDiff / 7.f;
                 // When cloudy, the sun damage effect is halved
-                static float fMagicSunBlockedMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find(
-                            "fMagicSunBlockedMult")->getFloat();
+                const float fMagicSunBlockedMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fMagicSunBlockedMult;
 
                 int weather = MWBase::Environment::get().getWorld()->getCurrentWeather();
                 if (weather > 1)
@@ -828,7 +834,7 @@ namespace MWMechanics
             if(timeLeft == 0.0f)
             {
                 // If drowning, apply 3 points of damage per second
-                static const float fSuffocationDamage = world->getStore().get<ESM::GameSetting>().find("fSuffocationDamage")->getFloat();
+                const float fSuffocationDamage = world->getStore().getGameSettingCache().fSuffocationDamage;
                 ptr.getClass().setActorHealth(ptr, stats.getHealth().getCurrent() - fSuffocationDamage*duration);
 
                 // Play a drowning sound
@@ -842,7 +848,7 @@ namespace MWMechanics
         }
         else
         {
-            static const float fHoldBreathTime = world->getStore().get<ESM::GameSetting>().find("fHoldBreathTime")->getFloat();
+            const float fHoldBreathTime = world->getStore().getGameSettingCache().fHoldBreathTime;
             stats.setTimeToStartDrowning(fHoldBreathTime);
         }
     }
@@ -959,7 +965,7 @@ namespace MWMechanics
             if (ptr.getClass().isClass(ptr, "Guard") && creatureStats.getAiSequence().getTypeId() != AiPackage::TypeIdPursue && !creatureStats.getAiSequence().isInCombat())
             {
                 const MWWorld::ESMStore& esmStore = MWBase::Environment::get().getWorld()->getStore();
-                int cutoff = esmStore.get<ESM::GameSetting>().find("iCrimeThreshold")->getInt();
+                int cutoff = esmStore.getGameSettingCache().iCrimeThreshold;
                 // Force dialogue on sight if bounty is greater than the cutoff
                 // In vanilla morrowind, the greeting dialogue is scripted to either arrest the player (< 5000 bounty) or attack (>= 5000 bounty)
                 if (   player.getClass().getNpcStats(player).getBounty() >= cutoff
@@ -967,7 +973,7 @@ namespace MWMechanics
                     && MWBase::Environment::get().getWorld()->getLOS(ptr, player)
                     && MWBase::Environment::get().getMechanicsManager()->awarenessCheck(player, ptr))
                 {
-                    static int iCrimeThresholdMultiplier = esmStore.get<ESM::GameSetting>().find("iCrimeThresholdMultiplier")->getInt();
+                    const int iCrimeThresholdMultiplier = esmStore.getGameSettingCache().iCrimeThresholdMultiplier;
                     if (player.getClass().getNpcStats(player).getBounty() >= cutoff * iCrimeThresholdMultiplier)
                         MWBase::Environment::get().getMechanicsManager()->startCombat(ptr, player);
                     else
@@ -1013,6 +1019,7 @@ namespace MWMechanics
 
         MWRender::Animation *anim = MWBase::Environment::get().getWorld()->getAnimation(ptr);
         mActors.insert(std::make_pair(ptr, new Actor(ptr, anim)));
+        mGrid.update(ptr, Ogre::Vector3(ptr.getRefData().getPosition().pos));
         if (updateImmediately)
             mActors[ptr]->getCharacterController()->update(0);
     }
@@ -1024,6 +1031,7 @@ namespace MWMechanics
         {
             delete iter->second;
             mActors.erase(iter);
+            mGrid.remove(ptr);
         }
     }
 
@@ -1037,6 +1045,9 @@ namespace MWMechanics
 
             actor->updatePtr(ptr);
             mActors.insert(std::make_pair(ptr, actor));
+
+            mGrid.remove(old);
+            mGrid.update(ptr, Ogre::Vector3(ptr.getRefData().getPosition().pos));
         }
     }
 
@@ -1047,6 +1058,7 @@ namespace MWMechanics
         {
             if(iter->first.getCell()==cellStore && iter->first != ignore)
             {
+                mGrid.remove(iter->first);
                 delete iter->second;
                 mActors.erase(iter++);
             }
@@ -1070,14 +1082,16 @@ namespace MWMechanics
 
             int hostilesCount = 0; // need to know this to play Battle music
 
-            // AI processing is only done within distance of 7168 units to the player. Note the "AI distance" slider doesn't affect this
+            // AI processing is only done within sActorsProcessingDistance units to the player. Note the "AI distance" slider doesn't affect this
             // (it only does some throttling for targets beyond the "AI distance", so doesn't give any guarantees as to whether AI will be enabled or not)
             // This distance could be made configurable later, but the setting must be marked with a big warning:
             // using higher values will make a quest in Bloodmoon harder or impossible to complete (bug #1876)
-            const float sqrProcessingDistance = 7168*7168;
+            const float sqrProcessingDistance = sActorsProcessingDistance*sActorsProcessingDistance;
 
             /// \todo move update logic to Actor class where appropriate
 
+            std::vector<MWWorld::Ptr> neighbours;
+
              // AI and magic effects update
             for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
             {
@@ -1093,11 +1107,16 @@ namespace MWMechanics
                             if (iter->first != player)
                                 adjustCommandedActor(iter->first);
 
-                            for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                            // engageCombat ignores actors beyond the processing distance
+                            neighbours.clear();
+                            mGrid.getActorsInRange(Ogre::Vector3(iter->first.getRefData().getPosition().pos),
+                                                   sActorsProcessingDistance, neighbours);
+
+                            for(std::vector<MWWorld::Ptr>::iterator it(neighbours.begin()); it != neighbours.end(); ++it)
                             {
-                                if (it->first == iter->first || iter->first == player) // player is not AI-controlled
+                                if (*it == iter->first || iter->first == player) // player is not AI-controlled
                                     continue;
-                                engageCombat(iter->first, it->first, it->first == player);
+                                engageCombat(iter->first, *it, *it == player);
                             }
                         }
                         if (timerUpdateHeadTrack == 0)
@@ -1105,11 +1124,15 @@ namespace MWMechanics
                             float sqrHeadTrackDistance = std::numeric_limits<float>::max();
                             MWWorld::Ptr headTrackTarget;
 
-                            for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                            neighbours.clear();
+                            mGrid.getActorsInRange(Ogre::Vector3(iter->first.getRefData().getPosition().pos),
+                                                   getMaxHeadTrackDistance(iter->first), neighbours);
+
+                            for(std::vector<MWWorld::Ptr>::iterator it(neighbours.begin()); it != neighbours.end(); ++it)
                             {
-                                if (it->first == iter->first)
+                                if (*it == iter->first)
                                     continue;
-                                updateHeadTracking(iter->first, it->first, headTrackTarget, sqrHeadTrackDistance);
+                                updateHeadTracking(iter->first, *it, headTrackTarget, sqrHeadTrackDistance);
                             }
                             iter->second->getCharacterController()->setHeadTrackTarget(headTrackTarget);
                         }
@@ -1213,9 +1236,9 @@ namespace MWMechanics
                 static float sneakSkillTimer = 0.f; // times sneak skill progress from "avoid notice"
 
                 const MWWorld::ESMStore& esmStore = MWBase::Environment::get().getWorld()->getStore();
-                const int radius = esmStore.get<ESM::GameSetting>().find("fSneakUseDist")->getInt();
+                const int radius = esmStore.getGameSettingCache().fSneakUseDist;
 
-                static float fSneakUseDelay = esmStore.get<ESM::GameSetting>().find("fSneakUseDelay")->getFloat();
+                const float fSneakUseDelay = esmStore.getGameSettingCache().fSneakUseDelay;
 
                 if (sneakTimer >= fSneakUseDelay)
                     sneakTimer = 0.f;
@@ -1382,13 +1405,15 @@ namespace MWMechanics
         return false;
     }
 
+    void Actors::updatePosition(const MWWorld::Ptr& ptr)
+    {
+        if (mActors.find(ptr) != mActors.end())
+            mGrid.update(ptr, Ogre::Vector3(ptr.getRefData().getPosition().pos));
+    }
+
     void Actors::getObjectsInRange(const Ogre::Vector3& position, float radius, std::vector<MWWorld::Ptr>& out)
     {
-        for (PtrActorMap::iterator iter = mActors.begin(); iter != mActors.end(); ++iter)
-        {
-            if (Ogre::Vector3(iter->first.getRefData().getPosition().pos).squaredDistance(position) <= radius*radius)
-                out.push_back(iter->first);
-        }
+        mGrid.getActorsInRange(position, radius, out);
     }
 
     std::list<MWWorld::Ptr> Actors::getActorsFollowing(const MWWorld::Ptr& actor)
@@ -1456,7 +1481,7 @@ namespace MWMechanics
         std::vector<MWWorld::Ptr> neighbors;
         Ogre::Vector3 position = Ogre::Vector3(actor.getRefData().getPosition().pos);
         getObjectsInRange(position,
-            MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fAlarmRadius")->getFloat(),
+            MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fAlarmRadius,
             neighbors); //only care about those within the alarm disance
         for(std::vector<MWWorld::Ptr>::iterator iter(neighbors.begin());iter != neighbors.end();++iter)
         {
@@ -1502,6 +1527,7 @@ namespace MWMechanics
             it->second = NULL;
         }
         mActors.clear();
+        mGrid.clear();
         mDeathCount.clear();
     }
 
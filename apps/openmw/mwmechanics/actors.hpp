@@ -8,6 +8,7 @@
 #include <list>
 
 #include "movement.hpp"
+#include "actorgrid.hpp"
 #include "../mwbase/world.hpp"
 
 namespace Ogre
@@ -75,6 +76,9 @@ namespace MWMechanics
             void updateActor(const MWWorld::Ptr &old, const MWWorld::Ptr& ptr);
             ///< Updates an actor with a new Ptr
 
+            void updatePosition(const MWWorld::Ptr& ptr);
+            ///< Updates the position of an actor after it has been moved
+
             void dropActors (const MWWorld::CellStore *cellStore, const MWWorld::Ptr& ignore);
             ///< Deregister all actors (except for \a ignore) in the given cell.
 
@@ -137,6 +141,7 @@ namespace MWMechanics
 
     private:
         PtrActorMap mActors;
+        ActorGrid mGrid;
 
     };
 }
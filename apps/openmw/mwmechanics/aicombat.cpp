@@ -343,8 +343,7 @@ namespace MWMechanics
 
             if (weaptype == WeapType_HandToHand)
             {
-                static float fHandToHandReach =
-                    world->getStore().get<ESM::GameSetting>().find("fHandToHandReach")->getFloat();
+                const float fHandToHandReach = world->getStore().getGameSettingCache().fHandToHandReach;
                 weapRange = fHandToHandReach;
             }
             else if (weaptype != WeapType_PickProbe && weaptype != WeapType_Spell && weaptype != WeapType_None)
@@ -405,7 +404,7 @@ namespace MWMechanics
                 if (actor.getClass().isNpc())
                 {
                     const MWWorld::ESMStore &store = world->getStore();
-                    int chance = store.get<ESM::GameSetting>().find("iVoiceAttackOdds")->getInt();
+                    int chance = store.getGameSettingCache().iVoiceAttackOdds;
                     if (Misc::Rng::roll0to99() < chance)
                     {
                         MWBase::Environment::get().getDialogueManager()->say(actor, "attack");
@@ -872,20 +871,16 @@ Ogre::Vector3 AimDirToMovingTarget(const MWWorld::Ptr& actor, const MWWorld::Ptr
     // get projectile speed (depending on weapon type)
     if (weapType == ESM::Weapon::MarksmanThrown)
     {
-        static float fThrownWeaponMinSpeed = 
-            MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fThrownWeaponMinSpeed")->getFloat();
-        static float fThrownWeaponMaxSpeed = 
-            MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fThrownWeaponMaxSpeed")->getFloat();
+        const float fThrownWeaponMinSpeed = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fThrownWeaponMinSpeed;
+        const float fThrownWeaponMaxSpeed = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fThrownWeaponMaxSpeed;
 
         projSpeed = 
             fThrownWeaponMinSpeed + (fThrownWeaponMaxSpeed - fThrownWeaponMinSpeed) * strength;
     }
     else
     {
-        static float fProjectileMinSpeed = 
-            MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fProjectileMinSpeed")->getFloat();
-        static float fProjectileMaxSpeed = 
-            MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fProjectileMaxSpeed")->getFloat();
+        const float fProjectileMinSpeed = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fProjectileMinSpeed;
+        const float fProjectileMaxSpeed = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fProjectileMaxSpeed;
 
         projSpeed = 
             fProjectileMinSpeed + (fProjectileMaxSpeed - fProjectileMinSpeed) * strength;
@@ -326,8 +326,8 @@ namespace MWMechanics
         {
             MWWorld::Ptr player = MWBase::Environment::get().getWorld()->getPlayerPtr();
 
-            static float fVoiceIdleOdds = MWBase::Environment::get().getWorld()->getStore()
-                    .get<ESM::GameSetting>().find("fVoiceIdleOdds")->getFloat();
+            const float fVoiceIdleOdds = MWBase::Environment::get().getWorld()->getStore()
+                    .getGameSettingCache().fVoiceIdleOdds;
 
             float roll = Misc::Rng::rollProbability() * 10000.0f;
 
@@ -429,8 +429,8 @@ namespace MWMechanics
             // Play a random voice greeting if the player gets too close
             int hello = cStats.getAiSetting(CreatureStats::AI_Hello).getModified();
             float helloDistance = static_cast<float>(hello);
-            static int iGreetDistanceMultiplier =MWBase::Environment::get().getWorld()->getStore()
-                .get<ESM::GameSetting>().find("iGreetDistanceMultiplier")->getInt();
+            const int iGreetDistanceMultiplier = MWBase::Environment::get().getWorld()->getStore()
+                .getGameSettingCache().iGreetDistanceMultiplier;
 
             helloDistance *= iGreetDistanceMultiplier;
 
@@ -627,8 +627,8 @@ namespace MWMechanics
 
         for(unsigned int counter = 0; counter < mIdle.size(); counter++)
         {
-            static float fIdleChanceMultiplier = MWBase::Environment::get().getWorld()->getStore()
-                .get<ESM::GameSetting>().find("fIdleChanceMultiplier")->getFloat();
+            const float fIdleChanceMultiplier = MWBase::Environment::get().getWorld()->getStore()
+                .getGameSettingCache().fIdleChanceMultiplier;
 
             unsigned short idleChance = static_cast<unsigned short>(fIdleChanceMultiplier * mIdle[counter]);
             unsigned short randSelect = (int)(Misc::Rng::rollProbability() * int(100 / fIdleChanceMultiplier));
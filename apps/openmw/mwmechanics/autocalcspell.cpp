@@ -22,32 +22,16 @@ namespace MWMechanics
 
     std::vector<std::string> autoCalcNpcSpells(const int *actorSkills, const int *actorAttributes, const ESM::Race* race)
     {
-        const MWWorld::Store<ESM::GameSetting>& gmst = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        static const float fNPCbaseMagickaMult = gmst.find("fNPCbaseMagickaMult")->getFloat();
-        float baseMagicka = fNPCbaseMagickaMult * actorAttributes[ESM::Attribute::Intelligence];
-
-        static const std::string schools[] = {
-            "alteration", "conjuration", "destruction", "illusion", "mysticism", "restoration"
-        };
-        static int iAutoSpellSchoolMax[6];
-        static bool init = false;
-        if (!init)
-        {
-            for (int i=0; i<6; ++i)
-            {
-                const std::string& gmstName = "iAutoSpell" + schools[i] + "Max";
-                iAutoSpellSchoolMax[i] = gmst.find(gmstName)->getInt();
-            }
-            init = true;
-        }
+        const MWWorld::GameSettingCache& gmst = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
+        float baseMagicka = gmst.fNPCbaseMagickaMult * actorAttributes[ESM::Attribute::Intelligence];
 
         std::map<int, SchoolCaps> schoolCaps;
         for (int i=0; i<6; ++i)
         {
             SchoolCaps caps;
             caps.mCount = 0;
-            caps.mLimit = iAutoSpellSchoolMax[i];
-            caps.mReachedLimit = iAutoSpellSchoolMax[i] <= 0;
+            caps.mLimit = gmst.iAutoSpellSchoolMax[i];
+            caps.mReachedLimit = gmst.iAutoSpellSchoolMax[i] <= 0;
             caps.mMinCost = INT_MAX;
             caps.mWeakestSpell.clear();
             schoolCaps[i] = caps;
@@ -68,8 +52,7 @@ namespace MWMechanics
                 continue;
             if (!(spell->mData.mFlags & ESM::Spell::F_Autocalc))
                 continue;
-            static const int iAutoSpellTimesCanCast = gmst.find("iAutoSpellTimesCanCast")->getInt();
-            if (baseMagicka < iAutoSpellTimesCanCast * spell->mData.mCost)
+            if (baseMagicka < gmst.iAutoSpellTimesCanCast * spell->mData.mCost)
                 continue;
 
             if (race && race->mPowers.exists(spell->mId))
@@ -87,8 +70,7 @@ namespace MWMechanics
             if (cap.mReachedLimit && spell->mData.mCost <= cap.mMinCost)
                 continue;
 
-            static const float fAutoSpellChance = gmst.find("fAutoSpellChance")->getFloat();
-            if (calcAutoCastChance(spell, actorSkills, actorAttributes, school) < fAutoSpellChance)
+            if (calcAutoCastChance(spell, actorSkills, actorAttributes, school) < gmst.fAutoSpellChance)
                 continue;
 
             selectedSpells.push_back(spell->mId);
@@ -146,7 +128,7 @@ namespace MWMechanics
         for (std::vector<ESM::ENAMstruct>::const_iterator effectIt = effects.begin(); effectIt != effects.end(); ++effectIt)
         {
             const ESM::MagicEffect* magicEffect = MWBase::Environment::get().getWorld()->getStore().get<ESM::MagicEffect>().find(effectIt->mEffectID);
-            static const int iAutoSpellAttSkillMin = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("iAutoSpellAttSkillMin")->getInt();
+            const int iAutoSpellAttSkillMin = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().iAutoSpellAttSkillMin;
 
             if ((magicEffect->mData.mFlags & ESM::MagicEffect::TargetSkill))
             {
@@ -199,7 +181,7 @@ namespace MWMechanics
             if (effect.mRange == ESM::RT_Target)
                 x *= 1.5f;
 
-            static const float fEffectCostMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fEffectCostMult")->getFloat();
+            const float fEffectCostMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fEffectCostMult;
             x *= fEffectCostMult;
 
             float s = 2.f * actorSkills[mapSchoolToSkill(magicEffect->mData.mSchool)];
@@ -77,10 +77,10 @@ namespace MWMechanics
         Ogre::Degree angle = signedAngle (Ogre::Vector3(attacker.getRefData().getPosition().pos) - Ogre::Vector3(blocker.getRefData().getPosition().pos),
                                           blocker.getRefData().getBaseNode()->getOrientation().yAxis(), Ogre::Vector3(0,0,1));
 
-        const MWWorld::Store<ESM::GameSetting>& gmst = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        if (angle.valueDegrees() < gmst.find("fCombatBlockLeftAngle")->getFloat())
+        const MWWorld::GameSettingCache& gmst = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
+        if (angle.valueDegrees() < gmst.fCombatBlockLeftAngle)
             return false;
-        if (angle.valueDegrees() > gmst.find("fCombatBlockRightAngle")->getFloat())
+        if (angle.valueDegrees() > gmst.fCombatBlockRightAngle)
             return false;
 
         MWMechanics::CreatureStats& attackerStats = attacker.getClass().getCreatureStats(attacker);
@@ -88,11 +88,11 @@ namespace MWMechanics
         float blockTerm = blocker.getClass().getSkill(blocker, ESM::Skill::Block) + 0.2f * blockerStats.getAttribute(ESM::Attribute::Agility).getModified()
             + 0.1f * blockerStats.getAttribute(ESM::Attribute::Luck).getModified();
         float enemySwing = attackerStats.getAttackStrength();
-        float swingTerm = enemySwing * gmst.find("fSwingBlockMult")->getFloat() + gmst.find("fSwingBlockBase")->getFloat();
+        float swingTerm = enemySwing * gmst.fSwingBlockMult + gmst.fSwingBlockBase;
 
         float blockerTerm = blockTerm * swingTerm;
         if (blocker.getClass().getMovementSettings(blocker).mPosition[1] <= 0)
-            blockerTerm *= gmst.find("fBlockStillBonus")->getFloat();
+            blockerTerm *= gmst.fBlockStillBonus;
         blockerTerm *= blockerStats.getFatigueTerm();
 
         int attackerSkill = 0;
@@ -105,8 +105,8 @@ namespace MWMechanics
         attackerTerm *= attackerStats.getFatigueTerm();
 
         int x = int(blockerTerm - attackerTerm);
-        int iBlockMaxChance = gmst.find("iBlockMaxChance")->getInt();
-        int iBlockMinChance = gmst.find("iBlockMinChance")->getInt();
+        int iBlockMaxChance = gmst.iBlockMaxChance;
+        int iBlockMinChance = gmst.iBlockMinChance;
         x = std::min(iBlockMaxChance, std::max(iBlockMinChance, x));
 
         if (Misc::Rng::roll0to99() < x)
@@ -120,9 +120,9 @@ namespace MWMechanics
                 inv.unequipItem(*shield, blocker);
 
             // Reduce blocker fatigue
-            const float fFatigueBlockBase = gmst.find("fFatigueBlockBase")->getFloat();
-            const float fFatigueBlockMult = gmst.find("fFatigueBlockMult")->getFloat();
-            const float fWeaponFatigueBlockMult = gmst.find("fWeaponFatigueBlockMult")->getFloat();
+            const float fFatigueBlockBase = gmst.fFatigueBlockBase;
+            const float fFatigueBlockMult = gmst.fFatigueBlockMult;
+            const float fWeaponFatigueBlockMult = gmst.fWeaponFatigueBlockMult;
             MWMechanics::DynamicStat<float> fatigue = blockerStats.getFatigue();
             float normalizedEncumbrance = blocker.getClass().getNormalizedEncumbrance(blocker);
             normalizedEncumbrance = std::min(1.f, normalizedEncumbrance);
@@ -156,7 +156,7 @@ namespace MWMechanics
 
         if ((weapon.get<ESM::Weapon>()->mBase->mData.mFlags & ESM::Weapon::Silver)
                 && actor.getClass().isNpc() && actor.getClass().getNpcStats(actor).isWerewolf())
-            damage *= MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fWereWolfSilverWeaponDamageMult")->getFloat();
+            damage *= MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fWereWolfSilverWeaponDamageMult;
 
         if (damage == 0 && attacker == MWBase::Environment::get().getWorld()->getPlayerPtr())
             MWBase::Environment::get().getWindowManager()->messageBox("#{sMagicTargetResistsWeapons}");
@@ -166,7 +166,7 @@ namespace MWMechanics
                        const Ogre::Vector3& hitPosition)
     {
         MWBase::World *world = MWBase::Environment::get().getWorld();
-        const MWWorld::Store<ESM::GameSetting> &gmst = world->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = world->getStore().getGameSettingCache();
 
         MWMechanics::CreatureStats& attackerStats = attacker.getClass().getCreatureStats(attacker);
 
@@ -210,7 +210,7 @@ namespace MWMechanics
             attacker.getClass().skillUsageSucceeded(attacker, weapskill, 0);
 
         if (victim.getClass().getCreatureStats(victim).getKnockedDown())
-            damage *= gmst.find("fCombatKODamageMult")->getFloat();
+            damage *= gmst.fCombatKODamageMult;
 
         // Apply "On hit" effect of the weapon
         bool appliedEnchantment = applyEnchantment(attacker, victim, weapon, hitPosition);
@@ -224,7 +224,7 @@ namespace MWMechanics
         if (victim != MWBase::Environment::get().getWorld()->getPlayerPtr()
                 && !appliedEnchantment)
         {
-            float fProjectileThrownStoreChance = gmst.find("fProjectileThrownStoreChance")->getFloat();
+            float fProjectileThrownStoreChance = gmst.fProjectileThrownStoreChance;
             if (Misc::Rng::rollProbability() < fProjectileThrownStoreChance / 100.f)
                 victim.getClass().getContainerStore(victim).add(projectile, 1, victim);
         }
@@ -238,7 +238,7 @@ namespace MWMechanics
         const MWMechanics::MagicEffects &mageffects = stats.getMagicEffects();
 
         MWBase::World *world = MWBase::Environment::get().getWorld();
-        const MWWorld::Store<ESM::GameSetting> &gmst = world->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = world->getStore().getGameSettingCache();
 
         float defenseTerm = 0;
         if (victim.getClass().getCreatureStats(victim).getFatigue().getCurrent() >= 0)
@@ -255,10 +255,10 @@ namespace MWMechanics
                 defenseTerm = victimStats.getEvasion();
             }
             defenseTerm += std::min(100.f,
-                                    gmst.find("fCombatInvisoMult")->getFloat() *
+                                    gmst.fCombatInvisoMult *
                                     victimStats.getMagicEffects().get(ESM::MagicEffect::Chameleon).getMagnitude());
             defenseTerm += std::min(100.f,
-                                    gmst.find("fCombatInvisoMult")->getFloat() *
+                                    gmst.fCombatInvisoMult *
                                     victimStats.getMagicEffects().get(ESM::MagicEffect::Invisibility).getMagnitude());
         }
         float attackTerm = skillValue +
@@ -304,7 +304,7 @@ namespace MWMechanics
 
             x = std::min(100.f, x + elementResistance);
 
-            static const float fElementalShieldMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fElementalShieldMult")->getFloat();
+            const float fElementalShieldMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fElementalShieldMult;
             x = fElementalShieldMult * magnitude * (1.f - 0.01f * x);
 
             // Note swapped victim and attacker, since the attacker takes the damage here.
@@ -329,7 +329,7 @@ namespace MWMechanics
         {
             int weaphealth = weapon.getClass().getItemHealth(weapon);
 
-            const float fWeaponDamageMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fWeaponDamageMult")->getFloat();
+            const float fWeaponDamageMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fWeaponDamageMult;
             float x = std::max(1.f, fWeaponDamageMult * damage);
 
             weaphealth -= std::min(int(x), weaphealth);
@@ -354,10 +354,8 @@ namespace MWMechanics
             damage *= (float(weaphealth) / weapmaxhealth);
         }
 
-        static const float fDamageStrengthBase = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                .find("fDamageStrengthBase")->getFloat();
-        static const float fDamageStrengthMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                .find("fDamageStrengthMult")->getFloat();
+        const float fDamageStrengthBase = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fDamageStrengthBase;
+        const float fDamageStrengthMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fDamageStrengthMult;
         damage *= fDamageStrengthBase +
                 (attacker.getClass().getCreatureStats(attacker).getAttribute(ESM::Attribute::Strength).getModified() * fDamageStrengthMult * 0.1f);
     }
@@ -368,8 +366,8 @@ namespace MWMechanics
         // calculations. Some mods recommend using it, so we may want to include an
         // option for it.
         const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
-        float minstrike = store.get<ESM::GameSetting>().find("fMinHandToHandMult")->getFloat();
-        float maxstrike = store.get<ESM::GameSetting>().find("fMaxHandToHandMult")->getFloat();
+        float minstrike = store.getGameSettingCache().fMinHandToHandMult;
+        float maxstrike = store.getGameSettingCache().fMaxHandToHandMult;
         damage  = static_cast<float>(attacker.getClass().getSkill(attacker, ESM::Skill::HandToHand));
         damage *= minstrike + ((maxstrike-minstrike)*attacker.getClass().getCreatureStats(attacker).getAttackStrength());
 
@@ -384,7 +382,7 @@ namespace MWMechanics
             damage *= MWBase::Environment::get().getWorld()->getGlobalFloat("werewolfclawmult");
         }
         if(healthdmg)
-            damage *= store.get<ESM::GameSetting>().find("fHandtoHandHealthPer")->getFloat();
+            damage *= store.getGameSettingCache().fHandtoHandHealthPer;
 
         MWBase::SoundManager *sndMgr = MWBase::Environment::get().getSoundManager();
         if(isWerewolf)
@@ -400,10 +398,10 @@ namespace MWMechanics
     void applyFatigueLoss(const MWWorld::Ptr &attacker, const MWWorld::Ptr &weapon)
     {
         // somewhat of a guess, but using the weapon weight makes sense
-        const MWWorld::Store<ESM::GameSetting>& store = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        const float fFatigueAttackBase = store.find("fFatigueAttackBase")->getFloat();
-        const float fFatigueAttackMult = store.find("fFatigueAttackMult")->getFloat();
-        const float fWeaponFatigueMult = store.find("fWeaponFatigueMult")->getFloat();
+        const MWWorld::GameSettingCache& gmst = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
+        const float fFatigueAttackBase = gmst.fFatigueAttackBase;
+        const float fFatigueAttackMult = gmst.fFatigueAttackMult;
+        const float fWeaponFatigueMult = gmst.fWeaponFatigueMult;
         CreatureStats& stats = attacker.getClass().getCreatureStats(attacker);
         MWMechanics::DynamicStat<float> fatigue = stats.getFatigue();
         const float normalizedEncumbrance = attacker.getClass().getNormalizedEncumbrance(attacker);
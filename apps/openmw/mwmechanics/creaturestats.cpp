@@ -5,6 +5,7 @@
 #include <components/esm/creaturestats.hpp>
 
 #include "../mwworld/esmstore.hpp"
+#include "../mwworld/inventorystore.hpp"
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -15,7 +16,8 @@ namespace MWMechanics
     int CreatureStats::sActorId = 0;
 
     CreatureStats::CreatureStats()
-        : mDrawState (DrawState_Nothing), mDead (false), mDied (false), mMurdered(false), mFriendlyHits (0),
+        : mDrawState (DrawState_Nothing), mPermanentSpellsRevision (0), mPermanentEquipmentRevision (0),
+          mDead (false), mDied (false), mMurdered(false), mFriendlyHits (0),
           mTalkedTo (false), mAlarmed (false), mAttacked (false), mAttackingOrSpell(false),
           mKnockdown(false), mKnockdownOneFrame(false), mKnockdownOverOneFrame(false),
           mHitRecovery(false), mBlock(false), mMovementFlags(0), mAttackStrength(0.f),
@@ -43,11 +45,9 @@ namespace MWMechanics
 
         float normalised = floor(max) == 0 ? 1 : std::max (0.0f, current / max);
 
-        const MWWorld::Store<ESM::GameSetting> &gmst =
-            MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
 
-        return gmst.find ("fFatigueBase")->getFloat()
-            - gmst.find ("fFatigueMult")->getFloat() * (1-normalised);
+        return gmst.fFatigueBase - gmst.fFatigueMult * (1-normalised);
     }
 
     const AttributeValue &CreatureStats::getAttribute(int index) const
@@ -212,6 +212,25 @@ namespace MWMechanics
         mMagicEffects.setModifiers(effects);
     }
 
+    const MagicEffects& CreatureStats::getPermanentEffects(const MWWorld::InventoryStore *equipment)
+    {
+        std::size_t equipmentRevision = equipment ? equipment->getMagicEffectsRevision() : 0;
+
+        if (mPermanentSpellsRevision != mSpells.getEffectsRevision() ||
+            mPermanentEquipmentRevision != equipmentRevision)
+        {
+            mPermanentEffects = mSpells.getMagicEffects();
+
+            if (equipment)
+                mPermanentEffects += equipment->getMagicEffects();
+
+            mPermanentSpellsRevision = mSpells.getEffectsRevision();
+            mPermanentEquipmentRevision = equipmentRevision;
+        }
+
+        return mPermanentEffects;
+    }
+
     void CreatureStats::setAttackingOrSpell(bool attackingOrSpell)
     {
         mAttackingOrSpell = attackingOrSpell;
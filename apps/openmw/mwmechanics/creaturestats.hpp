@@ -17,6 +17,11 @@ namespace ESM
     struct CreatureStats;
 }
 
+namespace MWWorld
+{
+    class InventoryStore;
+}
+
 namespace MWMechanics
 {
     /// \brief Common creature stats
@@ -31,6 +36,9 @@ namespace MWMechanics
         Spells mSpells;
         ActiveSpells mActiveSpells;
         MagicEffects mMagicEffects;
+        MagicEffects mPermanentEffects; // see getPermanentEffects
+        std::size_t mPermanentSpellsRevision;
+        std::size_t mPermanentEquipmentRevision;
         Stat<int> mAiSettings[4];
         AiSequence mAiSequence;
         bool mDead;
@@ -139,6 +147,10 @@ namespace MWMechanics
         /// Set Modifier for each magic effect according to \a effects. Does not touch Base values.
         void modifyMagicEffects(const MagicEffects &effects);
 
+        /// Return the sum of the effects of the spells and of the items equipped in \a equipment
+        /// (0 for creatures). It is only added up again after either of them changed.
+        const MagicEffects& getPermanentEffects(const MWWorld::InventoryStore *equipment);
+
         void setAttackingOrSpell(bool attackingOrSpell);
 
         void setLevel(int level);
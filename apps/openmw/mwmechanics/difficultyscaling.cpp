@@ -13,7 +13,7 @@ float scaleDamage(float damage, const MWWorld::Ptr& attacker, const MWWorld::Ptr
     // [-100, 100]
     int difficultySetting = Settings::Manager::getInt("difficulty", "Game");
 
-    static const float fDifficultyMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fDifficultyMult")->getFloat();
+    const float fDifficultyMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fDifficultyMult;
 
     float difficultyTerm = 0.01f * difficultySetting;
 
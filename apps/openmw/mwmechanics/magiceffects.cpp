@@ -2,11 +2,24 @@
 
 #include <cstdlib>
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <components/esm/effectlist.hpp>
 #include <components/esm/magiceffects.hpp>
 
+namespace
+{
+    struct CompareKeys
+    {
+        bool operator() (const MWMechanics::MagicEffects::value_type& left,
+            const MWMechanics::MagicEffects::value_type& right) const
+        {
+            return left.first<right.first;
+        }
+    };
+}
+
 namespace MWMechanics
 {
     EffectKey::EffectKey() : mId (0), mArg (-1) {}
@@ -86,40 +99,139 @@ namespace MWMechanics
         return *this;
     }
 
-    void MagicEffects::remove(const EffectKey &key)
+    bool MagicEffects::const_iterator::isIndexCurrent() const
     {
-        mCollection.erase(key);
+        // An indexed effect comes before the other effects with the same ID, their argument is
+        // not -1
+        return mIndex<ESM::MagicEffect::Length &&
+            (mOther==mEffects->mOther.size() || mIndex<=mEffects->mOther[mOther].first.mId);
     }
 
-    void MagicEffects::add (const EffectKey& key, const EffectParam& param)
+    void MagicEffects::const_iterator::update()
+    {
+        while (mIndex<ESM::MagicEffect::Length && !mEffects->mPresent[mIndex])
+            ++mIndex;
+
+        if (isIndexCurrent())
+            mValue = std::make_pair (EffectKey (mIndex), mEffects->mParams[mIndex]);
+        else if (mOther<mEffects->mOther.size())
+            mValue = mEffects->mOther[mOther];
+    }
+
+    MagicEffects::const_iterator::const_iterator (const MagicEffects *effects, int index,
+        std::size_t other)
+    : mEffects (effects), mIndex (index), mOther (other)
+    {
+        update();
+    }
+
+    MagicEffects::const_iterator& MagicEffects::const_iterator::operator++()
+    {
+        if (isIndexCurrent())
+            ++mIndex;
+        else
+            ++mOther;
+
+        update();
+        return *this;
+    }
+
+    MagicEffects::const_iterator MagicEffects::const_iterator::operator++ (int)
     {
-        Collection::iterator iter = mCollection.find (key);
+        const_iterator iter (*this);
+        ++*this;
+        return iter;
+    }
+
+    const EffectParam *MagicEffects::find (const EffectKey& key) const
+    {
+        if (isIndexed (key))
+            return mPresent[key.mId] ? &mParams[key.mId] : 0;
+
+        OtherEffects::const_iterator iter =
+            std::lower_bound (mOther.begin(), mOther.end(), std::make_pair (key, EffectParam()), CompareKeys());
+
+        if (iter==mOther.end() || key<iter->first)
+            return 0;
 
-        if (iter==mCollection.end())
+        return &iter->second;
+    }
+
+    EffectParam& MagicEffects::insert (const EffectKey& key)
+    {
+        if (isIndexed (key))
         {
-            mCollection.insert (std::make_pair (key, param));
+            mPresent.set (key.mId);
+            return mParams[key.mId];
         }
-        else
+
+        value_type value (key, EffectParam());
+
+        OtherEffects::iterator iter =
+            std::lower_bound (mOther.begin(), mOther.end(), value, CompareKeys());
+
+        if (iter==mOther.end() || key<iter->first)
+            iter = mOther.insert (iter, value);
+
+        return iter->second;
+    }
+
+    MagicEffects::const_iterator MagicEffects::begin() const
+    {
+        return const_iterator (this, 0, 0);
+    }
+
+    MagicEffects::const_iterator MagicEffects::end() const
+    {
+        return const_iterator (this, ESM::MagicEffect::Length, mOther.size());
+    }
+
+    void MagicEffects::remove(const EffectKey &key)
+    {
+        if (isIndexed (key))
         {
-            iter->second += param;
+            mPresent.reset (key.mId);
+            mParams[key.mId] = EffectParam();
+            return;
         }
+
+        value_type value (key, EffectParam());
+
+        OtherEffects::iterator iter =
+            std::lower_bound (mOther.begin(), mOther.end(), value, CompareKeys());
+
+        if (iter!=mOther.end() && !(key<iter->first))
+            mOther.erase (iter);
+    }
+
+    void MagicEffects::add (const EffectKey& key, const EffectParam& param)
+    {
+        insert (key) += param;
     }
 
     void MagicEffects::modifyBase(const EffectKey &key, int diff)
     {
-        mCollection[key].modifyBase(diff);
+        insert (key).modifyBase(diff);
     }
 
     void MagicEffects::setModifiers(const MagicEffects &effects)
     {
-        for (Collection::iterator it = mCollection.begin(); it != mCollection.end(); ++it)
+        for (int i=0; i<ESM::MagicEffect::Length; ++i)
+        {
+            if (effects.mPresent[i])
+                mPresent.set (i);
+
+            mParams[i].setModifier (effects.mParams[i].getModifier());
+        }
+
+        for (OtherEffects::iterator it = mOther.begin(); it != mOther.end(); ++it)
         {
             it->second.setModifier(effects.get(it->first).getModifier());
         }
 
-        for (Collection::const_iterator it = effects.begin(); it != effects.end(); ++it)
+        for (OtherEffects::const_iterator it = effects.mOther.begin(); it != effects.mOther.end(); ++it)
         {
-            mCollection[it->first].setModifier(it->second.getModifier());
+            insert (it->first).setModifier(it->second.getModifier());
         }
     }
 
@@ -132,31 +244,15 @@ namespace MWMechanics
             return *this;
         }
 
-        for (Collection::const_iterator iter (effects.begin()); iter!=effects.end(); ++iter)
-        {
-            Collection::iterator result = mCollection.find (iter->first);
+        mPresent |= effects.mPresent;
 
-            if (result!=mCollection.end())
-                result->second += iter->second;
-            else
-                mCollection.insert (*iter);
-        }
+        for (int i=0; i<ESM::MagicEffect::Length; ++i)
+            mParams[i] += effects.mParams[i];
 
-        return *this;
-    }
+        for (OtherEffects::const_iterator iter (effects.mOther.begin()); iter!=effects.mOther.end(); ++iter)
+            insert (iter->first) += iter->second;
 
-    EffectParam MagicEffects::get (const EffectKey& key) const
-    {
-        Collection::const_iterator iter = mCollection.find (key);
-
-        if (iter==mCollection.end())
-        {
-            return EffectParam();
-        }
-        else
-        {
-            return iter->second;
-        }
+        return *this;
     }
 
     MagicEffects MagicEffects::diff (const MagicEffects& prev, const MagicEffects& now)
@@ -164,11 +260,11 @@ namespace MWMechanics
         MagicEffects result;
 
         // adding/changing
-        for (Collection::const_iterator iter (now.begin()); iter!=now.end(); ++iter)
+        for (const_iterator iter (now.begin()); iter!=now.end(); ++iter)
         {
-            Collection::const_iterator other = prev.mCollection.find (iter->first);
+            const EffectParam *other = prev.find (iter->first);
 
-            if (other==prev.end())
+            if (!other)
             {
                 // adding
                 result.add (iter->first, iter->second);
@@ -176,15 +272,14 @@ namespace MWMechanics
             else
             {
                 // changing
-                result.add (iter->first, iter->second - other->second);
+                result.add (iter->first, iter->second - *other);
             }
         }
 
         // removing
-        for (Collection::const_iterator iter (prev.begin()); iter!=prev.end(); ++iter)
+        for (const_iterator iter (prev.begin()); iter!=prev.end(); ++iter)
         {
-            Collection::const_iterator other = now.mCollection.find (iter->first);
-            if (other==now.end())
+            if (!now.find (iter->first))
             {
                 result.add (iter->first, EffectParam() - iter->second);
             }
@@ -196,7 +291,7 @@ namespace MWMechanics
     void MagicEffects::writeState(ESM::MagicEffects &state) const
     {
         // Don't need to save Modifiers, they are recalculated every frame anyway.
-        for (Collection::const_iterator iter (begin()); iter!=end(); ++iter)
+        for (const_iterator iter (begin()); iter!=end(); ++iter)
         {
             if (iter->second.getBase() != 0)
             {
@@ -210,7 +305,7 @@ namespace MWMechanics
     {
         for (std::map<int, int>::const_iterator it = state.mEffects.begin(); it != state.mEffects.end(); ++it)
         {
-            mCollection[EffectKey(it->first)].setBase(it->second);
+            insert (EffectKey(it->first)).setBase(it->second);
         }
     }
 }
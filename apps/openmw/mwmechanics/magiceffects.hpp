@@ -1,8 +1,13 @@
 #ifndef GAME_MWMECHANICS_MAGICEFFECTS_H
 #define GAME_MWMECHANICS_MAGICEFFECTS_H
 
-#include <map>
+#include <bitset>
+#include <cstddef>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include <components/esm/loadmgef.hpp>
 
 namespace ESM
 {
@@ -80,21 +85,69 @@ namespace MWMechanics
     };
 
     /// \brief Effects currently affecting a NPC or creature
+    ///
+    /// Effects without a skill or attribute argument are kept in an array indexed by effect ID,
+    /// the few others in a small table sorted by key.
     class MagicEffects
     {
         public:
 
-            typedef std::map<EffectKey, EffectParam> Collection;
+            typedef std::pair<EffectKey, EffectParam> value_type;
+
+            /// Visits the effects in the order of their keys
+            class const_iterator
+            {
+                    const MagicEffects *mEffects;
+                    int mIndex; // in mParams
+                    std::size_t mOther; // in mOther
+                    value_type mValue;
+
+                    bool isIndexCurrent() const;
+
+                    void update();
+
+                public:
+
+                    const_iterator (const MagicEffects *effects, int index, std::size_t other);
+
+                    const value_type& operator*() const { return mValue; }
+
+                    const value_type *operator->() const { return &mValue; }
+
+                    const_iterator& operator++();
+
+                    const_iterator operator++ (int);
+
+                    bool operator== (const const_iterator& iter) const
+                    { return mIndex==iter.mIndex && mOther==iter.mOther; }
+
+                    bool operator!= (const const_iterator& iter) const { return !(*this==iter); }
+            };
 
         private:
 
-            Collection mCollection;
+            typedef std::vector<value_type> OtherEffects;
+
+            EffectParam mParams[ESM::MagicEffect::Length]; // zero unless present
+            std::bitset<ESM::MagicEffect::Length> mPresent;
+            OtherEffects mOther;
+
+            static bool isIndexed (const EffectKey& key)
+            {
+                return key.mArg==-1 && key.mId>=0 && key.mId<ESM::MagicEffect::Length;
+            }
+
+            /// \return 0 if \a key is not present
+            const EffectParam *find (const EffectKey& key) const;
+
+            /// Add \a key with a zero EffectParam if it is not present.
+            EffectParam& insert (const EffectKey& key);
 
         public:
 
-            Collection::const_iterator begin() const { return mCollection.begin(); }
+            const_iterator begin() const;
 
-            Collection::const_iterator end() const { return mCollection.end(); }
+            const_iterator end() const;
 
             void readState (const ESM::MagicEffects& state);
             void writeState (ESM::MagicEffects& state) const;
@@ -109,7 +162,14 @@ namespace MWMechanics
 
             MagicEffects& operator+= (const MagicEffects& effects);
 
-            EffectParam get (const EffectKey& key) const;
+            EffectParam get (const EffectKey& key) const
+            {
+                if (isIndexed (key))
+                    return mParams[key.mId];
+
+                const EffectParam *param = find (key);
+                return param ? *param : EffectParam();
+            }
             ///< This function can safely be used for keys that are not present.
 
             static MagicEffects diff (const MagicEffects& prev, const MagicEffects& now);
@@ -39,18 +39,15 @@ namespace
 
         float d = pos1.distance(pos2);
 
-        static const int iFightDistanceBase = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find(
-                    "iFightDistanceBase")->getInt();
-        static const float fFightDistanceMultiplier = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find(
-                    "fFightDistanceMultiplier")->getFloat();
+        const int iFightDistanceBase = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().iFightDistanceBase;
+        const float fFightDistanceMultiplier = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fFightDistanceMultiplier;
 
         return (iFightDistanceBase - fFightDistanceMultiplier * d);
     }
 
     float getFightDispositionBias(float disposition)
     {
-        static const float fFightDispMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find(
-                    "fFightDispMult")->getFloat();
+        const float fFightDispMult = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fFightDispMult;
         return ((50.f - disposition)  * fFightDispMult);
     }
 
@@ -215,7 +212,7 @@ namespace MWMechanics
         }
 
         // F_PCStart spells
-        static const float fPCbaseMagickaMult = esmStore.get<ESM::GameSetting>().find("fPCbaseMagickaMult")->getFloat();
+        const float fPCbaseMagickaMult = esmStore.getGameSettingCache().fPCbaseMagickaMult;
 
         float baseMagicka = fPCbaseMagickaMult * creatureStats.getAttribute(ESM::Attribute::Intelligence).getBase();
         bool reachedLimit = false;
@@ -253,7 +250,7 @@ namespace MWMechanics
             if (baseMagicka < spell->mData.mCost)
                 continue;
 
-            static const float fAutoPCSpellChance = esmStore.get<ESM::GameSetting>().find("fAutoPCSpellChance")->getFloat();
+            const float fAutoPCSpellChance = esmStore.getGameSettingCache().fAutoPCSpellChance;
             MWWorld::MWStore store;
 
             if (AutoCalc::calcAutoCastChance(spell, skills, attributes, -1, &store) < fAutoPCSpellChance)
@@ -288,7 +285,7 @@ namespace MWMechanics
                     weakestSpell = spell;
                     minCost = weakestSpell->mData.mCost;
                 }
-                static const unsigned int iAutoPCSpellMax = esmStore.get<ESM::GameSetting>().find("iAutoPCSpellMax")->getInt();
+                const unsigned int iAutoPCSpellMax = esmStore.getGameSettingCache().iAutoPCSpellMax;
                 if (selectedSpells.size() == iAutoPCSpellMax)
                     reachedLimit = true;
             }
@@ -348,6 +345,12 @@ namespace MWMechanics
             mObjects.updateObject(old, ptr);
     }
 
+    void MechanicsManager::updatePosition(const MWWorld::Ptr& ptr)
+    {
+        if(ptr.getClass().isActor())
+            mActors.updatePosition(ptr);
+    }
+
 
     void MechanicsManager::drop(const MWWorld::CellStore *cellStore)
     {
@@ -408,8 +411,7 @@ namespace MWMechanics
 
             if(stats.getTimeToStartDrowning() != mWatchedStats.getTimeToStartDrowning())
             {
-                const float fHoldBreathTime = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("fHoldBreathTime")->getFloat();
+                const float fHoldBreathTime = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fHoldBreathTime;
                 mWatchedStats.setTimeToStartDrowning(stats.getTimeToStartDrowning());
                 if(stats.getTimeToStartDrowning() >= fHoldBreathTime)
                     winMgr->setDrowningBarVisibility(false);
@@ -594,13 +596,13 @@ namespace MWMechanics
         MWWorld::LiveCellRef<ESM::NPC>* player = playerPtr.get<ESM::NPC>();
         const MWMechanics::NpcStats &playerStats = playerPtr.getClass().getNpcStats(playerPtr);
 
-        const MWWorld::Store<ESM::GameSetting>& gmst = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        static const float fDispRaceMod = gmst.find("fDispRaceMod")->getFloat();
+        const MWWorld::GameSettingCache& gmst = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
+        const float fDispRaceMod = gmst.fDispRaceMod;
         if (Misc::StringUtils::ciEqual(npc->mBase->mRace, player->mBase->mRace))
             x += fDispRaceMod;
 
-        static const float fDispPersonalityMult = gmst.find("fDispPersonalityMult")->getFloat();
-        static const float fDispPersonalityBase = gmst.find("fDispPersonalityBase")->getFloat();
+        const float fDispPersonalityMult = gmst.fDispPersonalityMult;
+        const float fDispPersonalityBase = gmst.fDispPersonalityBase;
         x += fDispPersonalityMult * (playerStats.getAttribute(ESM::Attribute::Personality).getModified() - fDispPersonalityBase);
 
         float reaction = 0;
@@ -637,20 +639,20 @@ namespace MWMechanics
             rank = 0;
         }
 
-        static const float fDispFactionRankMult = gmst.find("fDispFactionRankMult")->getFloat();
-        static const float fDispFactionRankBase = gmst.find("fDispFactionRankBase")->getFloat();
-        static const float fDispFactionMod = gmst.find("fDispFactionMod")->getFloat();
+        const float fDispFactionRankMult = gmst.fDispFactionRankMult;
+        const float fDispFactionRankBase = gmst.fDispFactionRankBase;
+        const float fDispFactionMod = gmst.fDispFactionMod;
         x += (fDispFactionRankMult * rank
             + fDispFactionRankBase)
             * fDispFactionMod * reaction;
 
-        static const float fDispCrimeMod = gmst.find("fDispCrimeMod")->getFloat();
-        static const float fDispDiseaseMod = gmst.find("fDispDiseaseMod")->getFloat();
+        const float fDispCrimeMod = gmst.fDispCrimeMod;
+        const float fDispDiseaseMod = gmst.fDispDiseaseMod;
         x -= fDispCrimeMod * playerStats.getBounty();
         if (playerStats.hasCommonDisease() || playerStats.hasBlightDisease())
             x += fDispDiseaseMod;
 
-        static const float fDispWeaponDrawn = gmst.find("fDispWeaponDrawn")->getFloat();
+        const float fDispWeaponDrawn = gmst.fDispWeaponDrawn;
         if (playerStats.getDrawState() == MWMechanics::DrawState_Weapon)
             x += fDispWeaponDrawn;
 
@@ -1066,7 +1068,7 @@ namespace MWMechanics
 
         Ogre::Vector3 from = Ogre::Vector3(player.getRefData().getPosition().pos);
         const MWWorld::ESMStore& esmStore = MWBase::Environment::get().getWorld()->getStore();
-        float radius = esmStore.get<ESM::GameSetting>().find("fAlarmRadius")->getFloat();
+        float radius = esmStore.getGameSettingCache().fAlarmRadius;
 
         mActors.getObjectsInRange(from, radius, neighbors);
 
@@ -1155,7 +1157,7 @@ namespace MWMechanics
         const MWWorld::ESMStore& esmStore = MWBase::Environment::get().getWorld()->getStore();
 
         Ogre::Vector3 from = Ogre::Vector3(player.getRefData().getPosition().pos);
-        float radius = esmStore.get<ESM::GameSetting>().find("fAlarmRadius")->getFloat();
+        float radius = esmStore.getGameSettingCache().fAlarmRadius;
 
         mActors.getObjectsInRange(from, radius, neighbors);
 
@@ -1339,7 +1341,7 @@ namespace MWMechanics
         if (observer.getClass().getCreatureStats(observer).isDead() || !observer.getRefData().isEnabled())
             return false;
 
-        const MWWorld::Store<ESM::GameSetting>& store = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
 
         CreatureStats& stats = ptr.getClass().getCreatureStats(ptr);
 
@@ -1352,8 +1354,8 @@ namespace MWMechanics
                 && !MWBase::Environment::get().getWorld()->isSwimming(ptr)
                 && MWBase::Environment::get().getWorld()->isOnGround(ptr))
         {
-            static float fSneakSkillMult = store.find("fSneakSkillMult")->getFloat();
-            static float fSneakBootMult = store.find("fSneakBootMult")->getFloat();
+            const float fSneakSkillMult = gmst.fSneakSkillMult;
+            const float fSneakBootMult = gmst.fSneakBootMult;
             float sneak = static_cast<float>(ptr.getClass().getSkill(ptr, ESM::Skill::Sneak));
             int agility = stats.getAttribute(ESM::Attribute::Agility).getModified();
             int luck = stats.getAttribute(ESM::Attribute::Luck).getModified();
@@ -1368,8 +1370,8 @@ namespace MWMechanics
             sneakTerm = fSneakSkillMult * sneak + 0.2f * agility + 0.1f * luck + bootWeight * fSneakBootMult;
         }
 
-        static float fSneakDistBase = store.find("fSneakDistanceBase")->getFloat();
-        static float fSneakDistMult = store.find("fSneakDistanceMultiplier")->getFloat();
+        const float fSneakDistBase = gmst.fSneakDistanceBase;
+        const float fSneakDistMult = gmst.fSneakDistanceMultiplier;
 
         Ogre::Vector3 pos1 (ptr.getRefData().getPosition().pos);
         Ogre::Vector3 pos2 (observer.getRefData().getPosition().pos);
@@ -1387,8 +1389,8 @@ namespace MWMechanics
         float obsTerm = obsSneak + 0.2f * obsAgility + 0.1f * obsLuck - obsBlind;
 
         // is ptr behind the observer?
-        static float fSneakNoViewMult = store.find("fSneakNoViewMult")->getFloat();
-        static float fSneakViewMult = store.find("fSneakViewMult")->getFloat();
+        const float fSneakNoViewMult = gmst.fSneakNoViewMult;
+        const float fSneakViewMult = gmst.fSneakViewMult;
         float y = 0;
         Ogre::Vector3 vec = pos1 - pos2;
         Ogre::Radian angle = observer.getRefData().getBaseNode()->getOrientation().yAxis().angleBetween(vec);
@@ -57,6 +57,9 @@ namespace MWMechanics
             virtual void updateCell(const MWWorld::Ptr &old, const MWWorld::Ptr &ptr);
             ///< Moves an object to a new cell
 
+            virtual void updatePosition(const MWWorld::Ptr& ptr);
+            ///< Moves an object to its new position within its cell
+
             virtual void drop(const MWWorld::CellStore *cellStore);
             ///< Deregister all objects in the given cell.
 
@@ -9,85 +9,6 @@
 #include "../mwworld/esmstore.hpp"
 #include "../mwworld/cellstore.hpp"
 
-namespace
-{
-    // Slightly cheaper version for comparisons.
-    // Caller needs to be careful for very short distances (i.e. less than 1)
-    // or when accumuating the results i.e. (a + b)^2 != a^2 + b^2
-    //
-    float distanceSquared(ESM::Pathgrid::Point point, Ogre::Vector3 pos)
-    {
-        return MWMechanics::PathFinder::MakeOgreVector3(point).squaredDistance(pos);
-    }
-
-    // Return the closest pathgrid point index from the specified position co
-    // -ordinates.  NOTE: Does not check if there is a sensible way to get there
-    // (e.g. a cliff in front).
-    //
-    // NOTE: pos is expected to be in local co-ordinates, as is grid->mPoints
-    //
-    int getClosestPoint(const ESM::Pathgrid* grid, Ogre::Vector3 pos)
-    {
-        if(!grid || grid->mPoints.empty())
-            return -1;
-
-        float distanceBetween = distanceSquared(grid->mPoints[0], pos);
-        int closestIndex = 0;
-
-        // TODO: if this full scan causes performance problems mapping pathgrid
-        //       points to a quadtree may help
-        for(unsigned int counter = 1; counter < grid->mPoints.size(); counter++)
-        {
-            float potentialDistBetween = distanceSquared(grid->mPoints[counter], pos);
-            if(potentialDistBetween < distanceBetween)
-            {
-                distanceBetween = potentialDistBetween;
-                closestIndex = counter;
-            }
-        }
-
-        return closestIndex;
-    }
-
-    // Chooses a reachable end pathgrid point.  start is assumed reachable.
-    std::pair<int, bool> getClosestReachablePoint(const ESM::Pathgrid* grid,
-                                                  const MWWorld::CellStore *cell,
-                                                  Ogre::Vector3 pos, int start)
-    {
-        if(!grid || grid->mPoints.empty())
-            return std::pair<int, bool> (-1, false);
-
-        float distanceBetween = distanceSquared(grid->mPoints[0], pos);
-        int closestIndex = 0;
-        int closestReachableIndex = 0;
-        // TODO: if this full scan causes performance problems mapping pathgrid
-        //       points to a quadtree may help
-        for(unsigned int counter = 1; counter < grid->mPoints.size(); counter++)
-        {
-            float potentialDistBetween = distanceSquared(grid->mPoints[counter], pos);
-            if(potentialDistBetween < distanceBetween)
-            {
-                // found a closer one
-                distanceBetween = potentialDistBetween;
-                closestIndex = counter;
-                if (cell->isPointConnected(start, counter))
-                {
-                    closestReachableIndex = counter;
-                }
-            }
-        }
-        // AiWander has logic that depends on whether a path was created, deleting
-        // allowed nodes if not.  Hence a path needs to be created even if the start
-        // and the end points are the same.
-        //if(start == closestReachableIndex)
-            //closestReachableIndex = -1; // couldn't find anyting other than start
-
-        return std::pair<int, bool>
-            (closestReachableIndex, closestReachableIndex == closestIndex);
-    }
-
-}
-
 namespace MWMechanics
 {
     float sqrDistanceIgnoreZ(ESM::Pathgrid::Point point, float x, float y)
@@ -211,12 +132,13 @@ namespace MWMechanics
         //       outside an area enclosed by walls, but there is a pathgrid
         //       point right behind the wall that is closer than any pathgrid
         //       point outside the wall
-        int startNode = getClosestPoint(mPathgrid,
+        int startNode = mCell->getClosestPoint(
                 Ogre::Vector3(startPoint.mX - xCell, startPoint.mY - yCell, static_cast<float>(startPoint.mZ)));
         // Some cells don't have any pathgrids at all
         if(startNode != -1)
         {
-            std::pair<int, bool> endNode = getClosestReachablePoint(mPathgrid, cell,
+            // Chooses a reachable end pathgrid point.  start is reachable.
+            std::pair<int, bool> endNode = mCell->getClosestReachablePoint(
                 Ogre::Vector3(endPoint.mX - xCell, endPoint.mY - yCell, static_cast<float>(endPoint.mZ)),
                     startNode);
 
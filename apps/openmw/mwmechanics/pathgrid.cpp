@@ -1,10 +1,12 @@
 #include "pathgrid.hpp"
 
-#include "../mwbase/world.hpp"
-#include "../mwbase/environment.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
 
-#include "../mwworld/cellstore.hpp"
-#include "../mwworld/esmstore.hpp"
+#include <components/esm/loadland.hpp>
 
 namespace
 {
@@ -45,15 +47,46 @@ namespace
         //return distance(a, b);
         return manhattan(a, b);
     }
+
+    // must give the same results as the full scan of the pathgrid points that
+    // PathFinder used before
+    float distanceSquared(const ESM::Pathgrid::Point& point, const Ogre::Vector3& pos)
+    {
+        return Ogre::Vector3(static_cast<Ogre::Real>(point.mX), static_cast<Ogre::Real>(point.mY),
+            static_cast<Ogre::Real>(point.mZ)).squaredDistance(pos);
+    }
+
+    float coordinate(const ESM::Pathgrid::Point& point, int axis)
+    {
+        return static_cast<float>(axis == 0 ? point.mX : (axis == 1 ? point.mY : point.mZ));
+    }
+
+    class CompareCoordinate
+    {
+            const ESM::Pathgrid *mPathgrid;
+            int mAxis;
+
+        public:
+            CompareCoordinate(const ESM::Pathgrid *pathgrid, int axis)
+                : mPathgrid(pathgrid), mAxis(axis)
+            {
+            }
+
+            bool operator()(int left, int right) const
+            {
+                return coordinate(mPathgrid->mPoints[left], mAxis) < coordinate(mPathgrid->mPoints[right], mAxis);
+            }
+    };
+
+    // how many paths each cell remembers
+    const std::size_t sPathCacheSize = 32;
 }
 
 namespace MWMechanics
 {
     PathgridGraph::PathgridGraph()
-        : mCell(NULL)
-        , mPathgrid(NULL)
+        : mPathgrid(NULL)
         , mIsExterior(0)
-        , mGraph(0)
         , mIsGraphConstructed(false)
         , mSCCId(0)
         , mSCCIndex(0)
@@ -61,12 +94,12 @@ namespace MWMechanics
     }
 
     /*
-     * mGraph is populated with the cost of each allowed edge.
+     * The graph is populated with the cost of each allowed edge.
      *
      * The data structure is based on the code in buildPath2() but modified.
      * Please check git history if interested.
      *
-     * mGraph[v].edges[i].index = w
+     * mEdges[mEdgeOffsets[v] + i].index = w
      *
      *   v = point index of location "from"
      *   i = index of edges from point v
@@ -75,14 +108,16 @@ namespace MWMechanics
      *
      * Example: (notice from p(0) to p(2) is not allowed in this example)
      *
-     *   mGraph[0].edges[0].index = 1
-     *            .edges[1].index = 3
+     *   mEdgeOffsets = 0, 2, 5, 6, ...
      *
-     *   mGraph[1].edges[0].index = 0
-     *            .edges[1].index = 2
-     *            .edges[2].index = 3
+     *   mEdges[0].index = 1   (edges of p(0))
+     *   mEdges[1].index = 3
      *
-     *   mGraph[2].edges[0].index = 1
+     *   mEdges[2].index = 0   (edges of p(1))
+     *   mEdges[3].index = 2
+     *   mEdges[4].index = 3
+     *
+     *   mEdges[5].index = 1   (edges of p(2))
      *
      *   (etc, etc)
      *
@@ -96,36 +131,47 @@ namespace MWMechanics
      *    +---------------->
      *      high cost
      */
-    bool PathgridGraph::load(const MWWorld::CellStore *cell)
+    bool PathgridGraph::load(const ESM::Pathgrid *pathgrid, bool isExterior)
     {
-        if(!cell)
-            return false;
-
         if(mIsGraphConstructed)
             return true;
 
-        mCell = cell->getCell();
-        mIsExterior = cell->getCell()->isExterior();
-        mPathgrid = MWBase::Environment::get().getWorld()->getStore().get<ESM::Pathgrid>().search(*cell->getCell());
+        mIsExterior = isExterior;
+        mPathgrid = pathgrid;
         if(!mPathgrid)
             return false;
 
+        int pointsSize = static_cast<int> (mPathgrid->mPoints.size());
+        int edgesSize = static_cast<int> (mPathgrid->mEdges.size());
+
+        // count the edges of each point first, then place them
+        mEdgeOffsets.assign(pointsSize + 1, 0);
+        for(int i = 0; i < edgesSize; i++)
+            mEdgeOffsets[mPathgrid->mEdges[i].mV0 + 1]++;
 
-        mGraph.resize(mPathgrid->mPoints.size());
-        for(int i = 0; i < static_cast<int> (mPathgrid->mEdges.size()); i++)
+        for(int v = 0; v < pointsSize; v++)
+            mEdgeOffsets[v + 1] += mEdgeOffsets[v];
+
+        std::vector<int> next(mEdgeOffsets.begin(), mEdgeOffsets.end() - 1);
+        mEdges.resize(edgesSize);
+        for(int i = 0; i < edgesSize; i++)
         {
             ConnectedPoint neighbour;
             neighbour.cost = costAStar(mPathgrid->mPoints[mPathgrid->mEdges[i].mV0],
                                        mPathgrid->mPoints[mPathgrid->mEdges[i].mV1]);
             // forward path of the edge
+            // NOTE: The reverse paths are redundant, ESM already contains them
             neighbour.index = mPathgrid->mEdges[i].mV1;
-            mGraph[mPathgrid->mEdges[i].mV0].edges.push_back(neighbour);
-            // reverse path of the edge
-            // NOTE: These are redundant, ESM already contains the required reverse paths
-            //neighbour.index = mPathgrid->mEdges[i].mV0;
-            //mGraph[mPathgrid->mEdges[i].mV1].edges.push_back(neighbour);
+            mEdges[next[mPathgrid->mEdges[i].mV0]++] = neighbour;
         }
+
         buildConnectedPoints();
+
+        mTree.resize(pointsSize);
+        for(int v = 0; v < pointsSize; v++)
+            mTree[v] = v;
+        buildTree(0, pointsSize, 0);
+
         mIsGraphConstructed = true;
         return true;
     }
@@ -137,11 +183,12 @@ namespace MWMechanics
         mSCCPoint[v].second = mSCCIndex; // lowlink
         mSCCIndex++;
         mSCCStack.push_back(v);
+        mSCCOnStack[v] = true;
         int w;
 
-        for(int i = 0; i < static_cast<int> (mGraph[v].edges.size()); i++)
+        for(int i = mEdgeOffsets[v]; i < mEdgeOffsets[v + 1]; i++)
         {
-            w = mGraph[v].edges[i].index;
+            w = mEdges[i].index;
             if(mSCCPoint[w].first == -1) // not visited
             {
                 recursiveStrongConnect(w); // recurse
@@ -150,7 +197,7 @@ namespace MWMechanics
             }
             else
             {
-                if(find(mSCCStack.begin(), mSCCStack.end(), w) != mSCCStack.end())
+                if(mSCCOnStack[w])
                     mSCCPoint[v].second = std::min(mSCCPoint[v].second,
                                                    mSCCPoint[w].first);
             }
@@ -162,7 +209,8 @@ namespace MWMechanics
             {
                 w = mSCCStack.back();
                 mSCCStack.pop_back();
-                mGraph[w].componentId = mSCCId;
+                mSCCOnStack[w] = false;
+                mComponentIds[w] = mSCCId;
             }
             while(w != v);
             mSCCId++;
@@ -171,26 +219,25 @@ namespace MWMechanics
     }
 
     /*
-     * mGraph contains the strongly connected component group id's along
-     * with pre-calculated edge costs.
+     * mComponentIds contains the strongly connected component group id's.
      *
      * A cell can have disjointed pathgrids, e.g. Seyda Neen has 3
      *
-     * mGraph for Seyda Neen will therefore have 3 different values.  When
-     * selecting a random pathgrid point for AiWander, mGraph can be checked
-     * for quickly finding whether the destination is reachable.
+     * mComponentIds for Seyda Neen will therefore have 3 different values.
+     * When selecting a random pathgrid point for AiWander, mComponentIds can
+     * be checked for quickly finding whether the destination is reachable.
      *
      * Otherwise, buildPath can automatically select a closest reachable end
      * pathgrid point (reachable from the closest start point).
      *
      * Using Tarjan's algorithm:
      *
-     *  mGraph                   | graph G   |
+     *  graph                    | graph G   |
      *  mSCCPoint                | V         | derived from mPoints
-     *  mGraph[v].edges          | E (for v) |
+     *  edges of v               | E (for v) |
      *  mSCCIndex                | index     | tracking smallest unused index
      *  mSCCStack                | S         |
-     *  mGraph[v].edges[i].index | w         |
+     *  mEdges[i].index          | w         |
      *
      */
     void PathgridGraph::buildConnectedPoints()
@@ -199,7 +246,9 @@ namespace MWMechanics
         //mSCCId = 0; // how many strongly connected components in this cell
         //mSCCIndex = 0;
         int pointsSize = static_cast<int> (mPathgrid->mPoints.size());
+        mComponentIds.resize(pointsSize, -1);
         mSCCPoint.resize(pointsSize, std::pair<int, int> (-1, -1));
+        mSCCOnStack.resize(pointsSize, false);
         mSCCStack.reserve(pointsSize);
 
         for(int v = 0; v < pointsSize; v++)
@@ -211,7 +260,87 @@ namespace MWMechanics
 
     bool PathgridGraph::isPointConnected(const int start, const int end) const
     {
-        return (mGraph[start].componentId == mGraph[end].componentId);
+        return (mComponentIds[start] == mComponentIds[end]);
+    }
+
+    void PathgridGraph::buildTree(int begin, int end, int depth)
+    {
+        if(end - begin < 2)
+            return;
+
+        int middle = begin + (end - begin) / 2;
+        std::nth_element(mTree.begin() + begin, mTree.begin() + middle, mTree.begin() + end,
+                         CompareCoordinate(mPathgrid, depth % 3));
+
+        buildTree(begin, middle, depth + 1);
+        buildTree(middle + 1, end, depth + 1);
+    }
+
+    void PathgridGraph::searchTree(int begin, int end, int depth, const Ogre::Vector3& pos, int componentId,
+                                   int& closest, float& closestDistance) const
+    {
+        if(begin >= end)
+            return;
+
+        int middle = begin + (end - begin) / 2;
+        int index = mTree[middle];
+        const ESM::Pathgrid::Point& point = mPathgrid->mPoints[index];
+
+        if(componentId == -1 || mComponentIds[index] == componentId)
+        {
+            // of points at the same distance the one with the lowest index wins, as in a full scan
+            float distance = distanceSquared(point, pos);
+            if(closest == -1 || distance < closestDistance
+                || (distance == closestDistance && index < closest))
+            {
+                closest = index;
+                closestDistance = distance;
+            }
+        }
+
+        int axis = depth % 3;
+        float difference = pos[axis] - coordinate(point, axis);
+
+        // search the side of the split pos is on first, the other one only if it can have a closer point
+        if(difference < 0)
+        {
+            searchTree(begin, middle, depth + 1, pos, componentId, closest, closestDistance);
+            if(closest == -1 || difference * difference <= closestDistance)
+                searchTree(middle + 1, end, depth + 1, pos, componentId, closest, closestDistance);
+        }
+        else
+        {
+            searchTree(middle + 1, end, depth + 1, pos, componentId, closest, closestDistance);
+            if(closest == -1 || difference * difference <= closestDistance)
+                searchTree(begin, middle, depth + 1, pos, componentId, closest, closestDistance);
+        }
+    }
+
+    int PathgridGraph::searchTree(const Ogre::Vector3& pos, int componentId) const
+    {
+        int closest = -1;
+        float closestDistance = 0;
+        searchTree(0, static_cast<int> (mTree.size()), 0, pos, componentId, closest, closestDistance);
+        return closest;
+    }
+
+    int PathgridGraph::getClosestPoint(const Ogre::Vector3& pos) const
+    {
+        if(!mIsGraphConstructed)
+            return -1;
+
+        return searchTree(pos, -1);
+    }
+
+    std::pair<int, bool> PathgridGraph::getClosestReachablePoint(const Ogre::Vector3& pos, int start) const
+    {
+        if(!mIsGraphConstructed || mTree.empty())
+            return std::pair<int, bool> (-1, false);
+
+        int closest = searchTree(pos, -1);
+        int closestReachable = searchTree(pos, mComponentIds[start]);
+
+        return std::pair<int, bool> (closestReachable, closestReachable == closest);
     }
 
     /*
@@ -219,10 +348,10 @@ namespace MWMechanics
      *       Should consider using a 3rd party library version (e.g. boost)
      *
      * Find the shortest path to the target goal using a well known algorithm.
-     * Uses mGraph which has pre-computed costs for allowed edges.  It is assumed
-     * that mGraph is already constructed.
+     * Uses the graph which has pre-computed costs for allowed edges.  It is
+     * assumed that the graph is already constructed.
      *
-     * Should be possible to make this MT safe.
+     * Not MT safe, as the paths found are remembered for the next search.
      *
      * Returns path which may be empty.  path contains pathgrid points in local
      * cell co-ordinates (indoors) or world co-ordinates (external).
@@ -231,15 +360,15 @@ namespace MWMechanics
      *   start, goal - pathgrid point indexes (for this cell)
      *
      * Variables:
-     *   openset - point indexes to be traversed, lowest cost at the front
-     *   closedset - point indexes already traversed
+     *   openset - fScore and point index to be traversed, lowest fScore on top;
+     *             a point whose fScore has been lowered since it was added is
+     *             in there more than once, the stale entries are skipped
+     *   closedset - points already traversed
      *   gScore - past accumulated costs vector indexed by point index
      *   fScore - future estimated costs vector indexed by point index
      *
-     * TODO: An intersting exercise might be to cache the paths created for a
-     *       start/goal pair.  To cache the results the paths need to be in
-     *       pathgrid points form (currently they are converted to world
-     *       co-ordinates).  Essentially trading speed w/ memory.
+     * The paths are cached for a start/goal pair in pathgrid points form, and
+     * converted to world co-ordinates when returned.
      */
     std::list<ESM::Pathgrid::Point> PathgridGraph::aStarSearch(const int start,
                                                                const int goal) const
@@ -250,69 +379,89 @@ namespace MWMechanics
             return path; // there is no path, return an empty path
         }
 
-        int graphSize = static_cast<int> (mGraph.size());
-        std::vector<float> gScore (graphSize, -1);
-        std::vector<float> fScore (graphSize, -1);
-        std::vector<int> graphParent (graphSize, -1);
+        std::list<CachedPath>::iterator cached = mPathCache.begin();
+        for(; cached != mPathCache.end(); ++cached)
+        {
+            if(cached->start == start && cached->end == goal)
+                break;
+        }
+
+        if(cached != mPathCache.end())
+        {
+            // most recently used first
+            mPathCache.splice(mPathCache.begin(), mPathCache, cached);
+        }
+        else
+        {
+            int graphSize = static_cast<int> (mComponentIds.size());
+            std::vector<float> gScore (graphSize, -1);
+            std::vector<float> fScore (graphSize, -1);
+            std::vector<int> graphParent (graphSize, -1);
+            std::vector<bool> closedset (graphSize, false);
+
+            // gScore & fScore keep costs for each pathgrid point in mPoints
+            gScore[start] = 0;
+            fScore[start] = costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]);
 
-        // gScore & fScore keep costs for each pathgrid point in mPoints
-        gScore[start] = 0;
-        fScore[start] = costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]);
+            typedef std::pair<float, int> OpenPoint;
+            std::priority_queue<OpenPoint, std::vector<OpenPoint>, std::greater<OpenPoint> > openset;
+            openset.push(OpenPoint(fScore[start], start));
 
-        std::list<int> openset;
-        std::list<int> closedset;
-        openset.push_back(start);
+            int current = -1;
 
-        int current = -1;
+            while(!openset.empty())
+            {
+                OpenPoint top = openset.top(); // lowest cost
+                openset.pop();
+                current = top.second;
 
-        while(!openset.empty())
-        {
-            current = openset.front(); // front has the lowest cost
-            openset.pop_front();
+                if(closedset[current] || top.first > fScore[current])
+                    continue; // stale entry
 
-            if(current == goal)
-                break;
+                if(current == goal)
+                    break;
 
-            closedset.push_back(current); // remember we've been here
+                closedset[current] = true; // remember we've been here
 
-            // check all edges for the current point index
-            for(int j = 0; j < static_cast<int> (mGraph[current].edges.size()); j++)
-            {
-                if(std::find(closedset.begin(), closedset.end(), mGraph[current].edges[j].index) ==
-                   closedset.end())
+                // check all edges for the current point index
+                for(int j = mEdgeOffsets[current]; j < mEdgeOffsets[current + 1]; j++)
                 {
-                    // not in closedset - i.e. have not traversed this edge destination
-                    int dest = mGraph[current].edges[j].index;
-                    float tentative_g = gScore[current] + mGraph[current].edges[j].cost;
-                    bool isInOpenSet = std::find(openset.begin(), openset.end(), dest) != openset.end();
-                    if(!isInOpenSet
-                        || tentative_g < gScore[dest])
+                    int dest = mEdges[j].index;
+                    if(closedset[dest])
+                        continue; // traversed this edge destination already, try the next edge
+
+                    float tentative_g = gScore[current] + mEdges[j].cost;
+                    if(gScore[dest] < 0 || tentative_g < gScore[dest])
                     {
                         graphParent[dest] = current;
                         gScore[dest] = tentative_g;
                         fScore[dest] = tentative_g + costAStar(mPathgrid->mPoints[dest],
                                                                mPathgrid->mPoints[goal]);
-                        if(!isInOpenSet)
-                        {
-                            // add this edge to openset, lowest cost goes to the front
-                            // TODO: if this causes performance problems a hash table may help
-                            std::list<int>::iterator it = openset.begin();
-                            for(it = openset.begin(); it!= openset.end(); ++it)
-                            {
-                                if(fScore[*it] > fScore[dest])
-                                    break;
-                            }
-                            openset.insert(it, dest);
-                        }
+                        openset.push(OpenPoint(fScore[dest], dest));
                     }
-                } // if in closedset, i.e. traversed this edge already, try the next edge
+                }
             }
-        }
 
-        if(current != goal)
-            return path; // for some reason couldn't build a path
+            if(current != goal)
+                return path; // for some reason couldn't build a path
+
+            CachedPath found;
+            found.start = start;
+            found.end = goal;
+
+            while(current != -1)
+            {
+                found.points.push_back(current);
+                current = graphParent[current];
+            }
+            std::reverse(found.points.begin(), found.points.end());
+
+            mPathCache.push_front(found);
+            if(mPathCache.size() > sPathCacheSize)
+                mPathCache.pop_back();
+        }
 
-        // reconstruct path to return, using world co-ordinates
+        // return the path using world co-ordinates
         float xCell = 0;
         float yCell = 0;
         if (mIsExterior)
@@ -321,21 +470,14 @@ namespace MWMechanics
             yCell = static_cast<float>(mPathgrid->mData.mY * ESM::Land::REAL_SIZE);
         }
 
-        while(graphParent[current] != -1)
+        const std::vector<int>& points = mPathCache.front().points;
+        for(std::vector<int>::const_iterator it = points.begin(); it != points.end(); ++it)
         {
-            ESM::Pathgrid::Point pt = mPathgrid->mPoints[current];
+            ESM::Pathgrid::Point pt = mPathgrid->mPoints[*it];
             pt.mX += static_cast<int>(xCell);
             pt.mY += static_cast<int>(yCell);
-            path.push_front(pt);
-            current = graphParent[current];
+            path.push_back(pt);
         }
-
-        // add first node to path explicitly
-        ESM::Pathgrid::Point pt = mPathgrid->mPoints[start];
-        pt.mX += static_cast<int>(xCell);
-        pt.mY += static_cast<int>(yCell);
-        path.push_front(pt);
         return path;
     }
 }
-
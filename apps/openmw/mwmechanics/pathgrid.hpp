@@ -3,16 +3,10 @@
 
 #include <components/esm/loadpgrd.hpp>
 #include <list>
+#include <utility>
+#include <vector>
 
-namespace ESM
-{
-    struct Cell;
-}
-
-namespace MWWorld
-{
-    class CellStore;
-}
+#include <OgreVector3.h>
 
 namespace MWMechanics
 {
@@ -21,12 +15,26 @@ namespace MWMechanics
         public:
             PathgridGraph();
 
-            bool load(const MWWorld::CellStore *cell);
+            // builds the graph of the pathgrid of a cell (which may be null),
+            // unless it has been built already
+            bool load(const ESM::Pathgrid *pathgrid, bool isExterior);
 
             // returns true if end point is strongly connected (i.e. reachable
             // from start point) both start and end are pathgrid point indexes
             bool isPointConnected(const int start, const int end) const;
 
+            // returns the index of the pathgrid point closest to pos, or -1 if
+            // there are none; pos is in local co-ordinates, as are the points
+            //
+            // NOTE: Does not check if there is a sensible way to get there
+            // (e.g. a cliff in front).
+            int getClosestPoint(const Ogre::Vector3& pos) const;
+
+            // returns the index of the pathgrid point closest to pos that is
+            // reachable from start, and whether it is also the closest point
+            // of all
+            std::pair<int, bool> getClosestReachablePoint(const Ogre::Vector3& pos, int start) const;
+
             // the input parameters are pathgrid point indexes
             // the output list is in local (internal cells) or world (external
             // cells) co-ordinates
@@ -36,7 +44,6 @@ namespace MWMechanics
                                                         const int end) const;
         private:
 
-            const ESM::Cell *mCell;
             const ESM::Pathgrid *mPathgrid;
             bool mIsExterior;
 
@@ -46,11 +53,11 @@ namespace MWMechanics
                 float cost;
             };
 
-            struct Node // point
-            {
-                int componentId;
-                std::vector<ConnectedPoint> edges; // neighbours
-            };
+            // The edges of point v are mEdges[mEdgeOffsets[v]] up to (not
+            // including) mEdges[mEdgeOffsets[v+1]], so that the neighbours of
+            // a point are next to each other in memory.
+            std::vector<int> mEdgeOffsets;
+            std::vector<ConnectedPoint> mEdges;
 
             // componentId is an integer indicating the groups of connected
             // pathgrid points (all connected points will have the same value)
@@ -61,13 +68,32 @@ namespace MWMechanics
             //   48, 49, 50, 51, 84, 85, 86, 87, 88, 89, 90 (ship & office)
             //   all other pathgrid points are the third set
             //
-            std::vector<Node> mGraph;
+            std::vector<int> mComponentIds;
             bool mIsGraphConstructed;
 
+            // k-d tree over the points: each range of mTree has its median
+            // (split by x, y and z in turn) in the middle
+            std::vector<int> mTree;
+            void buildTree(int begin, int end, int depth);
+            // componentId -1 accepts all points
+            void searchTree(int begin, int end, int depth, const Ogre::Vector3& pos, int componentId,
+                            int& closest, float& closestDistance) const;
+            int searchTree(const Ogre::Vector3& pos, int componentId) const;
+
+            // the last paths found, most recently used first
+            struct CachedPath
+            {
+                int start;
+                int end;
+                std::vector<int> points;
+            };
+            mutable std::list<CachedPath> mPathCache;
+
             // variables used to calculate connected components
             int mSCCId;
             int mSCCIndex;
             std::vector<int> mSCCStack;
+            std::vector<bool> mSCCOnStack;
             typedef std::pair<int, int> VPair; // first is index, second is lowlink
             std::vector<VPair> mSCCPoint;
             // methods used to calculate connected components
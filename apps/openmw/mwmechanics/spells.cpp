@@ -1,6 +1,7 @@
 #include "spells.hpp"
 
 #include <cstdlib>
+#include <vector>
 
 #include <components/esm/loadspel.hpp>
 #include <components/esm/spellstate.hpp>
@@ -14,6 +15,18 @@
 
 namespace MWMechanics
 {
+    std::size_t Spells::sEffectsRevision = 0;
+
+    Spells::Spells()
+    : mEffectsChanged (true), mEffectsRevision (++sEffectsRevision)
+    {}
+
+    void Spells::effectsChanged()
+    {
+        mEffectsChanged = true;
+        mEffectsRevision = ++sEffectsRevision;
+    }
+
     Spells::TIterator Spells::begin() const
     {
         return mSpells.begin();
@@ -51,6 +64,7 @@ namespace MWMechanics
             }
 
             mSpells.insert (std::make_pair (spell->mId, random));
+            effectsChanged();
         }
     }
 
@@ -73,14 +87,15 @@ namespace MWMechanics
             if (mPermanentSpellEffects.find(lower) != mPermanentSpellEffects.end())
             {
                 MagicEffects & effects = mPermanentSpellEffects[lower];
-                for (MagicEffects::Collection::const_iterator effectIt = effects.begin(); effectIt != effects.end();)
+                std::vector<EffectKey> harmful;
+                for (MagicEffects::const_iterator effectIt = effects.begin(); effectIt != effects.end(); ++effectIt)
                 {
                     const ESM::MagicEffect * magicEffect = MWBase::Environment::get().getWorld()->getStore().get<ESM::MagicEffect>().find(effectIt->first.mId);
                     if (magicEffect->mData.mFlags & ESM::MagicEffect::Harmful)
-                        effects.remove((effectIt++)->first);
-                    else
-                        ++effectIt;
+                        harmful.push_back(effectIt->first);
                 }
+                for (std::vector<EffectKey>::const_iterator it = harmful.begin(); it != harmful.end(); ++it)
+                    effects.remove(*it);
             }
             mCorprusSpells.erase(corprusIt);
         }
@@ -88,13 +103,16 @@ namespace MWMechanics
         if (iter!=mSpells.end())
             mSpells.erase (iter);
 
+        effectsChanged();
+
         if (spellId==mSelectedSpell)
             mSelectedSpell.clear();
     }
 
-    MagicEffects Spells::getMagicEffects() const
+    const MagicEffects& Spells::getMagicEffects() const
     {
-        // TODO: These are recalculated every frame, no need to do that
+        if (!mEffectsChanged)
+            return mEffects;
 
         MagicEffects effects;
 
@@ -124,12 +142,15 @@ namespace MWMechanics
             effects += it->second;
         }
 
-        return effects;
+        mEffects = effects;
+        mEffectsChanged = false;
+        return mEffects;
     }
 
     void Spells::clear()
     {
         mSpells.clear();
+        effectsChanged();
     }
 
     void Spells::setSelectedSpell (const std::string& spellId)
@@ -196,6 +217,8 @@ namespace MWMechanics
             else
                 ++iter;
         }
+
+        effectsChanged();
     }
 
     void Spells::purgeBlightDisease()
@@ -210,6 +233,8 @@ namespace MWMechanics
             else
                 ++iter;
         }
+
+        effectsChanged();
     }
 
     void Spells::purgeCorprusDisease()
@@ -224,6 +249,8 @@ namespace MWMechanics
             else
                 ++iter;
         }
+
+        effectsChanged();
     }
 
     void Spells::purgeCurses()
@@ -238,6 +265,8 @@ namespace MWMechanics
             else
                 ++iter;
         }
+
+        effectsChanged();
     }
 
     void Spells::visitEffectSources(EffectSourceVisitor &visitor) const
@@ -271,6 +300,7 @@ namespace MWMechanics
     {
         mCorprusSpells[corpSpellId].mNextWorsening = MWBase::Environment::get().getWorld()->getTimeStamp() + CorprusStats::sWorseningPeriod;
         mCorprusSpells[corpSpellId].mWorsenings++;
+        effectsChanged();
 
         // update worsened effects
         mPermanentSpellEffects[corpSpellId] = MagicEffects();
@@ -325,6 +355,8 @@ namespace MWMechanics
 
     void Spells::readState(const ESM::SpellState &state)
     {
+        effectsChanged();
+
         for (TContainer::const_iterator it = state.mSpells.begin(); it != state.mSpells.end(); ++it)
         {
             // Discard spells that are no longer available due to changed content files
@@ -378,7 +410,7 @@ namespace MWMechanics
         for (std::map<std::string, MagicEffects>::const_iterator it = mPermanentSpellEffects.begin(); it != mPermanentSpellEffects.end(); ++it)
         {
             std::vector<ESM::SpellState::PermanentSpellEffectInfo> effectList;
-            for (MagicEffects::Collection::const_iterator effectIt = it->second.begin(); effectIt != it->second.end(); ++effectIt)
+            for (MagicEffects::const_iterator effectIt = it->second.begin(); effectIt != it->second.end(); ++effectIt)
             {
                 ESM::SpellState::PermanentSpellEffectInfo info;
                 info.mId = effectIt->first.mId;
@@ -56,8 +56,18 @@ namespace MWMechanics
 
             std::map<std::string, CorprusStats> mCorprusSpells;
 
+            mutable MagicEffects mEffects;
+            mutable bool mEffectsChanged; // since mEffects was last calculated
+            std::size_t mEffectsRevision;
+
+            static std::size_t sEffectsRevision; // last one handed out
+
+            void effectsChanged();
+
         public:
 
+            Spells();
+
             void worsenCorprus(const std::string &corpSpellId);
             static bool hasCorprusEffect(const ESM::Spell *spell);
             const std::map<std::string, CorprusStats> & getCorprusSpells() const;
@@ -86,8 +96,13 @@ namespace MWMechanics
             ///< If the spell to be removed is the selected spell, the selected spell will be changed to
             /// no spell (empty string).
 
-            MagicEffects getMagicEffects() const;
+            const MagicEffects& getMagicEffects() const;
             ///< Return sum of magic effects resulting from abilities, blights, deseases and curses.
+            /// It is only recalculated after the spells have changed.
+
+            std::size_t getEffectsRevision() const { return mEffectsRevision; }
+            ///< Changes whenever the result of getMagicEffects() may have changed, and is never the
+            /// same for different effects of any two Spells.
 
             void clear();
             ///< Remove all spells of al types.
@@ -375,8 +375,7 @@ void RenderingManager::update (float duration, bool paused)
     bool isInAir = !world->isOnGround(player);
     bool isSwimming = world->isSwimming(player);
 
-    static const float i1stPersonSneakDelta = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-            .find("i1stPersonSneakDelta")->getFloat();
+    const float i1stPersonSneakDelta = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().i1stPersonSneakDelta;
     if(!paused && isSneaking && !(isSwimming || isInAir))
         mCamera->setSneakOffset(i1stPersonSneakDelta);
 
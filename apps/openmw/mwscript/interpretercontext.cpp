@@ -5,6 +5,7 @@
 #include <sstream>
 
 #include <components/interpreter/types.hpp>
+#include <components/interpreter/runtime.hpp>
 
 #include <components/compiler/locals.hpp>
 
@@ -26,6 +27,7 @@
 
 #include "locals.hpp"
 #include "globalscripts.hpp"
+#include "scriptlinks.hpp"
 
 namespace MWScript
 {
@@ -110,6 +112,40 @@ namespace MWScript
         }
     }
 
+    Locals& InterpreterContext::getMemberLocals (const Interpreter::Runtime& runtime, int id,
+        bool global, std::string& scriptId) const
+    {
+        if (global)
+        {
+            scriptId = runtime.getStringLiteral (id);
+
+            return MWBase::Environment::get().getScriptManager()->getGlobalScripts().
+                getLocals (scriptId);
+        }
+        else
+        {
+            MWWorld::Ptr ptr;
+
+            scriptId = mLinks->getScript (id, ptr);
+
+            ptr.getRefData().setLocals (
+                *MWBase::Environment::get().getWorld()->getStore().get<ESM::Script>().find (scriptId));
+
+            return ptr.getRefData().getLocals();
+        }
+    }
+
+    int InterpreterContext::getMemberIndex (const Interpreter::Runtime& runtime,
+        const std::string& scriptId, int name, char type) const
+    {
+        int index = mLinks->getMemberIndex (scriptId, name, type);
+
+        if (index!=-1)
+            return index;
+
+        return findLocalVariableIndex (scriptId, runtime.getStringLiteral (name), type);
+    }
+
     int InterpreterContext::findLocalVariableIndex (const std::string& scriptId,
         const std::string& name, char type) const
     {
@@ -139,7 +175,7 @@ namespace MWScript
     InterpreterContext::InterpreterContext (
         MWScript::Locals *locals, MWWorld::Ptr reference, const std::string& targetId)
     : mLocals (locals), mReference (reference),
-      mActivationHandled (false), mTargetId (targetId)
+      mActivationHandled (false), mTargetId (targetId), mLinks (0)
     {
         // If we run on a reference (local script, dialogue script or console with object
         // selected), store the ID of that reference store it so it can be inherited by
@@ -245,6 +281,78 @@ namespace MWScript
         MWBase::Environment::get().getWorld()->setGlobalFloat (name, value);
     }
 
+    int InterpreterContext::getGlobalShort (const Interpreter::Runtime& runtime, int name) const
+    {
+        if (!mLinks)
+            return Interpreter::Context::getGlobalShort (runtime, name);
+
+        return mLinks->getGlobal (name).mGlobal->getInteger();
+    }
+
+    int InterpreterContext::getGlobalLong (const Interpreter::Runtime& runtime, int name) const
+    {
+        if (!mLinks)
+            return Interpreter::Context::getGlobalLong (runtime, name);
+
+        return mLinks->getGlobal (name).mGlobal->getInteger();
+    }
+
+    float InterpreterContext::getGlobalFloat (const Interpreter::Runtime& runtime, int name) const
+    {
+        if (!mLinks)
+            return Interpreter::Context::getGlobalFloat (runtime, name);
+
+        return mLinks->getGlobal (name).mGlobal->getFloat();
+    }
+
+    void InterpreterContext::setGlobalShort (const Interpreter::Runtime& runtime, int name, int value)
+    {
+        if (!mLinks)
+        {
+            Interpreter::Context::setGlobalShort (runtime, name, value);
+            return;
+        }
+
+        const ScriptLinks::Link& link = mLinks->getGlobal (name);
+
+        if (link.mTimeGlobal)
+            setGlobalShort (link.mName, value);
+        else
+            link.mGlobal->setInteger (value);
+    }
+
+    void InterpreterContext::setGlobalLong (const Interpreter::Runtime& runtime, int name, int value)
+    {
+        if (!mLinks)
+        {
+            Interpreter::Context::setGlobalLong (runtime, name, value);
+            return;
+        }
+
+        const ScriptLinks::Link& link = mLinks->getGlobal (name);
+
+        if (link.mTimeGlobal)
+            setGlobalLong (link.mName, value);
+        else
+            link.mGlobal->setInteger (value);
+    }
+
+    void InterpreterContext::setGlobalFloat (const Interpreter::Runtime& runtime, int name, float value)
+    {
+        if (!mLinks)
+        {
+            Interpreter::Context::setGlobalFloat (runtime, name, value);
+            return;
+        }
+
+        const ScriptLinks::Link& link = mLinks->getGlobal (name);
+
+        if (link.mTimeGlobal)
+            setGlobalFloat (link.mName, value);
+        else
+            link.mGlobal->setFloat (value);
+    }
+
     std::vector<std::string> InterpreterContext::getGlobals() const
     {
         std::vector<std::string> ids;
@@ -591,6 +699,117 @@ namespace MWScript
         locals.mFloats[findLocalVariableIndex (scriptId, name, 'f')] = value;
     }
 
+    int InterpreterContext::getMemberShort (const Interpreter::Runtime& runtime, int id, int name,
+        bool global) const
+    {
+        if (!mLinks)
+            return Interpreter::Context::getMemberShort (runtime, id, name, global);
+
+        std::string scriptId;
+
+        const Locals& locals = getMemberLocals (runtime, id, global, scriptId);
+
+        return locals.mShorts[getMemberIndex (runtime, scriptId, name, 's')];
+    }
+
+    int InterpreterContext::getMemberLong (const Interpreter::Runtime& runtime, int id, int name,
+        bool global) const
+    {
+        if (!mLinks)
+            return Interpreter::Context::getMemberLong (runtime, id, name, global);
+
+        std::string scriptId;
+
+        const Locals& locals = getMemberLocals (runtime, id, global, scriptId);
+
+        return locals.mLongs[getMemberIndex (runtime, scriptId, name, 'l')];
+    }
+
+    float InterpreterContext::getMemberFloat (const Interpreter::Runtime& runtime, int id, int name,
+        bool global) const
+    {
+        if (!mLinks)
+            return Interpreter::Context::getMemberFloat (runtime, id, name, global);
+
+        std::string scriptId;
+
+        const Locals& locals = getMemberLocals (runtime, id, global, scriptId);
+
+        return locals.mFloats[getMemberIndex (runtime, scriptId, name, 'f')];
+    }
+
+    void InterpreterContext::setMemberShort (const Interpreter::Runtime& runtime, int id, int name,
+        int value, bool global)
+    {
+        if (!mLinks)
+        {
+            Interpreter::Context::setMemberShort (runtime, id, name, value, global);
+            return;
+        }
+
+        std::string scriptId;
+
+        Locals& locals = getMemberLocals (runtime, id, global, scriptId);
+
+        locals.mShorts[getMemberIndex (runtime, scriptId, name, 's')] = value;
+    }
+
+    void InterpreterContext::setMemberLong (const Interpreter::Runtime& runtime, int id, int name,
+        int value, bool global)
+    {
+        if (!mLinks)
+        {
+            Interpreter::Context::setMemberLong (runtime, id, name, value, global);
+            return;
+        }
+
+        std::string scriptId;
+
+        Locals& locals = getMemberLocals (runtime, id, global, scriptId);
+
+        locals.mLongs[getMemberIndex (runtime, scriptId, name, 'l')] = value;
+    }
+
+    void InterpreterContext::setMemberFloat (const Interpreter::Runtime& runtime, int id, int name,
+        float value, bool global)
+    {
+        if (!mLinks)
+        {
+            Interpreter::Context::setMemberFloat (runtime, id, name, value, global);
+            return;
+        }
+
+        std::string scriptId;
+
+        Locals& locals = getMemberLocals (runtime, id, global, scriptId);
+
+        locals.mFloats[getMemberIndex (runtime, scriptId, name, 'f')] = value;
+    }
+
+    void InterpreterContext::setLinks (ScriptLinks *links)
+    {
+        mLinks = links;
+    }
+
+    ScriptLinks *InterpreterContext::getLinks() const
+    {
+        return mLinks;
+    }
+
+    MWWorld::Ptr InterpreterContext::getReference (const Interpreter::Runtime& runtime, int id,
+        bool required, bool activeOnly)
+    {
+        if (mLinks)
+            return mLinks->getReference (id, required, activeOnly);
+
+        MWBase::World *world = MWBase::Environment::get().getWorld();
+
+        if (required)
+            return world->getPtr (runtime.getStringLiteral (id), activeOnly);
+        else
+            return world->searchPtr (runtime.getStringLiteral (id), activeOnly);
+    }
+
     MWWorld::Ptr InterpreterContext::getReference(bool required)
     {
         return getReferenceImp ("", true, required);
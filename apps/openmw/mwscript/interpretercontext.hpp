@@ -21,6 +21,7 @@ namespace MWInput
 namespace MWScript
 {
     class Locals;
+    class ScriptLinks;
 
     class InterpreterContext : public Interpreter::Context
     {
@@ -32,6 +33,8 @@ namespace MWScript
 
             std::string mTargetId;
 
+            ScriptLinks *mLinks;
+
             /// If \a id is empty, a reference the script is run from is returned or in case
             /// of a non-local script the reference derived from the target ID.
             MWWorld::Ptr getReferenceImp (const std::string& id = "", bool activeOnly = false,
@@ -48,6 +51,14 @@ namespace MWScript
             Locals& getMemberLocals (std::string& id, bool global);
             ///< \a id is changed to the respective script ID, if \a id wasn't a script ID before
 
+            Locals& getMemberLocals (const Interpreter::Runtime& runtime, int id, bool global,
+                std::string& scriptId) const;
+            ///< \a scriptId is set to the script ID
+
+            int getMemberIndex (const Interpreter::Runtime& runtime, const std::string& scriptId,
+                int name, char type) const;
+            ///< Throws an exception if local variable can't be found.
+
             /// Throws an exception if local variable can't be found.
             int findLocalVariableIndex (const std::string& scriptId, const std::string& name,
                 char type) const;
@@ -92,6 +103,18 @@ namespace MWScript
 
             virtual void setGlobalFloat (const std::string& name, float value);
 
+            virtual int getGlobalShort (const Interpreter::Runtime& runtime, int name) const;
+
+            virtual int getGlobalLong (const Interpreter::Runtime& runtime, int name) const;
+
+            virtual float getGlobalFloat (const Interpreter::Runtime& runtime, int name) const;
+
+            virtual void setGlobalShort (const Interpreter::Runtime& runtime, int name, int value);
+
+            virtual void setGlobalLong (const Interpreter::Runtime& runtime, int name, int value);
+
+            virtual void setGlobalFloat (const Interpreter::Runtime& runtime, int name, float value);
+
             virtual std::vector<std::string> getGlobals () const;
 
             virtual char getGlobalType (const std::string& name) const;
@@ -164,6 +187,28 @@ namespace MWScript
 
             virtual void setMemberFloat (const std::string& id, const std::string& name, float value, bool global);
 
+            virtual int getMemberShort (const Interpreter::Runtime& runtime, int id, int name, bool global) const;
+
+            virtual int getMemberLong (const Interpreter::Runtime& runtime, int id, int name, bool global) const;
+
+            virtual float getMemberFloat (const Interpreter::Runtime& runtime, int id, int name, bool global) const;
+
+            virtual void setMemberShort (const Interpreter::Runtime& runtime, int id, int name, int value, bool global);
+
+            virtual void setMemberLong (const Interpreter::Runtime& runtime, int id, int name, int value, bool global);
+
+            virtual void setMemberFloat (const Interpreter::Runtime& runtime, int id, int name, float value, bool global);
+
+            void setLinks (ScriptLinks *links);
+            ///< Look up what the string literals of the script being run refer to via \a links
+            /// (0: look them up by name each time). Ownership is not transferred.
+
+            ScriptLinks *getLinks() const;
+
+            MWWorld::Ptr getReference (const Interpreter::Runtime& runtime, int id, bool required,
+                bool activeOnly);
+            ///< Reference with the ID in the string literal \a id (see MWBase::World::searchPtr)
+
             MWWorld::Ptr getReference(bool required=true);
             ///< Reference, that the script is running from (can be empty)
 
@@ -1,6 +1,8 @@
 #include "miscextensions.hpp"
 
 #include <cstdlib>
+#include <fstream>
+#include <sstream>
 
 #include <components/compiler/extensions.hpp>
 #include <components/compiler/opcodes.hpp>
@@ -13,6 +15,8 @@
 #include <components/esm/loadmgef.hpp>
 #include <components/esm/loadcrea.hpp>
 
+#include <components/nifcache/nifcache.hpp>
+
 #include "../mwbase/environment.hpp"
 #include "../mwbase/windowmanager.hpp"
 #include "../mwbase/scriptmanager.hpp"
@@ -908,6 +912,65 @@ namespace MWScript
             }
         };
 
+        class OpNifCacheStats : public Interpreter::Opcode0
+        {
+        public:
+            virtual void execute (Interpreter::Runtime& runtime)
+            {
+                Nif::Cache::Stats stats = Nif::Cache::getInstance().getStats();
+
+                std::ostringstream str;
+                str << "NIF cache: " << stats.mFiles << " files, "
+                    << stats.mSize/1024 << " of " << stats.mBudget/1024 << " KiB" << std::endl
+                    << "hits " << stats.mHits << ", misses " << stats.mMisses
+                    << ", still loading " << stats.mPending << ", evictions " << stats.mEvictions;
+
+                if (stats.mDiskHits || stats.mDiskMisses)
+                    str << std::endl << "disk cache hits " << stats.mDiskHits
+                        << ", misses " << stats.mDiskMisses;
+
+                runtime.getContext().report(str.str());
+            }
+        };
+
+        class OpToggleScriptProfiler : public Interpreter::Opcode0
+        {
+        public:
+            virtual void execute (Interpreter::Runtime& runtime)
+            {
+                bool enabled = MWBase::Environment::get().getScriptManager()->toggleProfiling();
+
+                runtime.getContext().report(enabled ? "Script Profiler -> On" : "Script Profiler -> Off");
+            }
+        };
+
+        class OpScriptProfile : public Interpreter::Opcode1
+        {
+        public:
+            virtual void execute (Interpreter::Runtime& runtime, unsigned int arg0)
+            {
+                MWBase::ScriptManager *scriptManager = MWBase::Environment::get().getScriptManager();
+
+                if (arg0>0)
+                {
+                    std::string file = runtime.getStringLiteral (runtime[0].mInteger);
+                    runtime.pop();
+
+                    std::ofstream stream (file.c_str());
+                    scriptManager->writeProfileCsv (stream);
+
+                    runtime.getContext().report (stream.good() ?
+                        "Script profile written to " + file : "Failed to write script profile to " + file);
+                    return;
+                }
+
+                std::ostringstream str;
+                scriptManager->writeProfile (str, 10);
+
+                runtime.getContext().report(str.str());
+            }
+        };
+
         class OpToggleGodMode : public Interpreter::Opcode0
         {
             public:
@@ -1212,6 +1275,9 @@ namespace MWScript
             interpreter.installSegment5 (Compiler::Misc::opcodeShowVarsExplicit, new OpShowVars<ExplicitRef>);
             interpreter.installSegment5 (Compiler::Misc::opcodeToggleGodMode, new OpToggleGodMode);
             interpreter.installSegment5 (Compiler::Misc::opcodeToggleScripts, new OpToggleScripts);
+            interpreter.installSegment5 (Compiler::Misc::opcodeNifCacheStats, new OpNifCacheStats);
+            interpreter.installSegment5 (Compiler::Misc::opcodeToggleScriptProfiler, new OpToggleScriptProfiler);
+            interpreter.installSegment3 (Compiler::Misc::opcodeScriptProfile, new OpScriptProfile);
             interpreter.installSegment5 (Compiler::Misc::opcodeDisableLevitation, new OpEnableLevitation<false>);
             interpreter.installSegment5 (Compiler::Misc::opcodeEnableLevitation, new OpEnableLevitation<true>);
             interpreter.installSegment5 (Compiler::Misc::opcodeCast, new OpCast<ImplicitRef>);
@@ -0,0 +1,267 @@
+#include "parallelscripts.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <components/compiler/opcodes.hpp>
+
+#include <components/interpreter/installopcodes.hpp>
+#include <components/interpreter/opcodes.hpp>
+#include <components/interpreter/runtime.hpp>
+
+#include <components/misc/workqueue.hpp>
+
+#include "interpretercontext.hpp"
+
+namespace
+{
+    struct Deferrable
+    {
+        int mOpcode; // in segment 5
+        int mArguments;
+    };
+
+    const Deferrable sDeferrable[] =
+    {
+        { 47, 1 }, // StartScript
+        { 48, 1 }, // StopScript
+        { 51, 0 }, // Enable
+        { 52, 0 }, // Disable
+        { Compiler::Sound::opcodeStreamMusic, 1 },
+        { Compiler::Sound::opcodePlaySound, 1 },
+        { Compiler::Sound::opcodePlaySoundVP, 3 },
+        { Compiler::Sound::opcodePlaySound3D, 1 },
+        { Compiler::Sound::opcodePlaySound3DVP, 3 },
+        { Compiler::Sound::opcodePlayLoopSound3D, 1 },
+        { Compiler::Sound::opcodePlayLoopSound3DVP, 3 },
+        { Compiler::Sound::opcodeStopSound, 1 }
+    };
+
+    const int sDeferrableSize = sizeof (sDeferrable) / sizeof (sDeferrable[0]);
+
+    /// Context of a script running on a worker thread
+    class ParallelContext : public MWScript::InterpreterContext
+    {
+            MWScript::ParallelScripts::Script& mScript;
+
+        public:
+
+            ParallelContext (MWScript::ParallelScripts::Script& script)
+            : MWScript::InterpreterContext (&script.mPtr.getRefData().getLocals(), script.mPtr),
+              mScript (script)
+            {}
+
+            void defer (const MWScript::ParallelScripts::Command& command)
+            {
+                mScript.mCommands.push_back (command);
+            }
+    };
+
+    /// Records a segment 5 opcode with its arguments instead of executing it
+    class OpDefer : public Interpreter::Opcode0
+    {
+            Interpreter::Type_Code mCode;
+            int mArguments;
+
+        public:
+
+            OpDefer (int opcode, int arguments)
+            : mCode (0xc8000000 | opcode), mArguments (arguments)
+            {}
+
+            virtual void execute (Interpreter::Runtime& runtime)
+            {
+                MWScript::ParallelScripts::Command command;
+                command.mCode = mCode;
+
+                for (int i = 0; i<mArguments; ++i)
+                {
+                    command.mArguments.push_back (runtime[0]);
+                    runtime.pop();
+                }
+
+                static_cast<ParallelContext&> (runtime.getContext()).defer (command);
+            }
+    };
+}
+
+namespace MWScript
+{
+    class ParallelScripts::Batch : public Misc::WorkItem
+    {
+            Worker& mWorker;
+            std::vector<Script>::iterator mBegin;
+            std::vector<Script>::iterator mEnd;
+
+        protected:
+
+            virtual void doWork()
+            {
+                for (std::vector<Script>::iterator iter (mBegin); iter!=mEnd; ++iter)
+                    mWorker.run (*iter);
+            }
+
+        public:
+
+            Batch (Worker& worker, std::vector<Script>::iterator begin, std::vector<Script>::iterator end)
+            : mWorker (worker), mBegin (begin), mEnd (end)
+            {}
+    };
+
+    ParallelScripts::Worker::Worker()
+    {
+        installOpcodes (mInterpreter);
+    }
+
+    void ParallelScripts::Worker::run (Script& script)
+    {
+        try
+        {
+            const std::vector<Interpreter::Type_Code>& code = *script.mByteCode;
+
+            std::map<std::string, Interpreter::Instructions>::iterator iter =
+                mInstructions.find (script.mName);
+
+            if (iter==mInstructions.end())
+            {
+                iter = mInstructions.insert (std::make_pair (script.mName, Interpreter::Instructions())).first;
+                mInterpreter.decode (&code[0], code.size(), iter->second);
+            }
+
+            ParallelContext context (script);
+
+            if (mInterpreter.isProfiling())
+            {
+                boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+                std::size_t instructions = mInterpreter.getInstructionCount();
+
+                mInterpreter.run (&code[0], code.size(), iter->second, context);
+
+                script.mInstructions = mInterpreter.getInstructionCount() - instructions;
+                script.mTime = (boost::posix_time::microsec_clock::universal_time() - start).
+                    total_microseconds() / 1000000.0;
+            }
+            else
+                mInterpreter.run (&code[0], code.size(), iter->second, context);
+        }
+        catch (const std::exception& e)
+        {
+            script.mError = e.what();
+        }
+    }
+
+    Interpreter::Interpreter& ParallelScripts::Worker::getInterpreter()
+    {
+        return mInterpreter;
+    }
+
+    void ParallelScripts::installOpcodes (Interpreter::Interpreter& interpreter)
+    {
+        Interpreter::installLocalOpcodes (interpreter);
+
+        for (int i = 0; i<sDeferrableSize; ++i)
+            interpreter.installSegment5 (sDeferrable[i].mOpcode,
+                new OpDefer (sDeferrable[i].mOpcode, sDeferrable[i].mArguments));
+    }
+
+    ParallelScripts::ParallelScripts()
+    : mProfiling (false)
+    {
+        installOpcodes (mInterpreter);
+    }
+
+    ParallelScripts::~ParallelScripts()
+    {
+        mWorkQueue.reset();
+
+        for (std::vector<Worker *>::iterator iter (mWorkers.begin()); iter!=mWorkers.end(); ++iter)
+            delete *iter;
+    }
+
+    bool ParallelScripts::canRun (const std::vector<Interpreter::Type_Code>& byteCode) const
+    {
+        return !byteCode.empty() && mInterpreter.canRun (&byteCode[0], byteCode.size());
+    }
+
+    void ParallelScripts::run (std::vector<Script>& scripts, Interpreter::Interpreter& interpreter)
+    {
+        if (scripts.empty())
+            return;
+
+        if (!mWorkQueue)
+        {
+            mWorkQueue.reset (new Misc::WorkQueue);
+
+            for (int i = 0; i<mWorkQueue->getNumThreads(); ++i)
+            {
+                mWorkers.push_back (new Worker);
+                mWorkers.back()->getInterpreter().setProfiling (mProfiling);
+            }
+        }
+
+        // one batch of consecutive scripts per worker
+        std::size_t batches = std::min (mWorkers.size(), scripts.size());
+        std::vector<boost::shared_ptr<Batch> > items;
+
+        for (std::size_t i = 0; i<batches; ++i)
+        {
+            items.push_back (boost::shared_ptr<Batch> (new Batch (*mWorkers[i],
+                scripts.begin() + i*scripts.size()/batches,
+                scripts.begin() + (i+1)*scripts.size()/batches)));
+
+            mWorkQueue->addWorkItem (items.back());
+        }
+
+        for (std::vector<boost::shared_ptr<Batch> >::iterator iter (items.begin()); iter!=items.end();
+            ++iter)
+            (*iter)->waitTillDone();
+
+        // execute the recorded opcodes
+        for (std::vector<Script>::iterator iter (scripts.begin()); iter!=scripts.end(); ++iter)
+        {
+            if (iter->mCommands.empty())
+                continue;
+
+            InterpreterContext context (&iter->mPtr.getRefData().getLocals(), iter->mPtr);
+
+            for (std::vector<Command>::const_iterator command (iter->mCommands.begin());
+                command!=iter->mCommands.end(); ++command)
+            {
+                try
+                {
+                    Interpreter::Runtime runtime;
+                    runtime.configure (&(*iter->mByteCode)[0], iter->mByteCode->size(), context);
+
+                    for (std::size_t i = command->mArguments.size(); i>0; --i)
+                        runtime.push (command->mArguments[i-1]);
+
+                    Interpreter::Instruction instruction = interpreter.decode (command->mCode);
+                    instruction.mHandler (instruction, runtime);
+                }
+                catch (const std::exception& e)
+                {
+                    // happened before anything that failed on the worker thread
+                    iter->mError = e.what();
+                    break;
+                }
+            }
+        }
+    }
+
+    void ParallelScripts::setProfiling (bool profiling)
+    {
+        mProfiling = profiling;
+
+        for (std::vector<Worker *>::iterator iter (mWorkers.begin()); iter!=mWorkers.end(); ++iter)
+            (*iter)->getInterpreter().setProfiling (profiling);
+    }
+
+    void ParallelScripts::addProfiles (Interpreter::OpcodeProfiles& profiles) const
+    {
+        for (std::vector<Worker *>::const_iterator iter (mWorkers.begin()); iter!=mWorkers.end(); ++iter)
+            (*iter)->getInterpreter().addProfiles (profiles);
+    }
+}
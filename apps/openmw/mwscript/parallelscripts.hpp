@@ -0,0 +1,105 @@
+#ifndef GAME_SCRIPT_PARALLELSCRIPTS_H
+#define GAME_SCRIPT_PARALLELSCRIPTS_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <components/interpreter/interpreter.hpp>
+#include <components/interpreter/types.hpp>
+
+#include "../mwworld/ptr.hpp"
+
+namespace Misc
+{
+    class WorkQueue;
+}
+
+namespace MWScript
+{
+    /// \brief Runs local scripts that use nothing but their own local variables on worker threads
+    ///
+    /// Each worker thread has an interpreter of its own, with only the opcodes installed that
+    /// are safe to run there (see Interpreter::installLocalOpcodes). Opcodes that change the
+    /// world without returning anything to the script (enabling or disabling the reference,
+    /// starting or stopping scripts and sounds) are recorded instead and executed afterwards on
+    /// the calling thread, in the order of the scripts. That has the same effect as running the
+    /// scripts one after the other.
+    class ParallelScripts
+    {
+        public:
+
+            /// Opcode recorded to be executed later
+            struct Command
+            {
+                Interpreter::Type_Code mCode;
+                std::vector<Interpreter::Data> mArguments; ///< top of the stack first
+            };
+
+            struct Script
+            {
+                std::string mName;
+                MWWorld::Ptr mPtr;
+                const std::vector<Interpreter::Type_Code> *mByteCode;
+                std::vector<Command> mCommands;
+                std::string mError; ///< empty unless running the script failed
+                std::size_t mInstructions; ///< executed on the worker thread, while profiling
+                double mTime; ///< spent on the worker thread in seconds, while profiling
+
+                Script() : mByteCode (0), mInstructions (0), mTime (0) {}
+            };
+
+        private:
+
+            class Worker
+            {
+                    Interpreter::Interpreter mInterpreter;
+                    std::map<std::string, Interpreter::Instructions> mInstructions;
+
+                public:
+
+                    Worker();
+
+                    void run (Script& script);
+
+                    Interpreter::Interpreter& getInterpreter();
+            };
+
+            class Batch;
+
+            Interpreter::Interpreter mInterpreter; ///< to check which scripts can be run
+            std::vector<Worker *> mWorkers;
+            boost::scoped_ptr<Misc::WorkQueue> mWorkQueue; ///< created on first use
+            bool mProfiling;
+
+            ParallelScripts (const ParallelScripts&);
+            ParallelScripts& operator= (const ParallelScripts&);
+
+            static void installOpcodes (Interpreter::Interpreter& interpreter);
+
+        public:
+
+            ParallelScripts();
+
+            ~ParallelScripts();
+
+            bool canRun (const std::vector<Interpreter::Type_Code>& byteCode) const;
+            ///< Does \a byteCode use nothing but opcodes that can be run on a worker thread?
+
+            void run (std::vector<Script>& scripts, Interpreter::Interpreter& interpreter);
+            ///< Run \a scripts, all of which must pass canRun, on the worker threads and then
+            /// execute the commands they recorded with \a interpreter.
+
+            void setProfiling (bool profiling);
+            ///< Time the scripts and profile the opcodes run on the worker threads (see
+            /// Interpreter::setProfiling).
+
+            void addProfiles (Interpreter::OpcodeProfiles& profiles) const;
+            ///< Add the opcode profiles of the worker threads to \a profiles.
+    };
+}
+
+#endif
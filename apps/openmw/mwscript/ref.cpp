@@ -10,13 +10,13 @@
 MWWorld::Ptr MWScript::ExplicitRef::operator() (Interpreter::Runtime& runtime, bool required,
     bool activeOnly) const
 {
-    std::string id = runtime.getStringLiteral(runtime[0].mInteger);
+    MWScript::InterpreterContext& context
+    = static_cast<MWScript::InterpreterContext&> (runtime.getContext());
+
+    int id = runtime[0].mInteger;
     runtime.pop();
 
-    if (required)
-        return MWBase::Environment::get().getWorld()->getPtr(id, activeOnly);
-    else
-        return MWBase::Environment::get().getWorld()->searchPtr(id, activeOnly);
+    return context.getReference(runtime, id, required, activeOnly);
 }
 
 MWWorld::Ptr MWScript::ImplicitRef::operator() (Interpreter::Runtime& runtime, bool required,
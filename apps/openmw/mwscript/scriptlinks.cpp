@@ -0,0 +1,129 @@
+#include "scriptlinks.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <components/misc/stringops.hpp>
+
+#include <components/compiler/locals.hpp>
+
+#include "../mwbase/environment.hpp"
+#include "../mwbase/world.hpp"
+#include "../mwbase/scriptmanager.hpp"
+
+#include "../mwworld/class.hpp"
+
+namespace MWScript
+{
+    ScriptLinks::Link::Link (const std::string& name)
+    : mName (name), mGlobal (0), mTimeGlobal (false), mGlobalGeneration (0), mActiveOnly (false),
+      mPtrGeneration (0), mMemberType (' '), mMemberIndex (-1)
+    {}
+
+    ScriptLinks::ScriptLinks() : mSlowPathCount (0) {}
+
+    void ScriptLinks::link (const std::vector<Interpreter::Type_Code>& code)
+    {
+        mLinks.clear();
+
+        if (code.size()<4)
+            return;
+
+        // same layout as read by Interpreter::Runtime::getStringLiteral
+        std::size_t begin = 4 + code[0] + code[1] + code[2];
+        std::size_t size = code[3] * sizeof (Interpreter::Type_Code);
+
+        if (begin + code[3]>code.size())
+            throw std::runtime_error ("string literals beyond the end of the code");
+
+        const char *literals = reinterpret_cast<const char *> (&code[begin]);
+
+        for (std::size_t offset = 0; offset<size; )
+        {
+            std::size_t length = strnlen (literals+offset, size-offset);
+            mLinks.push_back (Link (std::string (literals+offset, length)));
+            offset += length+1;
+        }
+    }
+
+    const ScriptLinks::Link& ScriptLinks::getGlobal (int literal)
+    {
+        Link& link = mLinks.at (literal);
+
+        MWBase::World *world = MWBase::Environment::get().getWorld();
+
+        if (link.mGlobalGeneration!=world->getReferenceGeneration())
+        {
+            ++mSlowPathCount;
+
+            link.mGlobal = &world->getGlobalVariable (link.mName);
+            link.mTimeGlobal = Misc::StringUtils::ciEqual (link.mName, "gamehour") ||
+                Misc::StringUtils::ciEqual (link.mName, "day") ||
+                Misc::StringUtils::ciEqual (link.mName, "month");
+            link.mGlobalGeneration = world->getReferenceGeneration();
+        }
+
+        return link;
+    }
+
+    MWWorld::Ptr ScriptLinks::getReference (int literal, bool required, bool activeOnly)
+    {
+        Link& link = mLinks.at (literal);
+
+        MWBase::World *world = MWBase::Environment::get().getWorld();
+
+        // A reference found in the active cells is also the one found when searching all cells.
+        if (link.mPtrGeneration==world->getReferenceGeneration() && (link.mActiveOnly || !activeOnly))
+            return link.mPtr;
+
+        ++mSlowPathCount;
+
+        MWWorld::Ptr ptr = required ? world->getPtr (link.mName, activeOnly) :
+            world->searchPtr (link.mName, activeOnly);
+
+        // Items in containers can be moved or removed without the world noticing.
+        if (ptr.isInCell())
+        {
+            link.mPtr = ptr;
+            link.mActiveOnly = activeOnly;
+            link.mScript = ptr.getClass().getScript (ptr);
+            link.mPtrGeneration = world->getReferenceGeneration();
+        }
+
+        return ptr;
+    }
+
+    const std::string& ScriptLinks::getScript (int literal, MWWorld::Ptr& ptr)
+    {
+        ptr = getReference (literal, true, false);
+
+        Link& link = mLinks.at (literal);
+
+        if (!(link.mPtr==ptr))
+            link.mScript = ptr.getClass().getScript (ptr);
+
+        return link.mScript;
+    }
+
+    int ScriptLinks::getMemberIndex (const std::string& script, int literal, char type)
+    {
+        Link& link = mLinks.at (literal);
+
+        if (link.mMemberIndex==-1 || link.mMemberType!=type || link.mMemberScript!=script)
+        {
+            ++mSlowPathCount;
+
+            link.mMemberIndex = MWBase::Environment::get().getScriptManager()->getLocals (script).
+                searchIndex (type, link.mName);
+            link.mMemberType = type;
+            link.mMemberScript = script;
+        }
+
+        return link.mMemberIndex;
+    }
+
+    std::size_t ScriptLinks::getSlowPathCount() const
+    {
+        return mSlowPathCount;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef GAME_SCRIPT_SCRIPTLINKS_H
+#define GAME_SCRIPT_SCRIPTLINKS_H
+
+#include <string>
+#include <vector>
+
+#include <components/interpreter/types.hpp>
+
+#include "../mwworld/ptr.hpp"
+
+namespace ESM
+{
+    class Variant;
+}
+
+namespace MWScript
+{
+    /// \brief What the string literals of a compiled script refer to
+    ///
+    /// Global variables, references and member variables named by a literal are looked up the
+    /// first time the script uses them and kept from then on. References and global variables
+    /// are looked up again once MWBase::World::getReferenceGeneration has changed.
+    class ScriptLinks
+    {
+        public:
+
+            struct Link
+            {
+                std::string mName; ///< literal
+
+                ESM::Variant *mGlobal;
+                bool mTimeGlobal; ///< must be set via the world to keep the sky up to date
+                unsigned int mGlobalGeneration;
+
+                MWWorld::Ptr mPtr;
+                bool mActiveOnly; ///< mPtr was looked up in the active cells only
+                std::string mScript; ///< of mPtr
+                unsigned int mPtrGeneration;
+
+                std::string mMemberScript;
+                char mMemberType;
+                int mMemberIndex; ///< of the member variable in mMemberScript
+
+                Link (const std::string& name);
+            };
+
+        private:
+
+            std::vector<Link> mLinks;
+            std::size_t mSlowPathCount;
+
+        public:
+
+            ScriptLinks();
+
+            void link (const std::vector<Interpreter::Type_Code>& code);
+            ///< Set up a link for each string literal of \a code.
+
+            const Link& getGlobal (int literal);
+            ///< Throws if there is no global variable of that name.
+
+            MWWorld::Ptr getReference (int literal, bool required, bool activeOnly);
+            ///< Return the reference with the ID in \a literal (see MWBase::World::searchPtr).
+            ///
+            /// \param required Throw if there is no such reference instead of returning an
+            /// empty Ptr.
+
+            const std::string& getScript (int literal, MWWorld::Ptr& ptr);
+            ///< Return the script of the reference with the ID in \a literal and set \a ptr to
+            /// the reference.
+
+            int getMemberIndex (const std::string& script, int literal, char type);
+            ///< Return the index of the variable in \a literal among the variables of type
+            /// \a type of \a script or -1 if there is none.
+
+            std::size_t getSlowPathCount() const;
+            ///< Number of times a literal had to be looked up by name.
+    };
+}
+
+#endif
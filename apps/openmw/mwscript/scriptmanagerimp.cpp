@@ -5,6 +5,9 @@
 #include <sstream>
 #include <exception>
 #include <algorithm>
+#include <iomanip>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <components/esm/loadscpt.hpp>
 
@@ -12,12 +15,23 @@
 
 #include <components/compiler/scanner.hpp>
 #include <components/compiler/context.hpp>
+#include <components/compiler/extensions.hpp>
 #include <components/compiler/exception.hpp>
 #include <components/compiler/quickfileparser.hpp>
 
 #include "../mwworld/esmstore.hpp"
 
 #include "extensions.hpp"
+#include "interpretercontext.hpp"
+
+namespace
+{
+    template<typename T>
+    bool isSlower (const std::pair<double, T>& left, const std::pair<double, T>& right)
+    {
+        return left.first>right.first;
+    }
+}
 
 namespace MWScript
 {
@@ -26,7 +40,7 @@ namespace MWScript
         const std::vector<std::string>& scriptBlacklist)
     : mErrorHandler (std::cerr), mStore (store), mVerbose (verbose),
       mCompilerContext (compilerContext), mParser (mErrorHandler, mCompilerContext),
-      mOpcodesInstalled (false), mGlobalScripts (store)
+      mOpcodesInstalled (false), mGlobalScripts (store), mProfiling (false)
     {
         mErrorHandler.setWarningsMode (warningsMode);
 
@@ -80,9 +94,15 @@ namespace MWScript
 
             if (Success)
             {
-                std::vector<Interpreter::Type_Code> code;
-                mParser.getCode (code);
-                mScripts.insert (std::make_pair (name, std::make_pair (code, mParser.getLocals())));
+                installOpcodes();
+
+                CompiledScript compiled;
+                mParser.getCode (compiled.mByteCode);
+                mInterpreter.decode (&compiled.mByteCode[0], compiled.mByteCode.size(), compiled.mInstructions);
+                compiled.mLocals = mParser.getLocals();
+                compiled.mLinks.link (compiled.mByteCode);
+                compiled.mParallel = mParallelScripts.canRun (compiled.mByteCode);
+                mScripts.insert (std::make_pair (name, compiled));
 
                 return true;
             }
@@ -91,9 +111,8 @@ namespace MWScript
         return false;
     }
 
-    void ScriptManager::run (const std::string& name, Interpreter::Context& interpreterContext)
+    ScriptManager::ScriptCollection::iterator ScriptManager::findOrCompile (const std::string& name)
     {
-        // compile script
         ScriptCollection::iterator iter = mScripts.find (name);
 
         if (iter==mScripts.end())
@@ -101,34 +120,73 @@ namespace MWScript
             if (!compile (name))
             {
                 // failed -> ignore script from now on.
-                std::vector<Interpreter::Type_Code> empty;
-                mScripts.insert (std::make_pair (name, std::make_pair (empty, Compiler::Locals())));
-                return;
+                return mScripts.insert (std::make_pair (name, CompiledScript())).first;
             }
 
             iter = mScripts.find (name);
             assert (iter!=mScripts.end());
         }
 
+        return iter;
+    }
+
+    void ScriptManager::run (const std::string& name, Interpreter::Context& interpreterContext)
+    {
+        // compile script
+        ScriptCollection::iterator iter = findOrCompile (name);
+
         // execute script
-        if (!iter->second.first.empty())
+        if (!iter->second.mByteCode.empty())
+        {
+            // let the context keep what the literals of the script refer to
+            InterpreterContext *context = dynamic_cast<InterpreterContext *> (&interpreterContext);
+            ScriptLinks *links = 0;
+
+            if (context)
+            {
+                links = context->getLinks();
+                context->setLinks (&iter->second.mLinks);
+            }
+
             try
             {
-                if (!mOpcodesInstalled)
+                if (mProfiling)
                 {
-                    installOpcodes (mInterpreter);
-                    mOpcodesInstalled = true;
-                }
+                    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+                    std::size_t instructions = mInterpreter.getInstructionCount();
+
+                    mInterpreter.run (&iter->second.mByteCode[0], iter->second.mByteCode.size(),
+                        iter->second.mInstructions, interpreterContext);
 
-                mInterpreter.run (&iter->second.first[0], iter->second.first.size(), interpreterContext);
+                    ++iter->second.mRuns;
+                    iter->second.mInstructionCount += mInterpreter.getInstructionCount() - instructions;
+                    iter->second.mTime += (boost::posix_time::microsec_clock::universal_time() - start).
+                        total_microseconds() / 1000000.0;
+                }
+                else
+                    mInterpreter.run (&iter->second.mByteCode[0], iter->second.mByteCode.size(),
+                        iter->second.mInstructions, interpreterContext);
             }
             catch (const std::exception& e)
             {
                 std::cerr << "Execution of script " << name << " failed:" << std::endl;
                 std::cerr << e.what() << std::endl;
 
-                iter->second.first.clear(); // don't execute again.
+                iter->second.mByteCode.clear(); // don't execute again.
             }
+
+            if (context)
+                context->setLinks (links);
+        }
+    }
+
+    void ScriptManager::installOpcodes()
+    {
+        if (!mOpcodesInstalled)
+        {
+            MWScript::installOpcodes (mInterpreter);
+            mOpcodesInstalled = true;
+        }
     }
 
     std::pair<int, int> ScriptManager::compileAll()
@@ -160,7 +218,7 @@ namespace MWScript
             ScriptCollection::iterator iter = mScripts.find (name2);
 
             if (iter!=mScripts.end())
-                return iter->second.second;
+                return iter->second.mLocals;
         }
 
         {
@@ -193,6 +251,184 @@ namespace MWScript
         throw std::logic_error ("script " + name + " does not exist");
     }
 
+    bool ScriptManager::canRunInParallel (const std::string& name)
+    {
+        ScriptCollection::iterator iter = findOrCompile (name);
+
+        return iter->second.mParallel && !iter->second.mByteCode.empty();
+    }
+
+    void ScriptManager::runInParallel (const std::vector<std::pair<std::string, MWWorld::Ptr> >& scripts)
+    {
+        installOpcodes();
+
+        std::vector<ParallelScripts::Script> parallel (scripts.size());
+
+        for (std::size_t i = 0; i<scripts.size(); ++i)
+        {
+            ScriptCollection::iterator iter = mScripts.find (scripts[i].first);
+            assert (iter!=mScripts.end() && iter->second.mParallel);
+
+            parallel[i].mName = scripts[i].first;
+            parallel[i].mPtr = scripts[i].second;
+            parallel[i].mByteCode = &iter->second.mByteCode;
+        }
+
+        mParallelScripts.run (parallel, mInterpreter);
+
+        for (std::vector<ParallelScripts::Script>::const_iterator iter (parallel.begin());
+            iter!=parallel.end(); ++iter)
+        {
+            if (mProfiling)
+            {
+                CompiledScript& script = mScripts[iter->mName];
+                ++script.mRuns;
+                script.mInstructionCount += iter->mInstructions;
+                script.mTime += iter->mTime;
+            }
+
+            if (!iter->mError.empty())
+            {
+                std::cerr << "Execution of script " << iter->mName << " failed:" << std::endl;
+                std::cerr << iter->mError << std::endl;
+
+                mScripts[iter->mName].mByteCode.clear(); // don't execute again.
+            }
+        }
+    }
+
+    std::size_t ScriptManager::getSlowPathCount (const std::string& name) const
+    {
+        ScriptCollection::const_iterator iter = mScripts.find (name);
+
+        return iter!=mScripts.end() ? iter->second.mLinks.getSlowPathCount() : 0;
+    }
+
+    bool ScriptManager::toggleProfiling()
+    {
+        mProfiling = !mProfiling;
+
+        if (mProfiling)
+        {
+            for (ScriptCollection::iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+            {
+                iter->second.mRuns = 0;
+                iter->second.mInstructionCount = 0;
+                iter->second.mTime = 0;
+            }
+
+            mProfilingStart = boost::posix_time::microsec_clock::universal_time();
+            mProfilingStop = boost::posix_time::not_a_date_time;
+        }
+        else
+            mProfilingStop = boost::posix_time::microsec_clock::universal_time();
+
+        mInterpreter.setProfiling (mProfiling);
+        mParallelScripts.setProfiling (mProfiling);
+
+        return mProfiling;
+    }
+
+    std::string ScriptManager::getOpcodeName (const std::pair<int, unsigned int>& opcode) const
+    {
+        std::string name;
+
+        if (const Compiler::Extensions *extensions = mCompilerContext.getExtensions())
+            name = extensions->getKeyword (opcode.first, opcode.second);
+
+        if (name.empty())
+        {
+            // the opcodes of the interpreter itself have no keyword
+            std::ostringstream stream;
+            stream << "segment " << opcode.first << " opcode " << opcode.second;
+            name = stream.str();
+        }
+
+        return name;
+    }
+
+    void ScriptManager::writeProfile (std::ostream& stream, std::size_t limit) const
+    {
+        if (mProfilingStart.is_not_a_date_time())
+        {
+            stream << "Script profiling has not been enabled";
+            return;
+        }
+
+        boost::posix_time::ptime stop = mProfilingStop.is_not_a_date_time() ?
+            boost::posix_time::microsec_clock::universal_time() : mProfilingStop;
+
+        std::vector<std::pair<double, ScriptCollection::const_iterator> > scripts;
+        double total = 0;
+
+        for (ScriptCollection::const_iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+            if (iter->second.mRuns)
+            {
+                scripts.push_back (std::make_pair (iter->second.mTime, iter));
+                total += iter->second.mTime;
+            }
+
+        std::sort (scripts.begin(), scripts.end(), isSlower<ScriptCollection::const_iterator>);
+
+        Interpreter::OpcodeProfiles profiles;
+        mInterpreter.addProfiles (profiles);
+        mParallelScripts.addProfiles (profiles);
+
+        std::vector<std::pair<double, Interpreter::OpcodeProfiles::const_iterator> > opcodes;
+
+        for (Interpreter::OpcodeProfiles::const_iterator iter (profiles.begin()); iter!=profiles.end(); ++iter)
+            opcodes.push_back (std::make_pair (iter->second.getTime(), iter));
+
+        std::sort (opcodes.begin(), opcodes.end(), isSlower<Interpreter::OpcodeProfiles::const_iterator>);
+
+        stream
+            << std::fixed << std::setprecision (3)
+            << "Scripts took " << total*1000 << " ms in "
+            << (stop - mProfilingStart).total_milliseconds() / 1000.0 << " s";
+
+        for (std::size_t i = 0; i<scripts.size() && i<limit; ++i)
+        {
+            const CompiledScript& script = scripts[i].second->second;
+
+            stream
+                << "\n  " << scripts[i].second->first << ": " << script.mTime*1000 << " ms, "
+                << script.mRuns << " runs, " << script.mInstructionCount << " instructions, "
+                << script.mLinks.getSlowPathCount() << " slow lookups";
+        }
+
+        stream << "\nOpcodes (times estimated from samples):";
+
+        for (std::size_t i = 0; i<opcodes.size() && i<limit; ++i)
+        {
+            const Interpreter::OpcodeProfile& profile = opcodes[i].second->second;
+
+            stream
+                << "\n  " << getOpcodeName (opcodes[i].second->first) << ": "
+                << profile.getTime()*1000 << " ms, " << profile.mCount << " executions";
+        }
+    }
+
+    void ScriptManager::writeProfileCsv (std::ostream& stream) const
+    {
+        stream << "kind,name,count,instructions,slow lookups,seconds\n";
+
+        for (ScriptCollection::const_iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+            if (iter->second.mRuns)
+                stream
+                    << "script," << iter->first << "," << iter->second.mRuns << ","
+                    << iter->second.mInstructionCount << "," << iter->second.mLinks.getSlowPathCount()
+                    << "," << iter->second.mTime << "\n";
+
+        Interpreter::OpcodeProfiles profiles;
+        mInterpreter.addProfiles (profiles);
+        mParallelScripts.addProfiles (profiles);
+
+        for (Interpreter::OpcodeProfiles::const_iterator iter (profiles.begin()); iter!=profiles.end(); ++iter)
+            stream
+                << "opcode," << getOpcodeName (iter->first) << "," << iter->second.mCount << ",,,"
+                << iter->second.getTime() << "\n";
+    }
+
     GlobalScripts& ScriptManager::getGlobalScripts()
     {
         return mGlobalScripts;
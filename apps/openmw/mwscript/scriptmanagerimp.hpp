@@ -4,6 +4,8 @@
 #include <map>
 #include <string>
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
 #include <components/compiler/streamerrorhandler.hpp>
 #include <components/compiler/fileparser.hpp>
 
@@ -13,6 +15,8 @@
 #include "../mwbase/scriptmanager.hpp"
 
 #include "globalscripts.hpp"
+#include "parallelscripts.hpp"
+#include "scriptlinks.hpp"
 
 namespace MWWorld
 {
@@ -42,13 +46,37 @@ namespace MWScript
             Interpreter::Interpreter mInterpreter;
             bool mOpcodesInstalled;
 
-            typedef std::pair<std::vector<Interpreter::Type_Code>, Compiler::Locals> CompiledScript;
+            struct CompiledScript
+            {
+                std::vector<Interpreter::Type_Code> mByteCode;
+                Interpreter::Instructions mInstructions; ///< decoded from mByteCode
+                Compiler::Locals mLocals;
+                ScriptLinks mLinks;
+                bool mParallel; ///< can be run by mParallelScripts
+                std::size_t mRuns; ///< while profiling
+                std::size_t mInstructionCount; ///< while profiling
+                double mTime; ///< in seconds, while profiling
+
+                CompiledScript() : mParallel (false), mRuns (0), mInstructionCount (0), mTime (0) {}
+            };
+
             typedef std::map<std::string, CompiledScript> ScriptCollection;
 
             ScriptCollection mScripts;
             GlobalScripts mGlobalScripts;
             std::map<std::string, Compiler::Locals> mOtherLocals;
             std::vector<std::string> mScriptBlacklist;
+            ParallelScripts mParallelScripts;
+            bool mProfiling;
+            boost::posix_time::ptime mProfilingStart;
+            boost::posix_time::ptime mProfilingStop; ///< not_a_date_time while profiling
+
+            void installOpcodes();
+
+            ScriptCollection::iterator findOrCompile (const std::string& name);
+            ///< A script that fails to compile is added without code.
+
+            std::string getOpcodeName (const std::pair<int, unsigned int>& opcode) const;
 
         public:
 
@@ -71,6 +99,29 @@ namespace MWScript
             ///< Return locals for script \a name.
 
             virtual GlobalScripts& getGlobalScripts();
+
+            virtual bool canRunInParallel (const std::string& name);
+            ///< Does the script with the given name use nothing but its own local variables,
+            /// so that it can be run by runInParallel? (compile first, if not compiled yet)
+
+            virtual void runInParallel (const std::vector<std::pair<std::string, MWWorld::Ptr> >& scripts);
+            ///< Run local scripts that passed canRunInParallel on worker threads. The effect is
+            /// the same as running them one after the other.
+
+            virtual std::size_t getSlowPathCount (const std::string& name) const;
+            ///< Number of times script \a name had to look up a global variable, reference or
+            /// member variable by name.
+
+            virtual bool toggleProfiling();
+            ///< Start or stop counting and timing the runs of scripts and the opcodes they
+            /// execute. Starting discards what has been collected before.
+            /// \return Is the profiling enabled now?
+
+            virtual void writeProfile (std::ostream& stream, std::size_t limit) const;
+            ///< Write a summary of the \a limit scripts and opcodes that took the most time.
+
+            virtual void writeProfileCsv (std::ostream& stream) const;
+            ///< Write everything collected as comma separated values.
     };
 }
 
@@ -112,8 +112,8 @@ namespace MWSound
 
         if(snd->mData.mMinRange == 0 && snd->mData.mMaxRange == 0)
         {
-            static const float fAudioDefaultMinDistance = world->getStore().get<ESM::GameSetting>().find("fAudioDefaultMinDistance")->getFloat();
-            static const float fAudioDefaultMaxDistance = world->getStore().get<ESM::GameSetting>().find("fAudioDefaultMaxDistance")->getFloat();
+            const float fAudioDefaultMinDistance = world->getStore().getGameSettingCache().fAudioDefaultMinDistance;
+            const float fAudioDefaultMaxDistance = world->getStore().getGameSettingCache().fAudioDefaultMaxDistance;
             min = fAudioDefaultMinDistance;
             max = fAudioDefaultMaxDistance;
         }
@@ -123,8 +123,8 @@ namespace MWSound
             max = snd->mData.mMaxRange;
         }
 
-        static const float fAudioMinDistanceMult = world->getStore().get<ESM::GameSetting>().find("fAudioMinDistanceMult")->getFloat();
-        static const float fAudioMaxDistanceMult = world->getStore().get<ESM::GameSetting>().find("fAudioMaxDistanceMult")->getFloat();
+        const float fAudioMinDistanceMult = world->getStore().getGameSettingCache().fAudioMinDistanceMult;
+        const float fAudioMaxDistanceMult = world->getStore().getGameSettingCache().fAudioMaxDistanceMult;
         min *= fAudioMinDistanceMult;
         max *= fAudioMaxDistanceMult;
         min = std::max(min, 1.0f);
@@ -260,10 +260,10 @@ namespace MWSound
             const Ogre::Vector3 objpos(pos.pos);
 
             MWBase::World* world = MWBase::Environment::get().getWorld();
-            static const float fAudioMinDistanceMult = world->getStore().get<ESM::GameSetting>().find("fAudioMinDistanceMult")->getFloat();
-            static const float fAudioMaxDistanceMult = world->getStore().get<ESM::GameSetting>().find("fAudioMaxDistanceMult")->getFloat();
-            static const float fAudioVoiceDefaultMinDistance = world->getStore().get<ESM::GameSetting>().find("fAudioVoiceDefaultMinDistance")->getFloat();
-            static const float fAudioVoiceDefaultMaxDistance = world->getStore().get<ESM::GameSetting>().find("fAudioVoiceDefaultMaxDistance")->getFloat();
+            const float fAudioMinDistanceMult = world->getStore().getGameSettingCache().fAudioMinDistanceMult;
+            const float fAudioMaxDistanceMult = world->getStore().getGameSettingCache().fAudioMaxDistanceMult;
+            const float fAudioVoiceDefaultMinDistance = world->getStore().getGameSettingCache().fAudioVoiceDefaultMinDistance;
+            const float fAudioVoiceDefaultMaxDistance = world->getStore().getGameSettingCache().fAudioVoiceDefaultMaxDistance;
 
             float minDistance = fAudioVoiceDefaultMinDistance * fAudioMinDistanceMult;
             float maxDistance = fAudioVoiceDefaultMaxDistance * fAudioMaxDistanceMult;
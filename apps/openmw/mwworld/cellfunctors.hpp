@@ -13,16 +13,15 @@ namespace ESM
 
 namespace MWWorld
 {
-    /// List all (Ogre-)handles, then reset RefData::mBaseNode to 0.
+    /// List all objects with a scene node, then reset RefData::mBaseNode to 0.
     struct ListAndResetHandles
     {
-        std::vector<Ogre::SceneNode*> mHandles;
+        std::vector<MWWorld::Ptr> mHandles; ///< the objects that had a scene node
 
         bool operator() (MWWorld::Ptr ptr)
         {
-            Ogre::SceneNode* handle = ptr.getRefData().getBaseNode();
-            if (handle)
-                mHandles.push_back (handle);
+            if (ptr.getRefData().getBaseNode())
+                mHandles.push_back (ptr);
 
             ptr.getRefData().setBaseNode(0);
             return true;
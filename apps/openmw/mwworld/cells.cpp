@@ -13,6 +13,17 @@
 #include "containerstore.hpp"
 #include "cellstore.hpp"
 
+namespace
+{
+    bool isAvailable (const MWWorld::LiveCellRefBase& ref, const std::string& name)
+    {
+        // Same conditions as in CellRefList::find
+        return !ref.mData.isDeletedByContentFile()
+            && (ref.mRef.hasContentFile() || ref.mData.getCount() > 0)
+            && ref.mRef.getRefId() == name;
+    }
+}
+
 MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
 {
     if (cell->mData.mFlags & ESM::Cell::Interior)
@@ -47,8 +58,7 @@ void MWWorld::Cells::clear()
 {
     mInteriors.clear();
     mExteriors.clear();
-    std::fill(mIdCache.begin(), mIdCache.end(), std::make_pair("", (MWWorld::CellStore*)0));
-    mIdCacheIndex = 0;
+    mRefIndex.clear();
 }
 
 MWWorld::Ptr MWWorld::Cells::getPtrAndCache (const std::string& name, CellStore& cellStore)
@@ -57,15 +67,65 @@ MWWorld::Ptr MWWorld::Cells::getPtrAndCache (const std::string& name, CellStore&
 
     if (!ptr.isEmpty() && ptr.isInCell())
     {
-        mIdCache[mIdCacheIndex].first = name;
-        mIdCache[mIdCacheIndex].second = &cellStore;
-        if (++mIdCacheIndex>=mIdCache.size())
-            mIdCacheIndex = 0;
+        IndexEntry entry;
+        entry.mCell = &cellStore;
+        entry.mRef = ptr.getBase();
+        mRefIndex[name] = entry;
     }
 
     return ptr;
 }
 
+void MWWorld::Cells::loadCell (CellStore& cell)
+{
+    if (cell.getState()!=CellStore::State_Loaded)
+    {
+        cell.load (mStore, mReader);
+        indexIds (cell);
+    }
+}
+
+void MWWorld::Cells::preloadCell (CellStore& cell)
+{
+    if (cell.getState()==CellStore::State_Unloaded)
+    {
+        cell.preload (mStore, mReader);
+        indexIds (cell);
+    }
+}
+
+void MWWorld::Cells::indexIds (CellStore& cell)
+{
+    IndexEntry entry;
+    entry.mCell = &cell;
+    entry.mRef = 0;
+
+    const std::vector<std::string>& ids = cell.getIds();
+
+    for (std::vector<std::string>::const_iterator iter (ids.begin()); iter!=ids.end(); ++iter)
+    {
+        std::pair<std::map<std::string, IndexEntry>::iterator, bool> result =
+            mRefIndex.insert (std::make_pair (*iter, entry));
+
+        if (!result.second && result.first->second.mCell!=&cell &&
+            hasPriority (cell, *result.first->second.mCell))
+            result.first->second = entry;
+    }
+}
+
+bool MWWorld::Cells::hasPriority (const CellStore& cell, const CellStore& other)
+{
+    // Same order as the search through the listed cells in getPtr
+    if (cell.isExterior()!=other.isExterior())
+        return cell.isExterior();
+
+    if (cell.isExterior())
+        return std::make_pair (cell.getCell()->getGridX(), cell.getCell()->getGridY()) >
+            std::make_pair (other.getCell()->getGridX(), other.getCell()->getGridY());
+
+    return Misc::StringUtils::ciLess (cell.getCell()->mName, other.getCell()->mName);
+}
+
 void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
 {
     if (cell.getState()!=CellStore::State_Loaded)
@@ -84,9 +144,7 @@ void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
 }
 
 MWWorld::Cells::Cells (const MWWorld::ESMStore& store, std::vector<std::vector<ESM::ESMReader*> >& reader)
-: mStore (store), mReader (reader),
-  mIdCache (40, std::pair<std::string, CellStore *> ("", (CellStore*)0)), /// \todo make cache size configurable
-  mIdCacheIndex (0)
+: mStore (store), mReader (reader)
 {}
 
 MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
@@ -116,11 +174,8 @@ MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
             std::make_pair (x, y), CellStore (cell))).first;
     }
 
-    if (result->second.getState()!=CellStore::State_Loaded)
-    {
-        // Multiple plugin support for landscape data is much easier than for references. The last plugin wins.
-        result->second.load (mStore, mReader);
-    }
+    // Multiple plugin support for landscape data is much easier than for references. The last plugin wins.
+    loadCell (result->second);
 
     return &result->second;
 }
@@ -137,10 +192,7 @@ MWWorld::CellStore *MWWorld::Cells::getInterior (const std::string& name)
         result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell))).first;
     }
 
-    if (result->second.getState()!=CellStore::State_Loaded)
-    {
-        result->second.load (mStore, mReader);
-    }
+    loadCell (result->second);
 
     return &result->second;
 }
@@ -156,14 +208,13 @@ MWWorld::CellStore *MWWorld::Cells::getCell (const ESM::CellId& id)
 MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name, CellStore& cell,
     bool searchInContainers)
 {
-    if (cell.getState()==CellStore::State_Unloaded)
-        cell.preload (mStore, mReader);
+    preloadCell (cell);
 
     if (cell.getState()==CellStore::State_Preloaded)
     {
         if (cell.hasId (name))
         {
-            cell.load (mStore, mReader);
+            loadCell (cell);
         }
         else
             return Ptr();
@@ -182,16 +233,28 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name, CellStore& cell,
 
 MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
 {
-    // First check the cache
-    for (std::vector<std::pair<std::string, CellStore *> >::iterator iter (mIdCache.begin());
-        iter!=mIdCache.end(); ++iter)
-        if (iter->first==name && iter->second)
+    // First check the index
+    std::map<std::string, IndexEntry>::iterator found = mRefIndex.find (name);
+
+    if (found!=mRefIndex.end())
+    {
+        IndexEntry& entry = found->second;
+
+        if (entry.mRef && isAvailable (*entry.mRef, name))
+            return Ptr (entry.mRef, entry.mCell);
+
+        Ptr ptr = getPtr (name, *entry.mCell);
+
+        if (!ptr.isEmpty())
         {
-            Ptr ptr = getPtr (name, *iter->second);
-            if (!ptr.isEmpty())
-                return ptr;
+            entry.mRef = ptr.getBase();
+            return ptr;
         }
 
+        // Gone from that cell
+        mRefIndex.erase (found);
+    }
+
     // Then check cells that are already listed
     // Search in reverse, this is a workaround for an ambiguous chargen_plank reference in the vanilla game.
     // there is one at -22,16 and one at -2,-9, the latter should be used.
@@ -246,7 +309,7 @@ void MWWorld::Cells::getExteriorPtrs(const std::string &name, std::vector<MWWorl
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             out.push_back(ptr);
@@ -260,13 +323,24 @@ void MWWorld::Cells::getInteriorPtrs(const std::string &name, std::vector<MWWorl
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             out.push_back(ptr);
     }
 }
 
+void MWWorld::Cells::updatePtr (const Ptr& old, const Ptr& ptr)
+{
+    std::map<std::string, IndexEntry>::iterator found = mRefIndex.find (ptr.getCellRef().getRefId());
+
+    if (found!=mRefIndex.end() && found->second.mRef==old.getBase() && ptr.isInCell())
+    {
+        found->second.mCell = ptr.getCell();
+        found->second.mRef = ptr.getBase();
+    }
+}
+
 int MWWorld::Cells::countSavedGameRecords() const
 {
     int count = 0;
@@ -331,8 +405,7 @@ bool MWWorld::Cells::readRecord (ESM::ESMReader& reader, uint32_t type,
         if (state.mHasFogOfWar)
             cellStore->readFog(reader);
 
-        if (cellStore->getState()!=CellStore::State_Loaded)
-            cellStore->load (mStore, mReader);
+        loadCell (*cellStore);
 
         cellStore->readReferences (reader, contentFileMap);
 
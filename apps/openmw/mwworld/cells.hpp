@@ -31,8 +31,16 @@ namespace MWWorld
             std::vector<std::vector<ESM::ESMReader*> >& mReader;
             mutable std::map<std::string, CellStore> mInteriors;
             mutable std::map<std::pair<int, int>, CellStore> mExteriors;
-            std::vector<std::pair<std::string, CellStore *> > mIdCache;
-            std::size_t mIdCacheIndex;
+
+            struct IndexEntry
+            {
+                CellStore *mCell;
+                LiveCellRefBase *mRef; ///< 0 until the reference has been looked up
+            };
+
+            /// Cell that getPtr (name) resolves a lower case ID to, filled in as cells are
+            /// listed or loaded and when getPtr has to fall back to searching all cells
+            std::map<std::string, IndexEntry> mRefIndex;
 
             Cells (const Cells&);
             Cells& operator= (const Cells&);
@@ -41,6 +49,17 @@ namespace MWWorld
 
             Ptr getPtrAndCache (const std::string& name, CellStore& cellStore);
 
+            void loadCell (CellStore& cell);
+            ///< Load \a cell if necessary and add its references to the index.
+
+            void preloadCell (CellStore& cell);
+            ///< List the references of \a cell if necessary and add them to the index.
+
+            void indexIds (CellStore& cell);
+
+            static bool hasPriority (const CellStore& cell, const CellStore& other);
+            ///< Is \a cell searched before \a other when resolving an ID?
+
             void writeCell (ESM::ESMWriter& writer, CellStore& cell) const;
 
         public:
@@ -62,6 +81,10 @@ namespace MWWorld
             /// @note name must be lower case
             Ptr getPtr (const std::string& name);
 
+            void updatePtr (const Ptr& old, const Ptr& ptr);
+            ///< Resolve the ID of \a old to \a ptr from now on, if \a old is what it resolves to.
+            /// Call this when a reference has been moved to another cell.
+
             /// Get all Ptrs referencing \a name in exterior cells
             /// @note Due to the current implementation of getPtr this only supports one Ptr per cell.
             /// @note name must be lower case
@@ -152,7 +152,7 @@ namespace MWWorld
 
         if (const X *ptr = store.search (ref.mRefID))
         {
-            typename std::list<LiveRef>::iterator iter =
+            typename List::iterator iter =
                 std::find(mList.begin(), mList.end(), ref.mRefNum);
 
             LiveRef liveCellRef (ref, ptr);
@@ -211,6 +211,11 @@ namespace MWWorld
         return const_cast<CellStore *> (this)->search (id).isEmpty();
     }
 
+    const std::vector<std::string>& CellStore::getIds() const
+    {
+        return mIds;
+    }
+
     Ptr CellStore::search (const std::string& id)
     {
         bool oldState = mHasState;
@@ -404,8 +409,7 @@ namespace MWWorld
     {
         if (mState!=State_Loaded)
         {
-            if (mState==State_Preloaded)
-                mIds.clear();
+            mIds.clear();
 
             loadRefs (store, esm);
 
@@ -413,7 +417,7 @@ namespace MWWorld
 
             // TODO: the pathgrid graph only needs to be loaded for active cells, so move this somewhere else.
             // In a simple test, loading the graph for all cells in MW + expansions took 200 ms
-            mPathgridGraph.load(this);
+            mPathgridGraph.load(store.get<ESM::Pathgrid>().search(*mCell), mCell->isExterior());
         }
     }
 
@@ -501,6 +505,9 @@ namespace MWWorld
                 }
 
                 loadRef (ref, deleted, store);
+
+                if (!deleted)
+                    mIds.push_back (ref.mRefID);
             }
         }
 
@@ -510,7 +517,11 @@ namespace MWWorld
             ESM::CellRef &ref = const_cast<ESM::CellRef&>(*it);
 
             loadRef (ref, false, store);
+
+            mIds.push_back (ref.mRefID);
         }
+
+        std::sort (mIds.begin(), mIds.end());
     }
 
     bool CellStore::isExterior() const
@@ -780,6 +791,16 @@ namespace MWWorld
         return mPathgridGraph.isPointConnected(start, end);
     }
 
+    int CellStore::getClosestPoint(const Ogre::Vector3& pos) const
+    {
+        return mPathgridGraph.getClosestPoint(pos);
+    }
+
+    std::pair<int, bool> CellStore::getClosestReachablePoint(const Ogre::Vector3& pos, int start) const
+    {
+        return mPathgridGraph.getClosestReachablePoint(pos, start);
+    }
+
     std::list<ESM::Pathgrid::Point> CellStore::aStarSearch(const int start, const int end) const
     {
         return mPathgridGraph.aStarSearch(start, end);
@@ -799,7 +820,7 @@ namespace MWWorld
     {
         if (mState == State_Loaded)
         {
-            static int iMonthsToRespawn = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("iMonthsToRespawn")->getInt();
+            const int iMonthsToRespawn = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().iMonthsToRespawn;
             if (MWBase::Environment::get().getWorld()->getTimeStamp() - mLastRespawn > 24*30*iMonthsToRespawn)
             {
                 mLastRespawn = MWBase::Environment::get().getWorld()->getTimeStamp();
@@ -90,6 +90,10 @@ namespace MWWorld
             ///< May return true for deleted IDs when in preload state. Will return false, if cell is
             /// unloaded.
 
+            const std::vector<std::string>& getIds() const;
+            ///< Sorted lower case IDs of the references listed in the content files (moved
+            /// references included, deleted ones excluded). Empty if the cell is unloaded.
+
             Ptr search (const std::string& id);
             ///< Will return an empty Ptr if cell is not loaded. Does not check references in
             /// containers.
@@ -194,6 +198,10 @@ namespace MWWorld
 
             bool isPointConnected(const int start, const int end) const;
 
+            int getClosestPoint(const Ogre::Vector3& pos) const;
+
+            std::pair<int, bool> getClosestReachablePoint(const Ogre::Vector3& pos, int start) const;
+
             std::list<ESM::Pathgrid::Point> aStarSearch(const int start, const int end) const;
 
         private:
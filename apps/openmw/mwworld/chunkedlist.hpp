@@ -0,0 +1,259 @@
+#ifndef GAME_MWWORLD_CHUNKEDLIST_H
+#define GAME_MWWORLD_CHUNKEDLIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <vector>
+
+namespace MWWorld
+{
+    /// \brief Sequence that can only grow at the end, stored in arrays of increasing size
+    ///
+    /// Elements never move, so pointers, references and iterators to them stay valid until the
+    /// container is destroyed (as with std::list), while iteration walks consecutive memory and
+    /// most insertions do not allocate (as with std::vector).
+    template<typename T>
+    class ChunkedList
+    {
+            struct Chunk
+            {
+                T *mData;
+                std::size_t mCapacity;
+            };
+
+            std::vector<Chunk> mChunks;
+            std::size_t mSize;
+            std::size_t mBack; ///< number of elements in the last chunk
+
+            template<typename Value, typename List>
+            class Iterator
+            {
+                    List *mList;
+                    std::size_t mChunk;
+                    std::size_t mIndex;
+
+                    template<typename, typename> friend class Iterator;
+                    friend class ChunkedList;
+
+                    Iterator (List *list, std::size_t chunk, std::size_t index)
+                    : mList (list), mChunk (chunk), mIndex (index)
+                    {}
+
+                public:
+
+                    typedef std::bidirectional_iterator_tag iterator_category;
+                    typedef Value value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef Value *pointer;
+                    typedef Value& reference;
+
+                    Iterator() : mList (0), mChunk (0), mIndex (0) {}
+
+                    // allows conversion from iterator to const_iterator
+                    template<typename OtherValue, typename OtherList>
+                    Iterator (const Iterator<OtherValue, OtherList>& iter)
+                    : mList (iter.mList), mChunk (iter.mChunk), mIndex (iter.mIndex)
+                    {}
+
+                    Value& operator*() const
+                    {
+                        return mList->mChunks[mChunk].mData[mIndex];
+                    }
+
+                    Value *operator->() const
+                    {
+                        return &mList->mChunks[mChunk].mData[mIndex];
+                    }
+
+                    Iterator& operator++()
+                    {
+                        if (++mIndex==mList->mChunks[mChunk].mCapacity)
+                        {
+                            ++mChunk;
+                            mIndex = 0;
+                        }
+
+                        return *this;
+                    }
+
+                    Iterator operator++ (int)
+                    {
+                        Iterator iter (*this);
+                        ++*this;
+                        return iter;
+                    }
+
+                    Iterator& operator--()
+                    {
+                        if (mIndex==0)
+                            mIndex = mList->mChunks[--mChunk].mCapacity;
+
+                        --mIndex;
+                        return *this;
+                    }
+
+                    Iterator operator-- (int)
+                    {
+                        Iterator iter (*this);
+                        --*this;
+                        return iter;
+                    }
+
+                    bool operator== (const Iterator& iter) const
+                    {
+                        return mChunk==iter.mChunk && mIndex==iter.mIndex;
+                    }
+
+                    bool operator!= (const Iterator& iter) const
+                    {
+                        return !(*this==iter);
+                    }
+            };
+
+            // The first chunks are small, since most lists in a cell only hold a few references
+            static std::size_t getChunkCapacity (std::size_t chunk)
+            {
+                return chunk<4 ? std::size_t (8) << chunk : 128;
+            }
+
+        public:
+
+            typedef T value_type;
+            typedef Iterator<T, ChunkedList> iterator;
+            typedef Iterator<const T, const ChunkedList> const_iterator;
+
+            ChunkedList() : mSize (0), mBack (0) {}
+
+            ChunkedList (const ChunkedList& list) : mSize (0), mBack (0)
+            {
+                for (const_iterator iter (list.begin()); iter!=list.end(); ++iter)
+                    push_back (*iter);
+            }
+
+            ~ChunkedList()
+            {
+                clear();
+            }
+
+            ChunkedList& operator= (const ChunkedList& list)
+            {
+                ChunkedList copy (list);
+                swap (copy);
+                return *this;
+            }
+
+            void swap (ChunkedList& list)
+            {
+                mChunks.swap (list.mChunks);
+                std::swap (mSize, list.mSize);
+                std::swap (mBack, list.mBack);
+            }
+
+            iterator begin()
+            {
+                return iterator (this, 0, 0);
+            }
+
+            const_iterator begin() const
+            {
+                return const_iterator (this, 0, 0);
+            }
+
+            iterator end()
+            {
+                return iterator (this, getEndChunk(), getEndIndex());
+            }
+
+            const_iterator end() const
+            {
+                return const_iterator (this, getEndChunk(), getEndIndex());
+            }
+
+            std::size_t size() const
+            {
+                return mSize;
+            }
+
+            bool empty() const
+            {
+                return mSize==0;
+            }
+
+            T& front()
+            {
+                return *begin();
+            }
+
+            const T& front() const
+            {
+                return *begin();
+            }
+
+            T& back()
+            {
+                return *--end();
+            }
+
+            const T& back() const
+            {
+                return *--end();
+            }
+
+            void push_back (const T& item)
+            {
+                if (mChunks.empty() || mBack==mChunks.back().mCapacity)
+                {
+                    mChunks.reserve (mChunks.size()+1);
+
+                    Chunk chunk;
+                    chunk.mCapacity = getChunkCapacity (mChunks.size());
+                    chunk.mData = static_cast<T *> (::operator new (chunk.mCapacity * sizeof (T)));
+                    mChunks.push_back (chunk);
+                    mBack = 0;
+                }
+
+                new (mChunks.back().mData + mBack) T (item);
+                ++mBack;
+                ++mSize;
+            }
+
+            void clear()
+            {
+                for (std::size_t i = 0; i<mChunks.size(); ++i)
+                {
+                    std::size_t count = i+1==mChunks.size() ? mBack : mChunks[i].mCapacity;
+
+                    for (std::size_t j = 0; j<count; ++j)
+                        mChunks[i].mData[j].~T();
+
+                    ::operator delete (mChunks[i].mData);
+                }
+
+                mChunks.clear();
+                mSize = 0;
+                mBack = 0;
+            }
+
+        private:
+
+            std::size_t getEndChunk() const
+            {
+                if (!mChunks.empty() && mBack==mChunks.back().mCapacity)
+                    return mChunks.size();
+
+                return mChunks.empty() ? 0 : mChunks.size()-1;
+            }
+
+            std::size_t getEndIndex() const
+            {
+                if (!mChunks.empty() && mBack==mChunks.back().mCapacity)
+                    return 0;
+
+                return mBack;
+            }
+    };
+}
+
+#endif
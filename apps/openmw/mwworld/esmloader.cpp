@@ -1,18 +1,79 @@
 #include "esmloader.hpp"
 #include "esmstore.hpp"
 
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
 #include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
 #include <components/esm/esm4reader.hpp>
+#include <components/misc/workqueue.hpp>
+#include <components/to_utf8/to_utf8.hpp>
+
+namespace
+{
+    double getSeconds(const boost::posix_time::ptime& start)
+    {
+        return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+    }
+
+    // Increase when the layout of the snapshot or of the records written to it changes
+    const int sSnapshotVersion = 1;
+}
 
 namespace MWWorld
 {
 
+/// Reads the records of one TES3 content file on a worker thread
+class EsmLoader::ParseFile : public Misc::WorkItem
+{
+    const ESMStore& mStore;
+    ESM::ESMReader& mReader;
+    ToUTF8::Utf8Encoder* mEncoder;
+
+    // The encoder keeps its output buffer between calls, so each file needs its own
+    boost::scoped_ptr<ToUTF8::Utf8Encoder> mOwnEncoder;
+
+protected:
+    virtual void doWork()
+    {
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+        mReader.setEncoder(mOwnEncoder.get());
+        mStore.parse(mReader, mBatch);
+        mReader.setEncoder(mEncoder);
+
+        mTime = getSeconds(start);
+    }
+
+public:
+    LoadBatch mBatch;
+    double mTime;
+
+    ParseFile(const ESMStore& store, ESM::ESMReader& reader, ToUTF8::Utf8Encoder* encoder)
+        : mStore(store), mReader(reader), mEncoder(encoder), mTime(0)
+    {
+        if (encoder)
+            mOwnEncoder.reset(new ToUTF8::Utf8Encoder(*encoder));
+    }
+};
+
 EsmLoader::EsmLoader(MWWorld::ESMStore& store, std::vector<std::vector<ESM::ESMReader*> >& readers,
   ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener)
   : ContentLoader(listener)
   , mEsm(readers)
   , mStore(store)
   , mEncoder(encoder)
+  , mReportTimes(false)
+{
+}
+
+EsmLoader::~EsmLoader()
 {
 }
 
@@ -24,6 +85,8 @@ void EsmLoader::load(const boost::filesystem::path& filepath, std::vector<std::v
 
     ContentLoader::load(filepath.filename(), contentFiles); // set the label on the loading bar
 
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
     ESM::ESMReader *lEsm = new ESM::ESMReader();
     lEsm->setEncoder(mEncoder);
     lEsm->setGlobalReaderList(&mEsm[tesVerIndex]);  // global reader list is used by ESMStore::load only
@@ -34,6 +97,9 @@ void EsmLoader::load(const boost::filesystem::path& filepath, std::vector<std::v
     bool isTes5 = esmVer == ESM::VER_094 || esmVer == ESM::VER_17;
     bool isFONV = esmVer == ESM::VER_132 || esmVer == ESM::VER_133 || esmVer == ESM::VER_134;
 
+    PendingFile pending;
+    pending.mPath = filepath;
+
     if (isTes4 || isTes5 || isFONV)
     {
         if (isTes4)
@@ -67,9 +133,227 @@ void EsmLoader::load(const boost::filesystem::path& filepath, std::vector<std::v
         contentFiles[tesVerIndex].push_back(filepath.filename().string());
         lEsm->setIndex(index);
         mEsm[tesVerIndex].push_back(lEsm);
+
+        // The records are read in parallel, but only added to the store in load order by
+        // finish(), so that later files override earlier ones as with serial loading
+        pending.mParse.reset(new ParseFile(mStore, *lEsm, mEncoder));
+
+        // With a snapshot the files may not need to be read at all, so finish() decides
+        if (mSnapshotPath.empty())
+        {
+            if (!mWorkQueue)
+                mWorkQueue.reset(new Misc::WorkQueue);
+
+            mWorkQueue->addWorkItem(pending.mParse);
+        }
+    }
+
+    pending.mReader = mEsm[tesVerIndex][index];
+    pending.mOpenTime = getSeconds(start);
+    mPending.push_back(pending);
+}
+
+void EsmLoader::printOpenTime(const PendingFile& file, ESM::ESMReader& reader)
+{
+    std::cout << "Loaded " << file.mPath.filename().string() << " (" << reader.getFileSize() / 1024 << " KiB"
+        << (reader.isMapped() ? ", mapped" : "") << "): open " << static_cast<int>(file.mOpenTime * 1000) << " ms, ";
+}
+
+void EsmLoader::setSnapshotPath(const boost::filesystem::path& path)
+{
+    mSnapshotPath = path;
+}
+
+void EsmLoader::setReportTimes(bool report)
+{
+    mReportTimes = report;
+}
+
+std::string EsmLoader::getSnapshotKey()
+{
+    std::ostringstream key;
+    key << sSnapshotVersion;
+
+    // Record strings are stored converted, so a different encoding needs a new snapshot
+    if (mEncoder)
+    {
+        std::string legacy;
+        for (int c = 0x80; c < 0x100; ++c)
+            legacy += static_cast<char>(c);
+        key << '|' << mEncoder->getUtf8(legacy);
+    }
+
+    for (std::vector<PendingFile>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+        key << '|' << it->mPath.string() << '|' << boost::filesystem::file_size(it->mPath)
+            << '|' << boost::filesystem::last_write_time(it->mPath);
+
+    return key.str();
+}
+
+bool EsmLoader::loadSnapshot(const std::string& key)
+{
+    if (!boost::filesystem::exists(mSnapshotPath))
+        return false;
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    std::vector<ESM::ESMReader*> readers;
+    for (std::vector<PendingFile>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+        readers.push_back(it->mReader);
+
+    ESM::ESMReader snapshot;
+
+    try
+    {
+        snapshot.open(mSnapshotPath.string());
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Failed to open " << mSnapshotPath.string() << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    try
+    {
+        if (!mStore.loadSnapshot(snapshot, key, readers, &mListener))
+        {
+            std::cout << "Content files changed or snapshot damaged, not using " << mSnapshotPath.string() << std::endl;
+            return false;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        // Only a record that passed the layout check can fail here. The store may be partially
+        // filled already, so there is no way to continue, but the next start parses the content
+        // files again.
+        std::cerr << "Failed to load " << mSnapshotPath.string() << ": " << e.what() << std::endl;
+        boost::filesystem::remove(mSnapshotPath);
+        throw;
+    }
+
+    std::cout << "Loaded " << mPending.size() << " content files from " << mSnapshotPath.string() << ": "
+        << static_cast<int>(getSeconds(start) * 1000) << " ms" << std::endl;
+
+    return true;
+}
+
+void EsmLoader::writeSnapshot(const std::string& key)
+{
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    std::vector<const LoadBatch*> batches;
+    for (std::vector<PendingFile>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+        batches.push_back(&it->mParse->mBatch);
+
+    boost::filesystem::path newPath = mSnapshotPath.string() + ".new";
+
+    try
+    {
+        boost::filesystem::ofstream stream(newPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+            throw std::runtime_error("failed to open " + newPath.string());
+
+        ESM::ESMWriter writer;
+        writer.setVersion();
+        writer.setFormat(0);
+        writer.save(stream);
+        mStore.writeSnapshot(writer, key, batches);
+        writer.close();
+
+        stream.close();
+        if (!stream)
+            throw std::runtime_error("failed to write " + newPath.string());
+
+        boost::filesystem::rename(newPath, mSnapshotPath);
     }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Failed to save " << mSnapshotPath.string() << ": " << e.what() << std::endl;
+        return;
+    }
+
+    std::cout << "Saved " << mSnapshotPath.string() << ": "
+        << static_cast<int>(getSeconds(start) * 1000) << " ms" << std::endl;
+}
+
+void EsmLoader::finish()
+{
+    bool snapshot = !mSnapshotPath.empty() && !mPending.empty();
+    for (std::vector<PendingFile>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+        if (!it->mParse)
+            snapshot = false;
+
+    std::string key;
+
+    if (snapshot)
+    {
+        key = getSnapshotKey();
+
+        if (loadSnapshot(key))
+        {
+            mPending.clear();
+            return;
+        }
+
+        mWorkQueue.reset(new Misc::WorkQueue);
+        for (std::vector<PendingFile>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+            mWorkQueue->addWorkItem(it->mParse);
+    }
+    else if (!mWorkQueue)
+    {
+        // Files deferred in load() because a snapshot path was set, which can not be used here
+        for (std::vector<PendingFile>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+            if (it->mParse)
+            {
+                if (!mWorkQueue)
+                    mWorkQueue.reset(new Misc::WorkQueue);
+
+                mWorkQueue->addWorkItem(it->mParse);
+            }
+    }
+
+    for (std::vector<PendingFile>::iterator it = mPending.begin(); it != mPending.end(); ++it)
+    {
+        mListener.setLabel(it->mPath.filename().string());
+
+        ESM::ESMReader& reader = *it->mReader;
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+        if (it->mParse)
+        {
+            it->mParse->waitTillDone();
+
+            double waitTime = getSeconds(start);
+            mStore.merge(reader, it->mParse->mBatch, &mListener);
+            double mergeTime = getSeconds(start) - waitTime;
+
+            if (mReportTimes)
+            {
+                printOpenTime(*it, reader);
+                std::cout << "parse " << static_cast<int>(it->mParse->mTime * 1000) << " ms (waited "
+                    << static_cast<int>(waitTime * 1000) << " ms), merge "
+                    << static_cast<int>(mergeTime * 1000) << " ms" << std::endl;
+            }
+        }
+        else
+        {
+            size_t indexed = mStore.getTes4Records().getSize();
+            mStore.load(reader, &mListener);
+
+            if (mReportTimes)
+            {
+                printOpenTime(*it, reader);
+                std::cout << "records " << static_cast<int>(getSeconds(start) * 1000) << " ms ("
+                    << mStore.getTes4Records().getSize() - indexed << " new indexed)" << std::endl;
+            }
+        }
+    }
+
+    if (snapshot)
+        writeSnapshot(key);
 
-    mStore.load(*mEsm[tesVerIndex][index], &mListener);
+    mPending.clear();
+    mWorkQueue.reset();
 }
 
 } /* namespace MWWorld */
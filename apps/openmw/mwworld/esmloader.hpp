@@ -3,6 +3,9 @@
 
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+
 #include "contentloader.hpp"
 
 namespace ToUTF8
@@ -15,6 +18,11 @@ namespace ESM
     class ESMReader;
 }
 
+namespace Misc
+{
+    class WorkQueue;
+}
+
 namespace MWWorld
 {
 
@@ -25,12 +33,50 @@ struct EsmLoader : public ContentLoader
     EsmLoader(MWWorld::ESMStore& store, std::vector<std::vector<ESM::ESMReader*> >& readers,
         ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener);
 
+    ~EsmLoader();
+
+    /// Open the file and start reading its records in the background. The records are added
+    /// to the store by finish().
     void load(const boost::filesystem::path& filepath, std::vector<std::vector<std::string> >& contentFiles);
 
+    /// Add the records of all files passed to load() to the store, in the order they were passed.
+    void finish();
+
+    /// Restore the store from a snapshot at \a path in finish() if it was written for the same
+    /// content files, or write one there after loading them. Only used for TES3 content files.
+    void setSnapshotPath(const boost::filesystem::path& path);
+
+    /// Print how long opening, reading and merging each content file took in finish().
+    void setReportTimes(bool report);
+
     private:
+        class ParseFile;
+
+        struct PendingFile
+        {
+            boost::filesystem::path mPath;
+            ESM::ESMReader* mReader;
+            boost::shared_ptr<ParseFile> mParse; ///< empty for files loaded serially (TES4 and later)
+            double mOpenTime;
+        };
+
+        void printOpenTime(const PendingFile& file, ESM::ESMReader& reader);
+
+        /// Identifies the pending files, their contents and the encoding they are read with
+        std::string getSnapshotKey();
+
+        bool loadSnapshot(const std::string& key);
+
+        void writeSnapshot(const std::string& key);
+
         std::vector<std::vector<ESM::ESMReader*> >& mEsm; // Note: the ownership of the readers is with the caller
         MWWorld::ESMStore& mStore;
         ToUTF8::Utf8Encoder* mEncoder;
+        boost::filesystem::path mSnapshotPath;
+        bool mReportTimes;
+
+        std::vector<PendingFile> mPending;
+        boost::scoped_ptr<Misc::WorkQueue> mWorkQueue; ///< created on first use
 };
 
 } /* namespace MWWorld */
@@ -27,64 +27,41 @@ static bool isCacheableRecord(int id)
     return false;
 }
 
+static bool isTes4Format(int esmVer)
+{
+    return esmVer == ESM::VER_080 || esmVer == ESM::VER_100 || // TES4
+        esmVer == ESM::VER_094 || esmVer == ESM::VER_17 ||     // TES5
+        esmVer == ESM::VER_132 || esmVer == ESM::VER_133 || esmVer == ESM::VER_134; // FONV
+}
+
+// Records that refer back to their content file, and are read from it again when loading a snapshot
+static bool isReplayedRecord(int id)
+{
+    return id == ESM::REC_CELL || id == ESM::REC_LAND || id == ESM::REC_LTEX || id == ESM::REC_PGRD;
+}
+
+LoadBatch::~LoadBatch()
+{
+    for (std::vector<Entry>::iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+        delete it->mRecord;
+}
+
 void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
 {
     listener->setProgressRange(1000);
 
     ESM::Dialogue *dialogue = 0;
 
-    int esmVer = esm.getVer();
-    bool isTes4 = esmVer == ESM::VER_080 || esmVer == ESM::VER_100;
-    bool isTes5 = esmVer == ESM::VER_094 || esmVer == ESM::VER_17;
-    bool isFONV = esmVer == ESM::VER_132 || esmVer == ESM::VER_133 || esmVer == ESM::VER_134;
+    bool isTes4 = isTes4Format(esm.getVer());
 
     // FIXME: temporary workaround
-    if (!(isTes4 || isTes5 || isFONV)) // MW only
-    {
-        // Land texture loading needs to use a separate internal store for each plugin.
-        // We set the number of plugins here to avoid continual resizes during loading,
-        // and so we can properly verify if valid plugin indices are being passed to the
-        // LandTexture Store retrieval methods.
-        mLandTextures.resize(esm.getGlobalReaderList()->size()); // FIXME: size should be for MW only
-    }
-
-    // FIXME: for TES4/TES5 whether a dependent file is loaded is already checked in
-    // ESM4::Reader::updateModIndicies() which is called in EsmLoader::load() before this
-    if (!(isTes4 || isTes5 || isFONV)) // MW only
-    {
-        /// \todo Move this to somewhere else. ESMReader?
-        // Cache parent esX files by tracking their indices in the global list of
-        //  all files/readers used by the engine. This will greaty accelerate
-        //  refnumber mangling, as required for handling moved references.
-        const std::vector<ESM::Header::MasterData> &masters = esm.getGameFiles();
-        std::vector<ESM::ESMReader*> *allPlugins = esm.getGlobalReaderList();
-        for (size_t j = 0; j < masters.size(); j++) {
-            ESM::Header::MasterData &mast = const_cast<ESM::Header::MasterData&>(masters[j]);
-            std::string fname = mast.name;
-            int index = ~0;
-            for (int i = 0; i < esm.getIndex(); i++) {
-                const std::string &candidate = allPlugins->at(i)->getContext().filename;
-                std::string fnamecandidate = boost::filesystem::path(candidate).filename().string();
-                if (Misc::StringUtils::ciEqual(fname, fnamecandidate)) {
-                    index = i;
-                    break;
-                }
-            }
-            if (index == (int)~0) {
-                // Tried to load a parent file that has not been loaded yet. This is bad,
-                //  the launcher should have taken care of this.
-                std::string fstring = "File " + esm.getName() + " asks for parent file " + masters[j].name
-                    + ", but it has not been loaded yet. Please check your load order.";
-                esm.fail(fstring);
-            }
-            mast.index = index;
-        }
-    }
+    if (!isTes4) // MW only
+        resolveMasters(esm);
 
     // Loop through all records
     while(esm.hasMoreRecs())
     {
-        if (isTes4 || isTes5 || isFONV)
+        if (isTes4)
         {
             ESM4::Reader& reader = static_cast<ESM::ESM4Reader*>(&esm)->reader();
             reader.checkGroupStatus();
@@ -97,54 +74,362 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         ESM::NAME n = esm.getRecName();
         esm.getRecHeader();
 
-        // Look up the record type.
-        std::map<int, StoreBase *>::iterator it = mStores.find(n.val);
+        loadRecord(esm, n, dialogue);
+
+        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+    }
+}
+
+void ESMStore::parse(ESM::ESMReader &esm, LoadBatch &batch) const
+{
+    while(esm.hasMoreRecs())
+    {
+        LoadBatch::Entry entry;
+        entry.mOffset = esm.getFileOffset();
+        entry.mName = esm.getRecName();
+        entry.mStore = 0;
+        entry.mRecord = 0;
+
+        esm.getRecHeader();
+
+        std::map<int, StoreBase *>::const_iterator it = mStores.find(entry.mName.val);
+        if (it != mStores.end())
+            entry.mStore = it->second;
+
+        batch.mEntries.push_back(entry);
+
+        if (entry.mStore)
+            batch.mEntries.back().mRecord = entry.mStore->parse(esm);
+
+        if (!batch.mEntries.back().mRecord)
+            esm.skipRecord();
+    }
+}
+
+void ESMStore::merge(ESM::ESMReader &esm, LoadBatch &batch, Loading::Listener* listener)
+{
+    listener->setProgressRange(1000);
+
+    resolveMasters(esm);
+
+    // The reader is at the end of the file after parse(). Records that could not be parsed up
+    // front are read again from their start, which leaves leftFile as load() would have it.
+    ESM::ESM_Context end = esm.getContext();
+    ESM::ESM_Context context = end;
+    context.leftRec = 0;
+    context.leftSub = 0;
+    context.subCached = false;
 
-        if (it == mStores.end()) {
-            if (n.val == ESM::REC_INFO) {
-                if (dialogue)
+    size_t fileSize = esm.getFileSize();
+    ESM::Dialogue *dialogue = 0;
+
+    for (std::vector<LoadBatch::Entry>::iterator it = batch.mEntries.begin(); it != batch.mEntries.end(); ++it)
+    {
+        if (it->mRecord)
+        {
+            addRecordId(*it->mStore, it->mName, it->mStore->merge(*it->mRecord), dialogue);
+
+            delete it->mRecord;
+            it->mRecord = 0;
+        }
+        else
+        {
+            context.filePos = it->mOffset;
+            context.leftFile = fileSize - it->mOffset;
+            esm.restoreContext(context);
+
+            ESM::NAME n = esm.getRecName();
+            esm.getRecHeader();
+
+            loadRecord(esm, n, dialogue);
+        }
+
+        listener->setProgress(static_cast<size_t>(it->mOffset / (float)fileSize * 1000));
+    }
+
+    esm.restoreContext(end);
+}
+
+void ESMStore::writeSnapshot(ESM::ESMWriter &writer, const std::string &key,
+    const std::vector<const LoadBatch *> &batches) const
+{
+    writer.startRecord("SNAP");
+    writer.writeHNString("NAME", key);
+    writer.endRecord("SNAP");
+
+    for (std::map<int, StoreBase *>::const_iterator it = mStores.begin(); it != mStores.end(); ++it)
+        it->second->writeSnapshot(writer);
+
+    mMagicEffects.writeSnapshot(writer);
+    mSkills.writeSnapshot(writer);
+
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        writer.startRecord("RPLY");
+        writer.writeHNT("INTV", static_cast<uint32_t>(i));
+        writer.startSubRecord("DATA");
+
+        const std::vector<LoadBatch::Entry> &entries = batches[i]->mEntries;
+        for (std::vector<LoadBatch::Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+            if (isReplayedRecord(it->mName.val))
+                writer.writeT(static_cast<uint64_t>(it->mOffset));
+
+        writer.endRecord("DATA");
+        writer.endRecord("RPLY");
+    }
+
+    // Written last, so that it replaces the lookup load() builds. It can contain IDs of records
+    // deleted by a later content file.
+    writer.startRecord("IDLS");
+    for (std::map<std::string, int>::const_iterator it = mIds.begin(); it != mIds.end(); ++it)
+    {
+        writer.writeHNString("NAME", it->first);
+        writer.writeHNT("INTV", it->second);
+    }
+    writer.endRecord("IDLS");
+
+    // Marks a complete snapshot
+    writer.startRecord("SEND");
+    writer.endRecord("SEND");
+}
+
+bool ESMStore::isValidSnapshot(ESM::ESMReader &snapshot, const std::string &key,
+    const std::vector<ESM::ESMReader *> &readers) const
+{
+    try
+    {
+        if (!snapshot.hasMoreRecs() || snapshot.getRecName() != "SNAP")
+            return false;
+
+        snapshot.getRecHeader();
+        if (snapshot.getHNString("NAME") != key || snapshot.hasMoreSubs())
+            return false;
+
+        while (snapshot.hasMoreRecs())
+        {
+            ESM::NAME n = snapshot.getRecName();
+            snapshot.getRecHeader();
+
+            if (n == "SEND")
+                return !snapshot.hasMoreSubs() && !snapshot.hasMoreRecs();
+
+            if (n != "RPLY" && n != "IDLS" && mStores.find(n.val) == mStores.end() &&
+                n.val != ESM::REC_INFO && n.val != ESM::REC_MGEF && n.val != ESM::REC_SKIL)
+                return false;
+
+            // The reader does not check that sub-records fit into their record
+            uint32_t left = snapshot.getContext().leftRec;
+            uint32_t index = static_cast<uint32_t>(readers.size());
+
+            while (left > 0)
+            {
+                if (left < 8)
+                    return false;
+
+                snapshot.getSubName();
+                snapshot.getSubHeader();
+                uint32_t size = snapshot.getSubSize();
+                left -= 8;
+                if (size > left)
+                    return false;
+                left -= size;
+
+                if (n == "RPLY" && snapshot.retSubName() == "INTV" && size == sizeof(uint32_t))
                 {
-                    dialogue->readInfo(esm, esm.getIndex() != 0);
+                    snapshot.getT(index);
                 }
-                else
+                else if (n == "RPLY" && snapshot.retSubName() == "DATA")
                 {
-                    std::cerr << "error: info record without dialog" << std::endl;
-                    esm.skipRecord();
+                    if (index >= readers.size() || size % sizeof(uint64_t) != 0)
+                        return false;
+
+                    size_t fileSize = readers[index]->getFileSize();
+                    for (uint32_t i = 0; i < size / sizeof(uint64_t); ++i)
+                    {
+                        uint64_t offset;
+                        snapshot.getT(offset);
+                        if (offset >= fileSize)
+                            return false;
+                    }
                 }
-            } else if (n.val == ESM::REC_MGEF) {
-                mMagicEffects.load (esm);
-            } else if (n.val == ESM::REC_SKIL) {
-                mSkills.load (esm);
+                else
+                    snapshot.skip(size);
             }
-            else if (n.val==ESM::REC_FILT || n.val == ESM::REC_DBGP)
+        }
+    }
+    catch (const std::exception &)
+    {
+    }
+
+    return false;
+}
+
+bool ESMStore::loadSnapshot(ESM::ESMReader &snapshot, const std::string &key,
+    const std::vector<ESM::ESMReader *> &readers, Loading::Listener* listener)
+{
+    ESM::ESM_Context start = snapshot.getContext();
+    if (!isValidSnapshot(snapshot, key, readers))
+        return false;
+
+    // Skip the key, checked above
+    snapshot.restoreContext(start);
+    snapshot.getRecName();
+    snapshot.getRecHeader();
+    snapshot.skipRecord();
+
+    listener->setProgressRange(1000);
+
+    std::vector<std::vector<LoadBatch::Entry> > replayed(readers.size());
+    ESM::Dialogue *dialogue = 0;
+
+    while (snapshot.hasMoreRecs())
+    {
+        ESM::NAME n = snapshot.getRecName();
+        snapshot.getRecHeader();
+
+        if (n == "SEND")
+            break;
+
+        if (n == "RPLY")
+        {
+            uint32_t index;
+            snapshot.getHNT(index, "INTV");
+            if (index >= replayed.size())
+                snapshot.fail("Content file index out of range");
+
+            snapshot.getSubNameIs("DATA");
+            snapshot.getSubHeader();
+
+            std::vector<LoadBatch::Entry> &entries = replayed[index];
+            entries.resize(snapshot.getSubSize() / sizeof(uint64_t));
+
+            for (std::vector<LoadBatch::Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
             {
-                // ignore project file only records
-                esm.skipRecord();
-            }
-            else {
-                std::stringstream error;
-                error << "Unknown record: " << n.toString();
-                throw std::runtime_error(error.str());
+                uint64_t offset;
+                snapshot.getT(offset);
+                it->mOffset = static_cast<size_t>(offset);
+                it->mName.val = 0;
+                it->mStore = 0;
+                it->mRecord = 0;
             }
-        } else {
-            RecordId id = it->second->load(esm);
-            if (id.mIsDeleted)
+        }
+        else if (n == "IDLS")
+        {
+            mIds.clear();
+            while (snapshot.hasMoreSubs())
             {
-                it->second->eraseStatic(id.mId);
-                continue;
+                std::string id = snapshot.getHNString("NAME");
+                snapshot.getHNT(mIds[id], "INTV");
             }
+        }
+        else
+            loadRecord(snapshot, n, dialogue);
+
+        listener->setProgress(static_cast<size_t>(snapshot.getFileOffset() / (float)snapshot.getFileSize() * 1000));
+    }
+
+    for (size_t i = 0; i < readers.size(); ++i)
+    {
+        LoadBatch batch;
+        batch.mEntries.swap(replayed[i]);
+        merge(*readers[i], batch, listener);
+    }
+
+    return true;
+}
+
+void ESMStore::resolveMasters(ESM::ESMReader &esm)
+{
+    // Land texture loading needs to use a separate internal store for each plugin.
+    // We set the number of plugins here to avoid continual resizes during loading,
+    // and so we can properly verify if valid plugin indices are being passed to the
+    // LandTexture Store retrieval methods.
+    mLandTextures.resize(esm.getGlobalReaderList()->size()); // FIXME: size should be for MW only
+
+    // FIXME: for TES4/TES5 whether a dependent file is loaded is already checked in
+    // ESM4::Reader::updateModIndicies() which is called in EsmLoader::load() before this
 
-            if (n.val==ESM::REC_DIAL) {
-                dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
-            } else {
-                dialogue = 0;
+    /// \todo Move this to somewhere else. ESMReader?
+    // Cache parent esX files by tracking their indices in the global list of
+    //  all files/readers used by the engine. This will greaty accelerate
+    //  refnumber mangling, as required for handling moved references.
+    const std::vector<ESM::Header::MasterData> &masters = esm.getGameFiles();
+    std::vector<ESM::ESMReader*> *allPlugins = esm.getGlobalReaderList();
+    for (size_t j = 0; j < masters.size(); j++) {
+        ESM::Header::MasterData &mast = const_cast<ESM::Header::MasterData&>(masters[j]);
+        std::string fname = mast.name;
+        int index = ~0;
+        for (int i = 0; i < esm.getIndex(); i++) {
+            const std::string &candidate = allPlugins->at(i)->getContext().filename;
+            std::string fnamecandidate = boost::filesystem::path(candidate).filename().string();
+            if (Misc::StringUtils::ciEqual(fname, fnamecandidate)) {
+                index = i;
+                break;
             }
-            // Insert the reference into the global lookup
-            if (!id.mId.empty() && isCacheableRecord(n.val)) {
-                mIds[Misc::StringUtils::lowerCase (id.mId)] = n.val;
+        }
+        if (index == (int)~0) {
+            // Tried to load a parent file that has not been loaded yet. This is bad,
+            //  the launcher should have taken care of this.
+            std::string fstring = "File " + esm.getName() + " asks for parent file " + masters[j].name
+                + ", but it has not been loaded yet. Please check your load order.";
+            esm.fail(fstring);
+        }
+        mast.index = index;
+    }
+}
+
+void ESMStore::loadRecord(ESM::ESMReader &esm, ESM::NAME n, ESM::Dialogue*& dialogue)
+{
+    // Look up the record type.
+    std::map<int, StoreBase *>::iterator it = mStores.find(n.val);
+
+    if (it == mStores.end()) {
+        if (n.val == ESM::REC_INFO) {
+            if (dialogue)
+            {
+                dialogue->readInfo(esm, esm.getIndex() != 0);
+            }
+            else
+            {
+                std::cerr << "error: info record without dialog" << std::endl;
+                esm.skipRecord();
             }
+        } else if (n.val == ESM::REC_MGEF) {
+            mMagicEffects.load (esm);
+        } else if (n.val == ESM::REC_SKIL) {
+            mSkills.load (esm);
         }
-        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+        else if (n.val==ESM::REC_FILT || n.val == ESM::REC_DBGP)
+        {
+            // ignore project file only records
+            esm.skipRecord();
+        }
+        else {
+            std::stringstream error;
+            error << "Unknown record: " << n.toString();
+            throw std::runtime_error(error.str());
+        }
+    } else {
+        addRecordId(*it->second, n, it->second->load(esm), dialogue);
+    }
+}
+
+void ESMStore::addRecordId(StoreBase& store, ESM::NAME n, const RecordId& id, ESM::Dialogue*& dialogue)
+{
+    if (id.mIsDeleted)
+    {
+        store.eraseStatic(id.mId);
+        return;
+    }
+
+    if (n.val==ESM::REC_DIAL) {
+        dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
+    } else {
+        dialogue = 0;
+    }
+    // Insert the reference into the global lookup
+    if (!id.mId.empty() && isCacheableRecord(n.val)) {
+        mIds[Misc::StringUtils::lowerCase (id.mId)] = n.val;
     }
 }
 
@@ -268,16 +553,16 @@ void ESMStore::loadTes4Record (ESM::ESMReader& esm)
     ESM4::Reader& reader = static_cast<ESM::ESM4Reader*>(&esm)->reader();
     const ESM4::RecordHeader& hdr = reader.hdr();
 
-    switch (hdr.record.typeId)
+    // Only the location of base records is noted here, see Tes4Records
+    if (reader.grp().type == ESM4::Grp_RecordType &&
+        hdr.record.typeId != ESM4::REC_CELL && hdr.record.typeId != ESM4::REC_WRLD)
     {
-
-        // FIXME: removed for now
-
-        default:
-            reader.skipRecordData();
+        ESM4::FormId formId = hdr.record.id;
+        reader.adjustFormId(formId);
+        mTes4Records.add(static_cast<ESM::ESM4Reader&>(esm), formId);
     }
 
-    return;
+    reader.skipRecordData();
 }
 
 void ESMStore::setUp()
@@ -290,8 +575,37 @@ void ESMStore::setUp()
     mMagicEffects.setUp();
     mAttributes.setUp();
     mDialogs.setUp();
+
+    // Looking up the cached settings does not count as a lookup by name
+    LookupLog *log = mGameSettings.mLookupLog;
+    mGameSettings.setLookupLog(0);
+    mGameSettingCache.setUp(mGameSettings);
+    mGameSettings.setLookupLog(log);
 }
 
+    void ESMStore::setCountGameSettingLookups(bool count)
+    {
+        mGameSettings.setLookupLog(count ? &mGameSettingLookups : 0);
+    }
+
+    void ESMStore::reportGameSettingLookups(std::ostream &stream) const
+    {
+        std::map<std::string, int> counts;
+
+        {
+            boost::mutex::scoped_lock lock(mGameSettingLookups.mMutex);
+            counts.swap(mGameSettingLookups.mCounts);
+        }
+
+        if (counts.empty())
+            return;
+
+        stream << "Game settings looked up by name:";
+        for (std::map<std::string, int>::const_iterator it = counts.begin(); it != counts.end(); ++it)
+            stream << " " << it->first << " (" << it->second << ")";
+        stream << std::endl;
+    }
+
     int ESMStore::countSavedGameRecords() const
     {
         return 1 // DYNA (dynamic name counter)
@@ -1,10 +1,13 @@
 #ifndef OPENMW_MWWORLD_ESMSTORE_H
 #define OPENMW_MWWORLD_ESMSTORE_H
 
+#include <ostream>
 #include <stdexcept>
 
 #include <components/esm/records.hpp>
+#include "gamesettingcache.hpp"
 #include "store.hpp"
+#include "tes4records.hpp"
 
 namespace ESM4
 {
@@ -19,6 +22,32 @@ namespace Loading
 
 namespace MWWorld
 {
+    /// Records of one content file read by ESMStore::parse, in file order
+    class LoadBatch
+    {
+            struct Entry
+            {
+                size_t mOffset; // of the record name
+                ESM::NAME mName;
+                StoreBase *mStore;
+                LoadedRecord *mRecord; // 0 if the record has to be loaded during the merge
+            };
+
+            std::vector<Entry> mEntries;
+
+            LoadBatch (const LoadBatch&);
+            LoadBatch& operator= (const LoadBatch&);
+
+            friend class ESMStore;
+
+        public:
+
+            LoadBatch() {}
+            ~LoadBatch();
+
+            size_t getSize() const { return mEntries.size(); }
+    };
+
     class ESMStore
     {
         Store<ESM::Activator>       mActivators;
@@ -70,6 +99,9 @@ namespace MWWorld
         // Special entry which is hardcoded and not loaded from an ESM
         Store<ESM::Attribute>   mAttributes;
 
+        // Base records of TES4 content files, read when first used
+        Tes4Records mTes4Records;
+
         // Lookup of all IDs. Makes looking up references faster. Just
         // maps the id name to the record type.
         std::map<std::string, int> mIds;
@@ -79,9 +111,25 @@ namespace MWWorld
 
         unsigned int mDynamicCount;
 
+        GameSettingCache mGameSettingCache;
+        mutable LookupLog mGameSettingLookups;
+
         void loadTes4Group (ESM::ESMReader& esm);
         void loadTes4Record (ESM::ESMReader& esm);
 
+        void resolveMasters (ESM::ESMReader& esm);
+
+        /// Load a TES3 record whose header has just been read
+        void loadRecord (ESM::ESMReader& esm, ESM::NAME name, ESM::Dialogue*& dialogue);
+
+        void addRecordId (StoreBase& store, ESM::NAME name, const RecordId& id, ESM::Dialogue*& dialogue);
+
+        bool isValidSnapshot (ESM::ESMReader& snapshot, const std::string& key,
+            const std::vector<ESM::ESMReader *>& readers) const;
+        ///< Check the layout of a snapshot without loading it: the key, that every record and
+        /// sub-record fits, that all record types are known, that the replay offsets are inside
+        /// their content files and that the end marker is there.
+
     public:
         /// \todo replace with SharedIterator<StoreBase>
         typedef std::map<int, StoreBase *>::const_iterator iterator;
@@ -94,6 +142,10 @@ namespace MWWorld
             return mStores.end();
         }
 
+        const Tes4Records& getTes4Records() const {
+            return mTes4Records;
+        }
+
         /// Look up the given ID in 'all'. Returns 0 if not found.
         /// \note id must be in lower case.
         int find(const std::string &id) const
@@ -106,7 +158,7 @@ namespace MWWorld
         }
 
         ESMStore()
-          : mDynamicCount(0)
+          : mDynamicCount(0), mGameSettingCache()
         {
             mStores[ESM::REC_ACTI] = &mActivators;
             mStores[ESM::REC_ALCH] = &mPotions;
@@ -168,6 +220,29 @@ namespace MWWorld
 
         void load(ESM::ESMReader &esm, Loading::Listener* listener);
 
+        void parse(ESM::ESMReader &esm, LoadBatch &batch) const;
+        ///< Read the records of a TES3 content file that do not depend on records of other files,
+        /// without changing the store. Can be called for several files at once from different
+        /// threads, as long as each file has its own reader and encoder.
+
+        void merge(ESM::ESMReader &esm, LoadBatch &batch, Loading::Listener* listener);
+        ///< Add the records of \a esm read by parse() and load the remaining ones, with the same
+        /// result as load(). Has to be called in load order.
+
+        void writeSnapshot(ESM::ESMWriter &writer, const std::string &key,
+            const std::vector<const LoadBatch *> &batches) const;
+        ///< Write the records loaded by merge() so that loadSnapshot() can restore them without
+        /// reading the content files again. Has to be called before setUp().
+        ///
+        /// Cells, lands, land textures and pathgrids refer back to their content file, so only
+        /// their offsets are written, taken from the \a batches of the content files in load order.
+
+        bool loadSnapshot(ESM::ESMReader &snapshot, const std::string &key,
+            const std::vector<ESM::ESMReader *> &readers, Loading::Listener* listener);
+        ///< Load a snapshot instead of the content files opened by \a readers (in load order).
+        /// \return false, without changing the store, if it was written for a different \a key
+        /// or is damaged.
+
         template <class T>
         const Store<T> &get() const {
             throw std::runtime_error("Storage for this type not exist");
@@ -238,6 +313,18 @@ namespace MWWorld
         //  from the outside, so it must be public.
         void setUp();
 
+        const GameSettingCache &getGameSettingCache() const
+        {
+            return mGameSettingCache;
+        }
+
+        void setCountGameSettingLookups(bool count);
+        ///< Count the game settings looked up by name instead of through the GameSettingCache.
+
+        void reportGameSettingLookups(std::ostream &stream) const;
+        ///< Write the game settings looked up by name since the last report to \a stream, if there
+        /// were any.
+
         int countSavedGameRecords() const;
 
         void write (ESM::ESMWriter& writer, Loading::Listener& progress) const;
@@ -0,0 +1,195 @@
+#include "gamesettingcache.hpp"
+
+#include <string>
+
+#include <components/esm/loadgmst.hpp>
+
+#include "store.hpp"
+
+namespace
+{
+    float getFloat (const MWWorld::Store<ESM::GameSetting>& store, const std::string& name)
+    {
+        const ESM::GameSetting *setting = store.search (name);
+        return setting ? setting->getFloat() : 0;
+    }
+
+    int getInt (const MWWorld::Store<ESM::GameSetting>& store, const std::string& name)
+    {
+        const ESM::GameSetting *setting = store.search (name);
+        return setting ? setting->getInt() : 0;
+    }
+}
+
+namespace MWWorld
+{
+    void GameSettingCache::setUp (const Store<ESM::GameSetting>& store)
+    {
+        // Actor movement
+        fMinWalkSpeed = getFloat (store, "fMinWalkSpeed");
+        fMaxWalkSpeed = getFloat (store, "fMaxWalkSpeed");
+        fMinWalkSpeedCreature = getFloat (store, "fMinWalkSpeedCreature");
+        fMaxWalkSpeedCreature = getFloat (store, "fMaxWalkSpeedCreature");
+        fEncumberedMoveEffect = getFloat (store, "fEncumberedMoveEffect");
+        fSneakSpeedMultiplier = getFloat (store, "fSneakSpeedMultiplier");
+        fAthleticsRunBonus = getFloat (store, "fAthleticsRunBonus");
+        fBaseRunMultiplier = getFloat (store, "fBaseRunMultiplier");
+        fMinFlySpeed = getFloat (store, "fMinFlySpeed");
+        fMaxFlySpeed = getFloat (store, "fMaxFlySpeed");
+        fSwimRunBase = getFloat (store, "fSwimRunBase");
+        fSwimRunAthleticsMult = getFloat (store, "fSwimRunAthleticsMult");
+        fSwimHeightScale = getFloat (store, "fSwimHeightScale");
+        fStromWalkMult = getFloat (store, "fStromWalkMult");
+        fWereWolfRunMult = getFloat (store, "fWereWolfRunMult");
+        fJumpEncumbranceBase = getFloat (store, "fJumpEncumbranceBase");
+        fJumpEncumbranceMultiplier = getFloat (store, "fJumpEncumbranceMultiplier");
+        fJumpAcrobaticsBase = getFloat (store, "fJumpAcrobaticsBase");
+        fJumpAcroMultiplier = getFloat (store, "fJumpAcroMultiplier");
+        fJumpRunMultiplier = getFloat (store, "fJumpRunMultiplier");
+        fJumpMoveBase = getFloat (store, "fJumpMoveBase");
+        fJumpMoveMult = getFloat (store, "fJumpMoveMult");
+        fEncumbranceStrMult = getFloat (store, "fEncumbranceStrMult");
+        fFallDamageDistanceMin = getFloat (store, "fFallDamageDistanceMin");
+        fFallAcroBase = getFloat (store, "fFallAcroBase");
+        fFallAcroMult = getFloat (store, "fFallAcroMult");
+        fFallDistanceBase = getFloat (store, "fFallDistanceBase");
+        fFallDistanceMult = getFloat (store, "fFallDistanceMult");
+
+        // Fatigue
+        fFatigueBase = getFloat (store, "fFatigueBase");
+        fFatigueMult = getFloat (store, "fFatigueMult");
+        fFatigueReturnBase = getFloat (store, "fFatigueReturnBase");
+        fFatigueReturnMult = getFloat (store, "fFatigueReturnMult");
+        fEndFatigueMult = getFloat (store, "fEndFatigueMult");
+        fFatigueRunBase = getFloat (store, "fFatigueRunBase");
+        fFatigueRunMult = getFloat (store, "fFatigueRunMult");
+        fFatigueSwimWalkBase = getFloat (store, "fFatigueSwimWalkBase");
+        fFatigueSwimRunBase = getFloat (store, "fFatigueSwimRunBase");
+        fFatigueSwimWalkMult = getFloat (store, "fFatigueSwimWalkMult");
+        fFatigueSwimRunMult = getFloat (store, "fFatigueSwimRunMult");
+        fFatigueSneakBase = getFloat (store, "fFatigueSneakBase");
+        fFatigueSneakMult = getFloat (store, "fFatigueSneakMult");
+        fFatigueJumpBase = getFloat (store, "fFatigueJumpBase");
+        fFatigueJumpMult = getFloat (store, "fFatigueJumpMult");
+        fFatigueAttackBase = getFloat (store, "fFatigueAttackBase");
+        fFatigueAttackMult = getFloat (store, "fFatigueAttackMult");
+        fWeaponFatigueMult = getFloat (store, "fWeaponFatigueMult");
+        fFatigueBlockBase = getFloat (store, "fFatigueBlockBase");
+        fFatigueBlockMult = getFloat (store, "fFatigueBlockMult");
+        fWeaponFatigueBlockMult = getFloat (store, "fWeaponFatigueBlockMult");
+        fFatigueSpellBase = getFloat (store, "fFatigueSpellBase");
+        fFatigueSpellMult = getFloat (store, "fFatigueSpellMult");
+
+        // Combat
+        fCombatDistance = getFloat (store, "fCombatDistance");
+        fHandToHandReach = getFloat (store, "fHandToHandReach");
+        fCombatAngleXY = getFloat (store, "fCombatAngleXY");
+        fCombatAngleZ = getFloat (store, "fCombatAngleZ");
+        fCombatBlockLeftAngle = getFloat (store, "fCombatBlockLeftAngle");
+        fCombatBlockRightAngle = getFloat (store, "fCombatBlockRightAngle");
+        fSwingBlockMult = getFloat (store, "fSwingBlockMult");
+        fSwingBlockBase = getFloat (store, "fSwingBlockBase");
+        fBlockStillBonus = getFloat (store, "fBlockStillBonus");
+        iBlockMaxChance = getInt (store, "iBlockMaxChance");
+        iBlockMinChance = getInt (store, "iBlockMinChance");
+        fCombatInvisoMult = getFloat (store, "fCombatInvisoMult");
+        fCombatCriticalStrikeMult = getFloat (store, "fCombatCriticalStrikeMult");
+        fCombatKODamageMult = getFloat (store, "fCombatKODamageMult");
+        fKnockDownMult = getFloat (store, "fKnockDownMult");
+        iKnockDownOddsMult = getInt (store, "iKnockDownOddsMult");
+        iKnockDownOddsBase = getInt (store, "iKnockDownOddsBase");
+        fCombatArmorMinMult = getFloat (store, "fCombatArmorMinMult");
+        fUnarmoredBase1 = getFloat (store, "fUnarmoredBase1");
+        fUnarmoredBase2 = getFloat (store, "fUnarmoredBase2");
+        fDamageStrengthBase = getFloat (store, "fDamageStrengthBase");
+        fDamageStrengthMult = getFloat (store, "fDamageStrengthMult");
+        fWeaponDamageMult = getFloat (store, "fWeaponDamageMult");
+        fMinHandToHandMult = getFloat (store, "fMinHandToHandMult");
+        fMaxHandToHandMult = getFloat (store, "fMaxHandToHandMult");
+        fHandtoHandHealthPer = getFloat (store, "fHandtoHandHealthPer");
+        fElementalShieldMult = getFloat (store, "fElementalShieldMult");
+        fWereWolfSilverWeaponDamageMult = getFloat (store, "fWereWolfSilverWeaponDamageMult");
+        fProjectileThrownStoreChance = getFloat (store, "fProjectileThrownStoreChance");
+        fThrownWeaponMinSpeed = getFloat (store, "fThrownWeaponMinSpeed");
+        fThrownWeaponMaxSpeed = getFloat (store, "fThrownWeaponMaxSpeed");
+        fProjectileMinSpeed = getFloat (store, "fProjectileMinSpeed");
+        fProjectileMaxSpeed = getFloat (store, "fProjectileMaxSpeed");
+        fTargetSpellMaxSpeed = getFloat (store, "fTargetSpellMaxSpeed");
+        fDifficultyMult = getFloat (store, "fDifficultyMult");
+        iVoiceAttackOdds = getInt (store, "iVoiceAttackOdds");
+        iVoiceHitOdds = getInt (store, "iVoiceHitOdds");
+
+        // AI, awareness and disposition
+        iFightDistanceBase = getInt (store, "iFightDistanceBase");
+        fFightDistanceMultiplier = getFloat (store, "fFightDistanceMultiplier");
+        fFightDispMult = getFloat (store, "fFightDispMult");
+        fMaxHeadTrackDistance = getFloat (store, "fMaxHeadTrackDistance");
+        fInteriorHeadTrackMult = getFloat (store, "fInteriorHeadTrackMult");
+        fVoiceIdleOdds = getFloat (store, "fVoiceIdleOdds");
+        iGreetDistanceMultiplier = getInt (store, "iGreetDistanceMultiplier");
+        fIdleChanceMultiplier = getFloat (store, "fIdleChanceMultiplier");
+        fSneakSkillMult = getFloat (store, "fSneakSkillMult");
+        fSneakBootMult = getFloat (store, "fSneakBootMult");
+        fSneakDistanceBase = getFloat (store, "fSneakDistanceBase");
+        fSneakDistanceMultiplier = getFloat (store, "fSneakDistanceMultiplier");
+        fSneakNoViewMult = getFloat (store, "fSneakNoViewMult");
+        fSneakViewMult = getFloat (store, "fSneakViewMult");
+        fSneakUseDist = getInt (store, "fSneakUseDist");
+        fSneakUseDelay = getFloat (store, "fSneakUseDelay");
+        fAlarmRadius = getFloat (store, "fAlarmRadius");
+        iCrimeThreshold = getInt (store, "iCrimeThreshold");
+        iCrimeThresholdMultiplier = getInt (store, "iCrimeThresholdMultiplier");
+        fDispRaceMod = getFloat (store, "fDispRaceMod");
+        fDispPersonalityMult = getFloat (store, "fDispPersonalityMult");
+        fDispPersonalityBase = getFloat (store, "fDispPersonalityBase");
+        fDispFactionRankMult = getFloat (store, "fDispFactionRankMult");
+        fDispFactionRankBase = getFloat (store, "fDispFactionRankBase");
+        fDispFactionMod = getFloat (store, "fDispFactionMod");
+        fDispCrimeMod = getFloat (store, "fDispCrimeMod");
+        fDispDiseaseMod = getFloat (store, "fDispDiseaseMod");
+        fDispWeaponDrawn = getFloat (store, "fDispWeaponDrawn");
+
+        // Magic
+        fRestMagicMult = getFloat (store, "fRestMagicMult");
+        fSoulgemMult = getFloat (store, "fSoulgemMult");
+        fPCbaseMagickaMult = getFloat (store, "fPCbaseMagickaMult");
+        fNPCbaseMagickaMult = getFloat (store, "fNPCbaseMagickaMult");
+        fMagicSunBlockedMult = getFloat (store, "fMagicSunBlockedMult");
+        fSuffocationDamage = getFloat (store, "fSuffocationDamage");
+        fHoldBreathTime = getFloat (store, "fHoldBreathTime");
+        fEffectCostMult = getFloat (store, "fEffectCostMult");
+        fMagicItemRechargePerSecond = getFloat (store, "fMagicItemRechargePerSecond");
+        fMagicStartIconBlink = getFloat (store, "fMagicStartIconBlink");
+
+        // Spells and reputation of new characters
+        fAutoPCSpellChance = getFloat (store, "fAutoPCSpellChance");
+        iAutoPCSpellMax = getInt (store, "iAutoPCSpellMax");
+        fAutoSpellChance = getFloat (store, "fAutoSpellChance");
+        iAutoSpellTimesCanCast = getInt (store, "iAutoSpellTimesCanCast");
+        iAutoSpellAttSkillMin = getInt (store, "iAutoSpellAttSkillMin");
+        iAutoRepFacMod = getInt (store, "iAutoRepFacMod");
+        iAutoRepLevMod = getInt (store, "iAutoRepLevMod");
+
+        // Sound
+        fAudioDefaultMinDistance = getFloat (store, "fAudioDefaultMinDistance");
+        fAudioDefaultMaxDistance = getFloat (store, "fAudioDefaultMaxDistance");
+        fAudioVoiceDefaultMinDistance = getFloat (store, "fAudioVoiceDefaultMinDistance");
+        fAudioVoiceDefaultMaxDistance = getFloat (store, "fAudioVoiceDefaultMaxDistance");
+        fAudioMinDistanceMult = getFloat (store, "fAudioMinDistanceMult");
+        fAudioMaxDistanceMult = getFloat (store, "fAudioMaxDistanceMult");
+
+        // Other
+        fWortChanceValue = getFloat (store, "fWortChanceValue");
+        iMonthsToRespawn = getInt (store, "iMonthsToRespawn");
+        fNPCHealthBarFade = getFloat (store, "fNPCHealthBarFade");
+        fVanityDelay = getFloat (store, "fVanityDelay");
+        i1stPersonSneakDelta = getFloat (store, "i1stPersonSneakDelta");
+
+        static const char *schools[] = {
+            "Alteration", "Conjuration", "Destruction", "Illusion", "Mysticism", "Restoration"
+        };
+
+        for (int i=0; i<6; ++i)
+            iAutoSpellSchoolMax[i] = getInt (store, std::string ("iAutoSpell") + schools[i] + "Max");
+    }
+}
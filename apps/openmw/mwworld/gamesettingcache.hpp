@@ -0,0 +1,188 @@
+#ifndef GAME_MWWORLD_GAMESETTINGCACHE_H
+#define GAME_MWWORLD_GAMESETTINGCACHE_H
+
+namespace ESM
+{
+    struct GameSetting;
+}
+
+namespace MWWorld
+{
+    template <class T>
+    class Store;
+
+    /// \brief Values of the game settings (GMSTs) used by code that runs often
+    ///
+    /// The settings are looked up once, when the store is set up, instead of by name (which
+    /// means lowercasing and searching the store) on every use. Each member is named after its
+    /// setting and has the type the code reads it as. Settings that are missing from the
+    /// content files are 0.
+    struct GameSettingCache
+    {
+        // Actor movement
+        float fMinWalkSpeed;
+        float fMaxWalkSpeed;
+        float fMinWalkSpeedCreature;
+        float fMaxWalkSpeedCreature;
+        float fEncumberedMoveEffect;
+        float fSneakSpeedMultiplier;
+        float fAthleticsRunBonus;
+        float fBaseRunMultiplier;
+        float fMinFlySpeed;
+        float fMaxFlySpeed;
+        float fSwimRunBase;
+        float fSwimRunAthleticsMult;
+        float fSwimHeightScale;
+        float fStromWalkMult;
+        float fWereWolfRunMult;
+        float fJumpEncumbranceBase;
+        float fJumpEncumbranceMultiplier;
+        float fJumpAcrobaticsBase;
+        float fJumpAcroMultiplier;
+        float fJumpRunMultiplier;
+        float fJumpMoveBase;
+        float fJumpMoveMult;
+        float fEncumbranceStrMult;
+        float fFallDamageDistanceMin;
+        float fFallAcroBase;
+        float fFallAcroMult;
+        float fFallDistanceBase;
+        float fFallDistanceMult;
+
+        // Fatigue
+        float fFatigueBase;
+        float fFatigueMult;
+        float fFatigueReturnBase;
+        float fFatigueReturnMult;
+        float fEndFatigueMult;
+        float fFatigueRunBase;
+        float fFatigueRunMult;
+        float fFatigueSwimWalkBase;
+        float fFatigueSwimRunBase;
+        float fFatigueSwimWalkMult;
+        float fFatigueSwimRunMult;
+        float fFatigueSneakBase;
+        float fFatigueSneakMult;
+        float fFatigueJumpBase;
+        float fFatigueJumpMult;
+        float fFatigueAttackBase;
+        float fFatigueAttackMult;
+        float fWeaponFatigueMult;
+        float fFatigueBlockBase;
+        float fFatigueBlockMult;
+        float fWeaponFatigueBlockMult;
+        float fFatigueSpellBase;
+        float fFatigueSpellMult;
+
+        // Combat
+        float fCombatDistance;
+        float fHandToHandReach;
+        float fCombatAngleXY;
+        float fCombatAngleZ;
+        float fCombatBlockLeftAngle;
+        float fCombatBlockRightAngle;
+        float fSwingBlockMult;
+        float fSwingBlockBase;
+        float fBlockStillBonus;
+        int iBlockMaxChance;
+        int iBlockMinChance;
+        float fCombatInvisoMult;
+        float fCombatCriticalStrikeMult;
+        float fCombatKODamageMult;
+        float fKnockDownMult;
+        int iKnockDownOddsMult;
+        int iKnockDownOddsBase;
+        float fCombatArmorMinMult;
+        float fUnarmoredBase1;
+        float fUnarmoredBase2;
+        float fDamageStrengthBase;
+        float fDamageStrengthMult;
+        float fWeaponDamageMult;
+        float fMinHandToHandMult;
+        float fMaxHandToHandMult;
+        float fHandtoHandHealthPer;
+        float fElementalShieldMult;
+        float fWereWolfSilverWeaponDamageMult;
+        float fProjectileThrownStoreChance;
+        float fThrownWeaponMinSpeed;
+        float fThrownWeaponMaxSpeed;
+        float fProjectileMinSpeed;
+        float fProjectileMaxSpeed;
+        float fTargetSpellMaxSpeed;
+        float fDifficultyMult;
+        int iVoiceAttackOdds;
+        int iVoiceHitOdds;
+
+        // AI, awareness and disposition
+        int iFightDistanceBase;
+        float fFightDistanceMultiplier;
+        float fFightDispMult;
+        float fMaxHeadTrackDistance;
+        float fInteriorHeadTrackMult;
+        float fVoiceIdleOdds;
+        int iGreetDistanceMultiplier;
+        float fIdleChanceMultiplier;
+        float fSneakSkillMult;
+        float fSneakBootMult;
+        float fSneakDistanceBase;
+        float fSneakDistanceMultiplier;
+        float fSneakNoViewMult;
+        float fSneakViewMult;
+        int fSneakUseDist;
+        float fSneakUseDelay;
+        float fAlarmRadius;
+        int iCrimeThreshold;
+        int iCrimeThresholdMultiplier;
+        float fDispRaceMod;
+        float fDispPersonalityMult;
+        float fDispPersonalityBase;
+        float fDispFactionRankMult;
+        float fDispFactionRankBase;
+        float fDispFactionMod;
+        float fDispCrimeMod;
+        float fDispDiseaseMod;
+        float fDispWeaponDrawn;
+
+        // Magic
+        float fRestMagicMult;
+        float fSoulgemMult;
+        float fPCbaseMagickaMult;
+        float fNPCbaseMagickaMult;
+        float fMagicSunBlockedMult;
+        float fSuffocationDamage;
+        float fHoldBreathTime;
+        float fEffectCostMult;
+        float fMagicItemRechargePerSecond;
+        float fMagicStartIconBlink;
+
+        // Spells and reputation of new characters
+        float fAutoPCSpellChance;
+        int iAutoPCSpellMax;
+        float fAutoSpellChance;
+        int iAutoSpellTimesCanCast;
+        int iAutoSpellAttSkillMin;
+        int iAutoSpellSchoolMax[6]; ///< iAutoSpellAlterationMax to iAutoSpellRestorationMax
+        int iAutoRepFacMod;
+        int iAutoRepLevMod;
+
+        // Sound
+        float fAudioDefaultMinDistance;
+        float fAudioDefaultMaxDistance;
+        float fAudioVoiceDefaultMinDistance;
+        float fAudioVoiceDefaultMaxDistance;
+        float fAudioMinDistanceMult;
+        float fAudioMaxDistanceMult;
+
+        // Other
+        float fWortChanceValue;
+        int iMonthsToRespawn;
+        float fNPCHealthBarFade;
+        float fVanityDelay;
+        float i1stPersonSneakDelta;
+
+        void setUp (const Store<ESM::GameSetting>& store);
+        ///< Look up all settings in \a store.
+    };
+}
+
+#endif
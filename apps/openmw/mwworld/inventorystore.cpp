@@ -94,8 +94,11 @@ void MWWorld::InventoryStore::readEquipmentState(const MWWorld::ContainerStoreIt
     }
 }
 
+std::size_t MWWorld::InventoryStore::sMagicEffectsRevision = 0;
+
 MWWorld::InventoryStore::InventoryStore()
- : mListener(NULL)
+ : mMagicEffectsRevision(++sMagicEffectsRevision)
+ , mListener(NULL)
  , mUpdatesEnabled (true)
  , mFirstAutoEquip(true)
  , mSelectedEnchantItem(end())
@@ -107,6 +110,7 @@ MWWorld::InventoryStore::InventoryStore()
 MWWorld::InventoryStore::InventoryStore (const InventoryStore& store)
  : ContainerStore (store)
  , mMagicEffects(store.mMagicEffects)
+ , mMagicEffectsRevision(store.mMagicEffectsRevision)
  , mListener(store.mListener)
  , mUpdatesEnabled(store.mUpdatesEnabled)
  , mFirstAutoEquip(store.mFirstAutoEquip)
@@ -121,6 +125,7 @@ MWWorld::InventoryStore& MWWorld::InventoryStore::operator= (const InventoryStor
 {
     mListener = store.mListener;
     mMagicEffects = store.mMagicEffects;
+    mMagicEffectsRevision = store.mMagicEffectsRevision;
     mFirstAutoEquip = store.mFirstAutoEquip;
     mPermanentMagicEffectMagnitudes = store.mPermanentMagicEffectMagnitudes;
     mRechargingItemsUpToDate = false;
@@ -342,6 +347,7 @@ void MWWorld::InventoryStore::updateMagicEffects(const Ptr& actor)
         return;
 
     mMagicEffects = MWMechanics::MagicEffects();
+    magicEffectsChanged();
 
     for (TSlots::const_iterator iter (mSlots.begin()); iter!=mSlots.end(); ++iter)
     {
@@ -656,8 +662,7 @@ void MWWorld::InventoryStore::rechargeItems(float duration)
                 || it->first->getCellRef().getEnchantmentCharge() == it->second)
             continue;
 
-        static float fMagicItemRechargePerSecond = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find(
-                    "fMagicItemRechargePerSecond")->getFloat();
+        const float fMagicItemRechargePerSecond = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fMagicItemRechargePerSecond;
 
         if (it->first->getCellRef().getEnchantmentCharge() <= it->second)
         {
@@ -671,9 +676,15 @@ void MWWorld::InventoryStore::rechargeItems(float duration)
     }
 }
 
+void MWWorld::InventoryStore::magicEffectsChanged()
+{
+    mMagicEffectsRevision = ++sMagicEffectsRevision;
+}
+
 void MWWorld::InventoryStore::purgeEffect(short effectId)
 {
     mMagicEffects.remove(MWMechanics::EffectKey(effectId));
+    magicEffectsChanged();
 }
 
 void MWWorld::InventoryStore::purgeEffect(short effectId, const std::string &sourceId)
@@ -713,7 +724,10 @@ void MWWorld::InventoryStore::purgeEffect(short effectId, const std::string &sou
                 magnitude *= params[i].mMultiplier;
 
                 if (magnitude)
+                {
                     mMagicEffects.add (*effectIt, -magnitude);
+                    magicEffectsChanged();
+                }
 
                 params[i].mMultiplier = 0;
                 break;
@@ -68,6 +68,9 @@ namespace MWWorld
         private:
 
             MWMechanics::MagicEffects mMagicEffects;
+            std::size_t mMagicEffectsRevision;
+
+            static std::size_t sMagicEffectsRevision; // last one handed out
 
             InventoryStoreListener* mListener;
 
@@ -109,6 +112,9 @@ namespace MWWorld
             void initSlots (TSlots& slots_);
 
             void updateMagicEffects(const Ptr& actor);
+
+            void magicEffectsChanged();
+
             void updateRechargingItems();
 
             void fireEquipmentChangedEvent(const Ptr& actor);
@@ -164,6 +170,10 @@ namespace MWWorld
             const MWMechanics::MagicEffects& getMagicEffects() const;
             ///< Return magic effects from worn items.
 
+            std::size_t getMagicEffectsRevision() const { return mMagicEffectsRevision; }
+            ///< Changes whenever the result of getMagicEffects() changes, and is never the same for
+            /// different effects of any two stores.
+
             virtual void flagAsModified();
             ///< \attention This function is internal to the world model and should not be called from
             /// outside.
@@ -1,5 +1,6 @@
 #include "physicssystem.hpp"
 
+#include <iostream>
 #include <stdexcept>
 
 #include <OgreRoot.h>
@@ -19,6 +20,8 @@
 #include <components/nifbullet/bulletnifloader.hpp>
 #include <components/nifogre/skeleton.hpp>
 #include <components/misc/resourcehelpers.hpp>
+#include <components/misc/workqueue.hpp>
+#include <components/settings/settings.hpp>
 
 #include <components/esm/loadgmst.hpp>
 
@@ -43,12 +46,13 @@ using namespace Ogre;
 namespace
 {
 
-void animateCollisionShapes (std::map<OEngine::Physic::RigidBody*, OEngine::Physic::AnimatedShapeInstance>& map, btDynamicsWorld* dynamicsWorld)
+void animateCollisionShapes (std::map<OEngine::Physic::RigidBody*, OEngine::Physic::AnimatedShapeInstance>& map, btDynamicsWorld* dynamicsWorld,
+                              const MWWorld::PhysicsSystem& physics)
 {
     for (std::map<OEngine::Physic::RigidBody*, OEngine::Physic::AnimatedShapeInstance>::iterator it = map.begin();
          it != map.end(); ++it)
     {
-        MWWorld::Ptr ptr = MWBase::Environment::get().getWorld()->searchPtrViaHandle(it->first->mName);
+        MWWorld::Ptr ptr = physics.getPtr(OEngine::Physic::PhysicEngine::getHandle(it->first));
         if (ptr.isEmpty()) // Shouldn't happen
             throw std::runtime_error("can't find Ptr");
 
@@ -100,6 +104,51 @@ namespace MWWorld
     // Arbitrary number. To prevent infinite loops. They shouldn't happen but it's good to be prepared.
     static const int sMaxIterations = 8;
 
+    /// Movement of one actor in a frame. The input is looked up on the main thread before the
+    /// movement is solved; the result is then applied to the actor, again on the main thread.
+    struct ActorMovement
+    {
+        enum Result
+        {
+            Result_Unmoved, ///< not mobile or not in the scene
+            Result_NoCollision, ///< collision is disabled for the actor
+            Result_Solved
+        };
+
+        Ptr mPtr;
+        Ogre::Vector3 mMovement;
+        OEngine::Physic::PhysicActor *mPhysicActor;
+        bool mIsMobile;
+        bool mIsFlying;
+        bool mIsPureWaterCreature;
+        float mWaterLevel;
+        float mSlowFall;
+
+        Result mResult;
+        Ogre::Vector3 mPosition;
+        const OEngine::Physic::RigidBody *mCollision; ///< last object run into, if any
+        const OEngine::Physic::RigidBody *mStandingOn;
+        bool mWalkingOnWater;
+        bool mOnGround;
+        Ogre::Vector3 mInertia;
+
+        ActorMovement()
+        : mPhysicActor (0), mIsMobile (false), mIsFlying (false), mIsPureWaterCreature (false),
+          mWaterLevel (0), mSlowFall (1), mResult (Result_Unmoved), mCollision (0),
+          mStandingOn (0), mWalkingOnWater (false), mOnGround (false)
+        {}
+    };
+
+    /// Data used by the movement of all actors in a frame
+    struct MovementEnvironment
+    {
+        float mTime;
+        float mSwimHeightScale;
+        bool mInStorm;
+        Ogre::Vector3 mStormDirection;
+        float mStormWalkMult;
+    };
+
     class MovementSolver
     {
     private:
@@ -272,40 +321,46 @@ namespace MWWorld
             }
         }
 
-        static Ogre::Vector3 move(const MWWorld::Ptr &ptr, const Ogre::Vector3 &movement, float time,
-                                  bool isFlying, float waterlevel, float slowFall, OEngine::Physic::PhysicEngine *engine
-                                  , std::map<std::string, std::string>& collisionTracker
-                                  , std::map<std::string, std::string>& standingCollisionTracker)
+        /// Find where \a movement takes its actor. Nothing but the collision world is read,
+        /// and nothing is changed, so the movements of different actors can be solved at the
+        /// same time (see ActorMovement).
+        static void move(ActorMovement &movement, const MovementEnvironment &environment,
+                         OEngine::Physic::PhysicEngine *engine)
         {
-            const ESM::Position &refpos = ptr.getRefData().getPosition();
+            const ESM::Position &refpos = movement.mPtr.getRefData().getPosition();
             Ogre::Vector3 position(refpos.pos);
+            movement.mPosition = position;
 
             // Early-out for totally static creatures
             // (Not sure if gravity should still apply?)
-            if (!ptr.getClass().isMobile(ptr))
-                return position;
+            if (!movement.mIsMobile)
+                return;
 
-            OEngine::Physic::PhysicActor *physicActor = engine->getCharacter(ptr.getRefData().getHandle());
+            const OEngine::Physic::PhysicActor *physicActor = movement.mPhysicActor;
             if (!physicActor)
-                return position;
+                return;
 
-            // Reset per-frame data
-            physicActor->setWalkingOnWater(false);
             // Anything to collide with?
             if(!physicActor->getCollisionMode())
             {
-                return position +  (Ogre::Quaternion(Ogre::Radian(refpos.rot[2]), Ogre::Vector3::NEGATIVE_UNIT_Z) *
+                movement.mResult = ActorMovement::Result_NoCollision;
+                movement.mPosition = position +  (Ogre::Quaternion(Ogre::Radian(refpos.rot[2]), Ogre::Vector3::NEGATIVE_UNIT_Z) *
                                     Ogre::Quaternion(Ogre::Radian(refpos.rot[0]), Ogre::Vector3::NEGATIVE_UNIT_X))
-                                * movement * time;
+                                * movement.mMovement * environment.mTime;
+                return;
             }
 
+            movement.mResult = ActorMovement::Result_Solved;
+
+            const float time = environment.mTime;
+            const bool isFlying = movement.mIsFlying;
+            const float waterlevel = movement.mWaterLevel;
+
             btCollisionObject *colobj = physicActor->getCollisionBody();
             Ogre::Vector3 halfExtents = physicActor->getHalfExtents();
             position.z += halfExtents.z;
 
-            static const float fSwimHeightScale = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                    .find("fSwimHeightScale")->getFloat();
-            float swimlevel = waterlevel + halfExtents.z - (halfExtents.z * 2 * fSwimHeightScale);
+            float swimlevel = waterlevel + halfExtents.z - (halfExtents.z * 2 * environment.mSwimHeightScale);
 
             OEngine::Physic::ActorTracer tracer;
             Ogre::Vector3 inertia = physicActor->getInertialForce();
@@ -314,11 +369,11 @@ namespace MWWorld
             if(position.z < swimlevel || isFlying)
             {
                 velocity = (Ogre::Quaternion(Ogre::Radian(refpos.rot[2]), Ogre::Vector3::NEGATIVE_UNIT_Z)*
-                            Ogre::Quaternion(Ogre::Radian(refpos.rot[0]), Ogre::Vector3::NEGATIVE_UNIT_X)) * movement;
+                            Ogre::Quaternion(Ogre::Radian(refpos.rot[0]), Ogre::Vector3::NEGATIVE_UNIT_X)) * movement.mMovement;
             }
             else
             {
-                velocity = Ogre::Quaternion(Ogre::Radian(refpos.rot[2]), Ogre::Vector3::NEGATIVE_UNIT_Z) * movement;
+                velocity = Ogre::Quaternion(Ogre::Radian(refpos.rot[2]), Ogre::Vector3::NEGATIVE_UNIT_Z) * movement.mMovement;
 
                 if (velocity.z > 0.f)
                     inertia = velocity;
@@ -327,16 +382,12 @@ namespace MWWorld
                     velocity = velocity + physicActor->getInertialForce();
                 }
             }
-            ptr.getClass().getMovementSettings(ptr).mPosition[2] = 0;
 
             // Now that we have the effective movement vector, apply wind forces to it
-            if (MWBase::Environment::get().getWorld()->isInStorm())
+            if (environment.mInStorm)
             {
-                Ogre::Vector3 stormDirection = MWBase::Environment::get().getWorld()->getStormDirection();
-                Ogre::Degree angle = stormDirection.angleBetween(velocity);
-                static const float fStromWalkMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("fStromWalkMult")->getFloat();
-                velocity *= 1.f-(fStromWalkMult * (angle.valueDegrees()/180.f));
+                Ogre::Degree angle = environment.mStormDirection.angleBetween(velocity);
+                velocity *= 1.f-(environment.mStormWalkMult * (angle.valueDegrees()/180.f));
             }
 
             Ogre::Vector3 origVelocity = velocity;
@@ -383,7 +434,7 @@ namespace MWWorld
                         const btCollisionObject* standingOn = tracer.mHitObject;
                         if (const OEngine::Physic::RigidBody* body = dynamic_cast<const OEngine::Physic::RigidBody*>(standingOn))
                         {
-                            collisionTracker[ptr.getRefData().getHandle()] = body->mName;
+                            movement.mCollision = body;
                         }
                     }
                 }
@@ -409,7 +460,7 @@ namespace MWWorld
                 if(result)
                 {
                     // don't let pure water creatures move out of water after stepMove
-                    if (ptr.getClass().isPureWaterCreature(ptr)
+                    if (movement.mIsPureWaterCreature
                             && newPosition.z + halfExtents.z > waterlevel)
                         newPosition = oldPosition;
                 }
@@ -449,10 +500,10 @@ namespace MWWorld
                     const btCollisionObject* standingOn = tracer.mHitObject;
                     if (const OEngine::Physic::RigidBody* body = dynamic_cast<const OEngine::Physic::RigidBody*>(standingOn))
                     {
-                        standingCollisionTracker[ptr.getRefData().getHandle()] = body->mName;
+                        movement.mStandingOn = body;
                     }
                     if (standingOn->getBroadphaseHandle()->m_collisionFilterGroup == OEngine::Physic::CollisionType_Water)
-                        physicActor->setWalkingOnWater(true);
+                        movement.mWalkingOnWater = true;
 
                     if (!isFlying)
                         newPosition.z = tracer.mEndPos.z + 1.0f;
@@ -482,32 +533,66 @@ namespace MWWorld
             }
 
             if(isOnGround || newPosition.z < swimlevel || isFlying)
-                physicActor->setInertialForce(Ogre::Vector3(0.0f));
+                movement.mInertia = Ogre::Vector3(0.0f);
             else
             {
                 inertia.z += time * -627.2f;
                 if (inertia.z < 0)
-                    inertia.z *= slowFall;
-                physicActor->setInertialForce(inertia);
+                    inertia.z *= movement.mSlowFall;
+                movement.mInertia = inertia;
             }
-            physicActor->setOnGround(isOnGround);
+            movement.mOnGround = isOnGround;
 
             newPosition.z -= halfExtents.z; // remove what was added at the beginning
-            return newPosition;
+            movement.mPosition = newPosition;
         }
     };
 
+    /// Solves the movements of consecutive actors on a worker thread
+    class SolveMovements : public Misc::WorkItem
+    {
+            std::vector<ActorMovement>::iterator mBegin;
+            std::vector<ActorMovement>::iterator mEnd;
+            const MovementEnvironment& mEnvironment;
+            OEngine::Physic::PhysicEngine *mEngine;
+
+        protected:
+
+            virtual void doWork()
+            {
+                for (std::vector<ActorMovement>::iterator iter (mBegin); iter!=mEnd; ++iter)
+                    MovementSolver::move (*iter, mEnvironment, mEngine);
+            }
+
+        public:
+
+            SolveMovements (std::vector<ActorMovement>::iterator begin,
+                std::vector<ActorMovement>::iterator end, const MovementEnvironment& environment,
+                OEngine::Physic::PhysicEngine *engine)
+            : mBegin (begin), mEnd (end), mEnvironment (environment), mEngine (engine)
+            {}
+    };
+
 
     PhysicsSystem::PhysicsSystem(OEngine::Render::OgreRenderer &_rend) :
-        mRender(_rend), mEngine(0), mTimeAccum(0.0f), mWaterHeight(0), mWaterEnabled(false)
+        mRender(_rend), mEngine(0), mNameLookups(0), mTimeAccum(0.0f), mWaterHeight(0), mWaterEnabled(false),
+        mParallelMovement(Settings::Manager::getBool("parallel actor movement", "Game"))
     {
         // Create physics. shapeLoader is deleted by the physic engine
         NifBullet::ManualBulletShapeLoader* shapeLoader = new NifBullet::ManualBulletShapeLoader();
         mEngine = new OEngine::Physic::PhysicEngine(shapeLoader);
+
+        // Shapes stay loaded when their cell is unloaded, until this is exceeded
+        OEngine::Physic::BulletShapeManager::getSingleton().setMemoryBudget(64*1024*1024);
     }
 
     PhysicsSystem::~PhysicsSystem()
     {
+        mWorkQueue.reset();
+
+        if (std::size_t lookups = getNameLookupCount())
+            std::cout << "Physics objects looked up by name: " << lookups << std::endl;
+
         if (mWaterCollisionObject.get())
             mEngine->mDynamicsWorld->removeCollisionObject(mWaterCollisionObject.get());
         delete mEngine;
@@ -519,6 +604,51 @@ namespace MWWorld
         return mEngine;
     }
 
+    Ptr PhysicsSystem::getPtr(OEngine::Physic::ObjectHandle handle) const
+    {
+        std::size_t index = OEngine::Physic::getObjectIndex(handle);
+        if (!handle || index >= mPtrs.size() || mPtrs[index].first != handle)
+            return Ptr(); // not an object of the scene, e.g. a height field
+
+        // An object moved to another cell is noted by moveObject, and the Ptr it leaves behind
+        // loses its scene node. Until then, the object has to be looked up by its name.
+        const Ptr& ptr = mPtrs[index].second;
+        if (ptr.getRefData().getBaseNode())
+            return ptr;
+
+        ++mNameLookups;
+        return MWBase::Environment::get().getWorld()->searchPtrViaHandle(mEngine->getName(handle));
+    }
+
+    OEngine::Physic::ObjectHandle PhysicsSystem::getHandle(const Ptr& ptr) const
+    {
+        std::map<Ptr, OEngine::Physic::ObjectHandle>::const_iterator iter = mHandles.find(ptr);
+        if (iter != mHandles.end())
+            return iter->second;
+
+        return mEngine->getHandle(ptr.getRefData().getHandle());
+    }
+
+    std::size_t PhysicsSystem::getNameLookupCount() const
+    {
+        return mEngine->getNameLookupCount() + mNameLookups;
+    }
+
+    void PhysicsSystem::setPtr(OEngine::Physic::ObjectHandle handle, const Ptr& ptr)
+    {
+        if (!handle)
+            return;
+
+        std::size_t index = OEngine::Physic::getObjectIndex(handle);
+        if (index >= mPtrs.size())
+            mPtrs.resize(index+1, std::make_pair(OEngine::Physic::ObjectHandle(0), Ptr()));
+        else if (mPtrs[index].first)
+            mHandles.erase(mPtrs[index].second);
+
+        mPtrs[index] = std::make_pair(handle, ptr);
+        mHandles[ptr] = handle;
+    }
+
     std::pair<float, std::string> PhysicsSystem::getFacedHandle(float queryDistance)
     {
         Ray ray = mRender.getCamera()->getCameraToViewportRay(0.5, 0.5);
@@ -571,16 +701,16 @@ namespace MWWorld
         return results;
     }
 
-    std::pair<std::string,Ogre::Vector3> PhysicsSystem::getHitContact(const std::string &name,
-                                                                      const Ogre::Vector3 &origin,
-                                                                      const Ogre::Quaternion &orient,
-                                                                      float queryDistance)
+    std::pair<Ptr,Ogre::Vector3> PhysicsSystem::getHitContact(const Ptr &ptr,
+                                                              const Ogre::Vector3 &origin,
+                                                              const Ogre::Quaternion &orient,
+                                                              float queryDistance)
     {
-        const MWWorld::Store<ESM::GameSetting> &store = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
+        const MWWorld::GameSettingCache& gmst = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache();
 
-        btConeShape shape(Ogre::Degree(store.find("fCombatAngleXY")->getFloat()/2.0f).valueRadians(),
+        btConeShape shape(Ogre::Degree(gmst.fCombatAngleXY/2.0f).valueRadians(),
                           queryDistance);
-        shape.setLocalScaling(btVector3(1, 1, Ogre::Degree(store.find("fCombatAngleZ")->getFloat()/2.0f).valueRadians() /
+        shape.setLocalScaling(btVector3(1, 1, Ogre::Degree(gmst.fCombatAngleZ/2.0f).valueRadians() /
                                               shape.getRadius()));
 
         // The shape origin is its center, so we have to move it forward by half the length. The
@@ -593,10 +723,11 @@ namespace MWWorld
                                              btVector3(center.x, center.y, center.z)));
 
         std::pair<const OEngine::Physic::RigidBody*,btVector3> result = mEngine->getFilteredContact(
-                name, btVector3(origin.x, origin.y, origin.z), &object);
+                getHandle(ptr), btVector3(origin.x, origin.y, origin.z), &object);
         if(!result.first)
-            return std::make_pair(std::string(), Ogre::Vector3(&result.second[0]));
-        return std::make_pair(result.first->mName, Ogre::Vector3(&result.second[0]));
+            return std::make_pair(Ptr(), Ogre::Vector3(&result.second[0]));
+        return std::make_pair(getPtr(OEngine::Physic::PhysicEngine::getHandle(result.first)),
+                              Ogre::Vector3(&result.second[0]));
     }
 
 
@@ -676,21 +807,40 @@ namespace MWWorld
     {
         Ogre::SceneNode* node = ptr.getRefData().getBaseNode();
         handleToMesh[node->getName()] = mesh;
-        mEngine->createAndAdjustRigidBody(
+        OEngine::Physic::RigidBody* body = mEngine->createAndAdjustRigidBody(
             mesh, node->getName(), ptr.getCellRef().getScale(), node->getPosition(), node->getOrientation(), 0, 0, false, placeable);
-        mEngine->createAndAdjustRigidBody(
+        OEngine::Physic::RigidBody* raycastingBody = mEngine->createAndAdjustRigidBody(
             mesh, node->getName(), ptr.getCellRef().getScale(), node->getPosition(), node->getOrientation(), 0, 0, true, placeable);
+
+        if (body)
+            setPtr(OEngine::Physic::PhysicEngine::getHandle(body), ptr);
+        else if (raycastingBody)
+            setPtr(OEngine::Physic::PhysicEngine::getHandle(raycastingBody), ptr);
     }
 
     void PhysicsSystem::addActor (const Ptr& ptr, const std::string& mesh)
     {
         Ogre::SceneNode* node = ptr.getRefData().getBaseNode();
-        //TODO:optimize this. Searching the std::map isn't very efficient i think.
-        mEngine->addCharacter(node->getName(), mesh, node->getPosition(), node->getScale().x, node->getOrientation());
+        OEngine::Physic::PhysicActor* actor =
+            mEngine->addCharacter(node->getName(), mesh, node->getPosition(), node->getScale().x, node->getOrientation());
+        setPtr(OEngine::Physic::PhysicEngine::getHandle(actor->getCollisionBody()), ptr);
     }
 
-    void PhysicsSystem::removeObject (const std::string& handle)
+    void PhysicsSystem::removeObject (const Ptr& ptr)
     {
+        OEngine::Physic::ObjectHandle object = getHandle(ptr);
+        if (!object)
+            return;
+
+        std::size_t index = OEngine::Physic::getObjectIndex(object);
+        if (index < mPtrs.size() && mPtrs[index].first == object)
+        {
+            mHandles.erase(mPtrs[index].second);
+            mPtrs[index] = std::make_pair(OEngine::Physic::ObjectHandle(0), Ptr());
+        }
+
+        // the scene node may already be gone, but the engine still knows the name
+        std::string handle = mEngine->getName(object);
         mEngine->removeCharacter(handle);
         mEngine->removeRigidBody(handle);
         mEngine->deleteRigidBody(handle);
@@ -699,9 +849,12 @@ namespace MWWorld
     void PhysicsSystem::moveObject (const Ptr& ptr)
     {
         Ogre::SceneNode *node = ptr.getRefData().getBaseNode();
-        const std::string &handle = node->getName();
+        OEngine::Physic::ObjectHandle handle = getHandle(ptr);
         const Ogre::Vector3 &position = node->getPosition();
 
+        // the object may have been moved to another cell
+        setPtr(handle, ptr);
+
         if(OEngine::Physic::RigidBody *body = mEngine->getRigidBody(handle))
         {
             body->getWorldTransform().setOrigin(btVector3(position.x,position.y,position.z));
@@ -722,10 +875,9 @@ namespace MWWorld
     void PhysicsSystem::rotateObject (const Ptr& ptr)
     {
         Ogre::SceneNode* node = ptr.getRefData().getBaseNode();
-        const std::string &handle = node->getName();
+        OEngine::Physic::ObjectHandle handle = getHandle(ptr);
         const Ogre::Quaternion &rotation = node->getOrientation();
 
-        // TODO: map to MWWorld::Ptr for faster access
         if (OEngine::Physic::PhysicActor* act = mEngine->getCharacter(handle))
         {
             act->setRotation(rotation);
@@ -735,7 +887,7 @@ namespace MWWorld
             if(body->getCollisionShape()->getName() != "Box")
                 body->getWorldTransform().setRotation(btQuaternion(rotation.x, rotation.y, rotation.z, rotation.w));
             else
-                mEngine->boxAdjustExternal(handleToMesh[handle], body, node->getScale().x, node->getPosition(), rotation);
+                mEngine->boxAdjustExternal(handleToMesh[node->getName()], body, node->getScale().x, node->getPosition(), rotation);
             mEngine->mDynamicsWorld->updateSingleAabb(body);
         }
         if (OEngine::Physic::RigidBody* body = mEngine->getRigidBody(handle, true))
@@ -743,7 +895,7 @@ namespace MWWorld
             if(body->getCollisionShape()->getName() != "Box")
                 body->getWorldTransform().setRotation(btQuaternion(rotation.x, rotation.y, rotation.z, rotation.w));
             else
-                mEngine->boxAdjustExternal(handleToMesh[handle], body, node->getScale().x, node->getPosition(), rotation);
+                mEngine->boxAdjustExternal(handleToMesh[node->getName()], body, node->getScale().x, node->getPosition(), rotation);
             mEngine->mDynamicsWorld->updateSingleAabb(body);
         }
     }
@@ -757,16 +909,17 @@ namespace MWWorld
             std::string model = ptr.getClass().getModel(ptr);
             model = Misc::ResourceHelpers::correctActorModelPath(model); // FIXME: scaling shouldn't require model
 
+            OEngine::Physic::ObjectHandle object = getHandle(ptr);
             bool placeable = false;
-            if (OEngine::Physic::RigidBody* body = mEngine->getRigidBody(handle,true))
+            if (OEngine::Physic::RigidBody* body = mEngine->getRigidBody(object,true))
                 placeable = body->mPlaceable;
-            else if (OEngine::Physic::RigidBody* body = mEngine->getRigidBody(handle,false))
+            else if (OEngine::Physic::RigidBody* body = mEngine->getRigidBody(object,false))
                 placeable = body->mPlaceable;
-            removeObject(handle);
+            removeObject(ptr);
             addObject(ptr, model, placeable);
         }
 
-        if (OEngine::Physic::PhysicActor* act = mEngine->getCharacter(handle))
+        if (OEngine::Physic::PhysicActor* act = mEngine->getCharacter(getHandle(ptr)))
         {
             float scale = ptr.getCellRef().getScale();
             if (!ptr.getClass().isNpc())
@@ -826,14 +979,13 @@ namespace MWWorld
 
     void PhysicsSystem::queueObjectMovement(const Ptr &ptr, const Ogre::Vector3 &movement)
     {
-        PtrVelocityList::iterator iter = mMovementQueue.begin();
-        for(;iter != mMovementQueue.end();++iter)
+        std::pair<std::map<Ptr, std::size_t>::iterator, bool> inserted =
+            mMovementIndex.insert(std::make_pair(ptr, mMovementQueue.size()));
+
+        if (!inserted.second)
         {
-            if(iter->first == ptr)
-            {
-                iter->second = movement;
-                return;
-            }
+            mMovementQueue[inserted.first->second].second = movement;
+            return;
         }
 
         mMovementQueue.push_back(std::make_pair(ptr, movement));
@@ -842,6 +994,7 @@ namespace MWWorld
     void PhysicsSystem::clearQueuedMovement()
     {
         mMovementQueue.clear();
+        mMovementIndex.clear();
         mCollisions.clear();
         mStandingCollisions.clear();
     }
@@ -858,6 +1011,17 @@ namespace MWWorld
             mStandingCollisions.clear();
 
             const MWBase::World *world = MWBase::Environment::get().getWorld();
+
+            MovementEnvironment environment;
+            environment.mTime = mTimeAccum;
+            environment.mSwimHeightScale = world->getStore().getGameSettingCache().fSwimHeightScale;
+            environment.mInStorm = world->isInStorm();
+            environment.mStormDirection = environment.mInStorm ? world->getStormDirection() : Ogre::Vector3(0.0f);
+            environment.mStormWalkMult = world->getStore().getGameSettingCache().fStromWalkMult;
+
+            std::vector<ActorMovement> movements;
+            movements.reserve(mMovementQueue.size());
+
             PtrVelocityList::iterator iter = mMovementQueue.begin();
             for(;iter != mMovementQueue.end();++iter)
             {
@@ -866,8 +1030,6 @@ namespace MWWorld
                 if(cell->getCell()->hasWater())
                     waterlevel = cell->getWaterLevel();
 
-                float oldHeight = iter->first.getRefData().getPosition().pos[2];
-
                 const MWMechanics::MagicEffects& effects = iter->first.getClass().getCreatureStats(iter->first).getMagicEffects();
 
                 bool waterCollision = false;
@@ -877,37 +1039,99 @@ namespace MWWorld
                                                Ogre::Vector3(iter->first.getRefData().getPosition().pos)))
                     waterCollision = true;
 
-                OEngine::Physic::PhysicActor *physicActor = mEngine->getCharacter(iter->first.getRefData().getHandle());
+                OEngine::Physic::PhysicActor *physicActor = mEngine->getCharacter(getHandle(iter->first));
                 if (!physicActor) // actor was already removed from the scene
                     continue;
                 physicActor->setCanWaterWalk(waterCollision);
 
+                ActorMovement movement;
+                movement.mPtr = iter->first;
+                movement.mMovement = iter->second;
+                movement.mPhysicActor = physicActor;
+                movement.mIsMobile = iter->first.getClass().isMobile(iter->first);
+                movement.mIsFlying = world->isFlying(iter->first);
+                movement.mIsPureWaterCreature = iter->first.getClass().isPureWaterCreature(iter->first);
+                movement.mWaterLevel = waterlevel;
+
                 // Slow fall reduces fall speed by a factor of (effect magnitude / 200)
-                float slowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+                movement.mSlowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
 
-                Ogre::Vector3 newpos = MovementSolver::move(iter->first, iter->second, mTimeAccum,
-                                                            world->isFlying(iter->first),
-                                                            waterlevel, slowFall, mEngine, mCollisions, mStandingCollisions);
+                movements.push_back(movement);
+            }
+
+            // The solver only reads the collision world, which does not change until all
+            // movements have been solved, so they can be solved in any order.
+            if (mParallelMovement && movements.size() > 1)
+            {
+                if (!mWorkQueue)
+                    mWorkQueue.reset(new Misc::WorkQueue);
+
+                // one batch of consecutive actors per worker
+                std::size_t batches = std::min(static_cast<std::size_t>(mWorkQueue->getNumThreads()), movements.size());
+                std::vector<boost::shared_ptr<SolveMovements> > items;
+
+                for (std::size_t i = 0; i<batches; ++i)
+                {
+                    items.push_back(boost::shared_ptr<SolveMovements>(new SolveMovements(
+                        movements.begin() + i*movements.size()/batches,
+                        movements.begin() + (i+1)*movements.size()/batches, environment, mEngine)));
+
+                    mWorkQueue->addWorkItem(items.back());
+                }
+
+                for (std::vector<boost::shared_ptr<SolveMovements> >::iterator item = items.begin();
+                     item != items.end(); ++item)
+                    (*item)->waitTillDone();
+            }
+            else
+            {
+                for (std::vector<ActorMovement>::iterator movement = movements.begin();
+                     movement != movements.end(); ++movement)
+                    MovementSolver::move(*movement, environment, mEngine);
+            }
+
+            // apply the results in the order the movements were queued in
+            for (std::vector<ActorMovement>::const_iterator movement = movements.begin();
+                 movement != movements.end(); ++movement)
+            {
+                const Ptr& ptr = movement->mPtr;
+
+                if (movement->mResult != ActorMovement::Result_Unmoved)
+                    movement->mPhysicActor->setWalkingOnWater(movement->mWalkingOnWater);
+
+                if (movement->mResult == ActorMovement::Result_Solved)
+                {
+                    ptr.getClass().getMovementSettings(ptr).mPosition[2] = 0;
+
+                    if (movement->mCollision)
+                        mCollisions[ptr.getRefData().getHandle()] = movement->mCollision->mName;
+                    if (movement->mStandingOn)
+                        mStandingCollisions[ptr.getRefData().getHandle()] = movement->mStandingOn->mName;
+
+                    movement->mPhysicActor->setInertialForce(movement->mInertia);
+                    movement->mPhysicActor->setOnGround(movement->mOnGround);
+                }
 
-                float heightDiff = newpos.z - oldHeight;
+                float heightDiff = movement->mPosition.z - ptr.getRefData().getPosition().pos[2];
 
                 if (heightDiff < 0)
-                    iter->first.getClass().getCreatureStats(iter->first).addToFallHeight(-heightDiff);
+                    ptr.getClass().getCreatureStats(ptr).addToFallHeight(-heightDiff);
 
-                mMovementResults.push_back(std::make_pair(iter->first, newpos));
+                mMovementResults.push_back(std::make_pair(ptr, movement->mPosition));
             }
 
             mTimeAccum = 0.0f;
         }
         mMovementQueue.clear();
+        mMovementIndex.clear();
 
         return mMovementResults;
     }
 
     void PhysicsSystem::stepSimulation(float dt)
     {
-        animateCollisionShapes(mEngine->mAnimatedShapes, mEngine->mDynamicsWorld);
-        animateCollisionShapes(mEngine->mAnimatedRaycastingShapes, mEngine->mDynamicsWorld);
+        animateCollisionShapes(mEngine->mAnimatedShapes, mEngine->mDynamicsWorld, *this);
+        animateCollisionShapes(mEngine->mAnimatedRaycastingShapes, mEngine->mDynamicsWorld, *this);
 
         mEngine->stepSimulation(dt);
     }
@@ -1,15 +1,27 @@
 #ifndef GAME_MWWORLD_PHYSICSSYSTEM_H
 #define GAME_MWWORLD_PHYSICSSYSTEM_H
 
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
 
 #include <OgreVector3.h>
 
 #include <btBulletCollisionCommon.h>
 
+#include <openengine/bullet/objecthandle.hpp>
+
 #include "ptr.hpp"
 
 
+namespace Misc
+{
+    class WorkQueue;
+}
+
 namespace OEngine
 {
     namespace Render
@@ -48,8 +60,7 @@ namespace MWWorld
 
             void removeHeightField (int x, int y);
 
-            // have to keep this as handle for now as unloadcell only knows scenenode names
-            void removeObject (const std::string& handle);
+            void removeObject (const MWWorld::Ptr& ptr);
 
             void moveObject (const MWWorld::Ptr& ptr);
 
@@ -65,10 +76,10 @@ namespace MWWorld
             Ogre::Vector3 traceDown(const MWWorld::Ptr &ptr, float maxHeight);
 
             std::pair<float, std::string> getFacedHandle(float queryDistance);
-            std::pair<std::string,Ogre::Vector3> getHitContact(const std::string &name,
-                                                               const Ogre::Vector3 &origin,
-                                                               const Ogre::Quaternion &orientation,
-                                                               float queryDistance);
+            std::pair<Ptr,Ogre::Vector3> getHitContact(const Ptr &ptr,
+                                                       const Ogre::Vector3 &origin,
+                                                       const Ogre::Quaternion &orientation,
+                                                       float queryDistance);
             std::vector < std::pair <float, std::string> > getFacedHandles (float queryDistance);
             std::vector < std::pair <float, std::string> > getFacedHandles (float mouseX, float mouseY, float queryDistance);
 
@@ -85,6 +96,16 @@ namespace MWWorld
 
             OEngine::Physic::PhysicEngine* getEngine();
 
+            /// Return the object with \a handle, or an empty Ptr if it is not in the scene.
+            Ptr getPtr(OEngine::Physic::ObjectHandle handle) const;
+
+            /// Return the handle of the physics object of \a ptr, or 0 if it has none.
+            OEngine::Physic::ObjectHandle getHandle(const Ptr& ptr) const;
+
+            /// Number of physics objects looked up by their name so far, by the physics engine
+            /// or because the object of a handle was not known (see getPtr).
+            std::size_t getNameLookupCount() const;
+
             bool getObjectAABB(const MWWorld::Ptr &ptr, Ogre::Vector3 &min, Ogre::Vector3 &max);
 
             /// Queues velocity movement for a Ptr. If a Ptr is already queued, its velocity will
@@ -92,6 +113,9 @@ namespace MWWorld
             void queueObjectMovement(const Ptr &ptr, const Ogre::Vector3 &velocity);
 
             /// Apply all queued movements, then clear the list.
+            ///
+            /// With "parallel actor movement" enabled, the movements are solved on worker threads.
+            /// The results and collisions are the same either way.
             const PtrVelocityList& applyQueuedMovement(float dt);
 
             /// Clear the queued movements list without applying.
@@ -116,10 +140,18 @@ namespace MWWorld
 
             void updateWater();
 
+            /// Note that \a ptr is the object with \a handle.
+            void setPtr(OEngine::Physic::ObjectHandle handle, const Ptr& ptr);
+
             OEngine::Render::OgreRenderer &mRender;
             OEngine::Physic::PhysicEngine* mEngine;
             std::map<std::string, std::string> handleToMesh;
 
+            /// Object handle and Ptr by object index
+            std::vector<std::pair<OEngine::Physic::ObjectHandle, Ptr> > mPtrs;
+            std::map<Ptr, OEngine::Physic::ObjectHandle> mHandles;
+            mutable std::size_t mNameLookups;
+
             // Tracks all movement collisions happening during a single frame. <actor handle, collided handle>
             // This will detect e.g. running against a vertical wall. It will not detect climbing up stairs,
             // stepping up small objects, etc.
@@ -128,6 +160,7 @@ namespace MWWorld
             std::map<std::string, std::string> mStandingCollisions;
 
             PtrVelocityList mMovementQueue;
+            std::map<Ptr, std::size_t> mMovementIndex; ///< position of each actor in mMovementQueue
             PtrVelocityList mMovementResults;
 
             float mTimeAccum;
@@ -135,6 +168,9 @@ namespace MWWorld
             float mWaterHeight;
             float mWaterEnabled;
 
+            bool mParallelMovement;
+            boost::scoped_ptr<Misc::WorkQueue> mWorkQueue; ///< created on first use
+
             std::auto_ptr<btCollisionObject> mWaterCollisionObject;
             std::auto_ptr<btCollisionShape> mWaterCollisionShape;
 
@@ -8,6 +8,7 @@
 #include <components/esm/projectilestate.hpp>
 
 #include "../mwworld/manualref.hpp"
+#include "../mwworld/physicssystem.hpp"
 #include "../mwworld/class.hpp"
 #include "../mwworld/esmstore.hpp"
 #include "../mwworld/inventorystore.hpp"
@@ -29,8 +30,8 @@
 namespace MWWorld
 {
 
-    ProjectileManager::ProjectileManager(Ogre::SceneManager* sceneMgr, OEngine::Physic::PhysicEngine &engine)
-        : mPhysEngine(engine)
+    ProjectileManager::ProjectileManager(Ogre::SceneManager* sceneMgr, PhysicsSystem &physics)
+        : mPhysics(physics)
         , mSceneMgr(sceneMgr)
     {
 
@@ -67,7 +68,7 @@ namespace MWWorld
                                             const Ogre::Vector3& fallbackDirection)
     {
         float height = 0;
-        if (OEngine::Physic::PhysicActor* actor = mPhysEngine.getCharacter(caster.getRefData().getHandle()))
+        if (OEngine::Physic::PhysicActor* actor = mPhysics.getEngine()->getCharacter(mPhysics.getHandle(caster)))
             height = actor->getHalfExtents().z * 2 * 0.75f;         // Spawn at 0.75 * ActorHeight
 
         Ogre::Vector3 pos(caster.getRefData().getPosition().pos);
@@ -145,8 +146,7 @@ namespace MWWorld
         for (std::vector<MagicBoltState>::iterator it = mMagicBolts.begin(); it != mMagicBolts.end();)
         {
             Ogre::Quaternion orient = it->mNode->getOrientation();
-            static float fTargetSpellMaxSpeed = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("fTargetSpellMaxSpeed")->getFloat();
+            const float fTargetSpellMaxSpeed = MWBase::Environment::get().getWorld()->getStore().getGameSettingCache().fTargetSpellMaxSpeed;
             float speed = fTargetSpellMaxSpeed * it->mSpeed;
 
             Ogre::Vector3 direction = orient.yAxis();
@@ -166,12 +166,13 @@ namespace MWWorld
             btVector3 from(pos.x, pos.y, pos.z);
             btVector3 to(newPos.x, newPos.y, newPos.z);
 
-            std::vector<std::pair<float, std::string> > collisions = mPhysEngine.rayTest2(from, to, OEngine::Physic::CollisionType_Projectile);
+            std::vector<std::pair<float, OEngine::Physic::ObjectHandle> > collisions =
+                mPhysics.getEngine()->rayTestHandles(from, to, OEngine::Physic::CollisionType_Projectile);
             bool hit=false;
 
-            for (std::vector<std::pair<float, std::string> >::iterator cIt = collisions.begin(); cIt != collisions.end() && !hit; ++cIt)
+            for (std::vector<std::pair<float, OEngine::Physic::ObjectHandle> >::iterator cIt = collisions.begin(); cIt != collisions.end() && !hit; ++cIt)
             {
-                MWWorld::Ptr obstacle = MWBase::Environment::get().getWorld()->searchPtrViaHandle(cIt->second);
+                MWWorld::Ptr obstacle = mPhysics.getPtr(cIt->second);
 
                 MWWorld::Ptr caster = MWBase::Environment::get().getWorld()->searchPtrViaHandle(it->mCasterHandle);
                 if (caster.isEmpty())
@@ -242,12 +243,13 @@ namespace MWWorld
             // TODO: use a proper btRigidBody / btGhostObject?
             btVector3 from(pos.x, pos.y, pos.z);
             btVector3 to(newPos.x, newPos.y, newPos.z);
-            std::vector<std::pair<float, std::string> > collisions = mPhysEngine.rayTest2(from, to, OEngine::Physic::CollisionType_Projectile);
+            std::vector<std::pair<float, OEngine::Physic::ObjectHandle> > collisions =
+                mPhysics.getEngine()->rayTestHandles(from, to, OEngine::Physic::CollisionType_Projectile);
             bool hit=false;
 
-            for (std::vector<std::pair<float, std::string> >::iterator cIt = collisions.begin(); cIt != collisions.end() && !hit; ++cIt)
+            for (std::vector<std::pair<float, OEngine::Physic::ObjectHandle> >::iterator cIt = collisions.begin(); cIt != collisions.end() && !hit; ++cIt)
             {
-                MWWorld::Ptr obstacle = MWBase::Environment::get().getWorld()->searchPtrViaHandle(cIt->second);
+                MWWorld::Ptr obstacle = mPhysics.getPtr(cIt->second);
 
                 MWWorld::Ptr caster = MWBase::Environment::get().getWorld()->searchPtrViaActorId(it->mActorId);
 
@@ -12,14 +12,6 @@
 
 #include "ptr.hpp"
 
-namespace OEngine
-{
-namespace Physic
-{
-    class PhysicEngine;
-}
-}
-
 namespace Loading
 {
     class Listener;
@@ -32,12 +24,13 @@ namespace Ogre
 
 namespace MWWorld
 {
+    class PhysicsSystem;
 
     class ProjectileManager
     {
     public:
         ProjectileManager (Ogre::SceneManager* sceneMgr,
-                OEngine::Physic::PhysicEngine& engine);
+                PhysicsSystem& physics);
 
         /// If caster is an actor, the actor's facing orientation is used. Otherwise fallbackDirection is used.
         void launchMagicBolt (const std::string& model, const std::string &sound, const std::string &spellId,
@@ -57,7 +50,7 @@ namespace MWWorld
         int countSavedGameRecords() const;
 
     private:
-        OEngine::Physic::PhysicEngine& mPhysEngine;
+        PhysicsSystem& mPhysics;
         Ogre::SceneManager* mSceneMgr;
 
         struct State
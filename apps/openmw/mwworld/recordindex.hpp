@@ -0,0 +1,160 @@
+#ifndef OPENMW_MWWORLD_RECORDINDEX_H
+#define OPENMW_MWWORLD_RECORDINDEX_H
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MWWorld
+{
+    /// Open addressing (linear probing) table from case-folded record IDs to records owned by
+    /// a Store. Lookups hash and compare the ID as given, without making a lower case copy.
+    ///
+    /// \note The records must stay at the same address while they are indexed, which is the
+    /// case for the values of a std::map.
+    template <class T>
+    class RecordIndex
+    {
+        public:
+
+            RecordIndex() : mMask (0), mSize (0) {}
+
+            /// Return the record with an ID equal to \a id except for case, or 0.
+            T *find (const std::string& id) const
+            {
+                if (mSlots.empty())
+                    return 0;
+
+                std::uint64_t hash = hashId (id);
+
+                for (std::size_t i = hash & mMask; mSlots[i].mRecord; i = (i+1) & mMask)
+                    if (mSlots[i].mHash==hash && equal (mSlots[i].mRecord->mId, id))
+                        return mSlots[i].mRecord;
+
+                return 0;
+            }
+
+            /// \a record must not have the ID of a record already in the index.
+            void insert (T *record)
+            {
+                if ((mSize+1)*2 > mSlots.size())
+                    rehash (mSlots.empty() ? 16 : mSlots.size()*2);
+
+                place (hashId (record->mId), record);
+                ++mSize;
+            }
+
+            void erase (const std::string& id)
+            {
+                if (mSlots.empty())
+                    return;
+
+                std::uint64_t hash = hashId (id);
+                std::size_t i = hash & mMask;
+
+                while (mSlots[i].mRecord &&
+                    !(mSlots[i].mHash==hash && equal (mSlots[i].mRecord->mId, id)))
+                    i = (i+1) & mMask;
+
+                if (!mSlots[i].mRecord)
+                    return;
+
+                // Move later entries of the probe sequence back into the gap, so that find()
+                // can still stop at the first empty slot
+                for (std::size_t j = (i+1) & mMask; mSlots[j].mRecord; j = (j+1) & mMask)
+                {
+                    std::size_t home = mSlots[j].mHash & mMask;
+
+                    if (((j-home) & mMask) >= ((j-i) & mMask))
+                    {
+                        mSlots[i] = mSlots[j];
+                        i = j;
+                    }
+                }
+
+                mSlots[i].mRecord = 0;
+                --mSize;
+            }
+
+            void clear()
+            {
+                mSlots.clear();
+                mMask = 0;
+                mSize = 0;
+            }
+
+            std::size_t size() const { return mSize; }
+
+            /// FNV-1a of the lower case ID, mixed so that the low bits can be used directly.
+            static std::uint64_t hashId (const std::string& id)
+            {
+                std::uint64_t hash = 14695981039346656037ULL;
+
+                for (std::string::const_iterator iter (id.begin()); iter!=id.end(); ++iter)
+                {
+                    hash ^= static_cast<unsigned char> (std::tolower (static_cast<unsigned char> (*iter)));
+                    hash *= 1099511628211ULL;
+                }
+
+                hash ^= hash >> 33;
+                hash *= 0xff51afd7ed558ccdULL;
+                hash ^= hash >> 33;
+
+                return hash;
+            }
+
+        private:
+
+            struct Slot
+            {
+                std::uint64_t mHash;
+                T *mRecord;
+            };
+
+            std::vector<Slot> mSlots;
+            std::size_t mMask;
+            std::size_t mSize;
+
+            static bool equal (const std::string& x, const std::string& y)
+            {
+                if (x.size()!=y.size())
+                    return false;
+
+                for (std::size_t i = 0; i<x.size(); ++i)
+                    if (x[i]!=y[i] && std::tolower (static_cast<unsigned char> (x[i]))!=
+                        std::tolower (static_cast<unsigned char> (y[i])))
+                        return false;
+
+                return true;
+            }
+
+            void place (std::uint64_t hash, T *record)
+            {
+                std::size_t i = hash & mMask;
+                while (mSlots[i].mRecord)
+                    i = (i+1) & mMask;
+
+                mSlots[i].mHash = hash;
+                mSlots[i].mRecord = record;
+            }
+
+            void rehash (std::size_t capacity)
+            {
+                Slot empty;
+                empty.mHash = 0;
+                empty.mRecord = 0;
+
+                std::vector<Slot> slots (capacity, empty);
+                slots.swap (mSlots);
+                mMask = capacity-1;
+
+                for (typename std::vector<Slot>::const_iterator iter (slots.begin()); iter!=slots.end(); ++iter)
+                    if (iter->mRecord)
+                        place (iter->mHash, iter->mRecord);
+            }
+    };
+}
+
+#endif
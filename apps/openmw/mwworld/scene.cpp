@@ -1,9 +1,12 @@
 #include "scene.hpp"
 
 #include <OgreSceneNode.h>
+#include <OgreResourceGroupManager.h>
 
 #include <components/nif/niffile.hpp>
+#include <components/nifcache/nifcache.hpp>
 #include <components/misc/resourcehelpers.hpp>
+#include <components/misc/stringops.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -57,6 +60,37 @@ namespace
         }
     }
 
+    /// Open the models (and actor animations) of a cell's objects and start parsing them on
+    /// worker threads, so that they are (mostly) ready when InsertFunctor gets to them.
+    /// Compressed archive entries are inflated there as well.
+    struct PrefetchFunctor
+    {
+        bool operator() (const MWWorld::Ptr& ptr)
+        {
+            if (ptr.getRefData().isDeleted() || !ptr.getRefData().isEnabled())
+                return true;
+
+            std::string model = Misc::StringUtils::lowerCase(
+                Misc::ResourceHelpers::correctActorModelPath(ptr.getClass().getModel(ptr)));
+
+            if (model.size() > 4 && model.compare(model.size()-4, 4, ".nif") == 0)
+            {
+                Nif::Cache::getInstance().loadInBackground(model);
+
+                // the animations of an actor model are loaded from the KF file next to it (see
+                // Animation::addAnimSource)
+                if (ptr.getClass().isActor())
+                {
+                    std::string kf = model.substr(0, model.size()-4) + ".kf";
+                    if (Ogre::ResourceGroupManager::getSingleton().resourceExistsInAnyGroup(kf))
+                        Nif::Cache::getInstance().loadInBackground(kf);
+                }
+            }
+
+            return true;
+        }
+    };
+
     struct InsertFunctor
     {
         MWWorld::CellStore& mCell;
@@ -184,12 +218,9 @@ namespace MWWorld
         (*iter)->forEach<ListAndResetHandles>(functor);
         {
             // silence annoying g++ warning
-            for (std::vector<Ogre::SceneNode*>::const_iterator iter2 (functor.mHandles.begin());
+            for (std::vector<MWWorld::Ptr>::const_iterator iter2 (functor.mHandles.begin());
                 iter2!=functor.mHandles.end(); ++iter2)
-            {
-                Ogre::SceneNode* node = *iter2;
-                mPhysics->removeObject (node->getName());
-            }
+                mPhysics->removeObject (*iter2);
         }
 
         if ((*iter)->getCell()->isExterior())
@@ -211,6 +242,8 @@ namespace MWWorld
 
         MWBase::Environment::get().getSoundManager()->stopSound (*iter);
         mActiveCells.erase(*iter);
+
+        MWBase::Environment::get().getWorld()->invalidateReferences();
     }
 
     void Scene::loadCell (CellStore *cell, Loading::Listener* loadingListener)
@@ -221,6 +254,8 @@ namespace MWWorld
         {
             std::cout << "loading cell " << cell->getCell()->getDescription() << std::endl;
 
+            MWBase::Environment::get().getWorld()->invalidateReferences();
+
             float verts = ESM::Land::LAND_SIZE;
             float worldsize = ESM::Land::REAL_SIZE;
 
@@ -533,6 +568,9 @@ namespace MWWorld
 
     void Scene::insertCell (CellStore &cell, bool rescale, Loading::Listener* loadingListener)
     {
+        PrefetchFunctor prefetch;
+        cell.forEach (prefetch);
+
         InsertFunctor functor (cell, rescale, *loadingListener, *mPhysics, mRendering);
         cell.forEach (functor);
     }
@@ -555,7 +593,7 @@ namespace MWWorld
     {
         MWBase::Environment::get().getMechanicsManager()->remove (ptr);
         MWBase::Environment::get().getSoundManager()->stopSound3D (ptr);
-        mPhysics->removeObject (ptr.getRefData().getHandle());
+        mPhysics->removeObject (ptr);
         mRendering.removeObject (ptr);
     }
 
@@ -6,6 +6,7 @@
 #include <components/esm/esmreader.hpp>
 
 #include <components/misc/rng.hpp>
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 
@@ -29,6 +30,31 @@ namespace
         }
     };
 
+    // Record header flags that load() copies into the record
+    template<typename T>
+    uint32_t getRecordFlags(const T &record)
+    {
+        return 0;
+    }
+
+    uint32_t getRecordFlags(const ESM::NPC &record)
+    {
+        return record.mPersistent ? 0x0400 : 0;
+    }
+
+    uint32_t getRecordFlags(const ESM::Creature &record)
+    {
+        return record.mPersistent ? 0x0400 : 0;
+    }
+
+    template<typename T>
+    void writeRecord(ESM::ESMWriter &writer, const T &record)
+    {
+        writer.startRecord(T::sRecordId, getRecordFlags(record));
+        record.save(writer);
+        writer.endRecord(T::sRecordId);
+    }
+
     struct Compare
     {
         bool operator()(const ESM::Land *x, const ESM::Land *y) {
@@ -74,6 +100,12 @@ namespace MWWorld
             ret.first->second = record;
     }
     template<typename T>
+    void IndexedStore<T>::writeSnapshot(ESM::ESMWriter &writer) const
+    {
+        for (typename Static::const_iterator it = mStatic.begin(); it != mStatic.end(); ++it)
+            writeRecord(writer, it->second);
+    }
+    template<typename T>
     int IndexedStore<T>::getSize() const
     {
         return mStatic.size();
@@ -108,13 +140,16 @@ namespace MWWorld
 
     template<typename T>
     Store<T>::Store()
+        : mLookupLog(0)
     {
     }
 
     template<typename T>
     Store<T>::Store(const Store<T>& orig)
-        : mStatic(orig.mStatic)
+        : mStatic(orig.mStatic), mLookupLog(0)
     {
+        for (typename Static::iterator it = mStatic.begin(); it != mStatic.end(); ++it)
+            mStaticIndex.insert(&it->second);
     }
 
     template<typename T>
@@ -124,32 +159,32 @@ namespace MWWorld
         assert(mShared.size() >= mStatic.size());
         mShared.erase(mShared.begin() + mStatic.size(), mShared.end());
         mDynamic.clear();
+        mDynamicIndex.clear();
     }
 
     template<typename T>
     const T *Store<T>::search(const std::string &id) const
     {
-        T item;
-        item.mId = Misc::StringUtils::lowerCase(id);
-
-        typename Dynamic::const_iterator dit = mDynamic.find(item.mId);
-        if (dit != mDynamic.end()) {
-            return &dit->second;
+        if (mLookupLog)
+        {
+            boost::mutex::scoped_lock lock(mLookupLog->mMutex);
+            ++mLookupLog->mCounts[Misc::StringUtils::lowerCase(id)];
         }
 
-        typename std::map<std::string, T>::const_iterator it = mStatic.find(item.mId);
+        if (const T *ptr = mDynamicIndex.find(id))
+            return ptr;
 
-        if (it != mStatic.end() && Misc::StringUtils::ciEqual(it->second.mId, id)) {
-            return &(it->second);
-        }
-
-        return 0;
+        return mStaticIndex.find(id);
+    }
+    template<typename T>
+    void Store<T>::setLookupLog(LookupLog *log)
+    {
+        mLookupLog = log;
     }
     template<typename T>
     bool Store<T>::isDynamic(const std::string &id) const
     {
-        typename Dynamic::const_iterator dit = mDynamic.find(id);
-        return (dit != mDynamic.end());
+        return mDynamicIndex.find(id) != 0;
     }
     template<typename T>
     const T *Store<T>::searchRandom(const std::string &id) const
@@ -192,9 +227,34 @@ namespace MWWorld
         record.load(esm, isDeleted);
         Misc::StringUtils::lowerCaseInPlace(record.mId);
 
+        return insertLoaded(record, isDeleted);
+    }
+    template<typename T>
+    LoadedRecord *Store<T>::parse(ESM::ESMReader &esm) const
+    {
+        std::auto_ptr<ParsedRecord> parsed(new ParsedRecord);
+        parsed->mIsDeleted = false;
+
+        parsed->mRecord.load(esm, parsed->mIsDeleted);
+        Misc::StringUtils::lowerCaseInPlace(parsed->mRecord.mId);
+
+        return parsed.release();
+    }
+    template<typename T>
+    RecordId Store<T>::merge(LoadedRecord &record)
+    {
+        ParsedRecord& parsed = static_cast<ParsedRecord&>(record);
+        return insertLoaded(parsed.mRecord, parsed.mIsDeleted);
+    }
+    template<typename T>
+    RecordId Store<T>::insertLoaded(const T &record, bool isDeleted)
+    {
         std::pair<typename Static::iterator, bool> inserted = mStatic.insert(std::make_pair(record.mId, record));
         if (inserted.second)
+        {
             mShared.push_back(&inserted.first->second);
+            mStaticIndex.insert(&inserted.first->second);
+        }
         else
             inserted.first->second = record;
 
@@ -245,6 +305,7 @@ namespace MWWorld
         T *ptr = &result.first->second;
         if (result.second) {
             mShared.push_back(ptr);
+            mDynamicIndex.insert(ptr);
         } else {
             *ptr = item;
         }
@@ -259,6 +320,7 @@ namespace MWWorld
         T *ptr = &result.first->second;
         if (result.second) {
             mShared.push_back(ptr);
+            mStaticIndex.insert(ptr);
         } else {
             *ptr = item;
         }
@@ -284,6 +346,7 @@ namespace MWWorld
                 }
                 ++sharedIter;
             }
+            mStaticIndex.erase(id);
             mStatic.erase(it);
         }
 
@@ -298,6 +361,7 @@ namespace MWWorld
         if (it == mDynamic.end()) {
             return false;
         }
+        mDynamicIndex.erase(id);
         mDynamic.erase(it);
 
         // have to reinit the whole shared part
@@ -327,6 +391,14 @@ namespace MWWorld
         }
     }
 
+    template<typename T>
+    void Store<T>::writeSnapshot (ESM::ESMWriter& writer) const
+    {
+        // The static records come first in mShared, in the order they were loaded
+        for (size_t i = 0; i < mStatic.size(); ++i)
+            writeRecord(writer, *mShared[i]);
+    }
+
     template<typename T>
     RecordId Store<T>::read(ESM::ESMReader& reader)
     {
@@ -1088,7 +1160,8 @@ namespace MWWorld
         if (found == mStatic.end())
         {
             dialogue.loadData(esm, isDeleted);
-            mStatic.insert(std::make_pair(idLower, dialogue));
+            found = mStatic.insert(std::make_pair(idLower, dialogue)).first;
+            mStaticIndex.insert(&found->second);
         }
         else
         {
@@ -1098,6 +1171,34 @@ namespace MWWorld
 
         return RecordId(dialogue.mId, isDeleted);
     }
+
+    template <>
+    void Store<ESM::Dialogue>::writeSnapshot(ESM::ESMWriter &writer) const
+    {
+        // mShared is only filled by setUp() for dialogues. Each dialogue is followed by its INFOs
+        // in their merged order; the deleted ones would be removed by setUp() anyway.
+        for (Static::const_iterator it = mStatic.begin(); it != mStatic.end(); ++it)
+        {
+            const ESM::Dialogue& dialogue = it->second;
+            writeRecord(writer, dialogue);
+
+            for (ESM::Dialogue::InfoContainer::const_iterator info = dialogue.mInfo.begin();
+                info != dialogue.mInfo.end(); ++info)
+            {
+                ESM::Dialogue::LookupMap::const_iterator lookup = dialogue.mLookup.find(info->mId);
+                if (lookup == dialogue.mLookup.end() || !lookup->second.second)
+                    writeRecord(writer, *info);
+            }
+        }
+    }
+
+    template <>
+    LoadedRecord *Store<ESM::Dialogue>::parse(ESM::ESMReader &esm) const
+    {
+        // Merges into the dialogue of the same ID loaded before, and the INFO records that
+        // follow it need the result
+        return 0;
+    }
 #if 0
     // Script
     //=========================================================================
@@ -5,6 +5,8 @@
 #include <vector>
 #include <map>
 
+#include <boost/thread/mutex.hpp>
+
 #include <components/misc/rng.hpp>
 
 #include <components/esm/esmwriter.hpp>
@@ -13,6 +15,7 @@
 #include <components/loadinglistener/loadinglistener.hpp>
 
 #include "recordcmp.hpp"
+#include "recordindex.hpp"
 
 namespace MWWorld
 {
@@ -24,6 +27,19 @@ namespace MWWorld
         RecordId(const std::string &id = "", bool isDeleted = false);
     };
 
+    /// A record read by StoreBase::parse, waiting to be added to the store by StoreBase::merge
+    struct LoadedRecord
+    {
+        virtual ~LoadedRecord() {}
+    };
+
+    /// IDs looked up in a store by name, with the number of lookups (see Store::setLookupLog)
+    struct LookupLog
+    {
+        boost::mutex mMutex;
+        std::map<std::string, int> mCounts;
+    };
+
     class StoreBase
     {
     public:
@@ -38,11 +54,23 @@ namespace MWWorld
         virtual int getDynamicSize() const { return 0; }
         virtual RecordId load(ESM::ESMReader &esm) = 0;
 
+        virtual LoadedRecord *parse(ESM::ESMReader &esm) const { return 0; }
+        ///< Read a record without changing the store, so that several content files can be read
+        /// in parallel. Returns 0 if the record depends on the records loaded before it; it has to
+        /// be loaded with load() then.
+
+        virtual RecordId merge(LoadedRecord &record) { return RecordId(); }
+        ///< Add a record returned by parse(), with the same effect load() would have had
+
         virtual bool eraseStatic(const std::string &id) {return false;}
         virtual void clearDynamic() {}
 
         virtual void write (ESM::ESMWriter& writer, Loading::Listener& progress) const {}
 
+        virtual void writeSnapshot (ESM::ESMWriter& writer) const {}
+        ///< Write the records loaded from content files, so that load() can read them back in the
+        /// same order. No-op for stores whose records refer back to their content file.
+
         virtual RecordId read (ESM::ESMReader& reader) { return RecordId(); }
         ///< Read into dynamic storage
 
@@ -71,6 +99,8 @@ namespace MWWorld
         int getSize() const;
         void setUp();
 
+        void writeSnapshot(ESM::ESMWriter &writer) const;
+
         const T *search(int index) const;
         const T *find(int index) const;
     };
@@ -145,6 +175,12 @@ namespace MWWorld
                                      // for heads/hairs in the character creation)
         std::map<std::string, T> mDynamic;
 
+        // Case-insensitive lookup of the records in mStatic and mDynamic
+        RecordIndex<T> mStaticIndex;
+        RecordIndex<T> mDynamicIndex;
+
+        LookupLog *mLookupLog;
+
         typedef std::map<std::string, T> Dynamic;
         typedef std::map<std::string, T> Static;
 
@@ -166,6 +202,14 @@ namespace MWWorld
 
         T mLastAddedRecord;
 
+        struct ParsedRecord : public LoadedRecord
+        {
+            T mRecord;
+            bool mIsDeleted;
+        };
+
+        RecordId insertLoaded(const T &record, bool isDeleted);
+
         friend class ESMStore;
 
     public:
@@ -180,6 +224,9 @@ namespace MWWorld
 
         const T *search(const std::string &id) const;
 
+        void setLookupLog(LookupLog *log);
+        ///< Count the IDs passed to search() and find() in \a log (0 to stop counting).
+
         /**
          * Does the record with this ID come from the dynamic store?
          */
@@ -211,7 +258,10 @@ namespace MWWorld
         bool erase(const T &item);
 
         RecordId load(ESM::ESMReader &esm);
+        LoadedRecord *parse(ESM::ESMReader &esm) const;
+        RecordId merge(LoadedRecord &record);
         void write(ESM::ESMWriter& writer, Loading::Listener& progress) const;
+        void writeSnapshot(ESM::ESMWriter& writer) const;
         RecordId read(ESM::ESMReader& reader);
 #if 0
         std::string getLastAddedRecordId() const
@@ -0,0 +1,129 @@
+#include "tes4records.hpp"
+
+#include <components/esm/esm4reader.hpp>
+
+namespace MWWorld
+{
+    Tes4Records::Tes4Records()
+    : mMaterialized (0), mInflated (0)
+    {}
+
+    Tes4Records::~Tes4Records()
+    {
+        clear();
+    }
+
+    std::size_t Tes4Records::getFile (ESM::ESM4Reader& reader)
+    {
+        std::string path = reader.getName();
+
+        std::map<std::string, std::size_t>::const_iterator iter = mFileIndex.find (path);
+        if (iter!=mFileIndex.end())
+            return iter->second;
+
+        File file;
+        file.mPath = path;
+        file.mIndex = reader.getIndex();
+        file.mRecHeaderSize = reader.reader().recHeaderSize();
+        file.mModIndicies = reader.reader().modIndicies();
+
+        mFiles.push_back (file);
+        mFileIndex.insert (std::make_pair (path, mFiles.size()-1));
+        return mFiles.size()-1;
+    }
+
+    void Tes4Records::add (ESM::ESM4Reader& reader, FormId formId)
+    {
+        const ESM4::RecordHeader& header = reader.reader().hdr();
+
+        boost::mutex::scoped_lock lock (mMutex);
+
+        Location location;
+        location.mFile = getFile (reader);
+        location.mOffset = reader.getFileOffset() - reader.reader().recHeaderSize();
+        location.mType = header.record.typeId;
+        location.mCompressed = (header.record.flags & ESM4::Rec_Compressed)!=0;
+        location.mRecord = 0;
+
+        std::pair<Index::iterator, bool> inserted = mIndex.insert (std::make_pair (formId, location));
+
+        if (!inserted.second)
+        {
+            delete inserted.first->second.mRecord;
+            inserted.first->second = location;
+        }
+    }
+
+    ESM4::Reader& Tes4Records::seek (const Location& location) const
+    {
+        File& file = mFiles[location.mFile];
+
+        if (!file.mReader)
+        {
+            boost::shared_ptr<ESM::ESM4Reader> reader (
+                new ESM::ESM4Reader (file.mRecHeaderSize!=sizeof (ESM4::RecordHeader)));
+            reader->setIndex (file.mIndex);
+            reader->reader().setModIndex (file.mIndex);
+            reader->openTes4File (file.mPath);
+            reader->reader().setModIndicies (file.mModIndicies);
+            file.mReader = reader;
+        }
+
+        // The group stack only keeps track of how much of a group is left while reading
+        // through a file. A record read on its own is treated as the only one in a group.
+        ESM4::ReaderContext context = file.mReader->getESM4Context();
+        context.filePos = location.mOffset;
+        context.groupStack.clear();
+
+        ESM4::GroupTypeHeader group = ESM4::GroupTypeHeader();
+        group.type = ESM4::Grp_RecordType;
+        group.label.value = location.mType;
+        context.groupStack.push_back (std::make_pair (group, static_cast<std::uint32_t> (-1)));
+
+        file.mReader->restoreESM4Context (context);
+
+        ESM4::Reader& reader = file.mReader->reader();
+        reader.getRecordData();
+        return reader;
+    }
+
+    std::uint32_t Tes4Records::getType (FormId formId) const
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+
+        Index::const_iterator iter = mIndex.find (formId);
+        return iter==mIndex.end() ? 0 : iter->second.mType;
+    }
+
+    std::size_t Tes4Records::getSize() const
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+        return mIndex.size();
+    }
+
+    std::size_t Tes4Records::getMaterializedCount() const
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+        return mMaterialized;
+    }
+
+    std::size_t Tes4Records::getInflatedCount() const
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+        return mInflated;
+    }
+
+    void Tes4Records::clear()
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+
+        for (Index::iterator iter = mIndex.begin(); iter!=mIndex.end(); ++iter)
+            delete iter->second.mRecord;
+
+        mIndex.clear();
+        mFiles.clear();
+        mFileIndex.clear();
+        mMaterialized = 0;
+        mInflated = 0;
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef OPENMW_MWWORLD_TES4RECORDS_H
+#define OPENMW_MWWORLD_TES4RECORDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace ESM
+{
+    class ESM4Reader;
+}
+
+namespace ESM4
+{
+    class Reader;
+}
+
+namespace MWWorld
+{
+    /// \brief Index of the TES4 base records of the loaded content files
+    ///
+    /// Loading only notes where each record is. A record is read from its content file (and
+    /// inflated if it is compressed) the first time it is asked for, and kept from then on.
+    ///
+    /// The records are read with readers of their own, opened on first use, so the readers
+    /// used for loading neither have to outlive loading nor are moved by a search.
+    ///
+    /// \note Only records at the top level of their record type group are indexed. Cells,
+    /// worlds and their children depend on the groups they are in.
+    class Tes4Records
+    {
+        public:
+
+            typedef std::uint32_t FormId;
+
+            Tes4Records();
+            ~Tes4Records();
+
+            /// Note the record whose header \a reader has just read. A record of a later content
+            /// file replaces one with the same FormId.
+            void add (ESM::ESM4Reader& reader, FormId formId);
+
+            /// Return the record with \a formId as a T, reading it first if necessary, or 0 if
+            /// there is no such record or it is not of \a type (an ESM4::RecordTypes value).
+            template<typename T>
+            const T *search (FormId formId, std::uint32_t type) const;
+
+            /// \return the type of the record with \a formId, or 0 if there is none
+            std::uint32_t getType (FormId formId) const;
+
+            std::size_t getSize() const;
+
+            /// Number of records read from their content file so far
+            std::size_t getMaterializedCount() const;
+
+            /// Number of compressed records read from their content file so far
+            std::size_t getInflatedCount() const;
+
+            void clear();
+
+        private:
+
+            struct Materialized
+            {
+                virtual ~Materialized() {}
+            };
+
+            template<typename T>
+            struct Holder : Materialized
+            {
+                T mRecord;
+            };
+
+            /// What is needed to open a content file again
+            struct File
+            {
+                std::string mPath;
+                int mIndex; // load order position among the files of the same game
+                std::size_t mRecHeaderSize;
+                std::vector<std::uint32_t> mModIndicies; // of the masters
+                boost::shared_ptr<ESM::ESM4Reader> mReader; // 0 until a record is read
+            };
+
+            struct Location
+            {
+                std::size_t mFile; // in mFiles
+                std::size_t mOffset; // of the record header
+                std::uint32_t mType;
+                bool mCompressed;
+                Materialized *mRecord; // 0 until the record is asked for
+            };
+
+            typedef std::map<FormId, Location> Index;
+
+            Tes4Records (const Tes4Records&);
+            Tes4Records& operator= (const Tes4Records&);
+
+            /// \return the position of the file \a reader reads in mFiles, adding it if necessary
+            std::size_t getFile (ESM::ESM4Reader& reader);
+
+            /// Set up the reader of the file of \a location to read the data of its record
+            ESM4::Reader& seek (const Location& location) const;
+
+            mutable std::vector<File> mFiles;
+            std::map<std::string, std::size_t> mFileIndex;
+            mutable Index mIndex;
+            mutable std::size_t mMaterialized;
+            mutable std::size_t mInflated;
+            mutable boost::mutex mMutex;
+    };
+
+    template<typename T>
+    const T *Tes4Records::search (FormId formId, std::uint32_t type) const
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+
+        Index::iterator iter = mIndex.find (formId);
+
+        if (iter==mIndex.end() || iter->second.mType!=type)
+            return 0;
+
+        Location& location = iter->second;
+
+        if (!location.mRecord)
+        {
+            std::auto_ptr<Holder<T> > holder (new Holder<T>);
+            holder->mRecord.load (seek (location));
+            location.mRecord = holder.release();
+
+            ++mMaterialized;
+            if (location.mCompressed)
+                ++mInflated;
+        }
+
+        return &static_cast<Holder<T> *> (location.mRecord)->mRecord;
+    }
+}
+
+#endif
@@ -153,15 +153,16 @@ namespace MWWorld
         int activationDistanceOverride, const std::string& startCell, const std::string& startupScript)
     : mFallback(fallbackMap), mPlayer (0), mLocalScripts (mStore),
       mSky (true), mCells (mStore, mEsm),
-      mGodMode(false), mScriptsEnabled(true), mContentFiles (contentFiles),
+      mGodMode(false), mScriptsEnabled(true), mReferenceGeneration (1), mContentFiles (contentFiles),
       mActivationDistanceOverride (activationDistanceOverride), mStartupScript(startupScript),
       mStartCell (startCell), mTeleportEnabled(true),
-      mLevitationEnabled(true), mGoToJail(false), mDaysInPrison(0)
+      mLevitationEnabled(true), mGoToJail(false), mDaysInPrison(0),
+      mReportGameSettingLookups(Settings::Manager::getBool("report gmst lookups", "Game"))
     {
         mPhysics = new PhysicsSystem(renderer);
         mPhysEngine = mPhysics->getEngine();
 
-        mProjectileManager.reset(new ProjectileManager(renderer.getScene(), *mPhysEngine));
+        mProjectileManager.reset(new ProjectileManager(renderer.getScene(), *mPhysics));
 
         mRendering = new MWRender::RenderingManager(renderer, resDir, cacheDir, mPhysEngine,&mFallback);
 
@@ -182,7 +183,13 @@ namespace MWWorld
         gameContentLoader.addLoader(".omwaddon", &esmLoader);
         gameContentLoader.addLoader(".project", &esmLoader);
 
+        if (Settings::Manager::getBool("content snapshot", "Game"))
+            esmLoader.setSnapshotPath(cacheDir / "content.snapshot");
+
+        esmLoader.setReportTimes(Settings::Manager::getBool("report content load times", "Game"));
+
         loadContentFiles(fileCollections, contentFiles, gameContentLoader);
+        esmLoader.finish();
 
         listener->loadingOff();
 
@@ -192,8 +199,7 @@ namespace MWWorld
 
         mStore.setUp();
         mStore.movePlayerRecord();
-
-        mSwimHeightScale = mStore.get<ESM::GameSetting>().find("fSwimHeightScale")->getFloat();
+        mStore.setCountGameSettingLookups(mReportGameSettingLookups);
 
         mGlobalVariables.fill (mStore);
 
@@ -304,6 +310,8 @@ namespace MWWorld
         mLevitationEnabled = true;
 
         mGlobalVariables.fill (mStore);
+
+        invalidateReferences();
     }
 
     int World::countSavedGameRecords() const
@@ -603,6 +611,23 @@ namespace MWWorld
         return mGlobalVariables.getType (name);
     }
 
+    ESM::Variant& World::getGlobalVariable (const std::string& name)
+    {
+        return mGlobalVariables[name];
+    }
+
+    unsigned int World::getReferenceGeneration() const
+    {
+        return mReferenceGeneration;
+    }
+
+    void World::invalidateReferences()
+    {
+        // 0 is never a current generation
+        if (++mReferenceGeneration==0)
+            ++mReferenceGeneration;
+    }
+
     std::string World::getCellName (const MWWorld::CellStore *cell) const
     {
         if (!cell)
@@ -1073,12 +1098,11 @@ namespace MWWorld
                 pos += node->_getDerivedPosition();
         }
 
-        std::pair<std::string,Ogre::Vector3> result = mPhysics->getHitContact(ptr.getRefData().getHandle(),
-                                                                              pos, rot, distance);
-        if(result.first.empty())
+        std::pair<MWWorld::Ptr,Ogre::Vector3> result = mPhysics->getHitContact(ptr, pos, rot, distance);
+        if(result.first.isEmpty())
             return std::make_pair(MWWorld::Ptr(), Ogre::Vector3(0.0f));
 
-        return std::make_pair(searchPtrViaHandle(result.first), result.second);
+        return result;
     }
 
     void World::deleteObject (const Ptr& ptr)
@@ -1086,6 +1110,7 @@ namespace MWWorld
         if (!ptr.getRefData().isDeleted())
         {
             ptr.getRefData().setCount(0);
+            invalidateReferences();
 
             if (ptr.isInCell()
                 && mWorldScene->getActiveCells().find(ptr.getCell()) != mWorldScene->getActiveCells().end()
@@ -1105,6 +1130,7 @@ namespace MWWorld
         if (ptr.getRefData().isDeleted())
         {
             ptr.getRefData().setCount(1);
+            invalidateReferences();
             if (mWorldScene->getActiveCells().find(ptr.getCell()) != mWorldScene->getActiveCells().end()
                     && ptr.getRefData().isEnabled())
             {
@@ -1136,6 +1162,7 @@ namespace MWWorld
 
         if (currCell != newCell)
         {
+            invalidateReferences();
             removeContainerScripts(ptr);
 
             if (isPlayer)
@@ -1201,12 +1228,14 @@ namespace MWWorld
                     }
                 }
                 ptr.getRefData().setCount(0);
+                mCells.updatePtr (ptr, newPtr);
             }
         }
         if (haveToMove && newPtr.getRefData().getBaseNode())
         {
             mRendering->moveObject(newPtr, vec);
             mPhysics->moveObject (newPtr);
+            MWBase::Environment::get().getMechanicsManager()->updatePosition (newPtr);
         }
         if (isPlayer)
         {
@@ -1603,6 +1632,9 @@ namespace MWWorld
             ESM::Position pos = mPlayer->getPlayer().getRefData().getPosition();
             mPlayer->setLastKnownExteriorPosition(Ogre::Vector3(pos.pos));
         }
+
+        if (mReportGameSettingLookups)
+            mStore.reportGameSettingLookups(std::cout);
     }
 
     void World::updateSoundListener()
@@ -1895,6 +1927,7 @@ namespace MWWorld
 
         MWWorld::Ptr dropped =
             object.getClass().copyToCell(object, *cell, pos);
+        invalidateReferences();
 
         // Reset some position values that could be uninitialized if this item came from a container
         LocalRotation localRotation;
@@ -2001,12 +2034,18 @@ namespace MWWorld
 
     bool World::isSubmerged(const MWWorld::Ptr &object) const
     {
-        return isUnderwater(object, 1.0f/mSwimHeightScale);
+        float swimHeightScale = mStore.getGameSettingCache().fSwimHeightScale;
+
+        // a missing setting reads as 0, which puts the height to check infinitely high
+        if (swimHeightScale <= 0)
+            return false;
+
+        return isUnderwater(object, 1.0f/swimHeightScale);
     }
 
     bool World::isSwimming(const MWWorld::Ptr &object) const
     {
-        return isUnderwater(object, mSwimHeightScale);
+        return isUnderwater(object, mStore.getGameSettingCache().fSwimHeightScale);
     }
 
     bool World::isWading(const MWWorld::Ptr &object) const
@@ -2734,10 +2773,10 @@ namespace MWWorld
             Ogre::Vector3 dest = origin + direction * distance;
 
 
-            std::vector<std::pair<float, std::string> > collisions = mPhysEngine->rayTest2(btVector3(origin.x, origin.y, origin.z), btVector3(dest.x, dest.y, dest.z));
-            for (std::vector<std::pair<float, std::string> >::iterator cIt = collisions.begin(); cIt != collisions.end(); ++cIt)
+            std::vector<std::pair<float, OEngine::Physic::ObjectHandle> > collisions = mPhysEngine->rayTestHandles(btVector3(origin.x, origin.y, origin.z), btVector3(dest.x, dest.y, dest.z));
+            for (std::vector<std::pair<float, OEngine::Physic::ObjectHandle> >::iterator cIt = collisions.begin(); cIt != collisions.end(); ++cIt)
             {
-                MWWorld::Ptr collided = getPtrViaHandle(cIt->second);
+                MWWorld::Ptr collided = mPhysics->getPtr(cIt->second);
                 if (collided != actor)
                 {
                     target = collided;
@@ -83,6 +83,7 @@ namespace MWWorld
 
             bool mGodMode;
             bool mScriptsEnabled;
+            unsigned int mReferenceGeneration;
             std::vector<std::string> mContentFiles;
 
             // not implemented
@@ -136,7 +137,6 @@ namespace MWWorld
             void loadContentFiles(const Files::Collections& fileCollections,
                 const std::vector<std::string>& content, ContentLoader& contentLoader);
 
-            float mSwimHeightScale;
             bool isUnderwater(const MWWorld::Ptr &object, const float heightRatio) const;
             ///< helper function for implementing isSwimming(), isSubmerged(), isWading()
 
@@ -145,6 +145,8 @@ namespace MWWorld
             bool mGoToJail;
             int mDaysInPrison;
 
+            bool mReportGameSettingLookups;
+
             float feetToGameUnits(float feet);
 
             MWWorld::Ptr getClosestMarker( const MWWorld::Ptr &ptr, const std::string &id );
@@ -240,6 +242,20 @@ namespace MWWorld
             virtual char getGlobalVariableType (const std::string& name) const;
             ///< Return ' ', if there is no global variable with this name.
 
+            virtual ESM::Variant& getGlobalVariable (const std::string& name);
+            ///< Throws an exception, if there is no global variable with this name. The variable
+            /// stays valid until getReferenceGeneration changes.
+            ///
+            /// \note Changing gamehour, day or month this way does not update the sky.
+
+            virtual unsigned int getReferenceGeneration() const;
+            ///< Changes whenever the references returned by searchPtr may have been deleted or
+            /// moved to another cell, cells have been made active or inactive, or the global
+            /// variables have been replaced.
+
+            virtual void invalidateReferences();
+            ///< Change the reference generation.
+
             virtual std::string getCellName (const MWWorld::CellStore *cell = 0) const;
             ///< Return name of the cell.
             ///
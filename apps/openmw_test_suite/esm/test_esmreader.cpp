@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+
+namespace
+{
+    /// Content file written to a temporary file, so that it can be read both memory mapped
+    /// (from the file) and through a stream (from memory)
+    class ESMReaderTest : public testing::Test
+    {
+        protected:
+
+            boost::filesystem::path mPath;
+            std::string mData;
+
+            ESMReaderTest()
+            : mPath (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path ("esmreader-%%%%%%%%.esp"))
+            {}
+
+            virtual ~ESMReaderTest()
+            {
+                boost::system::error_code error;
+                boost::filesystem::remove (mPath, error);
+            }
+
+            void write (const std::string& data)
+            {
+                mData = data;
+                boost::filesystem::ofstream stream (mPath, std::ios::binary);
+                stream.write (data.data(), data.size());
+            }
+
+            /// A few records with small, empty and large (larger than the read buffer) strings
+            void writeContent()
+            {
+                ESM::ESMWriter writer;
+                std::ostringstream stream;
+
+                writer.setVersion();
+                writer.setFormat (0);
+                writer.save (stream);
+
+                for (int i = 0; i<20; ++i)
+                {
+                    std::ostringstream id;
+                    id << "record_" << i;
+
+                    writer.startRecord ("TEST");
+                    writer.writeHNString ("NAME", id.str());
+                    writer.writeHNT ("DATA", i);
+                    writer.writeHNCString ("TEXT", std::string (i==7 ? 100000 : i, 'a' + i));
+                    writer.endRecord ("TEST");
+                }
+
+                writer.close();
+
+                write (stream.str());
+            }
+
+            void openMapped (ESM::ESMReader& reader)
+            {
+                reader.open (mPath.string());
+                ASSERT_TRUE (reader.isMapped());
+            }
+
+            void openStream (ESM::ESMReader& reader)
+            {
+                Ogre::MemoryDataStream *stream = new Ogre::MemoryDataStream (mPath.string(), mData.size());
+                std::memcpy (stream->getPtr(), mData.data(), mData.size());
+                reader.open (Ogre::DataStreamPtr (stream), mPath.string());
+                ASSERT_FALSE (reader.isMapped());
+            }
+
+            /// Record and sub-record names and the raw data of each sub-record, with the offset
+            /// at the end of each record
+            static std::vector<std::string> readRaw (ESM::ESMReader& reader)
+            {
+                std::vector<std::string> records;
+
+                while (reader.hasMoreRecs())
+                {
+                    std::ostringstream record;
+                    record << reader.getRecName().toString();
+                    reader.getRecHeader();
+
+                    while (reader.hasMoreSubs())
+                    {
+                        reader.getSubName();
+                        reader.getSubHeader();
+
+                        std::string data (reader.getSubSize(), '\0');
+                        if (!data.empty())
+                            reader.getExact (&data[0], static_cast<int> (data.size()));
+
+                        record << ' ' << reader.retSubName().toString() << '=' << data;
+                    }
+
+                    record << " @" << reader.getFileOffset();
+                    records.push_back (record.str());
+                }
+
+                return records;
+            }
+
+            static void readStrings (ESM::ESMReader& reader)
+            {
+                for (int i = 0; reader.hasMoreRecs(); ++i)
+                {
+                    ASSERT_EQ (reader.getRecName().toString(), "TEST");
+                    reader.getRecHeader();
+
+                    std::ostringstream id;
+                    id << "record_" << i;
+                    ASSERT_EQ (reader.getHNString ("NAME"), id.str());
+
+                    int value = -1;
+                    reader.getHNT (value, "DATA");
+                    ASSERT_EQ (value, i);
+
+                    ASSERT_EQ (reader.getHNString ("TEXT"), std::string (i==7 ? 100000 : i, 'a' + i));
+                    ASSERT_FALSE (reader.hasMoreSubs());
+                }
+            }
+    };
+}
+
+TEST_F(ESMReaderTest, mapped_matches_stream_test)
+{
+    writeContent();
+
+    ESM::ESMReader mapped;
+    openMapped (mapped);
+    ESM::ESMReader stream;
+    openStream (stream);
+
+    ASSERT_EQ (mapped.getFileSize(), stream.getFileSize());
+    ASSERT_EQ (mapped.getFileOffset(), stream.getFileOffset());
+
+    std::vector<std::string> mappedRecords = readRaw (mapped);
+    std::vector<std::string> streamRecords = readRaw (stream);
+
+    ASSERT_EQ (mappedRecords.size(), 20u);
+    ASSERT_TRUE (mappedRecords == streamRecords);
+}
+
+TEST_F(ESMReaderTest, strings_test)
+{
+    writeContent();
+
+    ESM::ESMReader mapped;
+    openMapped (mapped);
+    readStrings (mapped);
+
+    ESM::ESMReader stream;
+    openStream (stream);
+    readStrings (stream);
+}
+
+TEST_F(ESMReaderTest, restore_context_test)
+{
+    writeContent();
+
+    ESM::ESMReader reader;
+    openMapped (reader);
+
+    // skip to the third record
+    for (int i = 0; i<2; ++i)
+    {
+        reader.getRecName();
+        reader.skipRecord();
+    }
+
+    ESM::ESM_Context context = reader.getContext();
+    std::vector<std::string> first = readRaw (reader);
+
+    reader.restoreContext (context);
+    ASSERT_EQ (reader.getFileOffset(), context.filePos);
+    std::vector<std::string> second = readRaw (reader);
+
+    ASSERT_EQ (first.size(), 18u);
+    ASSERT_TRUE (first == second);
+
+    // a copy shares the mapping and reads the same data
+    ESM::ESMReader copy (reader);
+    copy.restoreContext (context);
+    ASSERT_TRUE (readRaw (copy) == first);
+}
+
+TEST_F(ESMReaderTest, truncated_test)
+{
+    writeContent();
+    write (mData.substr (0, mData.size() - 10));
+
+    ESM::ESMReader mapped;
+    openMapped (mapped);
+    ASSERT_THROW (readRaw (mapped), std::runtime_error);
+
+    ESM::ESMReader stream;
+    openStream (stream);
+    ASSERT_THROW (readRaw (stream), std::runtime_error);
+}
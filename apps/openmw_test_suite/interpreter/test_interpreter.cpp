@@ -0,0 +1,472 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <components/compiler/context.hpp>
+#include <components/compiler/extensions.hpp>
+#include <components/compiler/fileparser.hpp>
+#include <components/compiler/scanner.hpp>
+#include <components/compiler/streamerrorhandler.hpp>
+
+#include <components/interpreter/context.hpp>
+#include <components/interpreter/installopcodes.hpp>
+#include <components/interpreter/interpreter.hpp>
+
+namespace
+{
+    /// Local scripts of the kind most mods run every frame: timers, state machines and some
+    /// arithmetic, plus a loop
+    const char *sCorpus[] =
+    {
+        "begin timerScript\n"
+        "short state\n"
+        "short count\n"
+        "long total\n"
+        "float timer\n"
+        "set timer to timer + 0.016\n"
+        "if ( timer > 1.5 )\n"
+        "    set timer to 0\n"
+        "    set state to state + 1\n"
+        "endif\n"
+        "if ( state == 0 )\n"
+        "    set count to count + 1\n"
+        "elseif ( state == 1 )\n"
+        "    set count to count - 1\n"
+        "else\n"
+        "    set state to 0\n"
+        "endif\n"
+        "set total to total + count * 2\n"
+        "end\n",
+
+        "begin doorScript\n"
+        "short open\n"
+        "short locked\n"
+        "float angle\n"
+        "if ( locked == 1 )\n"
+        "    return\n"
+        "endif\n"
+        "if ( open == 0 )\n"
+        "    if ( angle < 90 )\n"
+        "        set angle to angle + 2.5\n"
+        "    else\n"
+        "        set open to 1\n"
+        "    endif\n"
+        "elseif ( angle > 0 )\n"
+        "    set angle to angle - 2.5\n"
+        "else\n"
+        "    set open to 0\n"
+        "endif\n"
+        "end\n",
+
+        "begin loopScript\n"
+        "short i\n"
+        "float sum\n"
+        "set i to 0\n"
+        "set sum to 0\n"
+        "while ( i < 50 )\n"
+        "    set sum to sum + i * 0.5 - ( i / 3 )\n"
+        "    set i to i + 1\n"
+        "endwhile\n"
+        "end\n"
+    };
+
+    const int sCorpusSize = sizeof (sCorpus) / sizeof (sCorpus[0]);
+
+    class CompilerContext : public Compiler::Context
+    {
+        public:
+
+            virtual bool canDeclareLocals() const { return true; }
+
+            virtual char getGlobalType (const std::string& name) const
+            {
+                return name=="counter" ? 'l' : ' ';
+            }
+
+            virtual std::pair<char, bool> getMemberType (const std::string& name,
+                const std::string& id) const
+            {
+                return std::make_pair (' ', false);
+            }
+
+            virtual bool isId (const std::string& name) const { return false; }
+
+            virtual bool isJournalId (const std::string& name) const { return false; }
+    };
+
+    /// Context with local variables and global longs
+    class StubContext : public Interpreter::Context
+    {
+            std::vector<int> mShorts;
+            std::vector<int> mLongs;
+            std::vector<float> mFloats;
+
+        public:
+
+            std::map<std::string, int> mGlobals;
+            mutable int mGlobalLookups;
+
+            StubContext (const Compiler::Locals& locals)
+            : mShorts (locals.get ('s').size()), mLongs (locals.get ('l').size()),
+              mFloats (locals.get ('f').size()), mGlobalLookups (0)
+            {}
+
+            bool operator== (const StubContext& context) const
+            {
+                return mShorts==context.mShorts && mLongs==context.mLongs && mFloats==context.mFloats;
+            }
+
+            virtual int getLocalShort (int index) const { return mShorts.at (index); }
+            virtual int getLocalLong (int index) const { return mLongs.at (index); }
+            virtual float getLocalFloat (int index) const { return mFloats.at (index); }
+            virtual void setLocalShort (int index, int value) { mShorts.at (index) = value; }
+            virtual void setLocalLong (int index, int value) { mLongs.at (index) = value; }
+            virtual void setLocalFloat (int index, float value) { mFloats.at (index) = value; }
+
+            virtual void messageBox (const std::string& message, const std::vector<std::string>& buttons) {}
+            virtual void report (const std::string& message) {}
+            virtual bool menuMode() { return false; }
+
+            virtual int getGlobalShort (const std::string& name) const { return 0; }
+            virtual int getGlobalLong (const std::string& name) const
+            {
+                ++mGlobalLookups;
+                return mGlobals.find (name)->second;
+            }
+
+            virtual float getGlobalFloat (const std::string& name) const { return 0; }
+            virtual void setGlobalShort (const std::string& name, int value) {}
+            virtual void setGlobalLong (const std::string& name, int value)
+            {
+                ++mGlobalLookups;
+                mGlobals[name] = value;
+            }
+
+            virtual void setGlobalFloat (const std::string& name, float value) {}
+            virtual std::vector<std::string> getGlobals() const { return std::vector<std::string>(); }
+            virtual char getGlobalType (const std::string& name) const { return ' '; }
+
+            virtual std::string getActionBinding (const std::string& action) const { return ""; }
+            virtual std::string getNPCName() const { return ""; }
+            virtual std::string getNPCRace() const { return ""; }
+            virtual std::string getNPCClass() const { return ""; }
+            virtual std::string getNPCFaction() const { return ""; }
+            virtual std::string getNPCRank() const { return ""; }
+            virtual std::string getPCName() const { return ""; }
+            virtual std::string getPCRace() const { return ""; }
+            virtual std::string getPCClass() const { return ""; }
+            virtual std::string getPCRank() const { return ""; }
+            virtual std::string getPCNextRank() const { return ""; }
+            virtual int getPCBounty() const { return 0; }
+            virtual std::string getCurrentCellName() const { return ""; }
+
+            virtual bool isScriptRunning (const std::string& name) const { return false; }
+            virtual void startScript (const std::string& name, const std::string& targetId) {}
+            virtual void stopScript (const std::string& name) {}
+            virtual float getDistance (const std::string& name, const std::string& id) const { return 0; }
+            virtual float getSecondsPassed() const { return 0.016f; }
+            virtual bool isDisabled (const std::string& id) const { return false; }
+            virtual void enable (const std::string& id) {}
+            virtual void disable (const std::string& id) {}
+
+            virtual int getMemberShort (const std::string& id, const std::string& name, bool global) const
+            { return 0; }
+            virtual int getMemberLong (const std::string& id, const std::string& name, bool global) const
+            { return 0; }
+            virtual float getMemberFloat (const std::string& id, const std::string& name, bool global) const
+            { return 0; }
+            virtual void setMemberShort (const std::string& id, const std::string& name, int value, bool global) {}
+            virtual void setMemberLong (const std::string& id, const std::string& name, int value, bool global) {}
+            virtual void setMemberFloat (const std::string& id, const std::string& name, float value, bool global) {}
+
+            virtual std::string getTargetId() const { return ""; }
+    };
+
+    /// Context that keeps the global variable each string literal refers to
+    class LinkedContext : public StubContext
+    {
+            mutable std::map<int, int *> mLinks;
+
+            int& getGlobal (const Interpreter::Runtime& runtime, int name) const
+            {
+                std::map<int, int *>::iterator iter = mLinks.find (name);
+
+                if (iter==mLinks.end())
+                {
+                    ++mGlobalLookups;
+                    int *global = &const_cast<LinkedContext&> (*this).mGlobals[runtime.getStringLiteral (name)];
+                    iter = mLinks.insert (std::make_pair (name, global)).first;
+                }
+
+                return *iter->second;
+            }
+
+        public:
+
+            LinkedContext (const Compiler::Locals& locals) : StubContext (locals) {}
+
+            using StubContext::getGlobalLong;
+            using StubContext::setGlobalLong;
+
+            virtual int getGlobalLong (const Interpreter::Runtime& runtime, int name) const
+            {
+                return getGlobal (runtime, name);
+            }
+
+            virtual void setGlobalLong (const Interpreter::Runtime& runtime, int name, int value)
+            {
+                getGlobal (runtime, name) = value;
+            }
+    };
+
+    struct Script
+    {
+        std::vector<Interpreter::Type_Code> mCode;
+        Interpreter::Instructions mInstructions;
+        Compiler::Locals mLocals;
+    };
+
+    class InterpreterTest : public ::testing::Test
+    {
+        protected:
+
+            Compiler::Extensions mExtensions;
+            CompilerContext mCompilerContext;
+            Interpreter::Interpreter mInterpreter;
+            std::vector<Script> mScripts;
+
+            virtual void SetUp()
+            {
+                mCompilerContext.setExtensions (&mExtensions);
+                Interpreter::installOpcodes (mInterpreter);
+
+                for (int i = 0; i<sCorpusSize; ++i)
+                    mScripts.push_back (compile (sCorpus[i]));
+            }
+
+            Script compile (const std::string& text)
+            {
+                Compiler::StreamErrorHandler errorHandler (std::cerr);
+                Compiler::FileParser parser (errorHandler, mCompilerContext);
+
+                std::istringstream input (text);
+                Compiler::Scanner scanner (errorHandler, input, &mExtensions);
+                scanner.scan (parser);
+
+                if (!errorHandler.isGood())
+                    throw std::runtime_error ("failed to compile " + text);
+
+                Script script;
+                parser.getCode (script.mCode);
+                mInterpreter.decode (&script.mCode[0], script.mCode.size(), script.mInstructions);
+                script.mLocals = parser.getLocals();
+                return script;
+            }
+
+            /// \return instructions per second
+            double runCorpus (int passes, bool decoded)
+            {
+                std::vector<StubContext> contexts;
+                for (std::vector<Script>::const_iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+                    contexts.push_back (StubContext (iter->mLocals));
+
+                std::size_t count = mInterpreter.getInstructionCount();
+                boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+                for (int pass = 0; pass<passes; ++pass)
+                    for (std::size_t i = 0; i<mScripts.size(); ++i)
+                    {
+                        const Script& script = mScripts[i];
+
+                        if (decoded)
+                            mInterpreter.run (&script.mCode[0], script.mCode.size(), script.mInstructions,
+                                contexts[i]);
+                        else
+                            mInterpreter.run (&script.mCode[0], script.mCode.size(), contexts[i]);
+                    }
+
+                double seconds =
+                    (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+
+                return (mInterpreter.getInstructionCount() - count) / std::max (seconds, 1e-6);
+            }
+    };
+}
+
+TEST_F(InterpreterTest, decoded_matches_code_test)
+{
+    for (std::vector<Script>::const_iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+    {
+        StubContext context (iter->mLocals);
+        StubContext decodedContext (iter->mLocals);
+
+        ASSERT_EQ (iter->mInstructions.size(), iter->mCode[0]);
+
+        for (int frame = 0; frame<200; ++frame)
+        {
+            std::size_t count = mInterpreter.getInstructionCount();
+            mInterpreter.run (&iter->mCode[0], iter->mCode.size(), context);
+            std::size_t executed = mInterpreter.getInstructionCount() - count;
+
+            mInterpreter.run (&iter->mCode[0], iter->mCode.size(), iter->mInstructions, decodedContext);
+
+            ASSERT_EQ (mInterpreter.getInstructionCount() - count, 2*executed);
+            ASSERT_TRUE (context==decodedContext);
+        }
+    }
+}
+
+TEST_F(InterpreterTest, global_literal_test)
+{
+    Script script = compile (
+        "begin globalScript\n"
+        "set counter to counter + 1\n"
+        "if ( counter > 2 )\n"
+        "    set counter to counter * 10\n"
+        "endif\n"
+        "end\n");
+
+    StubContext context (script.mLocals);
+    LinkedContext linkedContext (script.mLocals);
+    context.mGlobals["counter"] = 0;
+    linkedContext.mGlobals["counter"] = 0;
+
+    for (int frame = 0; frame<3; ++frame)
+    {
+        mInterpreter.run (&script.mCode[0], script.mCode.size(), script.mInstructions, context);
+        mInterpreter.run (&script.mCode[0], script.mCode.size(), script.mInstructions, linkedContext);
+    }
+
+    ASSERT_EQ (context.mGlobals["counter"], 30);
+    ASSERT_EQ (linkedContext.mGlobals["counter"], 30);
+
+    // looked up by name on each access unless the context keeps what the literals refer to (the
+    // script has one literal per access)
+    ASSERT_EQ (context.mGlobalLookups, 3*2 + 3 + 2);
+    ASSERT_EQ (linkedContext.mGlobalLookups, 5);
+}
+
+/// Scripts that use nothing but their locals can be run by an interpreter with only the local
+/// opcodes installed, as the worker threads running local scripts in parallel have.
+TEST_F(InterpreterTest, local_opcodes_test)
+{
+    Interpreter::Interpreter local;
+    Interpreter::installLocalOpcodes (local);
+
+    for (std::vector<Script>::const_iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+    {
+        ASSERT_TRUE (local.canRun (&iter->mCode[0], iter->mCode.size()));
+
+        StubContext context (iter->mLocals);
+        StubContext localContext (iter->mLocals);
+
+        for (int frame = 0; frame<100; ++frame)
+        {
+            mInterpreter.run (&iter->mCode[0], iter->mCode.size(), iter->mInstructions, context);
+            local.run (&iter->mCode[0], iter->mCode.size(), localContext);
+        }
+
+        ASSERT_TRUE (context==localContext);
+    }
+
+    Script global = compile ("begin globalScript\nset counter to 1\nend\n");
+    ASSERT_FALSE (local.canRun (&global.mCode[0], global.mCode.size()));
+    ASSERT_TRUE (mInterpreter.canRun (&global.mCode[0], global.mCode.size()));
+}
+
+TEST_F(InterpreterTest, unknown_opcode_test)
+{
+    // push 1, an unknown opcode in segment 5, push 2
+    Interpreter::Type_Code code[] = { 3, 0, 0, 0, 1, 0xc8000000 | 0x3fffff0, 2 };
+    Compiler::Locals locals;
+    StubContext context (locals);
+
+    Interpreter::Instructions instructions;
+    mInterpreter.decode (code, 7, instructions);
+    ASSERT_EQ (instructions.size(), 3u);
+
+    ASSERT_THROW (mInterpreter.run (code, 7, context), std::runtime_error);
+    ASSERT_THROW (mInterpreter.run (code, 7, instructions, context), std::runtime_error);
+
+    // only reported when executed
+    code[0] = 1;
+    mInterpreter.decode (code, 7, instructions);
+    mInterpreter.run (code, 7, context);
+    mInterpreter.run (code, 7, instructions, context);
+}
+
+TEST_F(InterpreterTest, profiling_test)
+{
+    Interpreter::OpcodeProfiles profiles;
+    mInterpreter.addProfiles (profiles);
+    ASSERT_TRUE (profiles.empty());
+
+    mInterpreter.setProfiling (true);
+    std::size_t count = mInterpreter.getInstructionCount();
+
+    for (std::vector<Script>::const_iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+    {
+        StubContext context (iter->mLocals);
+
+        for (int frame = 0; frame<50; ++frame)
+        {
+            mInterpreter.run (&iter->mCode[0], iter->mCode.size(), context);
+            mInterpreter.run (&iter->mCode[0], iter->mCode.size(), iter->mInstructions, context);
+        }
+    }
+
+    mInterpreter.setProfiling (false);
+    count = mInterpreter.getInstructionCount() - count;
+
+    // every execution is counted, only a sample of them is timed, but at least one of each opcode
+    std::size_t executions = 0;
+    std::size_t timed = 0;
+    mInterpreter.addProfiles (profiles);
+
+    for (Interpreter::OpcodeProfiles::const_iterator iter (profiles.begin()); iter!=profiles.end(); ++iter)
+    {
+        executions += iter->second.mCount;
+        timed += iter->second.mTimed;
+        ASSERT_GE (iter->second.mTimed, 1u);
+        ASSERT_LE (iter->second.mTimed, iter->second.mCount);
+        ASSERT_GE (iter->second.getTime(), 0);
+    }
+
+    ASSERT_EQ (executions, count);
+    ASSERT_GT (timed, 0u);
+    ASSERT_LT (timed, count);
+
+    // nothing is collected while disabled, and enabling starts over
+    StubContext context (mScripts[0].mLocals);
+    mInterpreter.run (&mScripts[0].mCode[0], mScripts[0].mCode.size(), context);
+
+    Interpreter::OpcodeProfiles after;
+    mInterpreter.addProfiles (after);
+    ASSERT_EQ (after.size(), profiles.size());
+
+    mInterpreter.setProfiling (true);
+    after.clear();
+    mInterpreter.addProfiles (after);
+    ASSERT_TRUE (after.empty());
+}
+
+/// Run the corpus with the code decoded on each run and with the instructions decoded up front
+/// and report instructions per second.
+TEST_F(InterpreterTest, DISABLED_dispatch_benchmark)
+{
+    const int passes = 20000;
+
+    runCorpus (passes/10, true); // warm up
+
+    double code = runCorpus (passes, false);
+    double decoded = runCorpus (passes, true);
+
+    std::cout << "dispatch_benchmark: " << mScripts.size() << " scripts, " << passes << " passes, "
+        << static_cast<long> (code) << " instructions/s decoding on each run, "
+        << static_cast<long> (decoded) << " instructions/s pre-decoded" << std::endl;
+}
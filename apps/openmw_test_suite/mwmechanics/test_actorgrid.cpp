@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+#include <components/misc/rng.hpp>
+
+#include "apps/openmw/mwmechanics/actorgrid.hpp"
+
+namespace
+{
+    /// Actors at known positions, with their queries answered by looking at all of them
+    class ActorGridTest : public testing::Test
+    {
+        protected:
+
+            std::vector<char> mStorage; // the Ptrs only need distinct addresses
+            std::map<MWWorld::Ptr, Ogre::Vector3> mPositions;
+            MWMechanics::ActorGrid mGrid;
+
+            ActorGridTest() : mStorage (1000)
+            {
+                Misc::Rng::init (1);
+            }
+
+            static float random (float range)
+            {
+                return (Misc::Rng::rollClosedProbability() - 0.5f) * range;
+            }
+
+            MWWorld::Ptr getActor (std::size_t index)
+            {
+                return MWWorld::Ptr (reinterpret_cast<MWWorld::LiveCellRefBase *> (&mStorage[index]));
+            }
+
+            void place (const MWWorld::Ptr& actor, const Ogre::Vector3& position)
+            {
+                mPositions[actor] = position;
+                mGrid.update (actor, position);
+            }
+
+            void remove (const MWWorld::Ptr& actor)
+            {
+                mPositions.erase (actor);
+                mGrid.remove (actor);
+            }
+
+            std::vector<MWWorld::Ptr> getActorsInRange (const Ogre::Vector3& position, float radius)
+            {
+                std::vector<MWWorld::Ptr> actors;
+
+                for (std::map<MWWorld::Ptr, Ogre::Vector3>::const_iterator iter (mPositions.begin());
+                    iter!=mPositions.end(); ++iter)
+                    if (iter->second.squaredDistance (position)<=radius*radius)
+                        actors.push_back (iter->first);
+
+                return actors;
+            }
+
+            void compare (float range)
+            {
+                const float radii[] = { 0, 100, 400, 2000, 7168, 100000 };
+
+                for (int i = 0; i<50; ++i)
+                {
+                    Ogre::Vector3 position (random (range), random (range), random (1000));
+
+                    for (std::size_t j = 0; j<sizeof (radii)/sizeof (radii[0]); ++j)
+                    {
+                        std::vector<MWWorld::Ptr> found;
+                        mGrid.getActorsInRange (position, radii[j], found);
+
+                        ASSERT_TRUE (found==getActorsInRange (position, radii[j])) << radii[j];
+                    }
+                }
+            }
+    };
+}
+
+/// Towns, where most actors are close to each other, and actors spread over several exterior
+/// cells, with negative coordinates and grid cell borders.
+TEST_F(ActorGridTest, matches_brute_force_test)
+{
+    const float ranges[] = { 3000, 40000 };
+
+    for (std::size_t i = 0; i<sizeof (ranges)/sizeof (ranges[0]); ++i)
+    {
+        mGrid.clear();
+        mPositions.clear();
+
+        for (std::size_t j = 0; j<200; ++j)
+            place (getActor (j), Ogre::Vector3 (random (ranges[i]), random (ranges[i]), random (1000)));
+
+        place (getActor (200), Ogre::Vector3 (2048, -2048, 0));
+        place (getActor (201), Ogre::Vector3 (0, 0, 0));
+
+        ASSERT_EQ (mGrid.getSize(), 202u);
+        compare (ranges[i]);
+    }
+}
+
+/// Actors moving a little, moving far and leaving, as happens while the game runs.
+TEST_F(ActorGridTest, moving_actors_test)
+{
+    for (std::size_t i = 0; i<100; ++i)
+        place (getActor (i), Ogre::Vector3 (random (20000), random (20000), 0));
+
+    for (int frame = 0; frame<20; ++frame)
+    {
+        for (std::size_t i = 0; i<100; ++i)
+        {
+            MWWorld::Ptr actor = getActor (i);
+
+            if (mPositions.find (actor)==mPositions.end())
+                continue;
+
+            Ogre::Vector3 position = mPositions[actor];
+
+            if (i%10==frame%10)
+                position = Ogre::Vector3 (random (20000), random (20000), 0); // teleported
+            else
+                position += Ogre::Vector3 (random (600), random (600), 0);
+
+            place (actor, position);
+        }
+
+        remove (getActor (frame*3));
+        place (getActor (100+frame), Ogre::Vector3 (random (20000), random (20000), 0));
+
+        compare (20000);
+    }
+
+    ASSERT_EQ (mGrid.getSize(), mPositions.size());
+}
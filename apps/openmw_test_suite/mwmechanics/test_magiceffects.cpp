@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <components/misc/rng.hpp>
+
+#include "apps/openmw/mwmechanics/magiceffects.hpp"
+
+namespace
+{
+    typedef std::map<MWMechanics::EffectKey, MWMechanics::EffectParam> EffectMap;
+
+    /// MagicEffects as it used to be, on top of a std::map
+    struct MapEffects
+    {
+        EffectMap mCollection;
+
+        void add (const MWMechanics::EffectKey& key, const MWMechanics::EffectParam& param)
+        {
+            EffectMap::iterator iter = mCollection.find (key);
+
+            if (iter==mCollection.end())
+                mCollection.insert (std::make_pair (key, param));
+            else
+                iter->second += param;
+        }
+
+        MWMechanics::EffectParam get (const MWMechanics::EffectKey& key) const
+        {
+            EffectMap::const_iterator iter = mCollection.find (key);
+            return iter==mCollection.end() ? MWMechanics::EffectParam() : iter->second;
+        }
+
+        void setModifiers (const MapEffects& effects)
+        {
+            for (EffectMap::iterator it = mCollection.begin(); it != mCollection.end(); ++it)
+                it->second.setModifier (effects.get (it->first).getModifier());
+
+            for (EffectMap::const_iterator it = effects.mCollection.begin(); it != effects.mCollection.end(); ++it)
+                mCollection[it->first].setModifier (it->second.getModifier());
+        }
+
+        MapEffects& operator+= (const MapEffects& effects)
+        {
+            for (EffectMap::const_iterator iter = effects.mCollection.begin(); iter != effects.mCollection.end(); ++iter)
+                add (iter->first, iter->second);
+            return *this;
+        }
+    };
+
+    class MagicEffectsTest : public testing::Test
+    {
+        protected:
+
+            MagicEffectsTest()
+            {
+                Misc::Rng::init (1);
+            }
+
+            static int random (int range)
+            {
+                return Misc::Rng::rollDice (range);
+            }
+
+            /// Mostly effects without an argument, some skill or attribute effects and a few
+            /// effects with an unknown ID
+            static MWMechanics::EffectKey randomKey()
+            {
+                int kind = random (10);
+
+                if (kind<7)
+                    return MWMechanics::EffectKey (random (ESM::MagicEffect::Length));
+
+                if (kind<9)
+                {
+                    const int skillEffects[] = { ESM::MagicEffect::DrainSkill, ESM::MagicEffect::DamageSkill,
+                        ESM::MagicEffect::FortifySkill, ESM::MagicEffect::FortifyAttribute };
+                    return MWMechanics::EffectKey (skillEffects[random (4)], random (8));
+                }
+
+                return MWMechanics::EffectKey (ESM::MagicEffect::Length + random (5));
+            }
+
+            void compare (const MWMechanics::MagicEffects& effects, const MapEffects& expected)
+            {
+                EffectMap::const_iterator expectedIter = expected.mCollection.begin();
+
+                for (MWMechanics::MagicEffects::const_iterator iter = effects.begin(); iter != effects.end();
+                    ++iter, ++expectedIter)
+                {
+                    ASSERT_TRUE (expectedIter != expected.mCollection.end());
+                    ASSERT_EQ (iter->first.mId, expectedIter->first.mId);
+                    ASSERT_EQ (iter->first.mArg, expectedIter->first.mArg);
+                    ASSERT_EQ (iter->second.getModifier(), expectedIter->second.getModifier());
+                    ASSERT_EQ (iter->second.getBase(), expectedIter->second.getBase());
+                    ASSERT_EQ (effects.get (iter->first).getMagnitude(), expectedIter->second.getMagnitude());
+                }
+
+                ASSERT_TRUE (expectedIter == expected.mCollection.end());
+            }
+    };
+
+    template<typename T>
+    double timeFrames (std::vector<T>& stats, const std::vector<T>& sources, int frames, float& total)
+    {
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+        const int queries[] = { ESM::MagicEffect::WaterWalking, ESM::MagicEffect::Levitate,
+            ESM::MagicEffect::Paralyze, ESM::MagicEffect::Silence, ESM::MagicEffect::Burden,
+            ESM::MagicEffect::Feather, ESM::MagicEffect::Invisibility, ESM::MagicEffect::Chameleon,
+            ESM::MagicEffect::SwiftSwim, ESM::MagicEffect::WaterBreathing };
+
+        for (int frame = 0; frame<frames; ++frame)
+            for (std::size_t i = 0; i<stats.size(); ++i)
+            {
+                // Actors::adjustMagicEffects: spells, equipment and active spells
+                T now (sources[3*i]);
+                now += sources[3*i+1];
+                now += sources[3*i+2];
+                stats[i].setModifiers (now);
+
+                for (std::size_t j = 0; j<sizeof (queries) / sizeof (queries[0]); ++j)
+                    total += stats[i].get (MWMechanics::EffectKey (queries[j])).getMagnitude();
+
+                for (int attribute = 0; attribute<8; ++attribute)
+                    total += stats[i].get (MWMechanics::EffectKey (ESM::MagicEffect::FortifyAttribute,
+                        attribute)).getMagnitude();
+            }
+
+        return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+    }
+}
+
+TEST_F(MagicEffectsTest, matches_map_test)
+{
+    MWMechanics::MagicEffects effects;
+    MapEffects expected;
+
+    for (int i = 0; i<2000; ++i)
+    {
+        MWMechanics::EffectKey key = randomKey();
+
+        switch (random (4))
+        {
+            case 0:
+            case 1:
+            {
+                MWMechanics::EffectParam param (static_cast<float> (random (20)));
+                effects.add (key, param);
+                expected.add (key, param);
+                break;
+            }
+
+            case 2:
+
+                effects.modifyBase (key, 3);
+                expected.mCollection[key].modifyBase (3);
+                break;
+
+            case 3:
+
+                effects.remove (key);
+                expected.mCollection.erase (key);
+                break;
+        }
+    }
+
+    compare (effects, expected);
+
+    // iterating does not depend on the order the effects were added in
+    MWMechanics::MagicEffects copy;
+    for (EffectMap::const_reverse_iterator iter = expected.mCollection.rbegin(); iter != expected.mCollection.rend(); ++iter)
+        copy.add (iter->first, iter->second);
+
+    compare (copy, expected);
+}
+
+TEST_F(MagicEffectsTest, combine_test)
+{
+    MWMechanics::MagicEffects first;
+    MWMechanics::MagicEffects second;
+    MapEffects expectedFirst;
+    MapEffects expectedSecond;
+
+    for (int i = 0; i<200; ++i)
+    {
+        MWMechanics::EffectKey key = randomKey();
+        MWMechanics::EffectParam param (static_cast<float> (random (20)));
+
+        if (random (2))
+        {
+            first.add (key, param);
+            expectedFirst.add (key, param);
+        }
+        else
+        {
+            second.add (key, param);
+            expectedSecond.add (key, param);
+        }
+    }
+
+    first.modifyBase (MWMechanics::EffectKey (ESM::MagicEffect::Levitate), 5);
+    expectedFirst.mCollection[MWMechanics::EffectKey (ESM::MagicEffect::Levitate)].modifyBase (5);
+
+    MWMechanics::MagicEffects sum (first);
+    sum += second;
+    MapEffects expectedSum (expectedFirst);
+    expectedSum += expectedSecond;
+    compare (sum, expectedSum);
+
+    first.setModifiers (second);
+    expectedFirst.setModifiers (expectedSecond);
+    compare (first, expectedFirst);
+
+    MWMechanics::MagicEffects diff = MWMechanics::MagicEffects::diff (first, sum);
+    MWMechanics::MagicEffects restored (first);
+    restored += diff;
+
+    for (MWMechanics::MagicEffects::const_iterator iter = sum.begin(); iter != sum.end(); ++iter)
+        ASSERT_EQ (restored.get (iter->first).getMagnitude(), iter->second.getMagnitude());
+
+    // absent effects are zero
+    ASSERT_EQ (sum.get (MWMechanics::EffectKey (ESM::MagicEffect::Length + 10)).getMagnitude(), 0.f);
+    ASSERT_EQ (MWMechanics::MagicEffects().get (MWMechanics::EffectKey (0)).getMagnitude(), 0.f);
+}
+
+/// Combine the effect sources of a set of actors and look up the effects the mechanics ask for
+/// every frame, with the effects in a std::map and in MagicEffects.
+TEST_F(MagicEffectsTest, DISABLED_actor_update_benchmark)
+{
+    const std::size_t actors = 100;
+    const int frames = 200;
+
+    std::vector<MWMechanics::MagicEffects> sources (3*actors);
+    std::vector<MapEffects> mapSources (3*actors);
+
+    // a few abilities, a set of enchanted equipment and the odd active spell per actor
+    const int counts[] = { 4, 10, 2 };
+
+    for (std::size_t i = 0; i<sources.size(); ++i)
+        for (int j = 0; j<counts[i%3]; ++j)
+        {
+            MWMechanics::EffectKey key = randomKey();
+            MWMechanics::EffectParam param (static_cast<float> (random (20)));
+            sources[i].add (key, param);
+            mapSources[i].add (key, param);
+        }
+
+    std::vector<MWMechanics::MagicEffects> stats (actors);
+    std::vector<MapEffects> mapStats (actors);
+
+    float total = 0;
+    float mapTotal = 0;
+
+    double time = timeFrames (stats, sources, frames, total);
+    double mapTime = timeFrames (mapStats, mapSources, frames, mapTotal);
+
+    ASSERT_EQ (total, mapTotal);
+
+    for (std::size_t i = 0; i<actors; ++i)
+        compare (stats[i], mapStats[i]);
+
+    std::cout << "actor_update_benchmark: " << actors << " actors, " << frames << " frames, std::map "
+        << mapTime << " s, MagicEffects " << time << " s" << std::endl;
+}
@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <components/esm/loadland.hpp>
+#include <components/misc/rng.hpp>
+
+#include "apps/openmw/mwmechanics/pathgrid.hpp"
+
+namespace
+{
+    /// Pathgrid laid out like a town (jittered rows of points connected both ways), with an
+    /// enclosed yard that is only connected to the rest in one direction and a separate group of
+    /// points, like the ship in Seyda Neen.
+    class PathgridTest : public testing::Test
+    {
+        protected:
+
+            ESM::Pathgrid mPathgrid;
+            MWMechanics::PathgridGraph mGraph;
+            std::vector<std::vector<int> > mNeighbours;
+
+            static int random (int range)
+            {
+                return Misc::Rng::rollDice (range);
+            }
+
+            void addEdge (int from, int to)
+            {
+                ESM::Pathgrid::Edge edge;
+                edge.mV0 = from;
+                edge.mV1 = to;
+                mPathgrid.mEdges.push_back (edge);
+                mNeighbours[from].push_back (to);
+            }
+
+            int addPoint (int x, int y, int z)
+            {
+                mPathgrid.mPoints.push_back (ESM::Pathgrid::Point (x, y, z));
+                mNeighbours.push_back (std::vector<int>());
+                return static_cast<int> (mPathgrid.mPoints.size()) - 1;
+            }
+
+            PathgridTest()
+            {
+                Misc::Rng::init (1);
+
+                mPathgrid.mData.mX = -2;
+                mPathgrid.mData.mY = 3;
+
+                const int columns = 18;
+                const int rows = 15;
+
+                for (int y = 0; y<rows; ++y)
+                    for (int x = 0; x<columns; ++x)
+                        addPoint (x*450 + random (200), y*520 + random (200), random (300));
+
+                for (int y = 0; y<rows; ++y)
+                    for (int x = 0; x<columns; ++x)
+                    {
+                        int point = y*columns + x;
+
+                        // some streets are blocked
+                        if (x+1<columns && random (6))
+                        {
+                            addEdge (point, point+1);
+                            addEdge (point+1, point);
+                        }
+
+                        if (y+1<rows && random (6))
+                        {
+                            addEdge (point, point+columns);
+                            addEdge (point+columns, point);
+                        }
+                    }
+
+                int yard = addPoint (1000, 1000, 0);
+                addPoint (1100, 1000, 0);
+                addEdge (yard, yard+1);
+                addEdge (yard+1, yard);
+                addEdge (yard, 0);
+
+                int ship = addPoint (9000, 9000, 50);
+                for (int i = 1; i<10; ++i)
+                {
+                    addPoint (9000 + i*100, 9000 + random (300), 50);
+                    addEdge (ship+i-1, ship+i);
+                    addEdge (ship+i, ship+i-1);
+                }
+
+                mGraph.load (&mPathgrid, true);
+            }
+
+            std::set<int> getReachable (int start, bool reverse) const
+            {
+                std::set<int> reached;
+                std::vector<int> open (1, start);
+                reached.insert (start);
+
+                while (!open.empty())
+                {
+                    int current = open.back();
+                    open.pop_back();
+
+                    for (int i = 0; i<static_cast<int> (mNeighbours.size()); ++i)
+                    {
+                        bool edge = false;
+
+                        if (reverse)
+                            edge = std::find (mNeighbours[i].begin(), mNeighbours[i].end(), current)!=mNeighbours[i].end();
+                        else
+                            edge = i!=current && std::find (mNeighbours[current].begin(), mNeighbours[current].end(), i)!=mNeighbours[current].end();
+
+                        if (edge && reached.insert (i).second)
+                            open.push_back (i);
+                    }
+                }
+
+                return reached;
+            }
+
+            bool isConnected (int start, int end) const
+            {
+                return getReachable (start, false).count (end) && getReachable (end, false).count (start);
+            }
+
+            /// The full scan the closest points used to be found with
+            int getClosestPoint (const Ogre::Vector3& pos, int start = -1) const
+            {
+                int closest = -1;
+                float distance = 0;
+
+                for (int i = 0; i<static_cast<int> (mPathgrid.mPoints.size()); ++i)
+                {
+                    const ESM::Pathgrid::Point& point = mPathgrid.mPoints[i];
+                    float potential = Ogre::Vector3 (static_cast<Ogre::Real> (point.mX),
+                        static_cast<Ogre::Real> (point.mY), static_cast<Ogre::Real> (point.mZ)).squaredDistance (pos);
+
+                    if ((closest==-1 || potential<distance) && (start==-1 || mGraph.isPointConnected (start, i)))
+                    {
+                        closest = i;
+                        distance = potential;
+                    }
+                }
+
+                return closest;
+            }
+
+            Ogre::Vector3 getRandomPosition()
+            {
+                return Ogre::Vector3 (static_cast<float> (random (11000) - 1000),
+                    static_cast<float> (random (11000) - 1000), static_cast<float> (random (600) - 150));
+            }
+
+            int getPointCount() const
+            {
+                return static_cast<int> (mPathgrid.mPoints.size());
+            }
+    };
+}
+
+TEST_F(PathgridTest, components_test)
+{
+    for (int i = 0; i<200; ++i)
+    {
+        int start = random (getPointCount());
+        int end = random (getPointCount());
+
+        ASSERT_EQ (mGraph.isPointConnected (start, end), isConnected (start, end)) << start << " " << end;
+    }
+
+    // the yard can be left, but not entered
+    int yard = getPointCount() - 12;
+    ASSERT_TRUE (mGraph.isPointConnected (yard, yard+1));
+    ASSERT_FALSE (mGraph.isPointConnected (yard, 0));
+}
+
+TEST_F(PathgridTest, closest_point_test)
+{
+    for (int i = 0; i<1000; ++i)
+    {
+        Ogre::Vector3 pos = getRandomPosition();
+        int start = random (getPointCount());
+
+        int closest = mGraph.getClosestPoint (pos);
+        ASSERT_EQ (closest, getClosestPoint (pos));
+
+        std::pair<int, bool> reachable = mGraph.getClosestReachablePoint (pos, start);
+        ASSERT_EQ (reachable.first, getClosestPoint (pos, start));
+        ASSERT_EQ (reachable.second, reachable.first==closest);
+    }
+
+    // points at the same distance
+    ASSERT_EQ (mGraph.getClosestPoint (Ogre::Vector3 (1050, 1000, 0)), getPointCount() - 12);
+}
+
+TEST_F(PathgridTest, path_test)
+{
+    for (int i = 0; i<300; ++i)
+    {
+        int start = random (getPointCount());
+        int end = random (getPointCount());
+
+        std::list<ESM::Pathgrid::Point> path = mGraph.aStarSearch (start, end);
+
+        if (!mGraph.isPointConnected (start, end))
+        {
+            ASSERT_TRUE (path.empty());
+            continue;
+        }
+
+        ASSERT_FALSE (path.empty());
+
+        // in world co-ordinates, following the edges from start to end
+        std::vector<int> points;
+
+        for (std::list<ESM::Pathgrid::Point>::const_iterator iter (path.begin()); iter!=path.end(); ++iter)
+        {
+            int index = -1;
+
+            for (int j = 0; j<getPointCount(); ++j)
+                if (mPathgrid.mPoints[j].mX + mPathgrid.mData.mX*ESM::Land::REAL_SIZE==iter->mX &&
+                    mPathgrid.mPoints[j].mY + mPathgrid.mData.mY*ESM::Land::REAL_SIZE==iter->mY &&
+                    mPathgrid.mPoints[j].mZ==iter->mZ)
+                    index = j;
+
+            ASSERT_NE (index, -1);
+
+            if (!points.empty())
+            {
+                ASSERT_TRUE (std::find (mNeighbours[points.back()].begin(), mNeighbours[points.back()].end(),
+                    index)!=mNeighbours[points.back()].end());
+            }
+
+            points.push_back (index);
+        }
+
+        ASSERT_EQ (points.front(), start);
+        ASSERT_EQ (points.back(), end);
+
+        // the second search of the same path is answered by the cache
+        std::list<ESM::Pathgrid::Point> again = mGraph.aStarSearch (start, end);
+        ASSERT_EQ (again.size(), path.size());
+    }
+}
+
+/// Report closest point and path searches per second, for paths that are mostly not cached and
+/// for paths that are searched for again and again, as with actors wandering between the same
+/// points.
+TEST_F(PathgridTest, DISABLED_search_benchmark)
+{
+    const int searches = 20000;
+
+    std::vector<std::pair<int, int> > pairs;
+    for (int i = 0; i<searches; ++i)
+        pairs.push_back (std::make_pair (random (getPointCount()), random (getPointCount())));
+
+    std::vector<Ogre::Vector3> positions;
+    for (int i = 0; i<searches; ++i)
+        positions.push_back (getRandomPosition());
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    int found = 0;
+    for (int i = 0; i<searches; ++i)
+        found += mGraph.getClosestPoint (positions[i]);
+
+    boost::posix_time::ptime closest = boost::posix_time::microsec_clock::universal_time();
+
+    std::size_t points = 0;
+    for (int i = 0; i<searches; ++i)
+        points += mGraph.aStarSearch (pairs[i].first, pairs[i].second).size();
+
+    boost::posix_time::ptime uncached = boost::posix_time::microsec_clock::universal_time();
+
+    for (int i = 0; i<searches; ++i)
+        points += mGraph.aStarSearch (pairs[i%8].first, pairs[i%8].second).size();
+
+    boost::posix_time::ptime cached = boost::posix_time::microsec_clock::universal_time();
+
+    std::cout
+        << "search_benchmark: " << getPointCount() << " points, " << mPathgrid.mEdges.size() << " edges, "
+        << searches / std::max ((closest - start).total_microseconds() / 1e6, 1e-6) << " closest points/s, "
+        << searches / std::max ((uncached - closest).total_microseconds() / 1e6, 1e-6) << " paths/s, "
+        << searches / std::max ((cached - uncached).total_microseconds() / 1e6, 1e-6) << " cached paths/s"
+        << std::endl;
+
+    ASSERT_GT (found, 0);
+    ASSERT_GT (points, 0u);
+}
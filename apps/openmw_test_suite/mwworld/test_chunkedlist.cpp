@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <list>
+#include <iostream>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <components/esm/cellref.hpp>
+
+#include "apps/openmw/mwworld/chunkedlist.hpp"
+
+namespace
+{
+    /// Stand-in for a LiveCellRef, of a similar size and layout
+    struct Reference
+    {
+        const void *mClass;
+        ESM::CellRef mRef;
+        int mCount;
+        bool mEnabled;
+        float mPosition[6];
+        void *mBaseNode;
+
+        Reference() : mClass (0), mCount (1), mEnabled (true), mBaseNode (0)
+        {}
+    };
+
+    struct CountEnabled
+    {
+        std::size_t mCount;
+
+        CountEnabled() : mCount (0) {}
+
+        bool operator() (const Reference& ref)
+        {
+            if (ref.mEnabled && ref.mCount>0)
+                ++mCount;
+            return true;
+        }
+    };
+
+    /// Same shape as CellStore::forEachImp
+    template<typename Functor, typename List>
+    bool forEachImp (Functor& functor, List& list)
+    {
+        for (typename List::iterator iter (list.begin()); iter!=list.end(); ++iter)
+            if (!functor (*iter))
+                return false;
+
+        return true;
+    }
+
+    template<typename List>
+    double timeForEach (std::vector<List>& lists, int passes, std::size_t& visited)
+    {
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+        for (int pass = 0; pass<passes; ++pass)
+        {
+            CountEnabled functor;
+
+            for (typename std::vector<List>::iterator iter (lists.begin()); iter!=lists.end(); ++iter)
+                forEachImp (functor, *iter);
+
+            visited += functor.mCount;
+        }
+
+        return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+    }
+}
+
+TEST(ChunkedListTest, stable_addresses_test)
+{
+    MWWorld::ChunkedList<Reference> list;
+    std::vector<Reference *> pointers;
+
+    ASSERT_TRUE (list.empty());
+    ASSERT_TRUE (list.begin()==list.end());
+
+    for (int i = 0; i<1000; ++i)
+    {
+        Reference ref;
+        ref.mCount = i;
+        list.push_back (ref);
+        pointers.push_back (&list.back());
+    }
+
+    ASSERT_TRUE (list.size()==1000);
+
+    int i = 0;
+    for (MWWorld::ChunkedList<Reference>::iterator iter (list.begin()); iter!=list.end(); ++iter, ++i)
+    {
+        ASSERT_TRUE (&*iter==pointers[i]);
+        ASSERT_TRUE (iter->mCount==i);
+    }
+
+    ASSERT_TRUE (i==1000);
+
+    MWWorld::ChunkedList<Reference>::iterator last = --list.end();
+    ASSERT_TRUE (last->mCount==999);
+    ASSERT_TRUE (list.front().mCount==0);
+
+    // an iterator stays valid while elements are added
+    MWWorld::ChunkedList<Reference>::const_iterator first = list.begin();
+    for (int j = 0; j<100; ++j)
+        list.push_back (Reference());
+    ASSERT_TRUE (&*first==pointers[0]);
+    ASSERT_TRUE ((++last)->mCount==1);
+
+    MWWorld::ChunkedList<Reference> copy (list);
+    ASSERT_TRUE (copy.size()==list.size());
+    ASSERT_TRUE (copy.front().mCount==0 && &copy.front()!=&list.front());
+
+    list.clear();
+    ASSERT_TRUE (list.empty());
+    ASSERT_TRUE (list.begin()==list.end());
+}
+
+/// Compare CellStore::forEach style iteration over the references of a large city cell when
+/// they are kept in std::lists and in ChunkedLists.
+TEST(ChunkedListTest, DISABLED_for_each_benchmark)
+{
+    // Roughly the reference counts per type of a busy cell in a town
+    const std::size_t counts[] = { 40, 10, 5, 10, 30, 20, 150, 40, 120, 20, 5, 10, 150, 5, 300, 5, 10, 1200, 30, 60 };
+    const std::size_t types = sizeof (counts) / sizeof (counts[0]);
+    const int passes = 2000;
+
+    std::vector<std::list<Reference> > lists (types);
+    std::vector<MWWorld::ChunkedList<Reference> > chunkedLists (types);
+
+    // interleave the insertions, like loading a cell does
+    for (std::size_t i = 0; i<1200; ++i)
+        for (std::size_t type = 0; type<types; ++type)
+            if (i<counts[type])
+            {
+                lists[type].push_back (Reference());
+                chunkedLists[type].push_back (Reference());
+            }
+
+    std::size_t visitedList = 0;
+    std::size_t visitedChunked = 0;
+
+    double listTime = timeForEach (lists, passes, visitedList);
+    double chunkedTime = timeForEach (chunkedLists, passes, visitedChunked);
+
+    ASSERT_TRUE (visitedList==visitedChunked);
+
+    std::cout << "for_each_benchmark: " << visitedList << " references visited, std::list "
+        << listTime << " s, ChunkedList " << chunkedTime << " s" << std::endl;
+}
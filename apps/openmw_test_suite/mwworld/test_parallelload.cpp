@@ -0,0 +1,340 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+
+#include <boost/shared_ptr.hpp>
+
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+#include <components/loadinglistener/loadinglistener.hpp>
+#include <components/misc/workqueue.hpp>
+
+#include "apps/openmw/mwworld/esmstore.hpp"
+
+namespace
+{
+    Loading::Listener dummyListener;
+
+    /// Reads the records of one content file on a worker thread, as EsmLoader does
+    class ParseFile : public Misc::WorkItem
+    {
+            const MWWorld::ESMStore& mStore;
+            ESM::ESMReader& mReader;
+
+        protected:
+
+            virtual void doWork()
+            {
+                mStore.parse (mReader, mBatch);
+            }
+
+        public:
+
+            MWWorld::LoadBatch mBatch;
+
+            ParseFile (const MWWorld::ESMStore& store, ESM::ESMReader& reader)
+            : mStore (store), mReader (reader)
+            {}
+    };
+
+    /// In-memory content file with a few records of each kind the loading treats differently
+    class ContentFile
+    {
+            ESM::ESMWriter mWriter;
+            std::ostringstream mStream;
+
+        public:
+
+            ContentFile (const std::string& master = "")
+            {
+                mWriter.setVersion();
+                mWriter.setFormat (0);
+
+                if (!master.empty())
+                    mWriter.addMaster (master, 0);
+
+                mWriter.save (mStream);
+            }
+
+            template<typename T>
+            void add (const T& record, bool deleted = false)
+            {
+                mWriter.startRecord (T::sRecordId);
+                record.save (mWriter, deleted);
+                mWriter.endRecord (T::sRecordId);
+            }
+
+            /// Return a new stream over the records added so far
+            Ogre::DataStreamPtr open (const std::string& name)
+            {
+                std::string data = mStream.str();
+                Ogre::MemoryDataStream *stream = new Ogre::MemoryDataStream (name, data.size());
+                std::memcpy (stream->getPtr(), data.data(), data.size());
+
+                return Ogre::DataStreamPtr (stream);
+            }
+    };
+
+    ESM::Apparatus makeApparatus (const std::string& id, const std::string& model)
+    {
+        ESM::Apparatus record;
+        record.blank();
+        record.mId = id;
+        record.mModel = model;
+        return record;
+    }
+
+    ESM::GameSetting makeSetting (const std::string& id, float value)
+    {
+        ESM::GameSetting record;
+        record.blank();
+        record.mId = id;
+        record.mValue.setType (ESM::VT_Float);
+        record.mValue.setFloat (value);
+        return record;
+    }
+
+    ESM::Dialogue makeDialogue (const std::string& id)
+    {
+        ESM::Dialogue record;
+        record.blank();
+        record.mId = id;
+        record.mType = ESM::Dialogue::Greeting;
+        return record;
+    }
+
+    ESM::DialInfo makeInfo (const std::string& id, const std::string& prev, const std::string& next,
+        const std::string& response)
+    {
+        ESM::DialInfo record;
+        record.blank();
+        record.mId = id;
+        record.mPrev = prev;
+        record.mNext = next;
+        record.mResponse = response;
+        return record;
+    }
+
+    template<typename T>
+    std::string saveRecord (const T& record)
+    {
+        ESM::ESMWriter writer;
+        std::ostringstream stream;
+        writer.setFormat (0);
+        writer.save (stream);
+        writer.startRecord (T::sRecordId);
+        record.save (writer);
+        writer.endRecord (T::sRecordId);
+        writer.close();
+        return stream.str();
+    }
+
+    template<typename T>
+    void compareRecords (const MWWorld::ESMStore& serial, const MWWorld::ESMStore& parallel)
+    {
+        const MWWorld::Store<T>& serialStore = serial.get<T>();
+        const MWWorld::Store<T>& parallelStore = parallel.get<T>();
+
+        ASSERT_EQ (serialStore.getSize(), parallelStore.getSize()) << T::getRecordType();
+
+        typename MWWorld::Store<T>::iterator parallelIter = parallelStore.begin();
+        for (typename MWWorld::Store<T>::iterator iter = serialStore.begin(); iter != serialStore.end();
+            ++iter, ++parallelIter)
+        {
+            ASSERT_EQ (iter->mId, parallelIter->mId) << T::getRecordType();
+            ASSERT_TRUE (saveRecord (*iter) == saveRecord (*parallelIter)) << iter->mId;
+            ASSERT_TRUE (serial.find (Misc::StringUtils::lowerCase (iter->mId)) ==
+                parallel.find (Misc::StringUtils::lowerCase (iter->mId))) << iter->mId;
+        }
+    }
+
+    void compareInfos (const MWWorld::ESMStore& serial, const MWWorld::ESMStore& parallel)
+    {
+        const MWWorld::Store<ESM::Dialogue>& serialStore = serial.get<ESM::Dialogue>();
+
+        for (MWWorld::Store<ESM::Dialogue>::iterator iter = serialStore.begin(); iter != serialStore.end(); ++iter)
+        {
+            const ESM::Dialogue *dialogue = parallel.get<ESM::Dialogue>().search (iter->mId);
+            ASSERT_TRUE (dialogue != 0);
+            ASSERT_EQ (iter->mInfo.size(), dialogue->mInfo.size()) << iter->mId;
+
+            ESM::Dialogue::InfoContainer::const_iterator info = dialogue->mInfo.begin();
+            for (ESM::Dialogue::InfoContainer::const_iterator serialInfo = iter->mInfo.begin();
+                serialInfo != iter->mInfo.end(); ++serialInfo, ++info)
+                ASSERT_TRUE (saveRecord (*serialInfo) == saveRecord (*info)) << serialInfo->mId;
+        }
+    }
+}
+
+/// Load a master and a plugin that overrides, deletes and adds records both serially and with
+/// the records parsed in parallel, and compare the resulting stores.
+TEST(ParallelLoadTest, parallel_matches_serial_test)
+{
+    ContentFile master;
+    master.add (makeApparatus ("appa_a", "a.nif"));
+    master.add (makeApparatus ("appa_b", "b.nif"));
+    master.add (makeApparatus ("appa_c", "c.nif"));
+    master.add (makeSetting ("fSetting", 1));
+    master.add (makeDialogue ("Hello"));
+    master.add (makeInfo ("1", "", "2", "first"));
+    master.add (makeInfo ("2", "1", "", "last"));
+
+    ContentFile plugin ("master.esm");
+    plugin.add (makeApparatus ("APPA_A", "a2.nif"));
+    plugin.add (makeApparatus ("appa_b", ""), true);
+    plugin.add (makeApparatus ("appa_d", "d.nif"));
+    plugin.add (makeSetting ("fSetting", 2));
+    plugin.add (makeDialogue ("hello"));
+    plugin.add (makeInfo ("3", "1", "2", "inserted"));
+    plugin.add (makeInfo ("2", "3", "", "changed"));
+    plugin.add (makeApparatus ("appa_c", "c2.nif"));
+
+    const char *names[] = { "master.esm", "plugin.esp" };
+    ContentFile *files[] = { &master, &plugin };
+
+    MWWorld::ESMStore serial;
+    MWWorld::ESMStore parallel;
+
+    std::vector<ESM::ESMReader*> serialReaders;
+    std::vector<ESM::ESMReader*> parallelReaders;
+    ESM::ESMReader readers[4];
+
+    for (int i = 0; i < 2; ++i)
+    {
+        readers[i].setIndex (i);
+        readers[i].setGlobalReaderList (&serialReaders);
+        readers[i].open (files[i]->open (names[i]), names[i]);
+        serialReaders.push_back (&readers[i]);
+
+        readers[2+i].setIndex (i);
+        readers[2+i].setGlobalReaderList (&parallelReaders);
+        readers[2+i].open (files[i]->open (names[i]), names[i]);
+        parallelReaders.push_back (&readers[2+i]);
+    }
+
+    for (int i = 0; i < 2; ++i)
+        serial.load (readers[i], &dummyListener);
+
+    Misc::WorkQueue queue (2);
+    std::vector<boost::shared_ptr<ParseFile> > items;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        items.push_back (boost::shared_ptr<ParseFile> (new ParseFile (parallel, readers[2+i])));
+        queue.addWorkItem (items.back());
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        items[i]->waitTillDone();
+        parallel.merge (readers[2+i], items[i]->mBatch, &dummyListener);
+    }
+
+    serial.setUp();
+    parallel.setUp();
+
+    ASSERT_EQ (serial.get<ESM::Apparatus>().getSize(), 3u);
+    ASSERT_TRUE (serial.get<ESM::Apparatus>().search ("appa_b") == 0);
+    ASSERT_EQ (serial.get<ESM::Apparatus>().find ("appa_a")->mModel, "a2.nif");
+    ASSERT_EQ (serial.get<ESM::Dialogue>().find ("hello")->mInfo.size(), 3u);
+
+    compareRecords<ESM::Apparatus> (serial, parallel);
+    compareRecords<ESM::GameSetting> (serial, parallel);
+    compareRecords<ESM::Dialogue> (serial, parallel);
+    compareInfos (serial, parallel);
+}
+
+/// Write a snapshot of the store loaded from a master and a plugin and check that restoring it
+/// gives the same records.
+TEST(ParallelLoadTest, snapshot_matches_load_test)
+{
+    ContentFile master;
+    master.add (makeApparatus ("appa_a", "a.nif"));
+    master.add (makeApparatus ("appa_b", "b.nif"));
+    master.add (makeSetting ("fSetting", 1));
+    master.add (makeDialogue ("Hello"));
+    master.add (makeInfo ("1", "", "2", "first"));
+    master.add (makeInfo ("2", "1", "", "last"));
+
+    ContentFile plugin ("master.esm");
+    plugin.add (makeApparatus ("appa_b", ""), true);
+    plugin.add (makeApparatus ("appa_c", "c.nif"));
+    plugin.add (makeDialogue ("hello"));
+    plugin.add (makeInfo ("3", "1", "2", "inserted"));
+
+    const char *names[] = { "master.esm", "plugin.esp" };
+    ContentFile *files[] = { &master, &plugin };
+
+    MWWorld::ESMStore loaded;
+    MWWorld::ESMStore restored;
+
+    std::vector<ESM::ESMReader*> loadedReaders;
+    std::vector<ESM::ESMReader*> restoredReaders;
+    ESM::ESMReader readers[4];
+
+    for (int i = 0; i < 2; ++i)
+    {
+        readers[i].setIndex (i);
+        readers[i].setGlobalReaderList (&loadedReaders);
+        readers[i].open (files[i]->open (names[i]), names[i]);
+        loadedReaders.push_back (&readers[i]);
+
+        readers[2+i].setIndex (i);
+        readers[2+i].setGlobalReaderList (&restoredReaders);
+        readers[2+i].open (files[i]->open (names[i]), names[i]);
+        restoredReaders.push_back (&readers[2+i]);
+    }
+
+    std::vector<boost::shared_ptr<ParseFile> > items;
+    std::vector<const MWWorld::LoadBatch*> batches;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        items.push_back (boost::shared_ptr<ParseFile> (new ParseFile (loaded, readers[i])));
+        items.back()->run();
+        items.back()->waitTillDone();
+        loaded.merge (readers[i], items.back()->mBatch, &dummyListener);
+        batches.push_back (&items.back()->mBatch);
+    }
+
+    ESM::ESMWriter writer;
+    std::ostringstream stream;
+    writer.setVersion();
+    writer.setFormat (0);
+    writer.save (stream);
+    loaded.writeSnapshot (writer, "key", batches);
+    writer.close();
+
+    std::string data = stream.str();
+
+    // A snapshot for other content files, one cut in the middle and one without the end marker
+    // are ignored, without changing the store
+    const char *keys[] = { "other", "key", "key", "key" };
+    const size_t sizes[] = { data.size(), data.size() / 2, data.size() - 16, data.size() };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        Ogre::MemoryDataStream *memory = new Ogre::MemoryDataStream ("snapshot", sizes[i]);
+        std::memcpy (memory->getPtr(), data.data(), sizes[i]);
+
+        ESM::ESMReader snapshot;
+        snapshot.open (Ogre::DataStreamPtr (memory), "snapshot");
+
+        ASSERT_EQ (restored.loadSnapshot (snapshot, keys[i], restoredReaders, &dummyListener), i == 3);
+
+        if (i < 3)
+            ASSERT_TRUE (restored.get<ESM::Apparatus>().search ("appa_a") == 0);
+    }
+
+    loaded.setUp();
+    restored.setUp();
+
+    ASSERT_EQ (restored.get<ESM::Apparatus>().getSize(), 2u);
+    ASSERT_EQ (restored.get<ESM::Dialogue>().find ("hello")->mInfo.size(), 3u);
+
+    compareRecords<ESM::Apparatus> (loaded, restored);
+    compareRecords<ESM::GameSetting> (loaded, restored);
+    compareRecords<ESM::Dialogue> (loaded, restored);
+    compareInfos (loaded, restored);
+}
@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <sstream>
+
 #include <boost/filesystem/fstream.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <components/files/configurationmanager.hpp>
 #include <components/esm/esmreader.hpp>
 #include <components/esm/esmwriter.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
+#include <components/misc/stringops.hpp>
 
 #include "apps/openmw/mwworld/esmstore.hpp"
 
@@ -313,3 +317,162 @@ TEST_F(StoreTest, overwrite_test)
 
     ASSERT_TRUE (overwrittenRec && overwrittenRec->mModel == "the_new_model");
 }
+
+/// Tests case-insensitive lookup of static and dynamic records, including after removals.
+TEST_F(StoreTest, case_insensitive_lookup_test)
+{
+    typedef ESM::Apparatus RecordType;
+
+    MWWorld::Store<RecordType> store;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        RecordType record;
+        record.blank();
+        std::ostringstream id;
+        id << "Record_" << i;
+        record.mId = id.str();
+        store.insertStatic(record);
+    }
+
+    RecordType dynamicRecord;
+    dynamicRecord.blank();
+    dynamicRecord.mId = "record_7";
+    dynamicRecord.mModel = "dynamic";
+    store.insert(dynamicRecord);
+
+    ASSERT_TRUE (store.search("RECORD_7") != NULL);
+    ASSERT_TRUE (store.search("RECORD_7")->mModel == "dynamic");
+    ASSERT_TRUE (store.isDynamic("Record_7"));
+    ASSERT_TRUE (store.search("record_1") != NULL);
+    ASSERT_TRUE (store.search("record_100") == NULL);
+    ASSERT_TRUE (store.search("record_") == NULL);
+
+    // the static record becomes visible again
+    store.erase("Record_7");
+    ASSERT_TRUE (!store.isDynamic("record_7"));
+    ASSERT_TRUE (store.search("record_7") != NULL);
+    ASSERT_TRUE (store.search("record_7")->mModel.empty());
+
+    for (int i = 0; i < 100; i += 2)
+    {
+        std::ostringstream id;
+        id << "RECORD_" << i;
+        store.eraseStatic(id.str());
+    }
+
+    ASSERT_TRUE (store.getSize() == 50);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        std::ostringstream id;
+        id << "record_" << i;
+        ASSERT_TRUE ((store.search(id.str()) != NULL) == (i % 2 == 1));
+    }
+
+    store.insert(dynamicRecord);
+    store.clearDynamic();
+    ASSERT_TRUE (store.search("record_7") != NULL);
+    ASSERT_TRUE (store.search("record_7")->mModel.empty());
+}
+
+/// Tests the game settings cache and the counting of game settings looked up by name.
+TEST_F(StoreTest, game_setting_cache_test)
+{
+    ESM::GameSetting alarmRadius;
+    alarmRadius.mId = "fAlarmRadius";
+    alarmRadius.mValue.setType(ESM::VT_Float);
+    alarmRadius.mValue.setFloat(2000.5f);
+
+    ESM::GameSetting crimeThreshold;
+    crimeThreshold.mId = "iCrimeThreshold";
+    crimeThreshold.mValue.setType(ESM::VT_Int);
+    crimeThreshold.mValue.setInteger(1000);
+
+    mEsmStore.overrideRecord(alarmRadius);
+    mEsmStore.overrideRecord(crimeThreshold);
+    mEsmStore.setCountGameSettingLookups(true);
+    mEsmStore.setUp();
+
+    const MWWorld::GameSettingCache& cache = mEsmStore.getGameSettingCache();
+    ASSERT_EQ (cache.fAlarmRadius, 2000.5f);
+    ASSERT_EQ (cache.iCrimeThreshold, 1000);
+    ASSERT_EQ (cache.fSneakUseDelay, 0.f); // missing
+
+    // setting up the cache is not reported
+    std::ostringstream report;
+    mEsmStore.reportGameSettingLookups(report);
+    ASSERT_TRUE (report.str().empty());
+
+    mEsmStore.get<ESM::GameSetting>().find("fAlarmRadius");
+    mEsmStore.get<ESM::GameSetting>().search("FALARMRADIUS");
+    mEsmStore.get<ESM::GameSetting>().search("fNoSuchSetting");
+    mEsmStore.reportGameSettingLookups(report);
+    ASSERT_EQ (report.str(), "Game settings looked up by name: falarmradius (2) fnosuchsetting (1)\n");
+
+    // the counts start again after each report
+    report.str("");
+    mEsmStore.reportGameSettingLookups(report);
+    ASSERT_TRUE (report.str().empty());
+
+    mEsmStore.setCountGameSettingLookups(false);
+    mEsmStore.get<ESM::GameSetting>().find("fAlarmRadius");
+    mEsmStore.reportGameSettingLookups(report);
+    ASSERT_TRUE (report.str().empty());
+}
+
+/// Compare the lookup throughput of the store against a lower case copy of the ID and a std::map search,
+/// which the store used to do.
+TEST_F(StoreTest, DISABLED_lookup_benchmark)
+{
+    typedef ESM::Apparatus RecordType;
+
+    const int recordCount = 5000;
+    const int passes = 100;
+
+    MWWorld::Store<RecordType> store;
+    std::map<std::string, RecordType> map;
+    std::vector<std::string> ids;
+
+    for (int i = 0; i < recordCount; ++i)
+    {
+        RecordType record;
+        record.blank();
+        std::ostringstream id;
+        id << "Benchmark_Record_" << i;
+        record.mId = id.str();
+        store.insertStatic(record);
+        map.insert(std::make_pair(Misc::StringUtils::lowerCase(record.mId), record));
+        ids.push_back(record.mId);
+    }
+
+    std::size_t found = 0;
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    for (int pass = 0; pass < passes; ++pass)
+        for (std::vector<std::string>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+        {
+            std::map<std::string, RecordType>::const_iterator iter = map.find(Misc::StringUtils::lowerCase(*it));
+            if (iter != map.end() && Misc::StringUtils::ciEqual(iter->second.mId, *it))
+                ++found;
+        }
+
+    double mapTime = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+
+    start = boost::posix_time::microsec_clock::universal_time();
+
+    for (int pass = 0; pass < passes; ++pass)
+        for (std::vector<std::string>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+            if (store.search(*it))
+                ++found;
+
+    double storeTime = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+
+    ASSERT_TRUE (found == 2 * ids.size() * passes);
+
+    double lookups = static_cast<double>(ids.size()) * passes;
+    std::cout << "lookup_benchmark: " << lookups << " lookups, std::map "
+              << (mapTime > 0 ? lookups / mapTime : 0) << "/s, store "
+              << (storeTime > 0 ? lookups / storeTime : 0) << "/s" << std::endl;
+}
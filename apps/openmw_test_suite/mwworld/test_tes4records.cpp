@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <zlib.h>
+
+#include <extern/esm4/sgst.hpp>
+
+#include <components/esm/esm4reader.hpp>
+#include <components/loadinglistener/loadinglistener.hpp>
+
+#include "apps/openmw/mwworld/esmstore.hpp"
+
+namespace
+{
+    Loading::Listener dummyListener;
+
+    /// Little-endian data of a TES4 content file
+    class Tes4Data
+    {
+            std::string mData;
+
+        public:
+
+            template<typename T>
+            void add (T value)
+            {
+                mData.append (reinterpret_cast<const char *> (&value), sizeof (T));
+            }
+
+            void addTag (const char *tag)
+            {
+                mData.append (tag, 4);
+            }
+
+            void addData (const std::string& data)
+            {
+                mData += data;
+            }
+
+            void addSubRecord (const char *tag, const std::string& data)
+            {
+                addTag (tag);
+                add (static_cast<std::uint16_t> (data.size()));
+                addData (data);
+            }
+
+            void addString (const char *tag, const std::string& value)
+            {
+                addSubRecord (tag, std::string (value.c_str(), value.size()+1));
+            }
+
+            /// Record with a TES4 header, i.e. without version and unknown
+            void addRecord (const char *tag, std::uint32_t flags, std::uint32_t formId, const std::string& data)
+            {
+                addTag (tag);
+                add (static_cast<std::uint32_t> (data.size()));
+                add (flags);
+                add (formId);
+                add (static_cast<std::uint32_t> (0)); // revision
+                addData (data);
+            }
+
+            void addGroup (const char *label, const std::string& records)
+            {
+                addTag ("GRUP");
+                add (static_cast<std::uint32_t> (20 + records.size()));
+                addTag (label);
+                add (static_cast<std::int32_t> (ESM4::Grp_RecordType));
+                add (static_cast<std::uint32_t> (0)); // stamp and unknown
+                addData (records);
+            }
+
+            const std::string& str() const
+            {
+                return mData;
+            }
+    };
+
+    std::string makeSigilStone (const std::string& editorId, const std::string& name, std::uint32_t value)
+    {
+        Tes4Data stats;
+        stats.add (static_cast<std::uint8_t> (3)); // uses
+        stats.add (value);
+        stats.add (0.5f); // weight
+
+        Tes4Data data;
+        data.addString ("EDID", editorId);
+        data.addString ("FULL", name);
+        data.addSubRecord ("DATA", stats.str());
+        return data.str();
+    }
+
+    std::string compressRecord (const std::string& data)
+    {
+        std::vector<Bytef> buffer (compressBound (data.size()));
+        uLongf size = buffer.size();
+        if (compress (&buffer[0], &size, reinterpret_cast<const Bytef *> (data.data()), data.size())!=Z_OK)
+            throw std::runtime_error ("compressing a test record failed");
+
+        Tes4Data compressed;
+        compressed.add (static_cast<std::uint32_t> (data.size()));
+        compressed.addData (std::string (reinterpret_cast<const char *> (&buffer[0]), size));
+        return compressed.str();
+    }
+
+    class Tes4RecordsTest : public testing::Test
+    {
+        protected:
+
+            std::string mPath;
+            std::string mLongId;
+            MWWorld::ESMStore mStore;
+
+            Tes4RecordsTest()
+            : mPath ((boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path ("tes4records-%%%%-%%%%.esm")).string()),
+              mLongId (200, 'x')
+            {}
+
+            ~Tes4RecordsTest()
+            {
+                std::remove (mPath.c_str());
+            }
+
+            /// Write a master with a group of sigil stones, the last one compressed, and a group
+            /// that is skipped, and load it
+            void load (ESM::ESM4Reader& reader)
+            {
+                Tes4Data version;
+                version.add (0.8f);
+                version.add (static_cast<std::int32_t> (4)); // records
+                version.add (static_cast<std::uint32_t> (0x1000)); // next object id
+
+                Tes4Data header;
+                header.addSubRecord ("HEDR", version.str());
+
+                Tes4Data stones;
+                stones.addRecord ("SGST", 0, 0x10, makeSigilStone ("StoneA", "Stone A", 10));
+                stones.addRecord ("SGST", 0, 0x11, makeSigilStone ("StoneB", "Stone B", 20));
+                stones.addRecord ("SGST", ESM4::Rec_Compressed, 0x12,
+                    compressRecord (makeSigilStone (mLongId, "Stone C", 30)));
+
+                Tes4Data globals;
+                globals.addRecord ("GLOB", 0, 0x20, std::string (16, '\0'));
+
+                Tes4Data file;
+                file.addRecord ("TES4", ESM4::Rec_ESM, 0, header.str());
+                file.addGroup ("SGST", stones.str());
+                file.addGroup ("GLOB", globals.str());
+
+                {
+                    std::ofstream stream (mPath.c_str(), std::ios::binary);
+                    stream.write (file.str().data(), file.str().size());
+                }
+
+                reader.setIndex (0);
+                reader.reader().setModIndex (0);
+                reader.openTes4File (mPath);
+                mStore.load (reader, &dummyListener);
+            }
+    };
+}
+
+TEST_F(Tes4RecordsTest, index_test)
+{
+    ESM::ESM4Reader reader (true);
+    load (reader);
+
+    const MWWorld::Tes4Records& records = mStore.getTes4Records();
+
+    ASSERT_EQ (3u, records.getSize());
+    ASSERT_EQ (static_cast<std::uint32_t> (ESM4::REC_SGST), records.getType (0x11));
+    ASSERT_EQ (0u, records.getType (0x20));
+
+    // nothing is read while loading
+    ASSERT_EQ (0u, records.getMaterializedCount());
+    ASSERT_EQ (0u, records.getInflatedCount());
+}
+
+TEST_F(Tes4RecordsTest, search_test)
+{
+    const MWWorld::Tes4Records& records = mStore.getTes4Records();
+
+    {
+        ESM::ESM4Reader reader (true);
+        load (reader);
+    }
+
+    // the records are read with readers of their own, after the one used for loading is gone
+    const ESM4::SigilStone *stone = records.search<ESM4::SigilStone> (0x11, ESM4::REC_SGST);
+    ASSERT_TRUE (stone != 0);
+    ASSERT_EQ ("StoneB", stone->mEditorId);
+    ASSERT_EQ ("Stone B", stone->mFullName);
+    ASSERT_EQ (20u, stone->mData.value);
+    ASSERT_EQ (0x11u, stone->mFormId);
+    ASSERT_EQ (1u, records.getMaterializedCount());
+    ASSERT_EQ (0u, records.getInflatedCount());
+
+    // a record that was read already is not read again
+    ASSERT_EQ (stone, records.search<ESM4::SigilStone> (0x11, ESM4::REC_SGST));
+    ASSERT_EQ (1u, records.getMaterializedCount());
+
+    // records can be read in any order
+    const ESM4::SigilStone *compressed = records.search<ESM4::SigilStone> (0x12, ESM4::REC_SGST);
+    ASSERT_TRUE (compressed != 0);
+    ASSERT_EQ (mLongId, compressed->mEditorId);
+    ASSERT_EQ (30u, compressed->mData.value);
+    ASSERT_EQ (2u, records.getMaterializedCount());
+    ASSERT_EQ (1u, records.getInflatedCount());
+
+    const ESM4::SigilStone *first = records.search<ESM4::SigilStone> (0x10, ESM4::REC_SGST);
+    ASSERT_TRUE (first != 0);
+    ASSERT_EQ ("StoneA", first->mEditorId);
+    ASSERT_EQ (3u, records.getMaterializedCount());
+    ASSERT_EQ (1u, records.getInflatedCount());
+}
+
+TEST_F(Tes4RecordsTest, search_missing_test)
+{
+    ESM::ESM4Reader reader (true);
+    load (reader);
+
+    const MWWorld::Tes4Records& records = mStore.getTes4Records();
+
+    ASSERT_TRUE (records.search<ESM4::SigilStone> (0x13, ESM4::REC_SGST) == 0);
+    ASSERT_TRUE (records.search<ESM4::SigilStone> (0x20, ESM4::REC_SGST) == 0);
+
+    // a record of another type is not read
+    ASSERT_TRUE (records.search<ESM4::SigilStone> (0x10, ESM4::REC_SLGM) == 0);
+    ASSERT_EQ (0u, records.getMaterializedCount());
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <OgreDataStream.h>
+
+#include <components/nifbullet/bulletnifloader.hpp>
+#include <components/nifbullet/shapeserializer.hpp>
+
+namespace
+{
+    /// Collects the triangles reported by a shape
+    struct TriangleList : public btTriangleCallback
+    {
+        std::vector<btVector3> mVertices;
+
+        virtual void processTriangle (btVector3* triangle, int partId, int triangleIndex)
+        {
+            mVertices.insert (mVertices.end(), triangle, triangle+3);
+        }
+    };
+
+    class ShapeSerializerTest : public testing::Test
+    {
+        protected:
+
+            OEngine::Physic::BulletShape mShape;
+
+            ShapeSerializerTest() : mShape (NULL, "test", 0, "General") {}
+
+            /// A grid of triangles, large enough for the BVH to have several nodes
+            static NifBullet::TriangleMeshShape *createTriangleMesh()
+            {
+                btTriangleMesh *mesh = new btTriangleMesh();
+
+                for (int x = 0; x<20; ++x)
+                    for (int y = 0; y<20; ++y)
+                    {
+                        btVector3 corner (x*10.f, y*10.f, static_cast<float> ((x*y) % 7));
+                        mesh->addTriangle (corner, corner + btVector3 (10, 0, 1), corner + btVector3 (0, 10, 2));
+                        mesh->addTriangle (corner + btVector3 (10, 0, 1), corner + btVector3 (10, 10, 3),
+                            corner + btVector3 (0, 10, 2));
+                    }
+
+                return new NifBullet::TriangleMeshShape (mesh, true);
+            }
+
+            /// The collision shape is a compound of a box and a triangle mesh, the raycasting
+            /// shape a triangle mesh on its own
+            void createShape()
+            {
+                btCompoundShape *compound = new btCompoundShape;
+                compound->addChildShape (btTransform (btQuaternion (btVector3 (0, 0, 1), 0.5f), btVector3 (1, 2, 3)),
+                    new btBoxShape (btVector3 (4, 5, 6)));
+                compound->addChildShape (btTransform (btQuaternion::getIdentity(), btVector3 (-10, 0, 0)),
+                    createTriangleMesh());
+
+                mShape.mCollisionShape = compound;
+                mShape.mRaycastingShape = createTriangleMesh();
+                mShape.mAutogenerated = false;
+                mShape.mCollide = false;
+                mShape.mBoxTranslation = Ogre::Vector3 (1, 2, 3);
+                mShape.mBoxRotation = Ogre::Quaternion (Ogre::Radian (1), Ogre::Vector3::UNIT_Z);
+                mShape.mAnimatedShapes[3] = 1;
+                mShape.mAnimatedRaycastingShapes[5] = 0;
+            }
+
+            static void deserialize (OEngine::Physic::BulletShape& shape, const std::string& data)
+            {
+                std::vector<char> buffer (data.begin(), data.end());
+                Ogre::MemoryDataStream stream (buffer.empty() ? NULL : &buffer[0], buffer.size());
+                NifBullet::deserializeShape (shape, stream);
+            }
+
+            static std::string serialize (const OEngine::Physic::BulletShape& shape)
+            {
+                std::ostringstream stream;
+                NifBullet::serializeShape (shape, stream);
+                return stream.str();
+            }
+
+            static std::vector<btVector3> getTriangles (const btConcaveShape& shape, const btVector3& min,
+                const btVector3& max)
+            {
+                TriangleList triangles;
+                shape.processAllTriangles (&triangles, min, max);
+                return triangles.mVertices;
+            }
+
+            static void compareShapes (const btCollisionShape *expected, const btCollisionShape *shape)
+            {
+                ASSERT_TRUE (expected != NULL);
+                ASSERT_TRUE (shape != NULL);
+                ASSERT_EQ (expected->getShapeType(), shape->getShapeType());
+
+                if (expected->isCompound())
+                {
+                    const btCompoundShape *expectedCompound = static_cast<const btCompoundShape *> (expected);
+                    const btCompoundShape *compound = static_cast<const btCompoundShape *> (shape);
+
+                    ASSERT_EQ (expectedCompound->getNumChildShapes(), compound->getNumChildShapes());
+
+                    for (int i = 0; i<compound->getNumChildShapes(); ++i)
+                    {
+                        const btTransform& expectedTransform = expectedCompound->getChildTransform (i);
+                        const btTransform& transform = compound->getChildTransform (i);
+                        ASSERT_TRUE (expectedTransform.getOrigin() == transform.getOrigin());
+                        ASSERT_TRUE (expectedTransform.getBasis() == transform.getBasis());
+
+                        compareShapes (expectedCompound->getChildShape (i), compound->getChildShape (i));
+                    }
+                }
+                else if (const btBoxShape *expectedBox = dynamic_cast<const btBoxShape *> (expected))
+                {
+                    const btBoxShape *box = static_cast<const btBoxShape *> (shape);
+                    ASSERT_TRUE (expectedBox->getHalfExtentsWithMargin() == box->getHalfExtentsWithMargin());
+                }
+                else
+                {
+                    NifBullet::TriangleMeshShape *expectedMesh = const_cast<NifBullet::TriangleMeshShape *> (
+                        dynamic_cast<const NifBullet::TriangleMeshShape *> (expected));
+                    NifBullet::TriangleMeshShape *mesh = const_cast<NifBullet::TriangleMeshShape *> (
+                        dynamic_cast<const NifBullet::TriangleMeshShape *> (shape));
+                    ASSERT_TRUE (expectedMesh != NULL);
+                    ASSERT_TRUE (mesh != NULL);
+
+                    ASSERT_TRUE (expectedMesh->getLocalScaling() == mesh->getLocalScaling());
+                    ASSERT_EQ (expectedMesh->getMeshInterface()->getNumSubParts(), mesh->getMeshInterface()->getNumSubParts());
+
+                    // the BVH read with the mesh is used, and finds the same triangles
+                    ASSERT_TRUE (mesh->getOptimizedBvh() != NULL);
+                    ASSERT_EQ (expectedMesh->getOptimizedBvh()->calculateSerializeBufferSize(),
+                        mesh->getOptimizedBvh()->calculateSerializeBufferSize());
+
+                    btVector3 min (-1e6f, -1e6f, -1e6f);
+                    btVector3 max (1e6f, 1e6f, 1e6f);
+                    std::vector<btVector3> all = getTriangles (*mesh, min, max);
+                    ASSERT_EQ (all.size(), 20u*20u*2u*3u);
+                    ASSERT_TRUE (getTriangles (*expectedMesh, min, max) == all);
+
+                    btVector3 regionMin (35, 35, -1);
+                    btVector3 regionMax (75, 55, 10);
+                    std::vector<btVector3> region = getTriangles (*mesh, regionMin, regionMax);
+                    ASSERT_FALSE (region.empty());
+                    ASSERT_LT (region.size(), all.size());
+                    ASSERT_TRUE (getTriangles (*expectedMesh, regionMin, regionMax) == region);
+                }
+            }
+    };
+}
+
+TEST_F(ShapeSerializerTest, round_trip_test)
+{
+    createShape();
+    std::string data = serialize (mShape);
+
+    OEngine::Physic::BulletShape restored (NULL, "restored", 0, "General");
+    deserialize (restored, data);
+
+    ASSERT_EQ (restored.mAutogenerated, mShape.mAutogenerated);
+    ASSERT_EQ (restored.mCollide, mShape.mCollide);
+    ASSERT_EQ (restored.mBoxTranslation, mShape.mBoxTranslation);
+    ASSERT_TRUE (restored.mBoxRotation.equals (mShape.mBoxRotation, Ogre::Radian (1e-6f)));
+    ASSERT_TRUE (restored.mAnimatedShapes == mShape.mAnimatedShapes);
+    ASSERT_TRUE (restored.mAnimatedRaycastingShapes == mShape.mAnimatedRaycastingShapes);
+
+    compareShapes (mShape.mCollisionShape, restored.mCollisionShape);
+    compareShapes (mShape.mRaycastingShape, restored.mRaycastingShape);
+}
+
+TEST_F(ShapeSerializerTest, box_test)
+{
+    mShape.mCollisionShape = new btBoxShape (btVector3 (1, 2, 3));
+
+    OEngine::Physic::BulletShape restored (NULL, "restored", 0, "General");
+    deserialize (restored, serialize (mShape));
+
+    compareShapes (mShape.mCollisionShape, restored.mCollisionShape);
+    ASSERT_TRUE (restored.mRaycastingShape == NULL);
+}
+
+TEST_F(ShapeSerializerTest, truncated_test)
+{
+    createShape();
+    std::string data = serialize (mShape);
+
+    // cutting the data anywhere, or changing the header, must not give a shape
+    std::vector<std::string> damaged;
+    for (std::size_t size = 0; size<data.size(); size += size<64 ? 1 : 97)
+        damaged.push_back (data.substr (0, size));
+    damaged.push_back (data.substr (0, data.size()-1));
+
+    for (std::size_t i = 0; i<4; ++i)
+    {
+        std::string header (data);
+        header[i*4] ^= 1;
+        damaged.push_back (header);
+    }
+
+    for (std::vector<std::string>::const_iterator iter (damaged.begin()); iter!=damaged.end(); ++iter)
+    {
+        OEngine::Physic::BulletShape restored (NULL, "restored", 0, "General");
+        ASSERT_THROW (deserialize (restored, *iter), std::runtime_error) << iter->size();
+
+        ASSERT_TRUE (restored.mCollisionShape == NULL);
+        ASSERT_TRUE (restored.mRaycastingShape == NULL);
+        ASSERT_TRUE (restored.mAutogenerated);
+        ASSERT_TRUE (restored.mCollide);
+        ASSERT_TRUE (restored.mAnimatedShapes.empty());
+        ASSERT_TRUE (restored.mAnimatedRaycastingShapes.empty());
+    }
+}
@@ -23,9 +23,10 @@
 
 #include "bsa_archive.hpp"
 
-#include <map>
+#include <vector>
 
 #include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include <OgreFileSystem.h>
@@ -44,9 +45,10 @@
 #define OGRE_CONST
 #endif
 
-#include <extern/BSAOpt/hash.hpp>
 #include "bsa_file.hpp"
 #include "tes4bsa_file.hpp"
+#include "hashindex.hpp"
+#include "vfs.hpp"
 
 #include "../files/constrainedfiledatastream.hpp"
 
@@ -65,7 +67,7 @@ namespace
 
     // FIXME: not tested unicode path and filenames
     DWORD indexFiles(const std::string& rootDir, const std::string& subdir,
-                     std::map<std::uint64_t, std::string>& files, std::map<std::string, std::string>& index)
+                     std::vector<std::pair<std::string, std::string> >& index)
     {
         HANDLE hFind = INVALID_HANDLE_VALUE;
         WIN32_FIND_DATA ffd;
@@ -94,17 +96,9 @@ namespace
             }
             else
             {
-                std::uint64_t folderHash = GenOBHash(subdir, filename);
-
-                std::map<std::uint64_t, std::string>::iterator iter = files.find(folderHash);
-                if (iter != files.end())
-                    throw std::runtime_error ("duplicate hash found");
-
-                files[folderHash] = path + "\\" + filename;
-
                 std::string entry = ((subdir == "") ? "" : subdir + "\\") + filename;
                 std::replace(entry.begin(), entry.end(), '\\', '/');
-                index.insert(std::make_pair (entry, path + "/" + filename));
+                index.push_back(std::make_pair (entry, path + "/" + filename));
             }
         } while (FindNextFile(hFind, &ffd) != 0);
 
@@ -121,7 +115,7 @@ namespace
                 std::string dir = subDirs->at(i);
                 boost::algorithm::to_lower(dir);
                 // FIXME: ignoring errors for now
-                dwError = indexFiles(rootDir, ((subdir == "") ? "" : subdir + "\\") + dir, files, index);
+                dwError = indexFiles(rootDir, ((subdir == "") ? "" : subdir + "\\") + dir, index);
             }
         }
 
@@ -159,16 +153,84 @@ static std::string normalize_path(T1 begin, T2 end)
 /// An OGRE Archive wrapping a BSAFile archive
 class DirArchive: public Ogre::Archive
 {
-    typedef std::map <std::string, std::string> index;
+    struct Entry
+    {
+        std::string mName; // normalized
+        std::string mPath;
+
+        bool operator< (const Entry& entry) const { return mName < entry.mName; }
+        bool operator== (const Entry& entry) const { return mName == entry.mName; }
+    };
 
+    typedef std::vector<Entry> index;
+
+    /// sorted by normalized name
     index mIndex;
 
-    std::map <std::uint64_t, std::string> mFiles;
+    Bsa::HashIndex mLookup;
+
+    /// FNV-1a of the normalized path, without building the normalized string
+    static std::uint64_t hashName (std::string const & filename)
+    {
+        char (*normalize_char)(char) = fsstrict ? &strict_normalize_char : &nonstrict_normalize_char;
+
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::string::const_iterator iter = filename.begin (); iter != filename.end (); ++iter)
+        {
+            hash ^= static_cast<unsigned char> (normalize_char (*iter));
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    struct MatchName
+    {
+        const index& mIndex;
+        const std::string& mName;
+
+        MatchName (const index& entries, const std::string& name) : mIndex (entries), mName (name) {}
+
+        bool operator() (std::uint32_t i) const
+        {
+            const std::string& candidate = mIndex[i].mName;
+
+            if (candidate.size () != mName.size ())
+                return false;
+
+            char (*normalize_char)(char) = fsstrict ? &strict_normalize_char : &nonstrict_normalize_char;
+
+            for (std::size_t c = 0; c < candidate.size (); ++c)
+                if (candidate[c] != normalize_char (mName[c]))
+                    return false;
+
+            return true;
+        }
+    };
 
     index::const_iterator lookup_filename (std::string const & filename) const
     {
-        std::string normalized = normalize_path (filename.begin (), filename.end ());
-        return mIndex.find (normalized);
+        std::uint32_t i = mLookup.find (hashName (filename), MatchName (mIndex, filename));
+        return i == Bsa::HashIndex::sNotFound ? mIndex.end () : mIndex.begin () + i;
+    }
+
+    void buildIndex (const std::vector<std::pair<std::string, std::string> >& files)
+    {
+        mIndex.resize (files.size ());
+
+        for (std::size_t i = 0; i < files.size (); ++i)
+        {
+            mIndex[i].mName = normalize_path (files[i].first.begin (), files[i].first.end ());
+            mIndex[i].mPath = files[i].second;
+        }
+
+        // the first file found wins if names only differ in case
+        std::stable_sort (mIndex.begin (), mIndex.end ());
+        mIndex.erase (std::unique (mIndex.begin (), mIndex.end ()), mIndex.end ());
+
+        mLookup.reserve (mIndex.size ());
+        for (std::size_t i = 0; i < mIndex.size (); ++i)
+            mLookup.insert (hashName (mIndex[i].mName), static_cast<std::uint32_t> (i));
     }
 
 public:
@@ -176,8 +238,10 @@ public:
     DirArchive(const String& name)
         : Archive(name, "Dir")
     {
+        std::vector<std::pair<std::string, std::string> > files;
+
 #if defined _WIN32 || defined _WIN64
-        indexFiles(name, "", mFiles, mIndex);
+        indexFiles(name, "", files);
 #else
 
         typedef boost::filesystem::recursive_directory_iterator directory_iterator;
@@ -196,11 +260,11 @@ public:
 
             std::string proper = i->path ().string ();
 
-            std::string searchable = normalize_path (proper.begin () + prefix, proper.end ());
-
-            mIndex.insert (std::make_pair (searchable, proper));
+            files.push_back (std::make_pair (proper.substr (prefix), proper));
         }
 #endif
+
+        buildIndex (files);
     }
 
     bool isCaseSensitive() const { return fsstrict; }
@@ -211,27 +275,6 @@ public:
 
     virtual DataStreamPtr open(const String& filename, bool readonly = true) const
     {
-#if defined _WIN32 || defined _WIN64
-        boost::filesystem::path p(filename);
-        std::string file = p.filename().string();
-
-        p.remove_filename();
-        std::string dir = p.string();
-        boost::algorithm::to_lower(dir);
-        std::replace(dir.begin(), dir.end(), '/', '\\');
-
-        std::uint64_t hash = GenOBHash(dir, file);
-
-        std::map<std::uint64_t, std::string>::const_iterator it = mFiles.find(hash);
-        if (it == mFiles.end())
-        {
-            std::ostringstream os;
-            os << "The file '" << filename << "' could not be found.";
-            throw std::runtime_error (os.str());
-        }
-
-        return openConstrainedFileDataStream (it->second.c_str());
-#else
         index::const_iterator i = lookup_filename (filename);
 
         if (i == mIndex.end ())
@@ -241,8 +284,7 @@ public:
             throw std::runtime_error (os.str ());
         }
 
-        return openConstrainedFileDataStream (i->second.c_str ());
-#endif
+        return openConstrainedFileDataStream (i->mPath.c_str ());
     }
 
     StringVectorPtr list(bool recursive = true, bool dirs = false) const
@@ -262,34 +304,16 @@ public:
         StringVectorPtr ptr = StringVectorPtr(new StringVector());
         for(index::const_iterator iter = mIndex.begin();iter != mIndex.end();++iter)
         {
-            if(Ogre::StringUtil::match(iter->first, normalizedPattern) ||
-               (recursive && Ogre::StringUtil::match(iter->first, "*/"+normalizedPattern)))
-                ptr->push_back(iter->first);
+            if(Ogre::StringUtil::match(iter->mName, normalizedPattern) ||
+               (recursive && Ogre::StringUtil::match(iter->mName, "*/"+normalizedPattern)))
+                ptr->push_back(iter->mName);
         }
         return ptr;
     }
 
     bool exists(const String& filename) const
     {
-#if defined _WIN32 || defined _WIN64
-        boost::filesystem::path p(filename);
-        std::string file = p.filename().string();
-
-        p.remove_filename();
-        std::string dir = p.string();
-        boost::algorithm::to_lower(dir);
-        std::replace(dir.begin(), dir.end(), '/', '\\');
-
-        std::uint64_t hash = GenOBHash(dir, file);
-
-        std::map<std::uint64_t, std::string>::const_iterator it = mFiles.find(hash);
-        if (it == mFiles.end())
-            return false;
-
-        return true;
-#else
         return lookup_filename(filename) != mIndex.end ();
-#endif
     }
 
     time_t getModifiedTime(const String&) const { return 0; }
@@ -300,17 +324,17 @@ public:
         std::string normalizedPattern = normalize_path(pattern.begin(), pattern.end());
         FileInfoListPtr ptr = FileInfoListPtr(new FileInfoList());
 
-        index::const_iterator i = mIndex.find(normalizedPattern);
+        index::const_iterator i = lookup_filename(normalizedPattern);
         if(i != mIndex.end())
         {
-            std::string::size_type pt = i->first.rfind('/');
+            std::string::size_type pt = i->mName.rfind('/');
             if(pt == std::string::npos)
                 pt = 0;
 
             FileInfo fi;
             fi.archive = const_cast<DirArchive*>(this);
-            fi.path = i->first.substr(0, pt);
-            fi.filename = i->first.substr((i->first[pt]=='/') ? pt+1 : pt);
+            fi.path = i->mName.substr(0, pt);
+            fi.filename = i->mName.substr((i->mName[pt]=='/') ? pt+1 : pt);
             fi.compressedSize = fi.uncompressedSize = 0;
 
             ptr->push_back(fi);
@@ -319,17 +343,17 @@ public:
         {
             for(index::const_iterator iter = mIndex.begin();iter != mIndex.end();++iter)
             {
-                if(Ogre::StringUtil::match(iter->first, normalizedPattern) ||
-                   (recursive && Ogre::StringUtil::match(iter->first, "*/"+normalizedPattern)))
+                if(Ogre::StringUtil::match(iter->mName, normalizedPattern) ||
+                   (recursive && Ogre::StringUtil::match(iter->mName, "*/"+normalizedPattern)))
                 {
-                    std::string::size_type pt = iter->first.rfind('/');
+                    std::string::size_type pt = iter->mName.rfind('/');
                     if(pt == std::string::npos)
                         pt = 0;
 
                     FileInfo fi;
                     fi.archive = const_cast<DirArchive*>(this);
-                    fi.path = iter->first.substr(0, pt);
-                    fi.filename = iter->first.substr((iter->first[pt]=='/') ? pt+1 : pt);
+                    fi.path = iter->mName.substr(0, pt);
+                    fi.filename = iter->mName.substr((iter->mName[pt]=='/') ? pt+1 : pt);
                     fi.compressedSize = fi.uncompressedSize = 0;
 
                     ptr->push_back(fi);
@@ -445,7 +469,7 @@ class TES4BSAArchive : public BSAArchive
   Bsa::TES4BSAFile arc;
 
 public:
-  TES4BSAArchive::TES4BSAArchive(const String& name) : BSAArchive(name, "TES4BSA") { arc.open(name); }
+  TES4BSAArchive(const String& name) : BSAArchive(name, "TES4BSA") { arc.open(name); }
 
   virtual DataStreamPtr open(const String& filename, bool readonly = true) const
   {
@@ -457,6 +481,59 @@ public:
   {
     return arc.exists(filename);
   }
+
+  bool isCompressed(const String& filename) const
+  {
+    return arc.isCompressed(filename);
+  }
+
+    virtual StringVectorPtr find(const String& pattern, bool recursive = true,
+                         bool dirs = false) const
+    {
+        std::string normalizedPattern = normalize_path(pattern.begin(), pattern.end());
+        const Bsa::TES4BSAFile::FileList &filelist = arc.getList();
+        StringVectorPtr ptr = StringVectorPtr(new StringVector());
+        for(Bsa::TES4BSAFile::FileList::const_iterator iter = filelist.begin();iter != filelist.end();++iter)
+        {
+            std::string name = arc.getFileName(*iter);
+            std::string ent = normalize_path(name.begin(), name.end());
+            if(Ogre::StringUtil::match(ent, normalizedPattern) ||
+               (recursive && Ogre::StringUtil::match(ent, "*/"+normalizedPattern)))
+                ptr->push_back(name);
+        }
+        return ptr;
+    }
+
+    virtual FileInfoListPtr findFileInfo(const String& pattern, bool recursive = true,
+                                bool dirs = false) const
+    {
+        std::string normalizedPattern = normalize_path(pattern.begin(), pattern.end());
+        FileInfoListPtr ptr = FileInfoListPtr(new FileInfoList());
+        const Bsa::TES4BSAFile::FileList &filelist = arc.getList();
+
+        for(Bsa::TES4BSAFile::FileList::const_iterator iter = filelist.begin();iter != filelist.end();++iter)
+        {
+            std::string name = arc.getFileName(*iter);
+            std::string ent = normalize_path(name.begin(), name.end());
+            if(Ogre::StringUtil::match(ent, normalizedPattern) ||
+                (recursive && Ogre::StringUtil::match(ent, "*/"+normalizedPattern)))
+            {
+                std::string::size_type pt = ent.rfind('/');
+                if(pt == std::string::npos)
+                    pt = 0;
+
+                FileInfo fi;
+                fi.archive = const_cast<TES4BSAArchive*>(this);
+                fi.path = name.substr(0, pt);
+                fi.filename = name.substr((ent[pt]=='/') ? pt+1 : pt);
+                fi.compressedSize = fi.uncompressedSize = iter->size & ~(1<<30);
+
+                ptr->push_back(fi);
+            }
+        }
+
+        return ptr;
+    }
 };
 
 // An archive factory for BSA archives
@@ -527,10 +604,47 @@ public:
 };
 
 
+// Hands a VFS built by registerResources() over to the Ogre archive manager
+class VFSArchiveFactory : public ArchiveFactory
+{
+  Bsa::VFS *mPending;
+
+public:
+  VFSArchiveFactory() : mPending(0) {}
+
+  const String& getType() const
+  {
+    static String name = "VFS";
+    return name;
+  }
+
+  void setPending(Bsa::VFS *vfs) { mPending = vfs; }
+
+  Archive *createInstance( const String& name )
+  {
+    if (!mPending)
+        throw std::runtime_error ("No virtual file system to register as '" + name + "'");
+
+    Bsa::VFS *vfs = mPending;
+    mPending = 0;
+    return vfs;
+  }
+
+  virtual Archive* createInstance(const String& name, bool readOnly)
+  {
+    return createInstance(name);
+  }
+
+  void destroyInstance( Archive* arch) { delete arch; }
+};
+
+
 static bool init = false;
 static bool init2 = false;
 static bool init3 = false;
 
+static VFSArchiveFactory *vfsFactory = 0;
+
 static void insertBSAFactory()
 {
   if(!init)
@@ -562,8 +676,6 @@ static void insertDirFactory()
 namespace Bsa
 {
 
-// The function below is the only publicly exposed part of this file
-
 void addBSA(const std::string& name, const std::string& group)
 {
   insertBSAFactory();
@@ -587,4 +699,60 @@ void addDir(const std::string& name, const bool& fs, const std::string& group)
     addResourceLocation(name, "Dir", group, true);
 }
 
+void addVFS(VFS *vfs, const std::string& group)
+{
+    if (!vfsFactory)
+    {
+        vfsFactory = new VFSArchiveFactory;
+        ArchiveManager::getSingleton().addArchiveFactory(vfsFactory);
+    }
+
+    vfsFactory->setPending(vfs);
+
+    ResourceGroupManager::getSingleton().
+    addResourceLocation(vfs->getName(), "VFS", group, true);
+}
+
+Ogre::Archive *createBSAArchive(const std::string& name)
+{
+    return new BSAArchive(name);
+}
+
+Ogre::Archive *createTES4BSAArchive(const std::string& name)
+{
+    return new TES4BSAArchive(name);
+}
+
+Ogre::Archive *createDirArchive(const std::string& name, bool fs)
+{
+    fsstrict = fs;
+    return new DirArchive(name);
+}
+
+bool isCompressed(const Ogre::Archive *archive, const std::string& name)
+{
+    // Morrowind archives and directories never compress
+    if (archive->getType() != "TES4BSA")
+        return false;
+
+    return static_cast<const TES4BSAArchive *>(archive)->isCompressed(name);
+}
+
+Ogre::Archive *createArchive(const std::string& name, bool fs)
+{
+    if (boost::filesystem::is_directory(name))
+        return createDirArchive(name, fs);
+
+    boost::filesystem::ifstream input(boost::filesystem::path(name), std::ios_base::binary);
+
+    char magic[4] = { 0, 0, 0, 0 };
+    input.read(magic, 4);
+
+    // TES4 archives start with "BSA\0", Morrowind ones with their version number
+    if (magic[0] == 'B' && magic[1] == 'S' && magic[2] == 'A' && magic[3] == 0)
+        return createTES4BSAArchive(name);
+
+    return createBSAArchive(name);
+}
+
 }
@@ -27,15 +27,38 @@
 #ifndef BSA_BSA_ARCHIVE_H
 #define BSA_BSA_ARCHIVE_H
 
+namespace Ogre
+{
+    class Archive;
+}
+
 namespace Bsa
 {
 
+class VFS;
+
 /// Add the given BSA file as an input archive in the Ogre resource
 /// system.
 void addBSA(const std::string& file, const std::string& group="General");
 void addTES4BSA(const std::string& file, const std::string& group="General");
 void addDir(const std::string& file, const bool& fs, const std::string& group="General");
 
+/// Add a built VFS as the only location of \a group. Ownership passes to the Ogre
+/// archive manager.
+void addVFS(VFS *vfs, const std::string& group="General");
+
+/// Create archives without registering them with Ogre, e.g. for adding them to a VFS.
+Ogre::Archive *createBSAArchive(const std::string& file);
+Ogre::Archive *createTES4BSAArchive(const std::string& file);
+Ogre::Archive *createDirArchive(const std::string& file, bool fs);
+
+/// Create a directory, BSA or TES4 BSA archive depending on what \a file is.
+Ogre::Archive *createArchive(const std::string& file, bool fs);
+
+/// Check if \a file is stored compressed in \a archive, which must have been created by one of
+/// the functions above.
+bool isCompressed(const Ogre::Archive *archive, const std::string& file);
+
 }
 
 #endif
@@ -33,7 +33,13 @@
 
 namespace
 {
+    char toLower(char ch)
+    {
+        return (ch >= 'A' && ch <= 'Z') ? ch - 'A' + 'a' : ch;
+    }
+
     // see: http://en.uesp.net/wiki/Tes3Mod:BSA_File_Format
+    // name is lowered on the fly, so lookups do not need a temporary copy
     std::uint64_t getHash(const char *name)
     {
         unsigned int len = (unsigned int)strlen(name);
@@ -43,13 +49,13 @@ namespace
         unsigned sum, off, temp, i, n, hash1;
 
         for(sum = off = i = 0; i < l; i++) {
-            sum ^= (((unsigned)(name[i]))<<(off&0x1F));
+            sum ^= (((unsigned)(toLower(name[i])))<<(off&0x1F));
             off += 8;
         }
         hash1 = sum;
 
         for(sum = off = 0; i < len; i++) {
-            temp = (((unsigned)(name[i]))<<(off&0x1F));
+            temp = (((unsigned)(toLower(name[i])))<<(off&0x1F));
             sum ^= temp;
             n = temp & 0x1F;
             sum = (sum << (32-n)) | (sum >> n);  // binary "rotate right"
@@ -179,10 +185,11 @@ void BSAFile::readHeader()
     }
 
     std::uint64_t hash;
+    mIndex.reserve(filenum);
     for (size_t i = 0; i < filenum; ++i)
     {
         input.read(reinterpret_cast<char*>(&hash), 8);
-        mFiles[hash] = files[i];
+        mIndex.insert(hash, static_cast<std::uint32_t>(i));
     }
 
     isLoaded = true;
@@ -191,12 +198,9 @@ void BSAFile::readHeader()
 /// Get the index of a given file name, or -1 if not found
 int BSAFile::getIndex(const char *str) const
 {
-    std::string name(str);
-    boost::algorithm::to_lower(name);
-    std::uint64_t hash = getHash(name.c_str());
-    std::map<std::uint64_t, FileStruct>::const_iterator iter = mFiles.find(hash);
-    if (iter != mFiles.end())
-        return 0; // NOTE: this is a bit of a hack, exists() only checks for '-1'
+    std::uint32_t index = mIndex.find(getHash(str));
+    if (index != HashIndex::sNotFound)
+        return static_cast<int>(index);
     else
         return -1;
 }
@@ -212,14 +216,10 @@ Ogre::DataStreamPtr BSAFile::getFile(const char *file)
 {
     assert(file);
 
-    std::string name(file);
-    boost::algorithm::to_lower(name);
-    std::uint64_t hash = getHash(name.c_str());
-    std::map<std::uint64_t, FileStruct>::const_iterator it = mFiles.find(hash);
-    if (it != mFiles.end())
-    {
-        const FileStruct &fs = it->second;
-        return openConstrainedFileDataStream (filename.c_str (), fs.offset, fs.fileSize);
-    }
+    int i = getIndex(file);
+    if(i == -1)
         fail("File not found: " + string(file));
+
+    const FileStruct &fs = files[i];
+    return openConstrainedFileDataStream (filename.c_str (), fs.offset, fs.fileSize);
 }
@@ -32,6 +32,8 @@
 
 #include <OgreDataStream.h>
 
+#include "hashindex.hpp"
+
 
 namespace Bsa
 {
@@ -82,7 +84,8 @@ private:
     typedef std::map<const char*, int, iltstr> Lookup;
     Lookup lookup;
 
-    std::map<std::uint64_t, FileStruct> mFiles;
+    /// Keyed by the hashes stored in the archive, values are indices into files[]
+    HashIndex mIndex;
 
     /// Error handling
     void fail(const std::string &msg);
@@ -0,0 +1,103 @@
+#include "hashindex.hpp"
+
+namespace Bsa
+{
+    const std::uint32_t HashIndex::sNotFound;
+
+    boost::atomic<std::size_t> HashIndex::sLookups (0);
+    boost::atomic<std::size_t> HashIndex::sProbes (0);
+
+    HashIndex::HashIndex() : mMask (0), mSize (0) {}
+
+    void HashIndex::reserve (std::size_t count)
+    {
+        // keep the load factor at or below 1/2
+        std::size_t capacity = 16;
+        while (capacity < count*2)
+            capacity *= 2;
+
+        Slot empty;
+        empty.mKey = 0;
+        empty.mIndex = sNotFound;
+
+        mSlots.assign (capacity, empty);
+        mMask = capacity-1;
+        mSize = 0;
+    }
+
+    void HashIndex::insert (std::uint64_t key, std::uint32_t index)
+    {
+        if (mSlots.empty() || (mSize+1)*2 > mSlots.size())
+            grow();
+
+        std::size_t i = mix (key) & mMask;
+        while (mSlots[i].mIndex!=sNotFound)
+            i = (i+1) & mMask;
+
+        mSlots[i].mKey = key;
+        mSlots[i].mIndex = index;
+        ++mSize;
+    }
+
+    std::uint32_t HashIndex::find (std::uint64_t key) const
+    {
+        sLookups.fetch_add (1, boost::memory_order_relaxed);
+
+        if (mSlots.empty())
+            return sNotFound;
+
+        std::size_t probes = 0;
+        std::uint32_t found = sNotFound;
+
+        for (std::size_t i = mix (key) & mMask; mSlots[i].mIndex!=sNotFound; i = (i+1) & mMask)
+        {
+            ++probes;
+
+            if (mSlots[i].mKey==key)
+            {
+                found = mSlots[i].mIndex;
+                break;
+            }
+        }
+
+        sProbes.fetch_add (probes, boost::memory_order_relaxed);
+        return found;
+    }
+
+    void HashIndex::grow()
+    {
+        std::vector<Slot> slots;
+        slots.swap (mSlots);
+
+        reserve (slots.empty() ? 8 : slots.size());
+
+        // re-inserting in slot order would not preserve insertion order for equal keys
+        // within a probe sequence that wraps around, so start after an empty slot
+        std::size_t start = 0;
+        while (start<slots.size() && slots[start].mIndex!=sNotFound)
+            ++start;
+
+        for (std::size_t n = 0; n<slots.size(); ++n)
+        {
+            const Slot& slot = slots[(start+n) % slots.size()];
+            if (slot.mIndex!=sNotFound)
+                insert (slot.mKey, slot.mIndex);
+        }
+    }
+
+    std::size_t HashIndex::getLookupCount()
+    {
+        return sLookups.load (boost::memory_order_relaxed);
+    }
+
+    std::size_t HashIndex::getProbeCount()
+    {
+        return sProbes.load (boost::memory_order_relaxed);
+    }
+
+    void HashIndex::resetCounters()
+    {
+        sLookups.store (0, boost::memory_order_relaxed);
+        sProbes.store (0, boost::memory_order_relaxed);
+    }
+}
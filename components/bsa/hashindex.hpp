@@ -0,0 +1,99 @@
+#ifndef BSA_HASHINDEX_H
+#define BSA_HASHINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/atomic.hpp>
+
+namespace Bsa
+{
+    /// Open addressing (linear probing) table from precomputed 64 bit name hashes to
+    /// indices into an archive's file list. Built once when the archive is registered;
+    /// lookups do not allocate.
+    class HashIndex
+    {
+        public:
+
+            static const std::uint32_t sNotFound = 0xffffffff;
+
+            HashIndex();
+
+            /// Discard all entries and size the table for \a count entries.
+            void reserve (std::size_t count);
+
+            /// Several entries may share a key, find() visits them in insertion order.
+            void insert (std::uint64_t key, std::uint32_t index);
+
+            /// Return the index of the first entry with \a key or sNotFound.
+            std::uint32_t find (std::uint64_t key) const;
+
+            /// Return the index of the first entry with \a key for which \a match (index)
+            /// is true or sNotFound.
+            template<typename Match>
+            std::uint32_t find (std::uint64_t key, const Match& match) const
+            {
+                sLookups.fetch_add (1, boost::memory_order_relaxed);
+
+                if (mSlots.empty())
+                    return sNotFound;
+
+                std::size_t probes = 0;
+                std::uint32_t found = sNotFound;
+
+                for (std::size_t i = mix (key) & mMask; mSlots[i].mIndex!=sNotFound; i = (i+1) & mMask)
+                {
+                    ++probes;
+
+                    if (mSlots[i].mKey==key && match (mSlots[i].mIndex))
+                    {
+                        found = mSlots[i].mIndex;
+                        break;
+                    }
+                }
+
+                sProbes.fetch_add (probes, boost::memory_order_relaxed);
+                return found;
+            }
+
+            std::size_t size() const { return mSize; }
+
+            /// Number of find() calls on all tables since the last reset.
+            static std::size_t getLookupCount();
+
+            /// Number of slots compared by find() on all tables since the last reset.
+            static std::size_t getProbeCount();
+
+            static void resetCounters();
+
+        private:
+
+            struct Slot
+            {
+                std::uint64_t mKey;
+                std::uint32_t mIndex;
+            };
+
+            std::vector<Slot> mSlots;
+            std::size_t mMask;
+            std::size_t mSize;
+
+            // find() is called from several threads
+            static boost::atomic<std::size_t> sLookups;
+            static boost::atomic<std::size_t> sProbes;
+
+            /// Archive hashes keep characters in their low bits, spread them before masking.
+            static std::size_t mix (std::uint64_t key)
+            {
+                key ^= key >> 33;
+                key *= 0xff51afd7ed558ccdULL;
+                key ^= key >> 33;
+                return static_cast<std::size_t> (key);
+            }
+
+            void grow();
+    };
+}
+
+#endif
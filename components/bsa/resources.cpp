@@ -2,55 +2,88 @@
 #include "resources.hpp"
 
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
 #include <OgreResourceGroupManager.h>
-#include <OgreStringConverter.h>
 
 #include "bsa_archive.hpp"
+#include "vfs.hpp"
 
-void Bsa::registerResources (const Files::Collections& collections,
-    const std::vector<std::string>& archives, bool useLooseFiles, bool fsStrict, bool isTes4)
+namespace
+{
+    void addArchives (const Files::Collections& collections,
+        const std::vector<std::string>& archives, bool isTes4, std::vector<Ogre::Archive *>& added)
+    {
+        for (std::vector<std::string>::const_iterator archive = archives.begin(); archive != archives.end(); ++archive)
+        {
+            if (collections.doesExist(*archive))
+            {
+                const std::string archivePath = collections.getPath(*archive).string();
+                std::cout << "Adding BSA archive " << archivePath << std::endl;
+                if (!isTes4)
+                    added.push_back (Bsa::createBSAArchive(archivePath));
+                else
+                    added.push_back (Bsa::createTES4BSAArchive(archivePath));
+            }
+            else
+            {
+                std::stringstream message;
+                message << "Archive '" << *archive << "' not found";
+                throw std::runtime_error(message.str());
+            }
+        }
+    }
+}
+
+Bsa::VFS *Bsa::registerResources (const Files::Collections& collections,
+    const std::vector<std::string>& archives, const std::vector<std::string>& tes4Archives,
+    bool useLooseFiles, bool fsStrict)
 {
     const Files::PathContainer& dataDirs = collections.getPaths();
 
-    int i=0;
+    // lowest priority first
+    std::vector<Ogre::Archive *> tes4, bsa, dirs;
 
-    if (useLooseFiles)
-        for (Files::PathContainer::const_iterator iter = dataDirs.begin(); iter != dataDirs.end(); ++iter)
-        {
-            // Last data dir has the highest priority
-            std::string groupName = "Data" + Ogre::StringConverter::toString(dataDirs.size()-i, 8, '0');
-            Ogre::ResourceGroupManager::getSingleton ().createResourceGroup (groupName);
-
-            std::string dataDirectory = iter->string();
-            std::cout << "Data dir " << dataDirectory << std::endl;
-            Bsa::addDir(dataDirectory, fsStrict, groupName);
-            ++i;
-        }
+    try
+    {
+        if (useLooseFiles)
+            for (Files::PathContainer::const_iterator iter = dataDirs.begin(); iter != dataDirs.end(); ++iter)
+            {
+                std::string dataDirectory = iter->string();
+                std::cout << "Data dir " << dataDirectory << std::endl;
+                dirs.push_back (Bsa::createDirArchive(dataDirectory, fsStrict));
+            }
 
-    i=0;
-    for (std::vector<std::string>::const_iterator archive = archives.begin(); archive != archives.end(); ++archive)
+        addArchives (collections, archives, false, bsa);
+        addArchives (collections, tes4Archives, true, tes4);
+    }
+    catch (...)
     {
-        if (collections.doesExist(*archive))
-        {
-            // Last BSA has the highest priority
-            std::string groupName = (isTes4 ? "TES4BSA" : "DataBSA") + Ogre::StringConverter::toString(archives.size()-i, 8, '0');
+        for (std::size_t i = 0; i < dirs.size(); ++i) delete dirs[i];
+        for (std::size_t i = 0; i < bsa.size(); ++i) delete bsa[i];
+        for (std::size_t i = 0; i < tes4.size(); ++i) delete tes4[i];
+        throw;
+    }
 
-            Ogre::ResourceGroupManager::getSingleton ().createResourceGroup (groupName);
+    Bsa::VFS *vfs = new Bsa::VFS;
 
-            const std::string archivePath = collections.getPath(*archive).string();
-            std::cout << "Adding BSA archive " << archivePath << std::endl;
-            if (!isTes4)
-                Bsa::addBSA(archivePath, groupName);
-            else
-                Bsa::addTES4BSA(archivePath, groupName);
-            ++i;
-        }
-        else
-        {
-            std::stringstream message;
-            message << "Archive '" << *archive << "' not found";
-            throw std::runtime_error(message.str());
-        }
-    }
+    for (std::size_t i = 0; i < tes4.size(); ++i)
+        vfs->addArchive (tes4[i]);
+
+    for (std::size_t i = 0; i < bsa.size(); ++i)
+        vfs->addArchive (bsa[i]);
+
+    for (std::size_t i = 0; i < dirs.size(); ++i)
+        vfs->addArchive (dirs[i]);
+
+    vfs->build();
+
+    std::cout << "Resolved " << vfs->getEntries().size() << " resources from "
+        << vfs->getArchives().size() << " locations in " << vfs->getBuildTime() * 1000 << " ms" << std::endl;
+
+    Ogre::ResourceGroupManager::getSingleton ().createResourceGroup ("VFS");
+    Bsa::addVFS (vfs, "VFS");
+
+    return vfs;
 }
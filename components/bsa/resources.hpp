@@ -8,9 +8,18 @@
 
 namespace Bsa
 {
-    void registerResources (const Files::Collections& collections,
-        const std::vector<std::string>& archives, bool useLooseFiles, bool fsStrict, bool isTes4=false);
-    ///< Register resources directories and archives as OGRE resources groups
+    class VFS;
+
+    VFS *registerResources (const Files::Collections& collections,
+        const std::vector<std::string>& archives, const std::vector<std::string>& tes4Archives,
+        bool useLooseFiles, bool fsStrict);
+    ///< Merge resources directories and archives into a single VFS and register it as the
+    /// "VFS" OGRE resource group.
+    ///
+    /// Priority, highest first: data directories (last one first), \a archives (last one
+    /// first), \a tes4Archives (last one first).
+    ///
+    /// \return The VFS, owned by the OGRE archive manager.
 }
 
 #endif
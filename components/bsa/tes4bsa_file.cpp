@@ -26,6 +26,9 @@
 
 #include <stdexcept>
 #include <cassert>
+#include <cstring>
+#include <iostream>
+#include <map>
 
 #include <boost/scoped_array.hpp>
 #include <boost/algorithm/string.hpp>
@@ -34,9 +37,6 @@
 
 #include <zlib.h>
 
-#include <extern/BSAOpt/hash.hpp> // see: http://en.uesp.net/wiki/Tes4Mod:Hash_Calculation
-
-#undef TEST_UNIQUE_HASH
 
 namespace
 {
@@ -55,10 +55,165 @@ namespace
         assert((size_t)size-1 == str.size() && "getBZString string size mismatch");
         return;
     }
+
+    char normalizeChar(char ch)
+    {
+        if (ch == '/')
+            return '\\';
+
+        return (ch >= 'A' && ch <= 'Z') ? ch - 'A' + 'a' : ch;
+    }
+
+    // see: http://en.uesp.net/wiki/Tes4Mod:Hash_Calculation and extern/BSAOpt/hash.cpp
+
+    /// GenOBHashStr() on the lower case, '\\' separated form of the given characters
+    std::uint32_t hashStr(const char *str, std::size_t size)
+    {
+        std::uint32_t hash = 0;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash *= 0x1003F;
+            hash += static_cast<unsigned char>(normalizeChar(str[i]));
+        }
+
+        return hash;
+    }
+
+    bool extensionEquals(const char *ext, std::size_t size, const char *lowerCase)
+    {
+        std::size_t i = 0;
+        for (; i < size && lowerCase[i]; ++i)
+            if (normalizeChar(ext[i]) != lowerCase[i])
+                return false;
+
+        return i == size && !lowerCase[i];
+    }
+
+    /// GenOBHashPair() on the lower case, '\\' separated form of the given ranges, without
+    /// creating temporary strings
+    std::uint64_t hashPair(const char *file, std::size_t fileSize, const char *ext, std::size_t extSize)
+    {
+        std::uint64_t hash = 0;
+
+        if (fileSize > 0)
+        {
+            hash = static_cast<unsigned char>(normalizeChar(file[fileSize - 1]))
+                + (fileSize > 2 ? static_cast<unsigned char>(normalizeChar(file[fileSize - 2])) * 0x100 : 0)
+                + static_cast<std::uint64_t>(fileSize) * 0x10000
+                + static_cast<std::uint64_t>(static_cast<unsigned char>(normalizeChar(file[0]))) * 0x1000000;
+
+            if (fileSize > 3)
+                hash += static_cast<std::uint64_t>(hashStr(file + 1, fileSize - 3)) << 32;
+        }
+
+        if (extSize > 0)
+        {
+            hash += static_cast<std::uint64_t>(hashStr(ext, extSize)) << 32;
+
+            unsigned char i = 0;
+            if (extensionEquals(ext, extSize, ".nif")) i = 1;
+            if (extensionEquals(ext, extSize, ".kf" )) i = 2;
+            if (extensionEquals(ext, extSize, ".dds")) i = 3;
+            if (extensionEquals(ext, extSize, ".wav")) i = 4;
+
+            if (i != 0)
+            {
+                unsigned char a = (unsigned char)(((i & 0xfc ) << 5) + (unsigned char)((hash & 0xff000000) >> 24));
+                unsigned char b = (unsigned char)(((i & 0xfe ) << 6) + (unsigned char)( hash & 0x000000ff)       );
+                unsigned char c = (unsigned char)(( i          << 7) + (unsigned char)((hash & 0x0000ff00) >>  8));
+
+                hash -= hash & 0xFF00FFFF;
+                hash += (std::uint32_t)((a << 24) + b + (c << 8));
+            }
+        }
+
+        return hash;
+    }
+
+    std::uint64_t getKey(std::uint64_t folderHash, std::uint64_t fileHash)
+    {
+        return folderHash * 0x9E3779B97F4A7C15ULL ^ fileHash;
+    }
 }
 
 using namespace Bsa;
 
+class TES4BSAFile::MatchRecord
+{
+        const FileList& mFiles;
+        std::uint64_t mFolderHash;
+        std::uint64_t mFileHash;
+
+    public:
+
+        MatchRecord(const FileList& files, std::uint64_t folderHash, std::uint64_t fileHash)
+        : mFiles(files), mFolderHash(folderHash), mFileHash(fileHash)
+        {}
+
+        bool operator()(std::uint32_t index) const
+        {
+            return mFiles[index].folderHash == mFolderHash && mFiles[index].fileHash == mFileHash;
+        }
+};
+
+/// Stream of a compressed entry in the mapping, inflated on first use rather than by getFile(),
+/// so that it happens on whichever thread reads the stream
+class TES4BSAFile::InflateStream : public Ogre::DataStream
+{
+        InflateJob mJob;
+        Ogre::SharedPtr<Ogre::MemoryDataStream> mData; // null until inflated
+
+        Ogre::MemoryDataStream& getData()
+        {
+            if (mData.isNull())
+            {
+                Ogre::SharedPtr<Ogre::MemoryDataStream> data(new Ogre::MemoryDataStream(mJob.mOutSize));
+                mJob.mOut = data->getPtr();
+                TES4BSAFile::inflate(mJob);
+                mData = data;
+            }
+
+            return *mData;
+        }
+
+    public:
+
+        InflateStream(const InflateJob& job) : mJob(job)
+        {
+            mSize = job.mOutSize;
+        }
+
+        virtual size_t read(void *buf, size_t count)
+        {
+            return getData().read(buf, count);
+        }
+
+        virtual void skip(long count)
+        {
+            getData().skip(count);
+        }
+
+        virtual void seek(size_t pos)
+        {
+            getData().seek(pos);
+        }
+
+        virtual size_t tell() const
+        {
+            return mData.isNull() ? 0 : mData->tell();
+        }
+
+        virtual bool eof() const
+        {
+            return mData.isNull() ? mSize == 0 : mData->eof();
+        }
+
+        virtual void close()
+        {
+            mData.setNull();
+        }
+};
 
 /// Error handling
 void TES4BSAFile::fail(const std::string& msg)
@@ -126,60 +281,77 @@ void TES4BSAFile::readHeader()
     // TODO: more checks for BSA file corruption
 
     // folder records
+    std::map<std::uint64_t, std::pair<std::uint32_t, std::uint32_t> > folders; // hash -> (index, count)
     std::uint64_t hash;
-    FolderRecord fr;
+    std::uint32_t count, offset;
     for (std::uint32_t i = 0; i < folderCount; ++i)
     {
         input.read(reinterpret_cast<char*>(&hash), 8);
-        input.read(reinterpret_cast<char*>(&fr.count), 4); // not sure purpose of count
-        input.read(reinterpret_cast<char*>(&fr.offset), 4); // not sure purpose of offset
+        input.read(reinterpret_cast<char*>(&count), 4);
+        input.read(reinterpret_cast<char*>(&offset), 4); // not sure purpose of offset
 
-        std::map<std::uint64_t, FolderRecord>::const_iterator lb = mFolders.lower_bound(hash);
-        if (lb != mFolders.end() && !(mFolders.key_comp()(hash, lb->first)))
+        if (!folders.insert(std::make_pair(hash, std::make_pair(i, count))).second)
             fail("Archive found duplicate folder name hash");
-        else
-            mFolders.insert(lb, std::pair<std::uint64_t, FolderRecord>(hash, fr));
     }
 
+    mFiles.reserve(fileCount);
+    mIndex.reserve(fileCount);
+
     // file record blocks
-    std::uint64_t fileHash;
     FileRecord file;
 
     std::string folder("");
-    std::uint64_t folderHash;
     if ((archiveFlags & 0x1) == 0)
         folderCount = 1; // TODO: not tested
+    else
+        mFolderNames.resize(folderCount);
 
     for (std::uint32_t i = 0; i < folderCount; ++i)
     {
         if ((archiveFlags & 0x1) != 0)
             getBZString(folder, input);
 
-        folderHash = GenOBHash(folder, std::string(""));
+        file.folderHash = hashPair(folder.c_str(), folder.size(), 0, 0);
 
-        std::map<std::uint64_t, FolderRecord>::iterator iter = mFolders.find(folderHash);
-        if (iter == mFolders.end())
+        std::map<std::uint64_t, std::pair<std::uint32_t, std::uint32_t> >::const_iterator iter
+            = folders.find(file.folderHash);
+        if (iter == folders.end())
             fail("Archive folder name hash not found");
 
-        for (std::uint32_t j = 0; j < iter->second.count; ++j)
+        file.folder = iter->second.first;
+        if ((archiveFlags & 0x1) != 0)
+            mFolderNames[file.folder] = folder;
+
+        for (std::uint32_t j = 0; j < iter->second.second; ++j)
         {
-            input.read(reinterpret_cast<char*>(&fileHash), 8);
+            input.read(reinterpret_cast<char*>(&file.fileHash), 8);
             input.read(reinterpret_cast<char*>(&file.size), 4);
             input.read(reinterpret_cast<char*>(&file.offset), 4);
 
-            std::map<std::uint64_t, FileRecord>::const_iterator lb = iter->second.files.lower_bound(fileHash);
-            if (lb != iter->second.files.end() && !(iter->second.files.key_comp()(fileHash, lb->first)))
+            std::uint64_t key = getKey(file.folderHash, file.fileHash);
+            if (mIndex.find(key, MatchRecord(mFiles, file.folderHash, file.fileHash)) != HashIndex::sNotFound)
                 fail("Archive found duplicate file name hash");
 
-            iter->second.files.insert(lb, std::pair<std::uint64_t, FileRecord>(fileHash, file));
+            mIndex.insert(key, static_cast<std::uint32_t>(mFiles.size()));
+            mFiles.push_back(file);
         }
     }
 
-    // file record blocks
+    // file names, in the same order as the file records
     if ((archiveFlags & 0x2) != 0)
     {
         mStringBuf.resize(totalFileNameLength);
-        input.read(&mStringBuf[0], mStringBuf.size()); // TODO: maybe useful in building a lookup map?
+        input.read(&mStringBuf[0], mStringBuf.size());
+
+        std::size_t nameOffset = 0;
+        for (FileList::iterator iter = mFiles.begin(); iter != mFiles.end() && nameOffset < mStringBuf.size(); ++iter)
+        {
+            iter->nameOffset = static_cast<std::uint32_t>(nameOffset);
+            nameOffset += std::strlen(&mStringBuf[nameOffset]) + 1;
+        }
+
+        if (!mStringBuf.empty())
+            mStringBuf.back() = 0; // don't run off the end of a corrupt name buffer
     }
 
     // TODO: more checks for BSA file corruption
@@ -187,153 +359,199 @@ void TES4BSAFile::readHeader()
     isLoaded = true;
 }
 
-TES4BSAFile::FileRecord TES4BSAFile::getFileRecord(const std::string& str) const
+const TES4BSAFile::FileRecord *TES4BSAFile::findFileRecord(const std::string& str) const
 {
-    boost::filesystem::path p(str);
-    std::string stem = p.stem().string();
-    std::string ext = p.extension().string();
-    std::string filename = p.filename().string();
-    p.remove_filename();
-
-    std::string folder = p.string();
-    // GenOBHash already converts to lowercase and replaces file separators but not for path
-    boost::algorithm::to_lower(folder);
-    std::replace(folder.begin(), folder.end(), '/', '\\');
-
-    std::uint64_t folderHash = GenOBHash(folder, std::string(""));
-
-    std::map<std::uint64_t, FolderRecord>::const_iterator it = mFolders.find(folderHash);
-    if (it == mFolders.end())
-        return FileRecord(); // folder not found, return default which has offset of -1
-
-    boost::algorithm::to_lower(stem);
-    boost::algorithm::to_lower(ext);
-    std::uint64_t fileHash = GenOBHashPair(stem, ext);
-    std::map<std::uint64_t, FileRecord>::const_iterator iter = it->second.files.find(fileHash);
-    if (iter == it->second.files.end())
-        return FileRecord(); // file not found, return default which has offset of -1
-
-    // cache for next time
-    std::uint64_t hash = GenOBHash(folder, filename);
-
-#if defined (TEST_UNIQUE_HASH)
-    FileList::const_iterator lb = mFiles.lower_bound(hash);
-    if (lb != mFiles.end() && !(mFiles.key_comp()(hash, lb->first)))
-    {
-        // found, check if same filename
-        if (lb->second.fileName == str)
-            return iter->second; // same name, should not have got here!!
-        else
-        {
-            // different filename, hash is not unique!
-            std::cerr << "BSA hash collision: " << str << std::hex << "0x" << hash << std::endl;
+    std::size_t separator = str.find_last_of("/\\");
+    std::size_t nameBegin = separator == std::string::npos ? 0 : separator + 1;
+    std::size_t extBegin = str.rfind('.');
+    if (extBegin == std::string::npos || extBegin < nameBegin)
+        extBegin = str.size();
 
-            return iter->second; // return without cashing
-        }
-    }
+    const char *path = str.c_str();
+
+    std::uint64_t folderHash
+        = hashPair(path, separator == std::string::npos ? 0 : separator, path, 0);
+    std::uint64_t fileHash
+        = hashPair(path + nameBegin, extBegin - nameBegin, path + extBegin, str.size() - extBegin);
+
+    std::uint32_t index = mIndex.find(getKey(folderHash, fileHash), MatchRecord(mFiles, folderHash, fileHash));
+
+    return index == HashIndex::sNotFound ? 0 : &mFiles[index];
+}
+
+std::string TES4BSAFile::getFileName(const FileRecord& record) const
+{
+    if (record.nameOffset == std::uint32_t(-1))
+        return "";
+
+    const std::string& folder = mFolderNames.at(record.folder);
 
-    // not found, cache for later
-    const_cast<FileList&>(mFiles).insert(lb, std::pair<std::uint64_t, FileRecord>(hash, iter->second));
-    const_cast<FileList&>(mFiles)[hash].fileName = str;
-#else
-    const_cast<FileList&>(mFiles)[hash] = iter->second; // NOTE: const hack
-#endif
-    return iter->second;
+    return folder.empty() ? std::string(&mStringBuf[record.nameOffset])
+                          : folder + "\\" + &mStringBuf[record.nameOffset];
 }
 
 bool TES4BSAFile::exists(const std::string& str) const
 {
-    // check cache first
-    boost::filesystem::path p(str);
-    std::string filename = p.filename().string();
-    p.remove_filename();
-
-    std::string folder = p.string();
-    // GenOBHash already converts to lowercase and replaces file separators but not for path
-    boost::algorithm::to_lower(folder);
-    std::replace(folder.begin(), folder.end(), '/', '\\');
-
-    std::uint64_t hash = GenOBHash(folder, filename);
-
-    std::map<std::uint64_t, FileRecord>::const_iterator it = mFiles.find(hash);
-#if defined (TEST_UNIQUE_HASH)
-    if (it != mFiles.end() && it->second.fileName == str)
-#else
-    if (it != mFiles.end())
-#endif
-        return true;
-    else
-        return getFileRecord(str).offset != -1;
+    return findFileRecord(str) != 0;
+}
+
+bool TES4BSAFile::isCompressed(const std::string& str) const
+{
+    const FileRecord *fileRec = findFileRecord(str);
+    return fileRec && isCompressed(*fileRec);
 }
 
 void TES4BSAFile::open(const std::string& file)
 {
     mFilename = file;
     readHeader();
+
+    try
+    {
+        mMapping.open(mFilename.c_str());
+    }
+    catch (const std::exception& e)
+    {
+        // not fatal, files are then read through a stream on each request
+        std::cerr << "Warning: " << e.what() << std::endl;
+        mMapping.close();
+    }
 }
 
-Ogre::DataStreamPtr TES4BSAFile::getFile(const std::string& file)
+bool TES4BSAFile::isCompressed(const FileRecord& fileRec) const
 {
-    assert(file);
+    return (mCompressedByDefault && (fileRec.size & (1<<30)) == 0)
+        || (!mCompressedByDefault && (fileRec.size & (1<<30)) != 0);
+}
 
-    FileRecord fileRec = getFileRecord(file);
-    if(fileRec.offset == -1)
-        fail("File not found: " + std::string(file));
+void TES4BSAFile::inflate(const InflateJob& job)
+{
+    int ret;
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree  = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.avail_in = static_cast<uInt>(job.mInSize);
+    strm.next_in = const_cast<Bytef*>(job.mIn);
+    ret = inflateInit(&strm);
+    if (ret != Z_OK)
+        throw std::runtime_error("TES4BSAFile::getFile - inflateInit failed");
+
+    strm.avail_out = static_cast<uInt>(job.mOutSize);
+    strm.next_out = job.mOut;
+    ret = ::inflate(&strm, Z_NO_FLUSH);
+    assert(ret != Z_STREAM_ERROR && "TES4BSAFile::getFile - inflate - state clobbered");
+    switch (ret)
+    {
+    case Z_NEED_DICT:
+        ret = Z_DATA_ERROR; /* and fall through */
+    case Z_DATA_ERROR:
+    case Z_MEM_ERROR:
+        inflateEnd(&strm);
+        throw std::runtime_error("TES4BSAFile::getFile - inflate failed");
+    }
+    assert(ret == Z_OK || ret == Z_STREAM_END);
+    inflateEnd(&strm);
+}
+
+Ogre::DataStreamPtr TES4BSAFile::getMappedFile(const FileRecord& fileRec) const
+{
+    std::uint32_t size = fileRec.size & ~(1<<30);
+    const char *begin = mMapping.data() + fileRec.offset;
+    const char *end = begin + size;
+
+    if (fileRec.offset + static_cast<std::size_t>(size) > mMapping.size())
+        throw std::runtime_error("BSA Error: File record out of bounds\nArchive: " + mFilename);
+
+    if (mEmbeddedFileNames)
+    {
+        // skip bstring, TODO: not tested
+        if (begin == end || static_cast<unsigned char>(*begin) >= end - begin)
+            throw std::runtime_error("BSA Error: File record out of bounds\nArchive: " + mFilename);
+        begin += 1 + static_cast<unsigned char>(*begin);
+    }
+
+    if (isCompressed(fileRec))
+    {
+        if (end - begin < 4)
+            throw std::runtime_error("BSA Error: File record out of bounds\nArchive: " + mFilename);
+
+        std::uint32_t bufSize = 0;
+        std::memcpy(&bufSize, begin, 4);
+        begin += 4;
+
+        InflateJob job;
+        job.mIn = reinterpret_cast<const unsigned char*>(begin);
+        job.mInSize = end - begin;
+        job.mOutSize = bufSize;
+
+        return Ogre::SharedPtr<Ogre::DataStream>(new InflateStream(job));
+    }
+    else // not compressed, return a view into the mapping
+    {
+        Ogre::MemoryDataStream *outBuf = new Ogre::MemoryDataStream(const_cast<char*>(begin),
+                end - begin, false /*freeOnClose*/, true /*readOnly*/);
+
+        return Ogre::SharedPtr<Ogre::DataStream>(outBuf);
+    }
+}
+
+Ogre::DataStreamPtr TES4BSAFile::readFile(const FileRecord& fileRec) const
+{
+    std::uint32_t size = fileRec.size & ~(1<<30);
 
     boost::filesystem::ifstream input(boost::filesystem::path(mFilename), std::ios_base::binary);
     input.seekg(fileRec.offset);
 
     std::string fullPath;
     if (mEmbeddedFileNames)
+    {
         getBZString(fullPath, input); // TODO: maybe cache the hash and/or offset of frequently used ones?
+        if (fullPath.size() + 1 > size)
+            throw std::runtime_error("BSA Error: File record out of bounds\nArchive: " + mFilename);
+        size -= static_cast<std::uint32_t>(fullPath.size() + 1);
+    }
 
-    if (( mCompressedByDefault && (fileRec.size & (1<<30)) == 0)
-        ||
-        (!mCompressedByDefault && (fileRec.size & (1<<30)) != 0))
+    if (isCompressed(fileRec))
     {
+        if (size < 4)
+            throw std::runtime_error("BSA Error: File record out of bounds\nArchive: " + mFilename);
+
         std::uint32_t bufSize = 0;
         boost::scoped_array<unsigned char> inBuf;
-        inBuf.reset(new unsigned char[fileRec.size-4]);
+        inBuf.reset(new unsigned char[size-4]);
         input.read(reinterpret_cast<char*>(&bufSize), 4);
-        input.read(reinterpret_cast<char*>(inBuf.get()), fileRec.size-4);
+        input.read(reinterpret_cast<char*>(inBuf.get()), size-4);
         Ogre::MemoryDataStream *outBuf = new Ogre::MemoryDataStream(bufSize);
         Ogre::SharedPtr<Ogre::DataStream> streamPtr(outBuf);
 
-        int ret;
-        z_stream strm;
-        strm.zalloc = Z_NULL;
-        strm.zfree  = Z_NULL;
-        strm.opaque = Z_NULL;
-        strm.avail_in = bufSize;
-        strm.next_in = inBuf.get();
-        ret = inflateInit(&strm);
-        if (ret != Z_OK)
-            throw std::runtime_error("TES4BSAFile::getFile - inflateInit failed");
-
-        strm.avail_out = bufSize;
-        strm.next_out = outBuf->getPtr();
-        ret = inflate(&strm, Z_NO_FLUSH);
-        assert(ret != Z_STREAM_ERROR && "TES4BSAFile::getFile - inflate - state clobbered");
-        switch (ret)
-        {
-        case Z_NEED_DICT:
-            ret = Z_DATA_ERROR; /* and fall through */
-        case Z_DATA_ERROR:
-        case Z_MEM_ERROR:
-            inflateEnd(&strm);
-            throw std::runtime_error("TES4BSAFile::getFile - inflate failed");
-        }
-        assert(ret == Z_OK || ret == Z_STREAM_END);
-        inflateEnd(&strm);
+        InflateJob job;
+        job.mIn = inBuf.get();
+        job.mInSize = size-4;
+        job.mOut = outBuf->getPtr();
+        job.mOutSize = bufSize;
+        inflate(job);
 
         return streamPtr;
     }
     else // not compressed TODO: not tested
     {
-        Ogre::MemoryDataStream *outBuf = new Ogre::MemoryDataStream(fileRec.size);
+        Ogre::MemoryDataStream *outBuf = new Ogre::MemoryDataStream(size);
         Ogre::SharedPtr<Ogre::DataStream> streamPtr(outBuf);
-        input.read(reinterpret_cast<char*>(outBuf->getPtr()), fileRec.size);
+        input.read(reinterpret_cast<char*>(outBuf->getPtr()), size);
 
         return streamPtr;
     }
 }
+
+Ogre::DataStreamPtr TES4BSAFile::getFile(const std::string& file)
+{
+    const FileRecord *fileRec = findFileRecord(file);
+    if (!fileRec)
+        fail("File not found: " + file);
+
+    if (!mMapping.isOpen())
+        return readFile(*fileRec);
+
+    return getMappedFile(*fileRec);
+}
@@ -29,10 +29,12 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
-#include <map>
 
 #include <OgreDataStream.h>
 
+#include "../files/memorymappedfile.hpp"
+
+#include "hashindex.hpp"
 
 namespace Bsa
 {
@@ -44,11 +46,17 @@ namespace Bsa
             std::uint32_t size;
             std::uint32_t offset;
 
-            std::string fileName; // NOTE: for testing hash collision only, see TEST_UNIQUE_HASH
+            std::uint64_t folderHash;
+            std::uint64_t fileHash;
+
+            std::uint32_t folder;     // index into the folder names
+            std::uint32_t nameOffset; // into the file names buffer, -1 if the archive has no names
 
-            FileRecord() : size(0), offset(-1) {}
+            FileRecord() : size(0), offset(-1), folderHash(0), fileHash(0), folder(0), nameOffset(-1) {}
         };
 
+        typedef std::vector<FileRecord> FileList;
+
     private:
         /// Filenames string buffer
         std::vector<char> mStringBuf;
@@ -59,22 +67,50 @@ namespace Bsa
         bool mCompressedByDefault;
         bool mEmbeddedFileNames;
 
-        std::map<std::uint64_t, FileRecord> mFiles;
-        typedef std::map<std::uint64_t, FileRecord> FileList;
+        /// All file records in archive order
+        FileList mFiles;
 
-        struct FolderRecord
-        {
-            std::uint32_t count;
-            std::uint32_t offset;
-            std::map<std::uint64_t, FileRecord> files;
-        };
-        std::map<std::uint64_t, FolderRecord> mFolders;
+        /// Folder names, lower case with '\\' separators (empty if the archive has no names)
+        std::vector<std::string> mFolderNames;
+
+        /// Keyed by folder and file hash of each record in mFiles
+        HashIndex mIndex;
+
+        class MatchRecord;
 
-        FileRecord getFileRecord(const std::string& str) const;
+        /// Returns 0 if not found
+        const FileRecord *findFileRecord(const std::string& str) const;
 
         /// Used for error messages and getting files
         std::string mFilename;
 
+        /// Whole archive mapped into memory at open(); getFile() falls back to
+        /// reading through a file stream if the mapping could not be created
+        MemoryMappedFile mMapping;
+
+        struct InflateJob
+        {
+            const unsigned char *mIn;
+            std::size_t mInSize;
+            unsigned char *mOut;
+            std::size_t mOutSize;
+
+            InflateJob() : mIn(0), mInSize(0), mOut(0), mOutSize(0) {}
+        };
+
+        static void inflate(const InflateJob& job);
+
+        bool isCompressed(const FileRecord& fileRec) const;
+
+        class InflateStream;
+
+        /// Build a stream for a file record from the mapping. Compressed entries are inflated
+        /// when the stream is first read.
+        Ogre::DataStreamPtr getMappedFile(const FileRecord& fileRec) const;
+
+        /// Fallback for archives that could not be mapped
+        Ogre::DataStreamPtr readFile(const FileRecord& fileRec) const;
+
         /// Error handling
         void fail(const std::string &msg);
 
@@ -92,11 +128,21 @@ namespace Bsa
         /// Check if a file exists
         bool exists(const std::string& file) const;
 
+        /// Check if a file is stored compressed, false if it does not exist
+        bool isCompressed(const std::string& file) const;
+
+        /// Uncompressed files are returned as read-only views into the archive mapping,
+        /// valid for the lifetime of this object. Compressed files in the mapping are inflated
+        /// on the thread that first reads the stream, e.g. a NIF cache worker.
         Ogre::DataStreamPtr getFile(const std::string& file);
 
         /// Get a list of all files
-        const FileList &getList() const // FIXME
+        const FileList &getList() const
         { return mFiles; }
+
+        /// Full path of a file in the archive ("folder\\file.ext"), empty if the archive
+        /// does not store names
+        std::string getFileName(const FileRecord& record) const;
     };
 }
 
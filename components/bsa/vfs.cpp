@@ -0,0 +1,243 @@
+#include "vfs.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "bsa_archive.hpp"
+
+namespace
+{
+    char normalizeChar (char ch)
+    {
+        if (ch == '\\')
+            return '/';
+
+        return (ch >= 'A' && ch <= 'Z') ? ch - 'A' + 'a' : ch;
+    }
+
+    std::string normalizeName (const std::string& name)
+    {
+        std::string normalized (name);
+        std::transform (normalized.begin(), normalized.end(), normalized.begin(), &normalizeChar);
+        return normalized;
+    }
+}
+
+namespace Bsa
+{
+    class VFS::MatchName
+    {
+            const std::vector<Entry>& mEntries;
+            const std::string& mName;
+
+        public:
+
+            MatchName (const std::vector<Entry>& entries, const std::string& name)
+            : mEntries (entries), mName (name)
+            {}
+
+            bool operator() (std::uint32_t index) const
+            {
+                const std::string& candidate = mEntries[index].mName;
+
+                if (candidate.size() != mName.size())
+                    return false;
+
+                for (std::size_t i = 0; i < candidate.size(); ++i)
+                    if (candidate[i] != normalizeChar (mName[i]))
+                        return false;
+
+                return true;
+            }
+    };
+
+    std::uint64_t VFS::hashName (const std::string& name)
+    {
+        // FNV-1a of the normalized name
+        std::uint64_t hash = 14695981039346656037ULL;
+
+        for (std::string::const_iterator iter (name.begin()); iter != name.end(); ++iter)
+        {
+            hash ^= static_cast<unsigned char> (normalizeChar (*iter));
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    VFS::VFS (const std::string& name) : Ogre::Archive (name, "VFS"), mBuildTime (0) {}
+
+    VFS::~VFS()
+    {
+        for (std::vector<Ogre::Archive *>::iterator iter (mArchives.begin()); iter != mArchives.end(); ++iter)
+            delete *iter;
+    }
+
+    void VFS::addArchive (Ogre::Archive *archive)
+    {
+        mArchives.push_back (archive);
+    }
+
+    void VFS::build()
+    {
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+        mEntries.clear();
+
+        // highest priority first, so that it survives the removal of duplicates below
+        for (std::size_t i = mArchives.size(); i-- > 0; )
+        {
+            Ogre::StringVectorPtr names = mArchives[i]->list (true, false);
+
+            for (Ogre::StringVector::const_iterator iter (names->begin()); iter != names->end(); ++iter)
+            {
+                Entry entry;
+                entry.mName = normalizeName (*iter);
+                entry.mArchiveName = *iter;
+                entry.mArchive = static_cast<std::uint32_t> (i);
+                mEntries.push_back (entry);
+            }
+        }
+
+        std::stable_sort (mEntries.begin(), mEntries.end());
+        mEntries.erase (std::unique (mEntries.begin(), mEntries.end()), mEntries.end());
+
+        mLookup.reserve (mEntries.size());
+        for (std::size_t i = 0; i < mEntries.size(); ++i)
+            mLookup.insert (hashName (mEntries[i].mName), static_cast<std::uint32_t> (i));
+
+        mBuildTime = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+    }
+
+    double VFS::getBuildTime() const
+    {
+        return mBuildTime;
+    }
+
+    const VFS::Entry *VFS::lookup (const std::string& name) const
+    {
+        std::uint32_t index = mLookup.find (hashName (name), MatchName (mEntries, name));
+
+        return index == HashIndex::sNotFound ? 0 : &mEntries[index];
+    }
+
+    std::string VFS::getSourcePath (const std::string& name) const
+    {
+        const Entry *entry = lookup (name);
+
+        if (!entry)
+            return "";
+
+        const Ogre::Archive *archive = mArchives[entry->mArchive];
+
+        if (archive->getType()=="Dir")
+            return archive->getName() + "/" + entry->mArchiveName;
+
+        return archive->getName();
+    }
+
+    bool VFS::isCompressed (const std::string& name) const
+    {
+        const Entry *entry = lookup (name);
+
+        return entry && Bsa::isCompressed (mArchives[entry->mArchive], entry->mArchiveName);
+    }
+
+    const std::vector<VFS::Entry>& VFS::getEntries() const
+    {
+        return mEntries;
+    }
+
+    const std::vector<Ogre::Archive *>& VFS::getArchives() const
+    {
+        return mArchives;
+    }
+
+    bool VFS::isCaseSensitive() const
+    {
+        return false;
+    }
+
+    // The archives are loaded in their constructors and never unloaded.
+    void VFS::load() {}
+    void VFS::unload() {}
+
+    Ogre::DataStreamPtr VFS::open (const Ogre::String& filename, bool readonly) const
+    {
+        const Entry *entry = lookup (filename);
+
+        if (!entry)
+        {
+            std::ostringstream os;
+            os << "The file '" << filename << "' could not be found.";
+            throw std::runtime_error (os.str());
+        }
+
+        return mArchives[entry->mArchive]->open (entry->mArchiveName, readonly);
+    }
+
+    Ogre::StringVectorPtr VFS::list (bool recursive, bool dirs) const
+    {
+        return find ("*", recursive, dirs);
+    }
+
+    Ogre::FileInfoListPtr VFS::listFileInfo (bool recursive, bool dirs) const
+    {
+        return findFileInfo ("*", recursive, dirs);
+    }
+
+    Ogre::StringVectorPtr VFS::find (const Ogre::String& pattern, bool recursive, bool dirs) const
+    {
+        std::string normalizedPattern = normalizeName (pattern);
+        Ogre::StringVectorPtr ptr = Ogre::StringVectorPtr (new Ogre::StringVector());
+
+        for (std::vector<Entry>::const_iterator iter (mEntries.begin()); iter != mEntries.end(); ++iter)
+        {
+            if (Ogre::StringUtil::match (iter->mName, normalizedPattern) ||
+                (recursive && Ogre::StringUtil::match (iter->mName, "*/"+normalizedPattern)))
+                ptr->push_back (iter->mName);
+        }
+
+        return ptr;
+    }
+
+    Ogre::FileInfoListPtr VFS::findFileInfo (const Ogre::String& pattern, bool recursive, bool dirs) const
+    {
+        std::string normalizedPattern = normalizeName (pattern);
+        Ogre::FileInfoListPtr ptr = Ogre::FileInfoListPtr (new Ogre::FileInfoList());
+
+        for (std::vector<Entry>::const_iterator iter (mEntries.begin()); iter != mEntries.end(); ++iter)
+        {
+            if (Ogre::StringUtil::match (iter->mName, normalizedPattern) ||
+                (recursive && Ogre::StringUtil::match (iter->mName, "*/"+normalizedPattern)))
+            {
+                std::string::size_type pt = iter->mName.rfind ('/');
+                if (pt == std::string::npos)
+                    pt = 0;
+
+                Ogre::FileInfo fi;
+                fi.archive = const_cast<VFS *> (this);
+                fi.path = iter->mName.substr (0, pt);
+                fi.filename = iter->mName.substr ((iter->mName[pt]=='/') ? pt+1 : pt);
+                fi.compressedSize = fi.uncompressedSize = 0;
+
+                ptr->push_back (fi);
+            }
+        }
+
+        return ptr;
+    }
+
+    bool VFS::exists (const Ogre::String& filename) const
+    {
+        return lookup (filename) != 0;
+    }
+
+    time_t VFS::getModifiedTime (const Ogre::String& filename) const
+    {
+        return 0;
+    }
+}
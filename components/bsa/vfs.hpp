@@ -0,0 +1,108 @@
+#ifndef BSA_VFS_H
+#define BSA_VFS_H
+
+#include <string>
+#include <vector>
+
+#include <OgreArchive.h>
+
+#include "hashindex.hpp"
+
+namespace Bsa
+{
+    /// Merged view of data directories and archives.
+    ///
+    /// Every resource name is resolved once, when the VFS is built, to the archive with the
+    /// highest priority providing it. Afterwards a lookup is a single hash probe, no matter
+    /// how many archives were added.
+    ///
+    /// \note Names are matched case insensitively with '/' and '\\' treated alike.
+    class VFS : public Ogre::Archive
+    {
+        public:
+
+            struct Entry
+            {
+                std::string mName;        // lower case, '/' separated
+                std::string mArchiveName; // as listed by the archive
+                std::uint32_t mArchive;
+
+                bool operator< (const Entry& entry) const { return mName < entry.mName; }
+                bool operator== (const Entry& entry) const { return mName == entry.mName; }
+            };
+
+        private:
+
+            /// Highest priority last
+            std::vector<Ogre::Archive *> mArchives;
+
+            /// Sorted by name
+            std::vector<Entry> mEntries;
+
+            HashIndex mLookup;
+
+            double mBuildTime;
+
+            VFS (const VFS&);
+            VFS& operator= (const VFS&);
+
+            static std::uint64_t hashName (const std::string& name);
+
+            class MatchName;
+
+        public:
+
+            VFS (const std::string& name = "VFS");
+
+            virtual ~VFS();
+
+            /// Add \a archive with higher priority than all archives added before. Ownership
+            /// passes to the VFS.
+            ///
+            /// \note build() must be called before the new archive's contents can be found.
+            void addArchive (Ogre::Archive *archive);
+
+            /// (Re)build the resolution table from the archive listings.
+            void build();
+
+            /// Seconds spent in the last build()
+            double getBuildTime() const;
+
+            /// Returns 0 if \a name is not provided by any archive.
+            const Entry *lookup (const std::string& name) const;
+
+            /// Return the file on disk that \a name is read from: the loose file for data
+            /// directories, the archive otherwise. Empty if \a name is not found.
+            std::string getSourcePath (const std::string& name) const;
+
+            /// Check if \a name is read from a compressed archive entry, false if it is not found.
+            bool isCompressed (const std::string& name) const;
+
+            const std::vector<Entry>& getEntries() const;
+
+            const std::vector<Ogre::Archive *>& getArchives() const;
+
+            bool isCaseSensitive() const;
+
+            void load();
+            void unload();
+
+            virtual Ogre::DataStreamPtr open (const Ogre::String& filename, bool readonly = true) const;
+
+            Ogre::StringVectorPtr list (bool recursive = true, bool dirs = false) const;
+
+            Ogre::FileInfoListPtr listFileInfo (bool recursive = true, bool dirs = false) const;
+
+            Ogre::StringVectorPtr find (const Ogre::String& pattern, bool recursive = true,
+                bool dirs = false) const;
+
+            Ogre::FileInfoListPtr findFileInfo (const Ogre::String& pattern, bool recursive = true,
+                bool dirs = false) const;
+
+            bool exists (const Ogre::String& filename) const;
+
+            time_t getModifiedTime (const Ogre::String& filename) const;
+    };
+}
+
+#endif
@@ -213,4 +213,25 @@ namespace Compiler
             iter!=mKeywords.end(); ++iter)
             keywords.push_back (iter->first);
     }
+
+    std::string Extensions::getKeyword (int segment, int code) const
+    {
+        for (std::map<std::string, int>::const_iterator iter (mKeywords.begin());
+            iter!=mKeywords.end(); ++iter)
+        {
+            std::map<int, Function>::const_iterator function = mFunctions.find (iter->second);
+
+            if (function!=mFunctions.end() && function->second.mSegment==segment &&
+                (function->second.mCode==code || function->second.mCodeExplicit==code))
+                return iter->first;
+
+            std::map<int, Instruction>::const_iterator instruction = mInstructions.find (iter->second);
+
+            if (instruction!=mInstructions.end() && instruction->second.mSegment==segment &&
+                (instruction->second.mCode==code || instruction->second.mCodeExplicit==code))
+                return iter->first;
+        }
+
+        return "";
+    }
 }
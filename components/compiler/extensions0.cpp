@@ -304,6 +304,10 @@ namespace Compiler
             extensions.registerInstruction("tgm", "", opcodeToggleGodMode);
             extensions.registerInstruction("togglegodmode", "", opcodeToggleGodMode);
             extensions.registerInstruction("togglescripts", "", opcodeToggleScripts);
+            extensions.registerInstruction("nifcachestats", "", opcodeNifCacheStats);
+            extensions.registerInstruction("togglescriptprofiler", "", opcodeToggleScriptProfiler);
+            extensions.registerInstruction("tsp", "", opcodeToggleScriptProfiler);
+            extensions.registerInstruction("scriptprofile", "/S", opcodeScriptProfile);
             extensions.registerInstruction ("disablelevitation", "", opcodeDisableLevitation);
             extensions.registerInstruction ("enablelevitation", "", opcodeEnableLevitation);
             extensions.registerFunction ("getpcinjail", 'l', "", opcodeGetPcInJail);
@@ -2,6 +2,7 @@
 #include <stdexcept>
 
 #include "../files/constrainedfiledatastream.hpp"
+#include "../files/memorymappedfile.hpp"
 
 namespace ESM
 {
@@ -16,12 +17,15 @@ using namespace Misc;
 ESM_Context ESMReader::getContext()
 {
     // Update the file position before returning
-    mCtx.filePos = mEsm->tell();
+    mCtx.filePos = getOffset();
     return mCtx;
 }
 
 ESMReader::ESMReader()
     : mIdx(0)
+    , mBegin(0)
+    , mPos(0)
+    , mEnd(0)
     , mRecordFlags(0)
     , mBuffer(50*1024)
     , mGlobalReaderList(NULL)
@@ -44,12 +48,17 @@ void ESMReader::restoreContext(const ESM_Context &rc)
     mCtx = rc;
 
     // Make sure we seek to the right place
-    mEsm->seek(mCtx.filePos);
+    if (mMapping)
+        mPos = mBegin + mCtx.filePos;
+    else
+        mEsm->seek(mCtx.filePos);
 }
 
 void ESMReader::close()
 {
     mEsm.reset();
+    mMapping.reset();
+    mBegin = mPos = mEnd = 0;
     mCtx.filename.clear();
     mCtx.leftFile = 0;
     mCtx.leftRec = 0;
@@ -67,10 +76,24 @@ void ESMReader::openRaw(Ogre::DataStreamPtr _esm, const std::string &name)
     mCtx.leftFile = mEsm->size();
 }
 
+void ESMReader::openRaw(boost::shared_ptr<MemoryMappedFile> mapping, const std::string &name)
+{
+    close();
+    mMapping = mapping;
+    mBegin = mPos = mMapping->data();
+    mEnd = mBegin + mMapping->size();
+    mCtx.filename = name;
+    mCtx.leftFile = mMapping->size();
+}
+
 void ESMReader::open(Ogre::DataStreamPtr _esm, const std::string &name)
 {
     openRaw(_esm, name);
+    readHeader();
+}
 
+void ESMReader::readHeader()
+{
     NAME modVer = getRecName();
     if (modVer == "TES3")
     {
@@ -92,7 +115,7 @@ void ESMReader::open(Ogre::DataStreamPtr _esm, const std::string &name)
             rec = getRecName(); // adjust for extra 4 bytes
         bool readRec = true;
 
-        while (mEsm->size() - mEsm->tell() >= 4) // Shivering Isle or Bashed Patch can end here
+        while ((mMapping ? mEnd - mPos : mEsm->size() - mEsm->tell()) >= 4) // Shivering Isle or Bashed Patch can end here
         {
             if (!readRec) // may be already read
                 rec = getRecName();
@@ -172,12 +195,15 @@ void ESMReader::open(Ogre::DataStreamPtr _esm, const std::string &name)
 
 void ESMReader::open(const std::string &file)
 {
-    open (openConstrainedFileDataStream (file.c_str ()), file);
+    openRaw (file);
+    readHeader();
 }
 
 void ESMReader::openRaw(const std::string &file)
 {
-    openRaw (openConstrainedFileDataStream (file.c_str ()), file);
+    boost::shared_ptr<MemoryMappedFile> mapping (new MemoryMappedFile);
+    mapping->open (file.c_str ());
+    openRaw (mapping, file);
 }
 
 int64_t ESMReader::getHNLong(const char *name)
@@ -463,6 +489,15 @@ void ESMReader::getRecHeader(uint32_t &flags)
 
 void ESMReader::getExact(void*x, int size)
 {
+    if (mMapping)
+    {
+        if (size < 0 || mEnd - mPos < size)
+            fail("Read error");
+        std::memcpy(x, mPos, size);
+        mPos += size;
+        return;
+    }
+
     try
     {
         int t = mEsm->read(x, size);
@@ -475,20 +510,45 @@ void ESMReader::getExact(void*x, int size)
     }
 }
 
-std::string ESMReader::getString(int size)
+void ESMReader::skip(int bytes)
 {
+    if (mMapping)
+    {
+        if (bytes < 0 || mEnd - mPos < bytes)
+            fail("Skipped past the end of the file");
+        mPos += bytes;
+    }
+    else
+        mEsm->seek(mEsm->tell()+bytes);
+}
+
+const char *ESMReader::getData(int size)
+{
+    if (mMapping)
+    {
+        if (size < 0 || mEnd - mPos < size)
+            fail("Read error");
+        const char *data = mPos;
+        mPos += size;
+        return data;
+    }
+
     size_t s = size;
     if (mBuffer.size() <= s)
         // Add some extra padding to reduce the chance of having to resize
         // again later.
         mBuffer.resize(3*s);
 
-    // And make sure the string is zero terminated
-    mBuffer[s] = 0;
-
     // read ESM data
-    char *ptr = &mBuffer[0];
-    getExact(ptr, size);
+    getExact(&mBuffer[0], size);
+
+    return &mBuffer[0];
+}
+
+std::string ESMReader::getString(int size)
+{
+    // Read straight from the mapping if there is one
+    const char *ptr = getData(size);
 
     size = strnlen(ptr, size);
 
@@ -501,15 +561,7 @@ std::string ESMReader::getString(int size)
 
 void ESMReader::getString(std::string& str, int size)
 {
-    size_t s = size;
-    if (mBuffer.size() <= s)
-        // Add some extra padding to reduce the chance of having to resize again later.
-        mBuffer.resize(3*s);
-
-    mBuffer[s] = 0; // And make sure the string is zero terminated
-
-    char *ptr = &mBuffer[0];
-    getExact(ptr, size); // read ESM data
+    const char *ptr = getData(size);
 
     size = static_cast<int>(strnlen(ptr, size));
 
@@ -529,8 +581,8 @@ void ESMReader::fail(const std::string &msg)
     ss << "\n  File: " << mCtx.filename;
     ss << "\n  Record: " << mCtx.recName.toString();
     ss << "\n  Subrecord: " << mCtx.subName.toString();
-    if (mEsm)
-        ss << "\n  Offset: 0x" << hex << mEsm->tell();
+    if (!mEsm.isNull() || mMapping)
+        ss << "\n  Offset: 0x" << hex << getOffset();
     throw std::runtime_error(ss.str());
 }
 
@@ -9,6 +9,8 @@
 
 #include <OgreDataStream.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include <components/misc/stringops.hpp>
 
 #include <components/to_utf8/to_utf8.hpp>
@@ -16,6 +18,8 @@
 #include "esmcommon.hpp"
 #include "loadtes3.hpp"
 
+class MemoryMappedFile;
+
 namespace ESM {
 
 class ESMReader
@@ -54,7 +58,9 @@ public:
    */
   ESM_Context getContext();
 
-  /** Restore a previously saved context */
+  /** Restore a previously saved context. For a memory mapped file
+      that is already open this only sets the read position.
+   */
   void restoreContext(const ESM_Context &rc);
 
   /** Close the file, resets all information. After calling close()
@@ -70,14 +76,19 @@ public:
   /// currently open file first, if any.
   void open(Ogre::DataStreamPtr _esm, const std::string &name);
 
+  /// Map the file into memory and parse the header. Readers copied from this one
+  /// share the mapping.
   void open(const std::string &file);
 
   void openRaw(const std::string &file);
 
+  /// True if the open file is memory mapped rather than read through a stream
+  bool isMapped() const { return mMapping.get() != 0; }
+
   /// Get the file size. Make sure that the file has been opened!
-  virtual size_t getFileSize() { return mEsm->size(); }
+  virtual size_t getFileSize() { return mMapping ? mEnd - mBegin : mEsm->size(); }
   /// Get the current position in the file. Make sure that the file has been opened!
-  virtual size_t getFileOffset() { return mEsm->tell(); }
+  virtual size_t getFileOffset() { return getOffset(); }
 
   // This is a quick hack for multiple esm/esp files. Each plugin introduces its own
   //  terrain palette, but ESMReader does not pass a reference to the correct plugin
@@ -278,8 +289,8 @@ public:
   std::string getString(int size);
   void getString(std::string& str, int size);
 
-  void skip(int bytes) { mEsm->seek(mEsm->tell()+bytes); }
-  uint64_t getOffset() { return mEsm->tell(); }
+  void skip(int bytes);
+  uint64_t getOffset() { return mMapping ? mPos - mBegin : mEsm->tell(); }
 
   /// Used for error handling
   void fail(const std::string &msg);
@@ -291,8 +302,22 @@ public:
   unsigned int getRecordFlags() { return mRecordFlags; }
 
 private:
+  void openRaw(boost::shared_ptr<MemoryMappedFile> mapping, const std::string &name);
+
+  void readHeader();
+
+  // Return the next 'size' bytes, without copying them if the file is mapped. Valid
+  // until the next read.
+  const char *getData(int size);
+
   Ogre::DataStreamPtr mEsm;
 
+  // Used instead of mEsm when the file is memory mapped
+  boost::shared_ptr<MemoryMappedFile> mMapping;
+  const char *mBegin;
+  const char *mPos;
+  const char *mEnd;
+
   unsigned int mRecordFlags;
 
   // Special file signifier (see SpecialFile enum above)
@@ -0,0 +1,228 @@
+#include "memorymappedfile.hpp"
+
+#include <stdexcept>
+#include <sstream>
+#include <cassert>
+
+#if FILE_API == FILE_API_POSIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+namespace
+{
+    void failOpen (char const * filename)
+    {
+        std::ostringstream os;
+        os << "Failed to map '" << filename << "' for reading.";
+        throw std::runtime_error (os.str ());
+    }
+}
+
+#if FILE_API == FILE_API_STDIO
+/*
+ *
+ *  Implementation of MemoryMappedFile methods using c stdio (whole file is read into memory)
+ *
+ */
+
+MemoryMappedFile::MemoryMappedFile ()
+  : mData (NULL), mSize (0), mOpen (false)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile ()
+{
+}
+
+void MemoryMappedFile::open (char const * filename)
+{
+    assert (!isOpen ());
+
+    LowLevelFile file;
+    file.open (filename);
+
+    mBuffer.resize (file.size ());
+
+    if (!mBuffer.empty () && file.read (&mBuffer[0], mBuffer.size ()) != mBuffer.size ())
+    {
+        mBuffer.clear ();
+        failOpen (filename);
+    }
+
+    mSize = mBuffer.size ();
+    mData = mBuffer.empty () ? NULL : &mBuffer[0];
+    mOpen = true;
+}
+
+void MemoryMappedFile::close ()
+{
+    std::vector<char> ().swap (mBuffer);
+
+    mData = NULL;
+    mSize = 0;
+    mOpen = false;
+}
+
+bool MemoryMappedFile::isOpen () const
+{
+    return mOpen;
+}
+
+#elif FILE_API == FILE_API_POSIX
+/*
+ *
+ *  Implementation of MemoryMappedFile methods using posix mmap
+ *
+ */
+
+MemoryMappedFile::MemoryMappedFile ()
+  : mData (NULL), mSize (0), mHandle (-1)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile ()
+{
+    if (isOpen ())
+        close ();
+}
+
+void MemoryMappedFile::open (char const * filename)
+{
+    assert (!isOpen ());
+
+#ifdef O_BINARY
+    static const int openFlags = O_RDONLY | O_BINARY;
+#else
+    static const int openFlags = O_RDONLY;
+#endif
+
+    mHandle = ::open (filename, openFlags, 0);
+
+    if (mHandle == -1)
+        failOpen (filename);
+
+    struct stat info;
+    if (::fstat (mHandle, &info) == -1)
+    {
+        close ();
+        failOpen (filename);
+    }
+
+    mSize = size_t (info.st_size);
+
+    // mmap refuses zero length mappings; an empty file simply has no data
+    if (mSize == 0)
+        return;
+
+    void * data = ::mmap (NULL, mSize, PROT_READ, MAP_PRIVATE, mHandle, 0);
+
+    if (data == MAP_FAILED)
+    {
+        close ();
+        failOpen (filename);
+    }
+
+    mData = static_cast<const char *> (data);
+}
+
+void MemoryMappedFile::close ()
+{
+    if (mData != NULL)
+        ::munmap (const_cast<char *> (mData), mSize);
+
+    if (mHandle != -1)
+        ::close (mHandle);
+
+    mData = NULL;
+    mSize = 0;
+    mHandle = -1;
+}
+
+bool MemoryMappedFile::isOpen () const
+{
+    return mHandle != -1;
+}
+
+#elif FILE_API == FILE_API_WIN32
+/*
+ *
+ *  Implementation of MemoryMappedFile methods using Win32 file mappings
+ *
+ */
+
+MemoryMappedFile::MemoryMappedFile ()
+  : mData (NULL), mSize (0), mHandle (INVALID_HANDLE_VALUE), mMapping (NULL)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile ()
+{
+    if (isOpen ())
+        close ();
+}
+
+void MemoryMappedFile::open (char const * filename)
+{
+    assert (!isOpen ());
+
+    mHandle = CreateFileA (filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+
+    if (mHandle == INVALID_HANDLE_VALUE)
+        failOpen (filename);
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx (mHandle, &fileSize))
+    {
+        close ();
+        failOpen (filename);
+    }
+
+    mSize = size_t (fileSize.QuadPart);
+
+    if (mSize == 0)
+        return;
+
+    mMapping = CreateFileMappingA (mHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mMapping == NULL)
+    {
+        close ();
+        failOpen (filename);
+    }
+
+    mData = static_cast<const char *> (MapViewOfFile (mMapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (mData == NULL)
+    {
+        close ();
+        failOpen (filename);
+    }
+}
+
+void MemoryMappedFile::close ()
+{
+    if (mData != NULL)
+        UnmapViewOfFile (mData);
+
+    if (mMapping != NULL)
+        CloseHandle (mMapping);
+
+    if (mHandle != INVALID_HANDLE_VALUE)
+        CloseHandle (mHandle);
+
+    mData = NULL;
+    mSize = 0;
+    mMapping = NULL;
+    mHandle = INVALID_HANDLE_VALUE;
+}
+
+bool MemoryMappedFile::isOpen () const
+{
+    return mHandle != INVALID_HANDLE_VALUE;
+}
+
+#endif
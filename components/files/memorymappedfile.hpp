@@ -0,0 +1,47 @@
+#ifndef COMPONENTS_FILES_MEMORYMAPPEDFILE_HPP
+#define COMPONENTS_FILES_MEMORYMAPPEDFILE_HPP
+
+#include "lowlevelfile.hpp"
+
+#include <string>
+#include <vector>
+
+/// Read-only view of a whole file in memory.
+///
+/// Uses mmap/MapViewOfFile where available; on other platforms the file is read into a
+/// private buffer once, so callers can rely on data() staying valid until close().
+class MemoryMappedFile
+{
+public:
+
+    MemoryMappedFile ();
+    ~MemoryMappedFile ();
+
+    void open (char const * filename);
+    void close ();
+
+    bool isOpen () const;
+
+    const char * data () const { return mData; }
+    size_t size () const { return mSize; }
+
+private:
+
+    MemoryMappedFile (const MemoryMappedFile&);
+    MemoryMappedFile& operator= (const MemoryMappedFile&);
+
+    const char * mData;
+    size_t mSize;
+
+#if FILE_API == FILE_API_STDIO
+    std::vector<char> mBuffer;
+    bool mOpen;
+#elif FILE_API == FILE_API_POSIX
+    int mHandle;
+#elif FILE_API == FILE_API_WIN32
+    HANDLE mHandle;
+    HANDLE mMapping;
+#endif
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "context.hpp"
+
+#include "runtime.hpp"
+
+namespace Interpreter
+{
+    int Context::getGlobalShort (const Runtime& runtime, int name) const
+    {
+        return getGlobalShort (runtime.getStringLiteral (name));
+    }
+
+    int Context::getGlobalLong (const Runtime& runtime, int name) const
+    {
+        return getGlobalLong (runtime.getStringLiteral (name));
+    }
+
+    float Context::getGlobalFloat (const Runtime& runtime, int name) const
+    {
+        return getGlobalFloat (runtime.getStringLiteral (name));
+    }
+
+    void Context::setGlobalShort (const Runtime& runtime, int name, int value)
+    {
+        setGlobalShort (runtime.getStringLiteral (name), value);
+    }
+
+    void Context::setGlobalLong (const Runtime& runtime, int name, int value)
+    {
+        setGlobalLong (runtime.getStringLiteral (name), value);
+    }
+
+    void Context::setGlobalFloat (const Runtime& runtime, int name, float value)
+    {
+        setGlobalFloat (runtime.getStringLiteral (name), value);
+    }
+
+    int Context::getMemberShort (const Runtime& runtime, int id, int name, bool global) const
+    {
+        return getMemberShort (runtime.getStringLiteral (id), runtime.getStringLiteral (name), global);
+    }
+
+    int Context::getMemberLong (const Runtime& runtime, int id, int name, bool global) const
+    {
+        return getMemberLong (runtime.getStringLiteral (id), runtime.getStringLiteral (name), global);
+    }
+
+    float Context::getMemberFloat (const Runtime& runtime, int id, int name, bool global) const
+    {
+        return getMemberFloat (runtime.getStringLiteral (id), runtime.getStringLiteral (name), global);
+    }
+
+    void Context::setMemberShort (const Runtime& runtime, int id, int name, int value, bool global)
+    {
+        setMemberShort (runtime.getStringLiteral (id), runtime.getStringLiteral (name), value, global);
+    }
+
+    void Context::setMemberLong (const Runtime& runtime, int id, int name, int value, bool global)
+    {
+        setMemberLong (runtime.getStringLiteral (id), runtime.getStringLiteral (name), value, global);
+    }
+
+    void Context::setMemberFloat (const Runtime& runtime, int id, int name, float value, bool global)
+    {
+        setMemberFloat (runtime.getStringLiteral (id), runtime.getStringLiteral (name), value, global);
+    }
+}
@@ -6,6 +6,8 @@
 
 namespace Interpreter
 {
+    class Runtime;
+
     class Context
     {
         public:
@@ -110,6 +112,34 @@ namespace Interpreter
                 = 0;
 
             virtual std::string getTargetId() const = 0;
+
+            // Versions of the global and member variable access above that take the string
+            // literals holding the names, so that what they refer to can be kept. By default
+            // they look up the names.
+
+            virtual int getGlobalShort (const Runtime& runtime, int name) const;
+
+            virtual int getGlobalLong (const Runtime& runtime, int name) const;
+
+            virtual float getGlobalFloat (const Runtime& runtime, int name) const;
+
+            virtual void setGlobalShort (const Runtime& runtime, int name, int value);
+
+            virtual void setGlobalLong (const Runtime& runtime, int name, int value);
+
+            virtual void setGlobalFloat (const Runtime& runtime, int name, float value);
+
+            virtual int getMemberShort (const Runtime& runtime, int id, int name, bool global) const;
+
+            virtual int getMemberLong (const Runtime& runtime, int id, int name, bool global) const;
+
+            virtual float getMemberFloat (const Runtime& runtime, int id, int name, bool global) const;
+
+            virtual void setMemberShort (const Runtime& runtime, int id, int name, int value, bool global);
+
+            virtual void setMemberLong (const Runtime& runtime, int id, int name, int value, bool global);
+
+            virtual void setMemberFloat (const Runtime& runtime, int id, int name, float value, bool global);
     };
 }
 
@@ -13,7 +13,7 @@
 
 namespace Interpreter
 {
-    void installOpcodes (Interpreter& interpreter)
+    void installLocalOpcodes (Interpreter& interpreter)
     {
         // generic
         interpreter.installSegment0 (0, new OpPushInt);
@@ -24,7 +24,7 @@ namespace Interpreter
         interpreter.installSegment5 (17, new OpIntToFloat1);
         interpreter.installSegment5 (18, new OpFloatToInt1);
 
-        // local variables, global variables & literals
+        // local variables & literals
         interpreter.installSegment5 (0, new OpStoreLocalShort);
         interpreter.installSegment5 (1, new OpStoreLocalLong);
         interpreter.installSegment5 (2, new OpStoreLocalFloat);
@@ -33,24 +33,6 @@ namespace Interpreter
         interpreter.installSegment5 (21, new OpFetchLocalShort);
         interpreter.installSegment5 (22, new OpFetchLocalLong);
         interpreter.installSegment5 (23, new OpFetchLocalFloat);
-        interpreter.installSegment5 (39, new OpStoreGlobalShort);
-        interpreter.installSegment5 (40, new OpStoreGlobalLong);
-        interpreter.installSegment5 (41, new OpStoreGlobalFloat);
-        interpreter.installSegment5 (42, new OpFetchGlobalShort);
-        interpreter.installSegment5 (43, new OpFetchGlobalLong);
-        interpreter.installSegment5 (44, new OpFetchGlobalFloat);
-        interpreter.installSegment5 (59, new OpStoreMemberShort (false));
-        interpreter.installSegment5 (60, new OpStoreMemberLong (false));
-        interpreter.installSegment5 (61, new OpStoreMemberFloat (false));
-        interpreter.installSegment5 (62, new OpFetchMemberShort (false));
-        interpreter.installSegment5 (63, new OpFetchMemberLong (false));
-        interpreter.installSegment5 (64, new OpFetchMemberFloat (false));
-        interpreter.installSegment5 (65, new OpStoreMemberShort (true));
-        interpreter.installSegment5 (66, new OpStoreMemberLong (true));
-        interpreter.installSegment5 (67, new OpStoreMemberFloat (true));
-        interpreter.installSegment5 (68, new OpFetchMemberShort (true));
-        interpreter.installSegment5 (69, new OpFetchMemberLong (true));
-        interpreter.installSegment5 (70, new OpFetchMemberFloat (true));
 
         // math
         interpreter.installSegment5 (9, new OpAddInt<Type_Integer>);
@@ -95,11 +77,38 @@ namespace Interpreter
         interpreter.installSegment0 (1, new OpJumpForward);
         interpreter.installSegment0 (2, new OpJumpBackward);
 
+        // misc
+        interpreter.installSegment5 (50, new OpGetSecondsPassed);
+    }
+
+    void installOpcodes (Interpreter& interpreter)
+    {
+        installLocalOpcodes (interpreter);
+
+        // global & member variables
+        interpreter.installSegment5 (39, new OpStoreGlobalShort);
+        interpreter.installSegment5 (40, new OpStoreGlobalLong);
+        interpreter.installSegment5 (41, new OpStoreGlobalFloat);
+        interpreter.installSegment5 (42, new OpFetchGlobalShort);
+        interpreter.installSegment5 (43, new OpFetchGlobalLong);
+        interpreter.installSegment5 (44, new OpFetchGlobalFloat);
+        interpreter.installSegment5 (59, new OpStoreMemberShort (false));
+        interpreter.installSegment5 (60, new OpStoreMemberLong (false));
+        interpreter.installSegment5 (61, new OpStoreMemberFloat (false));
+        interpreter.installSegment5 (62, new OpFetchMemberShort (false));
+        interpreter.installSegment5 (63, new OpFetchMemberLong (false));
+        interpreter.installSegment5 (64, new OpFetchMemberFloat (false));
+        interpreter.installSegment5 (65, new OpStoreMemberShort (true));
+        interpreter.installSegment5 (66, new OpStoreMemberLong (true));
+        interpreter.installSegment5 (67, new OpStoreMemberFloat (true));
+        interpreter.installSegment5 (68, new OpFetchMemberShort (true));
+        interpreter.installSegment5 (69, new OpFetchMemberLong (true));
+        interpreter.installSegment5 (70, new OpFetchMemberFloat (true));
+
         // misc
         interpreter.installSegment3 (0, new OpMessageBox);
         interpreter.installSegment5 (38, new OpMenuMode);
         interpreter.installSegment5 (45, new OpRandom);
-        interpreter.installSegment5 (50, new OpGetSecondsPassed);
         interpreter.installSegment5 (51, new OpEnable);
         interpreter.installSegment5 (52, new OpDisable);
         interpreter.installSegment5 (53, new OpGetDisabled);
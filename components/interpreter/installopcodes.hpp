@@ -6,6 +6,10 @@ namespace Interpreter
     class Interpreter;
     
     void installOpcodes (Interpreter& interpreter);
+
+    void installLocalOpcodes (Interpreter& interpreter);
+    ///< Install only the opcodes that use nothing but the stack, the literals and local
+    /// variables of the script and the time passed (a subset of installOpcodes).
 }
 
 #endif
@@ -5,11 +5,118 @@
 #include <sstream>
 #include <stdexcept>
 
+#include <boost/date_time/posix_time/posix_time.hpp>
+
 #include "opcodes.hpp"
 
 namespace Interpreter
 {
-    void Interpreter::execute (Type_Code code)
+    namespace
+    {
+        void executeOpcode0 (const Instruction& instruction, Runtime& runtime)
+        {
+            static_cast<Opcode0 *> (instruction.mOpcode)->execute (runtime);
+        }
+
+        void executeOpcode1 (const Instruction& instruction, Runtime& runtime)
+        {
+            static_cast<Opcode1 *> (instruction.mOpcode)->execute (runtime, instruction.mArg0);
+        }
+
+        void executeOpcode2 (const Instruction& instruction, Runtime& runtime)
+        {
+            static_cast<Opcode2 *> (instruction.mOpcode)->execute (runtime, instruction.mArg0,
+                instruction.mArg1);
+        }
+
+        // segment in mArg0, opcode in mArg1
+        void abortUnknownCode (const Instruction& instruction, Runtime& runtime)
+        {
+            std::ostringstream error;
+
+            error << "unknown opcode " << instruction.mArg1 << " in segment " << instruction.mArg0;
+
+            throw std::runtime_error (error.str());
+        }
+
+        // code in mArg0
+        void abortUnknownSegment (const Instruction& instruction, Runtime& runtime)
+        {
+            std::ostringstream error;
+
+            error << "opcode outside of the allocated segment range: " << instruction.mArg0;
+
+            throw std::runtime_error (error.str());
+        }
+
+        template<typename T>
+        Instruction makeInstruction (Instruction::Handler handler, T *opcode, int segment,
+            unsigned int code, unsigned int arg0 = 0, unsigned int arg1 = 0)
+        {
+            Instruction instruction;
+
+            if (opcode)
+            {
+                instruction.mHandler = handler;
+                instruction.mOpcode = opcode;
+                instruction.mArg0 = arg0;
+                instruction.mArg1 = arg1;
+            }
+            else
+            {
+                instruction.mHandler = abortUnknownCode;
+                instruction.mOpcode = 0;
+                instruction.mArg0 = segment;
+                instruction.mArg1 = code;
+            }
+
+            return instruction;
+        }
+
+        // one in this many executions of an opcode is timed while profiling
+        const std::size_t sProfileSampleRate = 16;
+    }
+
+    OpcodeProfile::OpcodeProfile()
+    : mCount (0), mTimed (0), mTime (0)
+    {}
+
+    double OpcodeProfile::getTime() const
+    {
+        return mTimed ? mTime * mCount / mTimed : 0;
+    }
+
+    template<typename T>
+    Interpreter::OpcodeTable<T>::OpcodeTable (unsigned int extensionBase)
+    : mExtensionBase (extensionBase)
+    {}
+
+    template<typename T>
+    Interpreter::OpcodeTable<T>::~OpcodeTable()
+    {
+        for (typename std::vector<T *>::iterator iter (mCore.begin()); iter!=mCore.end(); ++iter)
+            delete *iter;
+
+        for (typename std::vector<T *>::iterator iter (mExtensions.begin()); iter!=mExtensions.end(); ++iter)
+            delete *iter;
+    }
+
+    template<typename T>
+    void Interpreter::OpcodeTable<T>::insert (unsigned int code, T *opcode)
+    {
+        std::vector<T *>& table = code<mExtensionBase ? mCore : mExtensions;
+
+        if (code>=mExtensionBase)
+            code -= mExtensionBase;
+
+        if (code>=table.size())
+            table.resize (code+1, 0);
+
+        assert (!table[code]);
+        table[code] = opcode;
+    }
+
+    Instruction Interpreter::decode (Type_Code code) const
     {
         unsigned int segSpec = code>>30;
 
@@ -20,14 +127,7 @@ namespace Interpreter
                 int opcode = code>>24;
                 unsigned int arg0 = code & 0xffffff;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment0.find (opcode);
-
-                if (iter==mSegment0.end())
-                    abortUnknownCode (0, opcode);
-
-                iter->second->execute (mRuntime, arg0);
-
-                return;
+                return makeInstruction (executeOpcode1, mSegment0.find (opcode), 0, opcode, arg0);
             }
 
             case 1:
@@ -36,14 +136,7 @@ namespace Interpreter
                 unsigned int arg0 = (code>>16) & 0xfff;
                 unsigned int arg1 = code & 0xfff;
 
-                std::map<int, Opcode2 *>::iterator iter = mSegment1.find (opcode);
-
-                if (iter==mSegment1.end())
-                    abortUnknownCode (1, opcode);
-
-                iter->second->execute (mRuntime, arg0, arg1);
-
-                return;
+                return makeInstruction (executeOpcode2, mSegment1.find (opcode), 1, opcode, arg0, arg1);
             }
 
             case 2:
@@ -51,14 +144,7 @@ namespace Interpreter
                 int opcode = (code>>20) & 0x3ff;
                 unsigned int arg0 = code & 0xfffff;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment2.find (opcode);
-
-                if (iter==mSegment2.end())
-                    abortUnknownCode (2, opcode);
-
-                iter->second->execute (mRuntime, arg0);
-
-                return;
+                return makeInstruction (executeOpcode1, mSegment2.find (opcode), 2, opcode, arg0);
             }
         }
 
@@ -71,14 +157,7 @@ namespace Interpreter
                 int opcode = (code>>8) & 0x3ffff;
                 unsigned int arg0 = code & 0xff;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment3.find (opcode);
-
-                if (iter==mSegment3.end())
-                    abortUnknownCode (3, opcode);
-
-                iter->second->execute (mRuntime, arg0);
-
-                return;
+                return makeInstruction (executeOpcode1, mSegment3.find (opcode), 3, opcode, arg0);
             }
 
             case 0x31:
@@ -87,50 +166,49 @@ namespace Interpreter
                 unsigned int arg0 = (code>>8) & 0xff;
                 unsigned int arg1 = code & 0xff;
 
-                std::map<int, Opcode2 *>::iterator iter = mSegment4.find (opcode);
-
-                if (iter==mSegment4.end())
-                    abortUnknownCode (4, opcode);
-
-                iter->second->execute (mRuntime, arg0, arg1);
-
-                return;
+                return makeInstruction (executeOpcode2, mSegment4.find (opcode), 4, opcode, arg0, arg1);
             }
 
             case 0x32:
             {
                 int opcode = code & 0x3ffffff;
 
-                std::map<int, Opcode0 *>::iterator iter = mSegment5.find (opcode);
-
-                if (iter==mSegment5.end())
-                    abortUnknownCode (5, opcode);
-
-                iter->second->execute (mRuntime);
-
-                return;
+                return makeInstruction (executeOpcode0, mSegment5.find (opcode), 5, opcode);
             }
         }
 
-        abortUnknownSegment (code);
+        Instruction instruction;
+        instruction.mHandler = abortUnknownSegment;
+        instruction.mOpcode = 0;
+        instruction.mArg0 = code;
+        instruction.mArg1 = 0;
+        return instruction;
     }
 
-    void Interpreter::abortUnknownCode (int segment, int opcode)
+    void Interpreter::decode (const Type_Code *code, int codeSize, Instructions& instructions) const
     {
-        std::ostringstream error;
+        assert (codeSize>=4);
 
-        error << "unknown opcode " << opcode << " in segment " << segment;
+        int opcodes = static_cast<int> (code[0]);
 
-        throw std::runtime_error (error.str());
+        instructions.clear();
+        instructions.reserve (opcodes);
+
+        for (int i = 0; i<opcodes; ++i)
+            instructions.push_back (decode (code[4+i]));
     }
 
-    void Interpreter::abortUnknownSegment (Type_Code code)
+    bool Interpreter::canRun (const Type_Code *code, int codeSize) const
     {
-        std::ostringstream error;
+        assert (codeSize>=4);
 
-        error << "opcode outside of the allocated segment range: " << code;
+        int opcodes = static_cast<int> (code[0]);
 
-        throw std::runtime_error (error.str());
+        for (int i = 0; i<opcodes; ++i)
+            if (!decode (code[4+i]).mOpcode)
+                return false;
+
+        return true;
     }
 
     void Interpreter::begin()
@@ -160,70 +238,78 @@ namespace Interpreter
         }
     }
 
-    Interpreter::Interpreter() : mRunning (false)
-    {}
-
-    Interpreter::~Interpreter()
+    void Interpreter::runProfiled (const Instruction& instruction)
     {
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment0.begin());
-            iter!=mSegment0.end(); ++iter)
-            delete iter->second;
+        if (!instruction.mOpcode)
+        {
+            instruction.mHandler (instruction, mRuntime);
+            return;
+        }
 
-        for (std::map<int, Opcode2 *>::iterator iter (mSegment1.begin());
-            iter!=mSegment1.end(); ++iter)
-            delete iter->second;
+        OpcodeProfile& profile = mProfiles[instruction.mOpcode];
+        ++profile.mCount;
 
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment2.begin());
-            iter!=mSegment2.end(); ++iter)
-            delete iter->second;
+        // Reading the clock costs about as much as a cheap opcode, so only a sample of the
+        // executions of each opcode is timed, starting with the first (see OpcodeProfile::getTime).
+        if ((profile.mCount-1) % sProfileSampleRate)
+        {
+            instruction.mHandler (instruction, mRuntime);
+            return;
+        }
 
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment3.begin());
-            iter!=mSegment3.end(); ++iter)
-            delete iter->second;
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
 
-        for (std::map<int, Opcode2 *>::iterator iter (mSegment4.begin());
-            iter!=mSegment4.end(); ++iter)
-            delete iter->second;
+        instruction.mHandler (instruction, mRuntime);
 
-        for (std::map<int, Opcode0 *>::iterator iter (mSegment5.begin());
-            iter!=mSegment5.end(); ++iter)
-            delete iter->second;
+        boost::posix_time::time_duration duration =
+            boost::posix_time::microsec_clock::universal_time() - start;
+
+        ++profile.mTimed;
+        profile.mTime += duration.total_microseconds() / 1000000.0;
     }
 
+    Interpreter::Interpreter()
+    : mRunning (false), mSegment0 (32), mSegment1 (32), mSegment2 (512), mSegment3 (131072),
+      mSegment4 (512), mSegment5 (0x2000000), mInstructionCount (0), mProfiling (false)
+    {}
+
+    Interpreter::~Interpreter()
+    {}
+
     void Interpreter::installSegment0 (int code, Opcode1 *opcode)
     {
-        assert(mSegment0.find(code) == mSegment0.end());
-        mSegment0.insert (std::make_pair (code, opcode));
+        mSegment0.insert (code, opcode);
+        mOpcodeIds[opcode] = std::make_pair (0, static_cast<unsigned int> (code));
     }
 
     void Interpreter::installSegment1 (int code, Opcode2 *opcode)
     {
-        assert(mSegment1.find(code) == mSegment1.end());
-        mSegment1.insert (std::make_pair (code, opcode));
+        mSegment1.insert (code, opcode);
+        mOpcodeIds[opcode] = std::make_pair (1, static_cast<unsigned int> (code));
     }
 
     void Interpreter::installSegment2 (int code, Opcode1 *opcode)
     {
-        assert(mSegment2.find(code) == mSegment2.end());
-        mSegment2.insert (std::make_pair (code, opcode));
+        mSegment2.insert (code, opcode);
+        mOpcodeIds[opcode] = std::make_pair (2, static_cast<unsigned int> (code));
     }
 
     void Interpreter::installSegment3 (int code, Opcode1 *opcode)
     {
-        assert(mSegment3.find(code) == mSegment3.end());
-        mSegment3.insert (std::make_pair (code, opcode));
+        mSegment3.insert (code, opcode);
+        mOpcodeIds[opcode] = std::make_pair (3, static_cast<unsigned int> (code));
     }
 
     void Interpreter::installSegment4 (int code, Opcode2 *opcode)
     {
-        assert(mSegment4.find(code) == mSegment4.end());
-        mSegment4.insert (std::make_pair (code, opcode));
+        mSegment4.insert (code, opcode);
+        mOpcodeIds[opcode] = std::make_pair (4, static_cast<unsigned int> (code));
     }
 
     void Interpreter::installSegment5 (int code, Opcode0 *opcode)
     {
-        assert(mSegment5.find(code) == mSegment5.end());
-        mSegment5.insert (std::make_pair (code, opcode));
+        mSegment5.insert (code, opcode);
+        mOpcodeIds[opcode] = std::make_pair (5, static_cast<unsigned int> (code));
     }
 
     void Interpreter::run (const Type_Code *code, int codeSize, Context& context)
@@ -242,9 +328,56 @@ namespace Interpreter
 
             while (mRuntime.getPC()>=0 && mRuntime.getPC()<opcodes)
             {
-                Type_Code code = codeBlock[mRuntime.getPC()];
+                Instruction instruction = decode (codeBlock[mRuntime.getPC()]);
                 mRuntime.setPC (mRuntime.getPC()+1);
-                execute (code);
+                ++mInstructionCount;
+
+                if (mProfiling)
+                    runProfiled (instruction);
+                else
+                    instruction.mHandler (instruction, mRuntime);
+            }
+        }
+        catch (...)
+        {
+            end();
+            throw;
+        }
+
+        end();
+    }
+
+    void Interpreter::run (const Type_Code *code, int codeSize, const Instructions& instructions,
+        Context& context)
+    {
+        assert (codeSize>=4);
+        assert (instructions.size()==code[0]);
+
+        begin();
+
+        try
+        {
+            mRuntime.configure (code, codeSize, context);
+
+            int opcodes = static_cast<int> (instructions.size());
+
+            if (opcodes>0)
+            {
+                const Instruction *block = &instructions[0];
+
+                // The opcodes were looked up by decode(), so each step is a single indirect call
+                // (and the virtual call of the opcode)
+                for (int pc = mRuntime.getPC(); pc>=0 && pc<opcodes; pc = mRuntime.getPC())
+                {
+                    const Instruction& instruction = block[pc];
+                    mRuntime.setPC (pc+1);
+                    ++mInstructionCount;
+
+                    if (mProfiling)
+                        runProfiled (instruction);
+                    else
+                        instruction.mHandler (instruction, mRuntime);
+                }
             }
         }
         catch (...)
@@ -255,4 +388,40 @@ namespace Interpreter
 
         end();
     }
+
+    std::size_t Interpreter::getInstructionCount() const
+    {
+        return mInstructionCount;
+    }
+
+    void Interpreter::setProfiling (bool profiling)
+    {
+        if (profiling && !mProfiling)
+            mProfiles.clear();
+
+        mProfiling = profiling;
+    }
+
+    bool Interpreter::isProfiling() const
+    {
+        return mProfiling;
+    }
+
+    void Interpreter::addProfiles (OpcodeProfiles& profiles) const
+    {
+        for (std::map<const void *, OpcodeProfile>::const_iterator iter (mProfiles.begin());
+            iter!=mProfiles.end(); ++iter)
+        {
+            std::map<const void *, std::pair<int, unsigned int> >::const_iterator id =
+                mOpcodeIds.find (iter->first);
+
+            if (id==mOpcodeIds.end())
+                continue;
+
+            OpcodeProfile& profile = profiles[id->second];
+            profile.mCount += iter->second.mCount;
+            profile.mTimed += iter->second.mTimed;
+            profile.mTime += iter->second.mTime;
+        }
+    }
 }
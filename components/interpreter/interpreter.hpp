@@ -1,8 +1,11 @@
 #ifndef INTERPRETER_INTERPRETER_H_INCLUDED
 #define INTERPRETER_INTERPRETER_H_INCLUDED
 
+#include <cstddef>
 #include <map>
 #include <stack>
+#include <utility>
+#include <vector>
 
 #include "runtime.hpp"
 #include "types.hpp"
@@ -13,32 +16,94 @@ namespace Interpreter
     class Opcode1;
     class Opcode2;
 
+    /// Code word with its opcode already looked up (see Interpreter::decode)
+    struct Instruction
+    {
+        typedef void (*Handler) (const Instruction& instruction, Runtime& runtime);
+
+        Handler mHandler;
+        void *mOpcode;
+        unsigned int mArg0;
+        unsigned int mArg1;
+    };
+
+    typedef std::vector<Instruction> Instructions;
+
+    /// Number of executions and running time of an opcode (see Interpreter::setProfiling)
+    struct OpcodeProfile
+    {
+        std::size_t mCount;
+        std::size_t mTimed; ///< number of executions that were timed
+        double mTime; ///< of the timed executions, in seconds
+
+        OpcodeProfile();
+
+        double getTime() const;
+        ///< Estimated running time of all executions, in seconds.
+    };
+
+    /// Opcode profiles by segment and opcode
+    typedef std::map<std::pair<int, unsigned int>, OpcodeProfile> OpcodeProfiles;
+
     class Interpreter
     {
+            /// Opcodes of one segment, in a vector indexed by opcode for the opcodes below the
+            /// range reserved for extensions and in another one for the extensions.
+            template<typename T>
+            class OpcodeTable
+            {
+                    std::vector<T *> mCore;
+                    std::vector<T *> mExtensions;
+                    unsigned int mExtensionBase;
+
+                    // not implemented
+                    OpcodeTable (const OpcodeTable&);
+                    OpcodeTable& operator= (const OpcodeTable&);
+
+                public:
+
+                    explicit OpcodeTable (unsigned int extensionBase);
+
+                    ~OpcodeTable();
+
+                    /// \return 0 if no opcode has been installed for \a code
+                    T *find (unsigned int code) const
+                    {
+                        if (code<mExtensionBase)
+                            return code<mCore.size() ? mCore[code] : 0;
+
+                        code -= mExtensionBase;
+                        return code<mExtensions.size() ? mExtensions[code] : 0;
+                    }
+
+                    void insert (unsigned int code, T *opcode);
+                    ///< ownership of \a opcode is transferred to *this.
+            };
+
             std::stack<Runtime> mCallstack;
             bool mRunning;
             Runtime mRuntime;
-            std::map<int, Opcode1 *> mSegment0;
-            std::map<int, Opcode2 *> mSegment1;
-            std::map<int, Opcode1 *> mSegment2;
-            std::map<int, Opcode1 *> mSegment3;
-            std::map<int, Opcode2 *> mSegment4;
-            std::map<int, Opcode0 *> mSegment5;
+            OpcodeTable<Opcode1> mSegment0;
+            OpcodeTable<Opcode2> mSegment1;
+            OpcodeTable<Opcode1> mSegment2;
+            OpcodeTable<Opcode1> mSegment3;
+            OpcodeTable<Opcode2> mSegment4;
+            OpcodeTable<Opcode0> mSegment5;
+            std::size_t mInstructionCount;
+            bool mProfiling;
+            std::map<const void *, OpcodeProfile> mProfiles; ///< by opcode
+            std::map<const void *, std::pair<int, unsigned int> > mOpcodeIds; ///< segment and opcode
 
             // not implemented
             Interpreter (const Interpreter&);
             Interpreter& operator= (const Interpreter&);
 
-            void execute (Type_Code code);
-
-            void abortUnknownCode (int segment, int opcode);
-
-            void abortUnknownSegment (Type_Code code);
-
             void begin();
 
             void end();
 
+            void runProfiled (const Instruction& instruction);
+
         public:
 
             Interpreter();
@@ -63,7 +128,34 @@ namespace Interpreter
             void installSegment5 (int code, Opcode0 *opcode);
             ///< ownership of \a opcode is transferred to *this.
 
+            Instruction decode (Type_Code code) const;
+            ///< Look up the opcode of \a code. Unknown opcodes are only reported when the
+            /// instruction is executed.
+
+            void decode (const Type_Code *code, int codeSize, Instructions& instructions) const;
+            ///< Decode the code block of \a code, which can then be run with the instructions
+            /// for as long as no opcodes are installed.
+
+            bool canRun (const Type_Code *code, int codeSize) const;
+            ///< Have opcodes been installed for all instructions of \a code?
+
             void run (const Type_Code *code, int codeSize, Context& context);
+
+            void run (const Type_Code *code, int codeSize, const Instructions& instructions,
+                Context& context);
+            ///< Run \a code with \a instructions decoded from it.
+
+            std::size_t getInstructionCount() const;
+            ///< Number of instructions executed so far.
+
+            void setProfiling (bool profiling);
+            ///< Count the executions of each opcode and time every few of them. Enabling the
+            /// profiling discards the counts and times collected before.
+
+            bool isProfiling() const;
+
+            void addProfiles (OpcodeProfiles& profiles) const;
+            ///< Add the counts and times collected so far to \a profiles.
     };
 }
 
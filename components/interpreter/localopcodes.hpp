@@ -122,9 +122,7 @@ namespace Interpreter
                 Type_Integer data = runtime[0].mInteger;
                 int index = runtime[1].mInteger;
 
-                std::string name = runtime.getStringLiteral (index);
-
-                runtime.getContext().setGlobalShort (name, data);
+                runtime.getContext().setGlobalShort (runtime, index, data);
 
                 runtime.pop();
                 runtime.pop();
@@ -140,9 +138,7 @@ namespace Interpreter
                 Type_Integer data = runtime[0].mInteger;
                 int index = runtime[1].mInteger;
 
-                std::string name = runtime.getStringLiteral (index);
-
-                runtime.getContext().setGlobalLong (name, data);
+                runtime.getContext().setGlobalLong (runtime, index, data);
 
                 runtime.pop();
                 runtime.pop();
@@ -158,9 +154,7 @@ namespace Interpreter
                 Type_Float data = runtime[0].mFloat;
                 int index = runtime[1].mInteger;
 
-                std::string name = runtime.getStringLiteral (index);
-
-                runtime.getContext().setGlobalFloat (name, data);
+                runtime.getContext().setGlobalFloat (runtime, index, data);
 
                 runtime.pop();
                 runtime.pop();
@@ -174,8 +168,7 @@ namespace Interpreter
             virtual void execute (Runtime& runtime)
             {
                 int index = runtime[0].mInteger;
-                std::string name = runtime.getStringLiteral (index);
-                Type_Integer value = runtime.getContext().getGlobalShort (name);
+                Type_Integer value = runtime.getContext().getGlobalShort (runtime, index);
                 runtime[0].mInteger = value;
             }
     };
@@ -187,8 +180,7 @@ namespace Interpreter
             virtual void execute (Runtime& runtime)
             {
                 int index = runtime[0].mInteger;
-                std::string name = runtime.getStringLiteral (index);
-                Type_Integer value = runtime.getContext().getGlobalLong (name);
+                Type_Integer value = runtime.getContext().getGlobalLong (runtime, index);
                 runtime[0].mInteger = value;
             }
     };
@@ -200,8 +192,7 @@ namespace Interpreter
             virtual void execute (Runtime& runtime)
             {
                 int index = runtime[0].mInteger;
-                std::string name = runtime.getStringLiteral (index);
-                Type_Float value = runtime.getContext().getGlobalFloat (name);
+                Type_Float value = runtime.getContext().getGlobalFloat (runtime, index);
                 runtime[0].mFloat = value;
             }
     };
@@ -217,12 +208,10 @@ namespace Interpreter
             virtual void execute (Runtime& runtime)
             {
                 Type_Integer data = runtime[0].mInteger;
-                Type_Integer index = runtime[1].mInteger;
-                std::string id = runtime.getStringLiteral (index);
-                index = runtime[2].mInteger;
-                std::string variable = runtime.getStringLiteral (index);
+                Type_Integer id = runtime[1].mInteger;
+                Type_Integer variable = runtime[2].mInteger;
 
-                runtime.getContext().setMemberShort (id, variable, data, mGlobal);
+                runtime.getContext().setMemberShort (runtime, id, variable, data, mGlobal);
 
                 runtime.pop();
                 runtime.pop();
@@ -241,12 +230,10 @@ namespace Interpreter
             virtual void execute (Runtime& runtime)
             {
                 Type_Integer data = runtime[0].mInteger;
-                Type_Integer index = runtime[1].mInteger;
-                std::string id = runtime.getStringLiteral (index);
-                index = runtime[2].mInteger;
-                std::string variable = runtime.getStringLiteral (index);
+                Type_Integer id = runtime[1].mInteger;
+                Type_Integer variable = runtime[2].mInteger;
 
-                runtime.getContext().setMemberLong (id, variable, data, mGlobal);
+                runtime.getContext().setMemberLong (runtime, id, variable, data, mGlobal);
 
                 runtime.pop();
                 runtime.pop();
@@ -265,12 +252,10 @@ namespace Interpreter
             virtual void execute (Runtime& runtime)
             {
                 Type_Float data = runtime[0].mFloat;
-                Type_Integer index = runtime[1].mInteger;
-                std::string id = runtime.getStringLiteral (index);
-                index = runtime[2].mInteger;
-                std::string variable = runtime.getStringLiteral (index);
+                Type_Integer id = runtime[1].mInteger;
+                Type_Integer variable = runtime[2].mInteger;
 
-                runtime.getContext().setMemberFloat (id, variable, data, mGlobal);
+                runtime.getContext().setMemberFloat (runtime, id, variable, data, mGlobal);
 
                 runtime.pop();
                 runtime.pop();
@@ -288,13 +273,11 @@ namespace Interpreter
 
             virtual void execute (Runtime& runtime)
             {
-                Type_Integer index = runtime[0].mInteger;
-                std::string id = runtime.getStringLiteral (index);
-                index = runtime[1].mInteger;
-                std::string variable = runtime.getStringLiteral (index);
+                Type_Integer id = runtime[0].mInteger;
+                Type_Integer variable = runtime[1].mInteger;
                 runtime.pop();
 
-                int value = runtime.getContext().getMemberShort (id, variable, mGlobal);
+                int value = runtime.getContext().getMemberShort (runtime, id, variable, mGlobal);
                 runtime[0].mInteger = value;
             }
     };
@@ -309,13 +292,11 @@ namespace Interpreter
 
             virtual void execute (Runtime& runtime)
             {
-                Type_Integer index = runtime[0].mInteger;
-                std::string id = runtime.getStringLiteral (index);
-                index = runtime[1].mInteger;
-                std::string variable = runtime.getStringLiteral (index);
+                Type_Integer id = runtime[0].mInteger;
+                Type_Integer variable = runtime[1].mInteger;
                 runtime.pop();
 
-                int value = runtime.getContext().getMemberLong (id, variable, mGlobal);
+                int value = runtime.getContext().getMemberLong (runtime, id, variable, mGlobal);
                 runtime[0].mInteger = value;
             }
     };
@@ -330,13 +311,11 @@ namespace Interpreter
 
             virtual void execute (Runtime& runtime)
             {
-                Type_Integer index = runtime[0].mInteger;
-                std::string id = runtime.getStringLiteral (index);
-                index = runtime[1].mInteger;
-                std::string variable = runtime.getStringLiteral (index);
+                Type_Integer id = runtime[0].mInteger;
+                Type_Integer variable = runtime[1].mInteger;
                 runtime.pop();
 
-                float value = runtime.getContext().getMemberFloat (id, variable, mGlobal);
+                float value = runtime.getContext().getMemberFloat (runtime, id, variable, mGlobal);
                 runtime[0].mFloat = value;
             }
     };
@@ -16,6 +16,9 @@ public:
     /// seed the RNG
     static void init();
 
+    /// seed the RNG with a fixed value, to repeat the same rolls (e.g. in tests)
+    static void init(unsigned int seed);
+
     /// return value in range [0.0f, 1.0f)  <- note open upper range.
     static float rollProbability();
   
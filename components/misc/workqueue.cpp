@@ -0,0 +1,117 @@
+#include "workqueue.hpp"
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace Misc
+{
+    WorkItem::WorkItem() : mDone (false) {}
+
+    WorkItem::~WorkItem() {}
+
+    void WorkItem::run()
+    {
+        std::string error;
+
+        try
+        {
+            doWork();
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+
+            if (error.empty())
+                error = "unknown error";
+        }
+        catch (...)
+        {
+            error = "unknown error";
+        }
+
+        boost::unique_lock<boost::mutex> lock (mMutex);
+        mError = error;
+        mDone = true;
+        mCondition.notify_all();
+    }
+
+    bool WorkItem::isDone() const
+    {
+        boost::unique_lock<boost::mutex> lock (mMutex);
+        return mDone;
+    }
+
+    void WorkItem::waitTillDone()
+    {
+        boost::unique_lock<boost::mutex> lock (mMutex);
+
+        while (!mDone)
+            mCondition.wait (lock);
+
+        if (!mError.empty())
+            throw std::runtime_error (mError);
+    }
+
+
+    WorkQueue::WorkQueue (int workerThreads) : mIsReleased (false)
+    {
+        if (workerThreads<=0)
+            workerThreads = static_cast<int> (boost::thread::hardware_concurrency())-1;
+
+        if (workerThreads<1)
+            workerThreads = 1;
+
+        for (int i=0; i<workerThreads; ++i)
+            mThreads.push_back (new boost::thread (boost::bind (&WorkQueue::threadBody, this)));
+    }
+
+    WorkQueue::~WorkQueue()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock (mMutex);
+            mQueue.clear();
+            mIsReleased = true;
+            mCondition.notify_all();
+        }
+
+        for (std::vector<boost::thread *>::iterator iter (mThreads.begin()); iter!=mThreads.end(); ++iter)
+        {
+            (*iter)->join();
+            delete *iter;
+        }
+    }
+
+    void WorkQueue::addWorkItem (WorkItemPtr item)
+    {
+        boost::unique_lock<boost::mutex> lock (mMutex);
+        mQueue.push_back (item);
+        mCondition.notify_one();
+    }
+
+    int WorkQueue::getNumThreads() const
+    {
+        return static_cast<int> (mThreads.size());
+    }
+
+    WorkItemPtr WorkQueue::removeWorkItem()
+    {
+        boost::unique_lock<boost::mutex> lock (mMutex);
+
+        while (mQueue.empty() && !mIsReleased)
+            mCondition.wait (lock);
+
+        if (mIsReleased)
+            return WorkItemPtr();
+
+        WorkItemPtr item = mQueue.front();
+        mQueue.pop_front();
+        return item;
+    }
+
+    void WorkQueue::threadBody()
+    {
+        while (WorkItemPtr item = removeWorkItem())
+            item->run();
+    }
+}
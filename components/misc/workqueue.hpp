@@ -0,0 +1,80 @@
+#ifndef OPENMW_COMPONENTS_MISC_WORKQUEUE_H
+#define OPENMW_COMPONENTS_MISC_WORKQUEUE_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace Misc
+{
+    /// A unit of work executed by a WorkQueue.
+    class WorkItem
+    {
+            mutable boost::mutex mMutex;
+            boost::condition_variable mCondition;
+            bool mDone;
+            std::string mError;
+
+            WorkItem (const WorkItem&);
+            WorkItem& operator= (const WorkItem&);
+
+        protected:
+
+            /// Called from a worker thread. Exceptions are caught and rethrown by waitTillDone().
+            virtual void doWork() = 0;
+
+        public:
+
+            WorkItem();
+
+            virtual ~WorkItem();
+
+            /// Execute the item on the calling thread and mark it as done.
+            void run();
+
+            bool isDone() const;
+
+            /// Block until the item has been executed.
+            /// \throw std::runtime_error if doWork() threw
+            void waitTillDone();
+    };
+
+    typedef boost::shared_ptr<WorkItem> WorkItemPtr;
+
+    /// A fixed pool of worker threads consuming WorkItems in FIFO order.
+    class WorkQueue
+    {
+            std::deque<WorkItemPtr> mQueue;
+            bool mIsReleased;
+            boost::mutex mMutex;
+            boost::condition_variable mCondition;
+            std::vector<boost::thread *> mThreads;
+
+            WorkQueue (const WorkQueue&);
+            WorkQueue& operator= (const WorkQueue&);
+
+            /// Block until an item is available; returns an empty pointer once the queue is released.
+            WorkItemPtr removeWorkItem();
+
+            void threadBody();
+
+        public:
+
+            /// \param workerThreads 0: one thread less than the number of hardware threads (at least one)
+            explicit WorkQueue (int workerThreads = 0);
+
+            /// Discards queued items that have not been started and joins the worker threads.
+            ~WorkQueue();
+
+            void addWorkItem (WorkItemPtr item);
+
+            int getNumThreads() const;
+    };
+}
+
+#endif
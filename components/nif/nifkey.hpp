@@ -5,6 +5,12 @@
 
 #include <OgreStringConverter.h>
 
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <map>
+#include <vector>
+
 #include "nifstream.hpp"
 
 namespace Nif
@@ -26,9 +32,12 @@ typedef KeyT<Ogre::Vector3> Vector3Key;
 typedef KeyT<Ogre::Vector4> Vector4Key;
 typedef KeyT<Ogre::Quaternion> QuaternionKey;
 
+/// Keys are kept in two parallel arrays sorted by time, so that finding the keys around a
+/// point in time does not have to chase pointers.
 template<typename T, T (NIFStream::*getValue)()>
 struct KeyMapT {
-    typedef std::map< float, KeyT<T> > MapType;
+    typedef std::vector<float> TimeList;
+    typedef std::vector< KeyT<T> > KeyList;
 
     static const unsigned int sLinearInterpolation = 1;
     static const unsigned int sQuadraticInterpolation = 2;
@@ -36,10 +45,37 @@ struct KeyMapT {
     static const unsigned int sXYZInterpolation = 4;
 
     unsigned int mInterpolationType;
-    MapType mKeys;
+    TimeList mTimes; ///< ascending, no duplicates
+    KeyList mKeys;   ///< mKeys[i] is the key at mTimes[i]
 
     KeyMapT() : mInterpolationType(sLinearInterpolation) {}
 
+    /// Return the index of the first key at or after \a time, or mKeys.size() if there is none.
+    ///
+    /// \param cursor The result of the previous call for the same user of this list. During
+    /// playback the answer is almost always the same key or the next one, so these are tried
+    /// before a binary search. Updated on return.
+    size_t findKey(float time, size_t &cursor) const
+    {
+        size_t size = mTimes.size();
+
+        if (cursor < size)
+        {
+            if (mTimes[cursor] >= time)
+            {
+                if (cursor == 0 || mTimes[cursor-1] < time)
+                    return cursor;
+            }
+            else if (cursor+1 == size || mTimes[cursor+1] >= time)
+                return ++cursor;
+        }
+        else if (size > 0 && mTimes.back() < time)
+            return cursor = size;
+
+        cursor = std::lower_bound(mTimes.begin(), mTimes.end(), time) - mTimes.begin();
+        return cursor;
+    }
+
     //Read in a KeyGroup (see http://niftools.sourceforge.net/doc/nif/NiKeyframeData.html)
     void read(NIFStream *nif, bool force=false)
     {
@@ -51,39 +87,42 @@ struct KeyMapT {
         if(count == 0 && !force)
             return;
 
+        mTimes.clear();
         mKeys.clear();
 
         mInterpolationType = nif->getUInt();
 
-        KeyT<T> key;
         NIFStream &nifReference = *nif;
 
         if(mInterpolationType == sLinearInterpolation)
         {
+            resize(count);
             for(size_t i = 0;i < count;i++)
             {
-                float time = nif->getFloat();
-                readValue(nifReference, key);
-                mKeys[time] = key;
+                mTimes[i] = nif->getFloat();
+                readValue(nifReference, mKeys[i]);
             }
+            sort();
         }
         else if(mInterpolationType == sQuadraticInterpolation)
         {
+            resize(count);
             for(size_t i = 0;i < count;i++)
             {
-                float time = nif->getFloat();
-                readQuadratic(nifReference, key);
-                mKeys[time] = key;
+                mTimes[i] = nif->getFloat();
+                readQuadratic(nifReference, mKeys[i]);
             }
+            sort();
         }
         else if(mInterpolationType == sTBCInterpolation)
         {
+            resize(count);
             for(size_t i = 0;i < count;i++)
             {
-                float time = nif->getFloat();
-                readTBC(nifReference, key);
-                mKeys[time] = key;
+                mTimes[i] = nif->getFloat();
+                readTBC(nifReference, mKeys[i]);
             }
+            sort();
         }
         //XYZ keys aren't actually read here.
         //data.hpp sees that the last type read was sXYZInterpolation and:
@@ -106,6 +145,32 @@ struct KeyMapT {
     }
 
 private:
+    void resize(size_t count)
+    {
+        mTimes.resize(count);
+        mKeys.resize(count);
+    }
+
+    /// Keys are stored in order in practice; if not, sort them and keep the last key read for
+    /// each time
+    void sort()
+    {
+        if (std::adjacent_find(mTimes.begin(), mTimes.end(), std::greater_equal<float>()) == mTimes.end())
+            return;
+
+        std::map< float, KeyT<T> > sorted;
+        for (size_t i = 0; i < mTimes.size(); i++)
+            sorted[mTimes[i]] = mKeys[i];
+
+        mTimes.clear();
+        mKeys.clear();
+        for (typename std::map< float, KeyT<T> >::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+        {
+            mTimes.push_back(it->first);
+            mKeys.push_back(it->second);
+        }
+    }
+
     static void readValue(NIFStream &nif, KeyT<T> &key)
     {
         key.mValue = (nif.*getValue)();
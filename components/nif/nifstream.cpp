@@ -2,35 +2,76 @@
 //For error reporting
 #include "niffile.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include <OgrePlatform.h>
+
 namespace Nif
 {
 
-//Private functions
-uint8_t NIFStream::read_byte()
-{
-    uint8_t byte;
-    if(inp->read(&byte, 1) != 1) return 0;
-    return byte;
-}
-uint16_t NIFStream::read_le16()
-{
-    uint8_t buffer[2];
-    if(inp->read(buffer, 2) != 2) return 0;
-    return buffer[0] | (buffer[1]<<8);
-}
-uint32_t NIFStream::read_le32()
+NIFStream::NIFStream (NIFFile * file, Ogre::DataStreamPtr inp)
+  : inp (inp), mPos (0), mEnd (0), file (file)
 {
-    uint8_t buffer[4];
-    if(inp->read(buffer, 4) != 4) return 0;
-    return buffer[0] | (buffer[1]<<8) | (buffer[2]<<16) | (buffer[3]<<24);
+    Ogre::MemoryDataStream *memory = dynamic_cast<Ogre::MemoryDataStream *>(inp.get());
+
+    if (memory)
+    {
+        // e.g. an archive entry that is already in memory, no need for another copy
+        mPos = reinterpret_cast<const char *>(memory->getCurrentPtr());
+        mEnd = mPos + (memory->size() - memory->tell());
+        return;
+    }
+
+    size_t size = inp->size();
+
+    if (size != 0)
+    {
+        mBuffer.resize(size);
+        mBuffer.resize(inp->read(&mBuffer[0], size));
+    }
+    else
+    {
+        // size unknown, read until the end
+        const size_t chunk = 64*1024;
+        while (!inp->eof())
+        {
+            size_t offset = mBuffer.size();
+            mBuffer.resize(offset + chunk);
+            size_t read = inp->read(&mBuffer[offset], chunk);
+            mBuffer.resize(offset + read);
+            if (read == 0)
+                break;
+        }
+    }
+
+    if (!mBuffer.empty())
+    {
+        mPos = &mBuffer[0];
+        mEnd = mPos + mBuffer.size();
+    }
 }
-float NIFStream::read_le32f()
+
+//Private functions
+void NIFStream::readLittleEndianArray(void *dest, size_t count, size_t size)
 {
-    union {
-        uint32_t i;
-        float f;
-    } u = { read_le32() };
-    return u.f;
+    size_t bytes = count * size;
+    size_t available = std::min(bytes, remaining());
+    available -= available % size; // a truncated value reads as 0
+
+    if (available > 0)
+        std::memcpy(dest, mPos, available);
+    if (available < bytes)
+        std::memset(static_cast<char *>(dest) + available, 0, bytes - available);
+
+    mPos = available == bytes ? mPos + bytes : mEnd;
+
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+    char *value = static_cast<char *>(dest);
+    for (size_t i = 0; i < count; ++i, value += size)
+        std::reverse(value, value + size);
+#endif
 }
 
 //Public functions
@@ -88,13 +129,14 @@ std::string NIFStream::getString(size_t length)
     if(fileSize != 0 && fileSize < length)
         file->fail("Attempted to read a string with " + Ogre::StringConverter::toString(length) + " characters , but file is only "+Ogre::StringConverter::toString(fileSize)+ " bytes!");
 
-    std::vector<char> str (length+1, 0);
+    const char *str = advance(length);
 
-    if(inp->read(&str[0], length) != length)
+    if(!str)
         throw std::runtime_error (":  String length in NIF file "+ file->getFilename() +" does not match!  Expected length:  "
             + Ogre::StringConverter::toString(length));
 
-    return &str[0];
+    // stop at an embedded terminator, like the C string this used to be copied through
+    return std::string(str, std::find(str, str + length, '\0'));
 }
 std::string NIFStream::getString()
 {
@@ -103,44 +145,80 @@ std::string NIFStream::getString()
 }
 std::string NIFStream::getVersionString()
 {
-    return inp->getLine();
+    const char *begin = mPos;
+    const char *end = std::find(begin, mEnd, '\n');
+
+    mPos = end == mEnd ? mEnd : end + 1;
+
+    // trim like Ogre::DataStream::getLine
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin)))
+        ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(*(end - 1))))
+        --end;
+
+    return std::string(begin, end);
 }
 
 void NIFStream::getShorts(std::vector<short> &vec, size_t size)
 {
     vec.resize(size);
-    for(size_t i = 0;i < vec.size();i++)
-        vec[i] = getShort();
+    if(size > 0)
+        readLittleEndianArray(&vec[0], size, sizeof(short));
 }
 void NIFStream::getFloats(std::vector<float> &vec, size_t size)
 {
     vec.resize(size);
-    for(size_t i = 0;i < vec.size();i++)
-        vec[i] = getFloat();
+    if(size > 0)
+        readLittleEndianArray(&vec[0], size, sizeof(float));
 }
 void NIFStream::getVector2s(std::vector<Ogre::Vector2> &vec, size_t size)
 {
     vec.resize(size);
-    for(size_t i = 0;i < vec.size();i++)
-        vec[i] = getVector2();
+    if(size == 0)
+        return;
+
+    if(sizeof(Ogre::Vector2) == 2*sizeof(float))
+        readLittleEndianArray(&vec[0], size*2, sizeof(float));
+    else
+        for(size_t i = 0;i < vec.size();i++)
+            vec[i] = getVector2();
 }
 void NIFStream::getVector3s(std::vector<Ogre::Vector3> &vec, size_t size)
 {
     vec.resize(size);
-    for(size_t i = 0;i < vec.size();i++)
-        vec[i] = getVector3();
+    if(size == 0)
+        return;
+
+    if(sizeof(Ogre::Vector3) == 3*sizeof(float))
+        readLittleEndianArray(&vec[0], size*3, sizeof(float));
+    else
+        for(size_t i = 0;i < vec.size();i++)
+            vec[i] = getVector3();
 }
 void NIFStream::getVector4s(std::vector<Ogre::Vector4> &vec, size_t size)
 {
     vec.resize(size);
-    for(size_t i = 0;i < vec.size();i++)
-        vec[i] = getVector4();
+    if(size == 0)
+        return;
+
+    if(sizeof(Ogre::Vector4) == 4*sizeof(float))
+        readLittleEndianArray(&vec[0], size*4, sizeof(float));
+    else
+        for(size_t i = 0;i < vec.size();i++)
+            vec[i] = getVector4();
 }
 void NIFStream::getQuaternions(std::vector<Ogre::Quaternion> &quat, size_t size)
 {
     quat.resize(size);
-    for(size_t i = 0;i < quat.size();i++)
-        quat[i] = getQuaternion();
+    if(size == 0)
+        return;
+
+    // stored as w, x, y, z, which is also Ogre's member order
+    if(sizeof(Ogre::Quaternion) == 4*sizeof(float))
+        readLittleEndianArray(&quat[0], size*4, sizeof(float));
+    else
+        for(size_t i = 0;i < quat.size();i++)
+            quat[i] = getQuaternion();
 }
 
 }
@@ -5,6 +5,7 @@
 
 #include <stdint.h>
 #include <stdexcept>
+#include <vector>
 
 #include <OgreDataStream.h>
 #include <OgreVector2.h>
@@ -21,23 +22,73 @@ namespace Nif
 
 class NIFFile;
 
+/// Reads the whole file into memory once (or uses the stream's buffer directly if it already
+/// is a MemoryDataStream) and decodes from there; arrays are copied in bulk.
 class NIFStream {
 
     /// Input stream
     Ogre::DataStreamPtr inp;
 
-    uint8_t read_byte();
-    uint16_t read_le16();
-    uint32_t read_le32();
-    float read_le32f();
+    /// Copy of the stream contents, unused if inp is a MemoryDataStream
+    std::vector<char> mBuffer;
+
+    const char *mPos;
+    const char *mEnd;
+
+    /// Return a pointer to the next \a size bytes and advance past them, or 0 (and move to the
+    /// end) if there are not enough bytes left
+    const char *advance(size_t size)
+    {
+        if (static_cast<size_t>(mEnd - mPos) < size)
+        {
+            mPos = mEnd;
+            return 0;
+        }
+
+        const char *data = mPos;
+        mPos += size;
+        return data;
+    }
+
+    /// Copy \a count little endian values of \a size bytes each into \a dest
+    void readLittleEndianArray(void *dest, size_t count, size_t size);
+
+    uint8_t read_byte()
+    {
+        const char *data = advance(1);
+        return data ? static_cast<uint8_t>(data[0]) : 0;
+    }
+    uint16_t read_le16()
+    {
+        const unsigned char *data = reinterpret_cast<const unsigned char *>(advance(2));
+        if (!data) return 0;
+        return data[0] | (data[1]<<8);
+    }
+    uint32_t read_le32()
+    {
+        const unsigned char *data = reinterpret_cast<const unsigned char *>(advance(4));
+        if (!data) return 0;
+        return data[0] | (data[1]<<8) | (data[2]<<16) | (static_cast<uint32_t>(data[3])<<24);
+    }
+    float read_le32f()
+    {
+        union {
+            uint32_t i;
+            float f;
+        } u = { read_le32() };
+        return u.f;
+    }
 
 public:
 
     NIFFile * const file;
 
-    NIFStream (NIFFile * file, Ogre::DataStreamPtr inp): inp (inp), file (file) {}
+    NIFStream (NIFFile * file, Ogre::DataStreamPtr inp);
 
-    void skip(size_t size) { inp->skip(size); }
+    void skip(size_t size) { advance(size); }
+
+    /// Number of bytes not read yet
+    size_t remaining() const { return mEnd - mPos; }
 
     char getChar() { return read_byte(); }
     short getShort() { return read_le16(); }
@@ -0,0 +1,104 @@
+///Program to measure how fast .nif files are decoded.
+///
+///Usage: nifbench [-n passes] <file or directory>...
+///Directories are searched recursively. Reports the throughput of NIFFile parsing in MB/s.
+
+#include "../niffile.hpp"
+#include <OgreRoot.h>
+#include <OgreResourceGroupManager.h>
+#include <boost/filesystem.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+
+namespace bfs = boost::filesystem;
+
+///See if the file has the "nif" extension.
+bool isNIF(const bfs::path &path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".nif";
+}
+
+///Add the given file or all nif files below the given directory
+void collect(const bfs::path &path, std::vector<std::string> &files, boost::uintmax_t &bytes)
+{
+    if(bfs::is_directory(path))
+    {
+        for(bfs::recursive_directory_iterator iter(path), end; iter != end; ++iter)
+            if(bfs::is_regular_file(iter->path()) && isNIF(iter->path()))
+                collect(iter->path(), files, bytes);
+    }
+    else if(bfs::is_regular_file(path))
+    {
+        files.push_back(bfs::absolute(path).string());
+        bytes += bfs::file_size(path);
+    }
+    else
+        std::cerr << "ERROR:  \"" << path.string() << "\" does not exist" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int passes = 1;
+    std::vector<std::string> files;
+    boost::uintmax_t bytes = 0;
+
+    for(int i = 1; i<argc;i++)
+    {
+        std::string arg = argv[i];
+
+        if(arg == "-n" && i+1 < argc)
+            passes = std::max(1, std::atoi(argv[++i]));
+        else
+            collect(arg, files, bytes);
+    }
+
+    if(files.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [-n passes] <file or directory>..." << std::endl;
+        return 1;
+    }
+
+    //Need this for Ogre's getSingleton
+    new Ogre::Root("", "", "nifbench.log");
+    //Needed to read files from file system
+    Ogre::ResourceGroupManager::getSingleton().addResourceLocation("/", "FileSystem");
+    Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+
+    int failed = 0;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    for(int pass = 0; pass < passes; pass++)
+    {
+        for(std::vector<std::string>::const_iterator iter(files.begin()); iter != files.end(); ++iter)
+        {
+            try
+            {
+                Nif::NIFFile nif(*iter);
+            }
+            catch (std::exception &e)
+            {
+                if(pass == 0)
+                {
+                    std::cerr << "ERROR:  \"" << *iter << "\"  " << e.what() << std::endl;
+                    ++failed;
+                }
+            }
+        }
+    }
+
+    double seconds = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+    double megabytes = static_cast<double>(bytes) * passes / (1024*1024);
+
+    std::cout << files.size() << " files (" << failed << " failed), "
+              << std::fixed << std::setprecision(2) << megabytes/passes << " MB, "
+              << passes << " pass(es) in " << seconds << " s: "
+              << (seconds > 0 ? megabytes/seconds : 0) << " MB/s" << std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -3,6 +3,8 @@
 #include "../niffile.hpp"
 #include "../../bsa/bsa_file.hpp"
 #include "../../bsa/bsa_archive.hpp"
+#include "../../bsa/vfs.hpp"
+#include "../../nifcache/diskcache.hpp"
 #include <OgreRoot.h>
 #include <OgreResourceGroupManager.h>
 #include <iostream>
@@ -55,6 +57,43 @@ void readBSA(std::string filename)
     }
 }
 
+///Decode every nif file in the given data directories and archives through a disk cache,
+///adding the compressed ones that are not cached yet.
+int warmCache(const std::string &cacheFile, int argc, char **argv)
+{
+    Bsa::VFS vfs;
+    for(int i = 0; i<argc; i++)
+        vfs.addArchive(Bsa::createArchive(argv[i], false));
+    vfs.build();
+
+    Nif::DiskCache cache(cacheFile, vfs);
+    int failed = 0;
+
+    const std::vector<Bsa::VFS::Entry> &entries = vfs.getEntries();
+    for(std::vector<Bsa::VFS::Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        if(!isNIF(it->mName))
+            continue;
+
+        try
+        {
+            Nif::NIFFile temp_nif(it->mName, cache.open(it->mName));
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "ERROR:  \"" << it->mName << "\"  " << e.what() << std::endl;
+            ++failed;
+        }
+    }
+
+    cache.save();
+
+    std::cout << cache.getHitCount() << " files read from " << cacheFile << ", "
+              << cache.getMissCount() << " added, " << failed << " failed" << std::endl;
+
+    return failed ? 1 : 0;
+}
+
 int main(int argc, char **argv)
 {
 
@@ -66,6 +105,20 @@ int main(int argc, char **argv)
     // Initialize the resource groups:
     Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
 
+    //niftest --cache <cache file> <data directory or archive>...
+    if(argc >= 3 && std::string(argv[1]) == "--cache")
+    {
+        try
+        {
+            return warmCache(argv[2], argc-3, argv+3);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "ERROR, an exception has occured" << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     std::cout << "Reading Files" << std::endl;
      for(int i = 1; i<argc;i++)
      {
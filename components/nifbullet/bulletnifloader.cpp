@@ -24,12 +24,15 @@ http://www.gnu.org/licenses/ .
 #include "bulletnifloader.hpp"
 
 #include <cstdio>
+#include <sstream>
 
 
 #include <components/misc/stringops.hpp>
 
 #include <components/nifcache/nifcache.hpp>
 
+#include "shapeserializer.hpp"
+
 #include "../nif/niffile.hpp"
 #include "../nif/node.hpp"
 #include "../nif/data.hpp"
@@ -102,10 +105,44 @@ void extractControlledNodes(Nif::NIFFilePtr kfFile, std::set<std::string>& contr
 namespace NifBullet
 {
 
+Nif::DiskCache *ManualBulletShapeLoader::sDiskCache = NULL;
+
 ManualBulletShapeLoader::~ManualBulletShapeLoader()
 {
 }
 
+void ManualBulletShapeLoader::setDiskCache(Nif::DiskCache *cache)
+{
+    sDiskCache = cache;
+}
+
+bool ManualBulletShapeLoader::loadCached(const std::string &nifFile)
+{
+    Ogre::DataStreamPtr stream = sDiskCache->find(Nif::Cache::normalize(nifFile), nifFile);
+    if (stream.isNull())
+        return false;
+
+    try
+    {
+        deserializeShape(*mShape, *stream);
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        warn("Failed to read the cached collision shape of " + nifFile + ": " + e.what());
+        return false;
+    }
+}
+
+void ManualBulletShapeLoader::saveCached(const std::string &nifFile)
+{
+    std::ostringstream stream;
+    serializeShape(*mShape, stream);
+
+    std::string data = stream.str();
+    sDiskCache->add(Nif::Cache::normalize(nifFile), nifFile, data.data(), data.size());
+}
+
 
 btVector3 ManualBulletShapeLoader::getbtVector(Ogre::Vector3 const &v)
 {
@@ -123,7 +160,13 @@ void ManualBulletShapeLoader::loadResource(Ogre::Resource *resource)
     mCompoundShape = NULL;
     mStaticMesh = NULL;
 
-    Nif::NIFFilePtr pnif (Nif::Cache::getInstance().load(mResourceName.substr(0, mResourceName.length()-7)));
+    // The shape does not depend on the scale at the end of the resource name, it is applied later
+    std::string nifFile = mResourceName.substr(0, mResourceName.length()-7);
+
+    if (sDiskCache && loadCached(nifFile))
+        return;
+
+    Nif::NIFFilePtr pnif (Nif::Cache::getInstance().load(nifFile));
     Nif::NIFFile & nif = *pnif.get ();
     if (nif.numRoots() < 1)
     {
@@ -134,7 +177,7 @@ void ManualBulletShapeLoader::loadResource(Ogre::Resource *resource)
     // Have to load controlled nodes from the .kf
     // FIXME: the .kf has to be loaded both for rendering and physics, ideally it should be opened once and then reused
     mControlledNodes.clear();
-    std::string kfname = mResourceName.substr(0, mResourceName.length()-7);
+    std::string kfname = nifFile;
     Misc::StringUtils::lowerCaseInPlace(kfname);
     if(kfname.size() > 4 && kfname.compare(kfname.size()-4, 4, ".nif") == 0)
         kfname.replace(kfname.size()-4, 4, ".kf");
@@ -210,6 +253,9 @@ void ManualBulletShapeLoader::loadResource(Ogre::Resource *resource)
     }
     else if (mStaticMesh)
         mShape->mRaycastingShape = new TriangleMeshShape(mStaticMesh,true);
+
+    if (sDiskCache)
+        saveCached(nifFile);
 }
 
 bool ManualBulletShapeLoader::hasAutoGeneratedCollision(Nif::Node const * rootNode)
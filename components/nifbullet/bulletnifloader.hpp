@@ -31,12 +31,14 @@
 #include <BulletCollision/CollisionShapes/btCompoundShape.h>
 #include <btBulletDynamicsCommon.h>
 #include <openengine/bullet/BulletShapeLoader.h>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
 
 // For warning messages
 #include <iostream>
 
 namespace Nif
 {
+    class DiskCache;
     class Node;
     struct Transformation;
     struct NiTriShape;
@@ -48,8 +50,10 @@ namespace NifBullet
 // Subclass btBhvTriangleMeshShape to auto-delete the meshInterface
 struct TriangleMeshShape : public btBvhTriangleMeshShape
 {
-    TriangleMeshShape(btStridingMeshInterface* meshInterface, bool useQuantizedAabbCompression)
-        : btBvhTriangleMeshShape(meshInterface, useQuantizedAabbCompression)
+    TriangleMeshShape(btStridingMeshInterface* meshInterface, bool useQuantizedAabbCompression,
+                      bool buildBvh=true)
+        : btBvhTriangleMeshShape(meshInterface, useQuantizedAabbCompression, buildBvh)
+        , mBvhBuffer(NULL)
     {
     }
 
@@ -57,7 +61,31 @@ struct TriangleMeshShape : public btBvhTriangleMeshShape
     {
         delete getTriangleInfoMap();
         delete m_meshInterface;
+        btAlignedFree(mBvhBuffer);
     }
+
+    /**
+    *Use the BVH serialized into \a buffer (see btQuantizedBvh::serialize), which was built for the local
+    *\a scaling, instead of building one.
+    *\a buffer must have been allocated with btAlignedAlloc, ownership of it is transferred to this shape.
+    *Only for shapes constructed without a BVH.
+    *@return false (and \a buffer is freed) if the BVH could not be read
+    */
+    bool setSerializedBvh(void* buffer, unsigned int size, const btVector3& scaling)
+    {
+        btOptimizedBvh* bvh = static_cast<btOptimizedBvh*>(btOptimizedBvh::deSerializeInPlace(buffer, size, false));
+        if (!bvh)
+        {
+            btAlignedFree(buffer);
+            return false;
+        }
+        setOptimizedBvh(bvh, scaling);
+        mBvhBuffer = buffer;
+        return true;
+    }
+
+private:
+    void* mBvhBuffer; // holds a deserialized BVH
 };
 
 
@@ -101,7 +129,23 @@ public:
     */
     void load(const std::string &name,const std::string &group);
 
+    /**
+    *Keep the shapes built from NIF files in \a cache, and take them from there instead of building
+    *them as long as the NIF files have not changed. \a cache is not owned, 0 to build all shapes.
+    */
+    static void setDiskCache(Nif::DiskCache *cache);
+
 private:
+    /**
+    *Fill the current shape from the disk cache, return false if it is not in there.
+    */
+    bool loadCached(const std::string &nifFile);
+
+    /**
+    *Add the current shape, which must not have been scaled yet, to the disk cache.
+    */
+    void saveCached(const std::string &nifFile);
+
     btVector3 getbtVector(Ogre::Vector3 const &v);
 
     /**
@@ -133,6 +177,8 @@ private:
     std::set<std::string> mControlledNodes;
 
     bool mShowMarkers;
+
+    static Nif::DiskCache *sDiskCache;
 };
 
 
@@ -0,0 +1,368 @@
+#include "shapeserializer.hpp"
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <openengine/bullet/BulletShapeLoader.h>
+
+#include "bulletnifloader.hpp"
+
+namespace
+{
+    // Layout:
+    //   header: version, Bullet version, size of btScalar, size of btQuantizedBvh
+    //   flags, box translation and rotation, animated shapes, animated raycasting shapes
+    //   collision shape, raycasting shape
+    // Shapes are a type followed by
+    //   box: half extents
+    //   compound: child count, per child the transform and the child shape
+    //   triangle mesh: local scaling, triangle count, three unscaled vertices per triangle, BVH size,
+    //                  BVH (built for the local scaling)
+    const std::uint32_t sVersion = 2;
+
+    enum ShapeType
+    {
+        Shape_None = 0,
+        Shape_Box = 1,
+        Shape_Compound = 2,
+        Shape_TriangleMesh = 3
+    };
+
+    template<typename T>
+    void put(std::ostream &stream, T value)
+    {
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    T get(Ogre::DataStream &stream)
+    {
+        T value;
+        if (stream.read(&value, sizeof(T)) != sizeof(T))
+            throw std::runtime_error("truncated");
+        return value;
+    }
+
+    void putVector(std::ostream &stream, const btVector3 &vector)
+    {
+        put<float>(stream, vector.x());
+        put<float>(stream, vector.y());
+        put<float>(stream, vector.z());
+    }
+
+    btVector3 getVector(Ogre::DataStream &stream)
+    {
+        float x = get<float>(stream);
+        float y = get<float>(stream);
+        float z = get<float>(stream);
+        return btVector3(x, y, z);
+    }
+
+    void putAnimatedShapes(std::ostream &stream, const std::map<int, int> &shapes)
+    {
+        put<std::uint32_t>(stream, static_cast<std::uint32_t>(shapes.size()));
+        for (std::map<int, int>::const_iterator iter = shapes.begin(); iter != shapes.end(); ++iter)
+        {
+            put<std::int32_t>(stream, iter->first);
+            put<std::int32_t>(stream, iter->second);
+        }
+    }
+
+    void getAnimatedShapes(Ogre::DataStream &stream, std::map<int, int> &shapes)
+    {
+        std::uint32_t count = get<std::uint32_t>(stream);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            int node = get<std::int32_t>(stream);
+            shapes[node] = get<std::int32_t>(stream);
+        }
+    }
+
+    /// Write the triangle count and the unscaled vertices of each triangle of \a mesh
+    void putTriangles(std::ostream &stream, const btStridingMeshInterface &mesh)
+    {
+        const unsigned char *vertexBase;
+        const unsigned char *indexBase;
+        int numVertices, vertexStride, indexStride, numFaces;
+        PHY_ScalarType vertexType, indexType;
+
+        mesh.getLockedReadOnlyVertexIndexBase(&vertexBase, numVertices, vertexType, vertexStride,
+            &indexBase, indexStride, numFaces, indexType, 0);
+
+        put<std::uint32_t>(stream, numFaces);
+
+        for (int face = 0; face < numFaces; ++face)
+        {
+            const unsigned char *indices = indexBase + face * indexStride;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                unsigned int index = indexType == PHY_SHORT ?
+                    reinterpret_cast<const unsigned short *>(indices)[i] :
+                    reinterpret_cast<const unsigned int *>(indices)[i];
+
+                const unsigned char *vertex = vertexBase + index * vertexStride;
+
+                for (int j = 0; j < 3; ++j)
+                    put<float>(stream, vertexType == PHY_DOUBLE ?
+                        static_cast<float>(reinterpret_cast<const double *>(vertex)[j]) :
+                        reinterpret_cast<const float *>(vertex)[j]);
+            }
+        }
+
+        mesh.unLockReadOnlyVertexBase(0);
+    }
+
+    void deleteShape(btCollisionShape *shape)
+    {
+        if (shape != NULL)
+        {
+            if (shape->isCompound())
+            {
+                btCompoundShape *compound = static_cast<btCompoundShape *>(shape);
+                for (int i = 0; i < compound->getNumChildShapes(); ++i)
+                    deleteShape(compound->getChildShape(i));
+            }
+            delete shape;
+        }
+    }
+
+    void writeShape(std::ostream &stream, const btCollisionShape *shape)
+    {
+        if (shape == NULL)
+        {
+            put<std::uint32_t>(stream, Shape_None);
+        }
+        else if (shape->isCompound())
+        {
+            const btCompoundShape *compound = static_cast<const btCompoundShape *>(shape);
+
+            put<std::uint32_t>(stream, Shape_Compound);
+            put<std::uint32_t>(stream, compound->getNumChildShapes());
+
+            for (int i = 0; i < compound->getNumChildShapes(); ++i)
+            {
+                const btTransform &transform = compound->getChildTransform(i);
+                btQuaternion rotation = transform.getRotation();
+
+                putVector(stream, transform.getOrigin());
+                put<float>(stream, rotation.x());
+                put<float>(stream, rotation.y());
+                put<float>(stream, rotation.z());
+                put<float>(stream, rotation.w());
+
+                writeShape(stream, compound->getChildShape(i));
+            }
+        }
+        else if (const NifBullet::TriangleMeshShape *trishape =
+            dynamic_cast<const NifBullet::TriangleMeshShape *>(shape))
+        {
+            put<std::uint32_t>(stream, Shape_TriangleMesh);
+            putVector(stream, trishape->getLocalScaling());
+            putTriangles(stream, *trishape->getMeshInterface());
+
+            const btOptimizedBvh *bvh = const_cast<NifBullet::TriangleMeshShape *>(trishape)->getOptimizedBvh();
+            unsigned int size = bvh ? bvh->calculateSerializeBufferSize() : 0;
+
+            put<std::uint32_t>(stream, size);
+
+            if (size > 0)
+            {
+                void *buffer = btAlignedAlloc(size, 16);
+                bvh->serialize(buffer, size, false);
+                stream.write(static_cast<const char *>(buffer), size);
+                btAlignedFree(buffer);
+            }
+        }
+        else if (const btBoxShape *box = dynamic_cast<const btBoxShape *>(shape))
+        {
+            put<std::uint32_t>(stream, Shape_Box);
+            putVector(stream, box->getHalfExtentsWithMargin());
+        }
+        else
+            throw std::logic_error(std::string("Unhandled Bullet shape serialization: ") + shape->getName());
+    }
+
+    btCollisionShape *readShape(Ogre::DataStream &stream)
+    {
+        switch (get<std::uint32_t>(stream))
+        {
+            case Shape_None:
+
+                return NULL;
+
+            case Shape_Box:
+
+                return new btBoxShape(getVector(stream));
+
+            case Shape_Compound:
+            {
+                btCompoundShape *compound = new btCompoundShape;
+
+                try
+                {
+                    std::uint32_t count = get<std::uint32_t>(stream);
+
+                    for (std::uint32_t i = 0; i < count; ++i)
+                    {
+                        btVector3 origin = getVector(stream);
+                        float x = get<float>(stream);
+                        float y = get<float>(stream);
+                        float z = get<float>(stream);
+                        float w = get<float>(stream);
+
+                        btCollisionShape *child = readShape(stream);
+                        if (child == NULL)
+                            throw std::runtime_error("empty compound child");
+
+                        compound->addChildShape(btTransform(btQuaternion(x, y, z, w), origin), child);
+                    }
+                }
+                catch (...)
+                {
+                    deleteShape(compound);
+                    throw;
+                }
+
+                return compound;
+            }
+
+            case Shape_TriangleMesh:
+            {
+                btVector3 scaling = getVector(stream);
+                std::uint32_t count = get<std::uint32_t>(stream);
+
+                if (count > stream.size() / (9 * sizeof(float)))
+                    throw std::runtime_error("truncated");
+
+                std::vector<float> vertices(count * 9);
+                if (count > 0 && stream.read(&vertices[0], vertices.size() * sizeof(float)) !=
+                    vertices.size() * sizeof(float))
+                    throw std::runtime_error("truncated");
+
+                btTriangleMesh *mesh = new btTriangleMesh();
+                mesh->preallocateVertices(count * 3);
+
+                for (std::size_t i = 0; i < vertices.size(); i += 9)
+                    mesh->addTriangle(btVector3(vertices[i], vertices[i+1], vertices[i+2]),
+                                      btVector3(vertices[i+3], vertices[i+4], vertices[i+5]),
+                                      btVector3(vertices[i+6], vertices[i+7], vertices[i+8]));
+
+                NifBullet::TriangleMeshShape *shape = new NifBullet::TriangleMeshShape(mesh, true, false);
+
+                try
+                {
+                    std::uint32_t size = get<std::uint32_t>(stream);
+
+                    if (size == 0)
+                    {
+                        shape->buildOptimizedBvh();
+                        shape->setLocalScaling(scaling);
+                    }
+                    else
+                    {
+                        if (size > stream.size())
+                            throw std::runtime_error("truncated");
+
+                        void *buffer = btAlignedAlloc(size, 16);
+                        if (stream.read(buffer, size) != size)
+                        {
+                            btAlignedFree(buffer);
+                            throw std::runtime_error("truncated");
+                        }
+
+                        if (!shape->setSerializedBvh(buffer, size, scaling))
+                            throw std::runtime_error("invalid BVH");
+                    }
+                }
+                catch (...)
+                {
+                    delete shape;
+                    throw;
+                }
+
+                return shape;
+            }
+        }
+
+        throw std::runtime_error("unknown shape type");
+    }
+}
+
+namespace NifBullet
+{
+
+void serializeShape(const OEngine::Physic::BulletShape &shape, std::ostream &stream)
+{
+    put<std::uint32_t>(stream, sVersion);
+    put<std::uint32_t>(stream, BT_BULLET_VERSION);
+    put<std::uint32_t>(stream, sizeof(btScalar));
+    put<std::uint32_t>(stream, sizeof(btQuantizedBvh));
+
+    put<std::uint8_t>(stream, shape.mAutogenerated);
+    put<std::uint8_t>(stream, shape.mCollide);
+
+    put<float>(stream, shape.mBoxTranslation.x);
+    put<float>(stream, shape.mBoxTranslation.y);
+    put<float>(stream, shape.mBoxTranslation.z);
+    put<float>(stream, shape.mBoxRotation.w);
+    put<float>(stream, shape.mBoxRotation.x);
+    put<float>(stream, shape.mBoxRotation.y);
+    put<float>(stream, shape.mBoxRotation.z);
+
+    putAnimatedShapes(stream, shape.mAnimatedShapes);
+    putAnimatedShapes(stream, shape.mAnimatedRaycastingShapes);
+
+    writeShape(stream, shape.mCollisionShape);
+    writeShape(stream, shape.mRaycastingShape);
+}
+
+void deserializeShape(OEngine::Physic::BulletShape &shape, Ogre::DataStream &stream)
+{
+    // the BVH layout may change between Bullet versions, without changing its size
+    if (get<std::uint32_t>(stream) != sVersion || get<std::uint32_t>(stream) != BT_BULLET_VERSION ||
+        get<std::uint32_t>(stream) != sizeof(btScalar) || get<std::uint32_t>(stream) != sizeof(btQuantizedBvh))
+        throw std::runtime_error("unsupported version");
+
+    bool autogenerated = get<std::uint8_t>(stream) != 0;
+    bool collide = get<std::uint8_t>(stream) != 0;
+
+    float translation[3];
+    for (int i = 0; i < 3; ++i)
+        translation[i] = get<float>(stream);
+
+    float rotation[4];
+    for (int i = 0; i < 4; ++i)
+        rotation[i] = get<float>(stream);
+
+    std::map<int, int> animatedShapes;
+    std::map<int, int> animatedRaycastingShapes;
+    getAnimatedShapes(stream, animatedShapes);
+    getAnimatedShapes(stream, animatedRaycastingShapes);
+
+    btCollisionShape *collisionShape = readShape(stream);
+    btCollisionShape *raycastingShape = NULL;
+
+    try
+    {
+        raycastingShape = readShape(stream);
+    }
+    catch (...)
+    {
+        deleteShape(collisionShape);
+        throw;
+    }
+
+    shape.mAutogenerated = autogenerated;
+    shape.mCollide = collide;
+    shape.mBoxTranslation = Ogre::Vector3(translation[0], translation[1], translation[2]);
+    shape.mBoxRotation = Ogre::Quaternion(rotation[0], rotation[1], rotation[2], rotation[3]);
+    shape.mAnimatedShapes.swap(animatedShapes);
+    shape.mAnimatedRaycastingShapes.swap(animatedRaycastingShapes);
+    shape.mCollisionShape = collisionShape;
+    shape.mRaycastingShape = raycastingShape;
+}
+
+}
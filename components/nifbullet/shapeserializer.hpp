@@ -0,0 +1,38 @@
+#ifndef OPENMW_COMPONENTS_NIFBULLET_SHAPESERIALIZER_HPP
+#define OPENMW_COMPONENTS_NIFBULLET_SHAPESERIALIZER_HPP
+
+#include <ostream>
+
+#include <OgreDataStream.h>
+
+namespace OEngine
+{
+namespace Physic
+{
+    class BulletShape;
+}
+}
+
+namespace NifBullet
+{
+
+/**
+*Write the collision and raycasting shapes of \a shape (boxes, compounds and triangle meshes, as built
+*by the ManualBulletShapeLoader before they are scaled for an object) to \a stream, triangle meshes
+*with their optimized BVH.
+*
+*The data is in native byte order and only meant to be read back on the same machine, with the same
+*Bullet version.
+*/
+void serializeShape(const OEngine::Physic::BulletShape &shape, std::ostream &stream);
+
+/**
+*Set the shapes of \a shape, which must not have any yet, to the ones read from \a stream. Triangle
+*meshes use the BVH read with them instead of building a new one.
+*@throw std::runtime_error if the data is not usable; \a shape is left unchanged then
+*/
+void deserializeShape(OEngine::Physic::BulletShape &shape, Ogre::DataStream &stream);
+
+}
+
+#endif
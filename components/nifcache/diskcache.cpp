@@ -0,0 +1,350 @@
+#include "diskcache.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <components/bsa/vfs.hpp>
+
+#include "nifcache.hpp"
+
+namespace
+{
+    // Layout, native byte order:
+    //   header: magic, version, entry count, index offset
+    //   file contents
+    //   index: per entry offset, size, source size, source time, name length, name
+    const char sMagic[8] = { 'O', 'M', 'W', 'N', 'I', 'F', 'C', '\x1a' };
+    // 2: model caches only hold compressed archive entries, older ones may hold others that
+    // would never be dropped
+    const std::uint32_t sVersion = 2;
+    const std::size_t sHeaderSize = 8 + 4 + 4 + 8;
+    const std::size_t sIndexEntrySize = 8 + 8 + 8 + 8 + 4;
+
+    template<typename T>
+    T get(const char *&data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+
+    template<typename T>
+    void put(std::ostream &stream, T value)
+    {
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+}
+
+namespace Nif
+{
+
+DiskCache::DiskCache(const std::string &path, const Bsa::VFS &vfs)
+    : mPath(path)
+    , mVFS(vfs)
+    , mPendingSize(0)
+    , mWritable(true)
+    , mHits(0)
+    , mMisses(0)
+{
+    load();
+}
+
+DiskCache::~DiskCache()
+{
+    try
+    {
+        save();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to save cache " << mPath << ": " << e.what() << std::endl;
+    }
+}
+
+std::string DiskCache::getPendingPath() const
+{
+    return mPath + ".pending";
+}
+
+void DiskCache::load()
+{
+    mEntries.clear();
+    mFile.close();
+
+    if (!boost::filesystem::exists(mPath))
+        return;
+
+    try
+    {
+        mFile.open(mPath.c_str());
+
+        const char *begin = mFile.data();
+        const char *end = begin + mFile.size();
+        const char *data = begin;
+
+        if (mFile.size() < sHeaderSize || std::memcmp(data, sMagic, sizeof(sMagic)) != 0)
+            throw std::runtime_error("not a cache file");
+        data += sizeof(sMagic);
+
+        if (get<std::uint32_t>(data) != sVersion)
+            throw std::runtime_error("unsupported version");
+
+        std::uint32_t count = get<std::uint32_t>(data);
+        std::uint64_t indexOffset = get<std::uint64_t>(data);
+
+        if (indexOffset > mFile.size())
+            throw std::runtime_error("truncated");
+
+        data = begin + indexOffset;
+
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            if (static_cast<std::size_t>(end - data) < sIndexEntrySize)
+                throw std::runtime_error("truncated");
+
+            Entry entry;
+            entry.mOffset = get<std::uint64_t>(data);
+            entry.mSize = get<std::uint64_t>(data);
+            entry.mSource.mSize = get<std::uint64_t>(data);
+            entry.mSource.mTime = get<std::int64_t>(data);
+            entry.mPending = false;
+            std::uint32_t length = get<std::uint32_t>(data);
+
+            if (static_cast<std::size_t>(end - data) < length || entry.mOffset > indexOffset ||
+                entry.mSize > indexOffset - entry.mOffset)
+                throw std::runtime_error("truncated");
+
+            mEntries[std::string(data, length)] = entry;
+            data += length;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Discarding cache " << mPath << ": " << e.what() << std::endl;
+        mEntries.clear();
+        mFile.close();
+    }
+}
+
+bool DiskCache::getSource(const std::string &name, Source &source)
+{
+    std::string path = mVFS.getSourcePath(name);
+
+    if (path.empty())
+        return false;
+
+    std::map<std::string, Source>::const_iterator iter = mSources.find(path);
+
+    if (iter == mSources.end())
+    {
+        boost::system::error_code error;
+
+        source.mSize = boost::filesystem::file_size(path, error);
+        if (!error)
+            source.mTime = boost::filesystem::last_write_time(path, error);
+        if (error)
+            return false;
+
+        iter = mSources.insert(std::make_pair(path, source)).first;
+    }
+
+    source = iter->second;
+    return true;
+}
+
+Ogre::DataStreamPtr DiskCache::open(const std::string &name)
+{
+    if (!mVFS.isCompressed(name))
+        return mVFS.open(name);
+
+    std::string key = Cache::normalize(name);
+
+    Ogre::DataStreamPtr cached = find(key, name);
+    if (!cached.isNull())
+        return cached;
+
+    Ogre::DataStreamPtr stream = mVFS.open(name);
+    Ogre::MemoryDataStream *memory = new Ogre::MemoryDataStream(name, stream);
+    Ogre::DataStreamPtr result(memory);
+
+    add(key, name, reinterpret_cast<const char *>(memory->getPtr()), memory->size());
+
+    return result;
+}
+
+Ogre::DataStreamPtr DiskCache::find(const std::string &key, const std::string &name)
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    Source source;
+    EntryMap::const_iterator iter = mEntries.find(key);
+
+    if (getSource(name, source) && iter != mEntries.end() && !iter->second.mPending &&
+        iter->second.mSource == source)
+    {
+        ++mHits;
+        return Ogre::DataStreamPtr(new Ogre::MemoryDataStream(
+            const_cast<char *>(mFile.data() + iter->second.mOffset), iter->second.mSize, false, true));
+    }
+
+    ++mMisses;
+    return Ogre::DataStreamPtr();
+}
+
+void DiskCache::add(const std::string &key, const std::string &name, const char *data, std::size_t size)
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    Source source;
+    if (!getSource(name, source))
+        return;
+
+    EntryMap::const_iterator iter = mEntries.find(key);
+
+    if (iter != mEntries.end() && iter->second.mPending && iter->second.mSource == source)
+        return; // already added during this session
+
+    addPending(key, source, data, size);
+}
+
+void DiskCache::addPending(const std::string &key, const Source &source, const char *data, std::size_t size)
+{
+    if (!mWritable)
+        return;
+
+    if (!mPending.is_open())
+    {
+        boost::system::error_code error;
+        boost::filesystem::create_directories(boost::filesystem::path(mPath).parent_path(), error);
+
+        mPending.open(getPendingPath(), std::ios_base::binary | std::ios_base::trunc);
+        mPendingSize = 0;
+
+        if (!mPending.is_open())
+        {
+            std::cerr << "Failed to create " << getPendingPath() << ", cache will not be updated" << std::endl;
+            mWritable = false;
+            return;
+        }
+    }
+
+    mPending.write(data, size);
+
+    Entry entry;
+    entry.mOffset = mPendingSize;
+    entry.mSize = size;
+    entry.mSource = source;
+    entry.mPending = true;
+    mEntries[key] = entry;
+
+    mPendingSize += size;
+}
+
+void DiskCache::save()
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    if (!mPending.is_open())
+        return;
+
+    mPending.close();
+
+    if (!mPending)
+    {
+        mPending.clear();
+        throw std::runtime_error("failed to write " + getPendingPath());
+    }
+
+    std::string newPath = mPath + ".new";
+    boost::filesystem::ofstream out(newPath, std::ios_base::binary | std::ios_base::trunc);
+    boost::filesystem::ifstream pending(getPendingPath(), std::ios_base::binary);
+
+    if (!out.is_open() || !pending.is_open())
+        throw std::runtime_error("failed to open " + newPath);
+
+    out.write(sMagic, sizeof(sMagic));
+    put<std::uint32_t>(out, sVersion);
+    put<std::uint32_t>(out, 0);
+    put<std::uint64_t>(out, 0);
+
+    std::uint64_t offset = sHeaderSize;
+    std::vector<char> buffer;
+    EntryMap written;
+
+    for (EntryMap::const_iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+    {
+        Entry entry = iter->second;
+
+        if (entry.mPending)
+        {
+            buffer.resize(static_cast<std::size_t>(entry.mSize));
+            pending.seekg(entry.mOffset);
+            if (!buffer.empty())
+                pending.read(&buffer[0], buffer.size());
+            if (!pending)
+                throw std::runtime_error("failed to read " + getPendingPath());
+            if (!buffer.empty())
+                out.write(&buffer[0], buffer.size());
+        }
+        else
+        {
+            // Drop entries whose source went away or changed
+            Source source;
+            if (!getSource(iter->first, source) || !(source == entry.mSource))
+                continue;
+
+            out.write(mFile.data() + entry.mOffset, entry.mSize);
+        }
+
+        entry.mOffset = offset;
+        entry.mPending = false;
+        offset += entry.mSize;
+        written.insert(std::make_pair(iter->first, entry));
+    }
+
+    for (EntryMap::const_iterator iter = written.begin(); iter != written.end(); ++iter)
+    {
+        put<std::uint64_t>(out, iter->second.mOffset);
+        put<std::uint64_t>(out, iter->second.mSize);
+        put<std::uint64_t>(out, iter->second.mSource.mSize);
+        put<std::int64_t>(out, iter->second.mSource.mTime);
+        put<std::uint32_t>(out, static_cast<std::uint32_t>(iter->first.size()));
+        out.write(iter->first.data(), iter->first.size());
+    }
+
+    out.seekp(sizeof(sMagic) + 4);
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(written.size()));
+    put<std::uint64_t>(out, offset);
+
+    out.close();
+    pending.close();
+
+    if (!out)
+        throw std::runtime_error("failed to write " + newPath);
+
+    // Streams handed out before are invalidated here
+    mFile.close();
+    boost::filesystem::rename(newPath, mPath);
+    boost::filesystem::remove(getPendingPath());
+
+    load();
+}
+
+size_t DiskCache::getHitCount() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    return mHits;
+}
+
+size_t DiskCache::getMissCount() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    return mMisses;
+}
+
+}
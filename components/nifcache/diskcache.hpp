@@ -0,0 +1,119 @@
+#ifndef OPENMW_COMPONENTS_NIFCACHE_DISKCACHE_H
+#define OPENMW_COMPONENTS_NIFCACHE_DISKCACHE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <OgreDataStream.h>
+
+#include <components/files/memorymappedfile.hpp>
+
+namespace Bsa
+{
+    class VFS;
+}
+
+namespace Nif
+{
+    /// @brief File with the inflated contents of previously loaded NIF files
+    ///
+    /// Only files stored compressed in TES4 archives are kept: the cache saves inflating them,
+    /// not parsing them, and other files can be read straight from their archive or directory.
+    ///
+    /// An entry is used as long as the archive it was read from still has the same size and
+    /// modification time; the file is memory mapped, so a hit costs no I/O or decompression
+    /// up front and the parser reads straight from the mapping. Files that are not cached yet
+    /// are read from the VFS and written to the cache by save().
+    ///
+    /// Data derived from a resource can be kept the same way with find() and add().
+    ///
+    /// open(), find() and add() may be called from several threads, save() must not overlap
+    /// with them.
+    class DiskCache
+    {
+    public:
+        /// Use the cache file at \a path (it is fine for it not to exist yet) for resources of
+        /// \a vfs, which must outlive the cache.
+        DiskCache(const std::string& path, const Bsa::VFS& vfs);
+
+        /// Calls save(), errors are only reported.
+        ~DiskCache();
+
+        /// Open \a name from the cache if it is up to date, otherwise from the VFS. Files that
+        /// are not compressed in their archive are always opened from the VFS.
+        /// @note Streams returned from the cache are only valid until the next save().
+        Ogre::DataStreamPtr open(const std::string& name);
+
+        /// Return the entry \a key if it was added for the resource \a name and the archive (or
+        /// loose file) \a name is in has not changed since, otherwise a null pointer.
+        /// @note Streams returned from the cache are only valid until the next save().
+        Ogre::DataStreamPtr find(const std::string& key, const std::string& name);
+
+        /// Add \a size bytes at \a data as the entry \a key for the resource \a name, unless it has
+        /// been added during this session already.
+        void add(const std::string& key, const std::string& name, const char *data, std::size_t size);
+
+        /// Write a new cache file with all valid entries, if any were added.
+        /// @throw std::runtime_error
+        void save();
+
+        size_t getHitCount() const;
+        size_t getMissCount() const;
+
+    private:
+        struct Source
+        {
+            std::uint64_t mSize;
+            std::int64_t mTime;
+
+            bool operator==(const Source& source) const
+            { return mSize == source.mSize && mTime == source.mTime; }
+        };
+
+        struct Entry
+        {
+            std::uint64_t mOffset;
+            std::uint64_t mSize;
+            Source mSource;
+            bool mPending; ///< in the pending file instead of the cache file
+        };
+
+        typedef std::map<std::string, Entry> EntryMap;
+
+        std::string mPath;
+        const Bsa::VFS& mVFS;
+
+        mutable boost::mutex mMutex;
+        MemoryMappedFile mFile;
+        EntryMap mEntries;
+        std::map<std::string, Source> mSources; ///< by source path, sources don't change while running
+
+        /// New entries, collected here so that they don't have to be kept in memory until save()
+        boost::filesystem::ofstream mPending;
+        std::uint64_t mPendingSize;
+        bool mWritable;
+
+        size_t mHits;
+        size_t mMisses;
+
+        DiskCache(const DiskCache&);
+        DiskCache& operator=(const DiskCache&);
+
+        std::string getPendingPath() const;
+
+        /// Read the index of the cache file, discarding it if it is not usable.
+        void load();
+
+        /// Return false if \a name is not found. mMutex must be locked.
+        bool getSource(const std::string& name, Source& source);
+
+        /// Add \a size bytes at \a data to the pending file. mMutex must be locked.
+        void addPending(const std::string& key, const Source& source, const char *data, std::size_t size);
+    };
+}
+
+#endif
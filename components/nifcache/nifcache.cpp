@@ -1,8 +1,36 @@
 #include "nifcache.hpp"
 
+#include <cassert>
+
+#include <OgreResourceGroupManager.h>
+
+#include <components/misc/workqueue.hpp>
+
 namespace Nif
 {
 
+class Cache::BackgroundLoad : public Misc::WorkItem
+{
+    Cache& mCache;
+    std::string mKey;
+    std::string mFilename;
+
+protected:
+    virtual void doWork()
+    {
+        mCache.loadQueued(mKey, mFilename);
+    }
+
+public:
+    BackgroundLoad(Cache& cache, const std::string& key, const std::string& filename)
+        : mCache(cache), mKey(key), mFilename(filename)
+    {}
+};
+
+Cache::Stats::Stats()
+    : mHits(0), mMisses(0), mPending(0), mEvictions(0), mFiles(0), mSize(0), mBudget(0), mDiskHits(0), mDiskMisses(0)
+{}
+
 Cache* Cache::sThis = 0;
 
 Cache& Cache::getInstance()
@@ -16,25 +44,279 @@ Cache* Cache::getInstancePtr()
     return sThis;
 }
 
-Cache::Cache()
+Cache::Cache(size_t budget)
 {
     assert (!sThis);
     sThis = this;
+    mStats.mBudget = budget;
+}
+
+Cache::~Cache()
+{
+    // Finish the files being loaded before the map goes away
+    mWorkQueue.reset();
+    sThis = 0;
+}
+
+std::string Cache::normalize(const std::string &filename)
+{
+    std::string key = filename;
+
+    for (std::string::iterator iter = key.begin(); iter != key.end(); ++iter)
+    {
+        if (*iter == '/')
+            *iter = '\\';
+        else if (*iter >= 'A' && *iter <= 'Z')
+            *iter = *iter - 'A' + 'a';
+    }
+
+    return key;
+}
+
+void Cache::loadInBackground(const std::string &file)
+{
+    std::string key = normalize(file);
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    if (mLoadedMap.find(key) != mLoadedMap.end())
+        return;
+
+    lock.unlock();
+
+    // Ogre resources must not be used from worker threads
+    Ogre::DataStreamPtr stream;
+    try
+    {
+        stream = open(file);
+    }
+    catch (...)
+    {
+        return; // reported if the file is loaded
+    }
+
+    lock.lock();
+
+    if (mLoadedMap.find(key) != mLoadedMap.end())
+        return;
+
+    Entry entry;
+    entry.mState = Entry::State_Queued;
+    entry.mStream = stream;
+    mLoadedMap.insert(std::make_pair(key, entry));
+
+    if (!mWorkQueue)
+        mWorkQueue.reset(new Misc::WorkQueue);
+
+    mWorkQueue->addWorkItem(Misc::WorkItemPtr(new BackgroundLoad(*this, key, file)));
 }
 
 NIFFilePtr Cache::load(const std::string &filename)
 {
-    // TODO: normalize file path to make sure we're not loading the same file twice
+    std::string key = normalize(filename);
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
 
-    LoadedMap::iterator it = mLoadedMap.find(filename);
-    if (it != mLoadedMap.end())
-        return it->second;
-    else
+    bool counted = false;
+    Ogre::DataStreamPtr stream;
+
+    while (true)
     {
-        NIFFilePtr file(new Nif::NIFFile(filename));
-        mLoadedMap[filename] = file;
-        return file;
+        LoadedMap::iterator it = mLoadedMap.find(key);
+
+        if (it == mLoadedMap.end())
+        {
+            // Not loaded, or a load we were waiting for failed; load it here and report the error
+            if (!counted)
+                ++mStats.mMisses;
+
+            Entry entry;
+            entry.mState = Entry::State_Loading;
+            mLoadedMap.insert(std::make_pair(key, entry));
+            break;
+        }
+
+        if (it->second.mState == Entry::State_Loaded)
+        {
+            if (!counted)
+                ++mStats.mHits;
+
+            mLru.splice(mLru.begin(), mLru, it->second.mLru);
+            return it->second.mFile;
+        }
+
+        if (!counted)
+        {
+            ++mStats.mPending;
+            counted = true;
+        }
+
+        if (it->second.mState == Entry::State_Queued)
+        {
+            // Don't wait behind the rest of the queue, the worker will skip it
+            it->second.mState = Entry::State_Loading;
+            stream = it->second.mStream;
+            it->second.mStream.setNull();
+            break;
+        }
+
+        mLoaded.wait(lock);
     }
+
+    lock.unlock();
+
+    return loadFile(key, filename, stream);
+}
+
+Ogre::DataStreamPtr Cache::open(const std::string &filename)
+{
+    if (mDiskCache)
+        return mDiskCache->open(filename);
+
+    return Ogre::ResourceGroupManager::getSingleton().openResource(filename);
+}
+
+NIFFilePtr Cache::loadFile(const std::string &key, const std::string &filename, Ogre::DataStreamPtr stream)
+{
+    NIFFilePtr file;
+
+    try
+    {
+        if (stream.isNull())
+            stream = open(filename);
+
+        file.reset(new Nif::NIFFile(filename, stream));
+    }
+    catch (...)
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        mLoadedMap.erase(key);
+        mLoaded.notify_all();
+        throw;
+    }
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    Entry& entry = mLoadedMap[key];
+    entry.mState = Entry::State_Loaded;
+    entry.mFile = file;
+    mLru.push_front(key);
+    entry.mLru = mLru.begin();
+
+    ++mStats.mFiles;
+    mStats.mSize += file->getSize();
+
+    evict();
+
+    mLoaded.notify_all();
+
+    return file;
+}
+
+void Cache::loadQueued(const std::string &key, const std::string &filename)
+{
+    Ogre::DataStreamPtr stream;
+
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+
+        LoadedMap::iterator it = mLoadedMap.find(key);
+        if (it == mLoadedMap.end() || it->second.mState != Entry::State_Queued)
+            return;
+
+        it->second.mState = Entry::State_Loading;
+        stream = it->second.mStream;
+        it->second.mStream.setNull();
+    }
+
+    loadFile(key, filename, stream);
+}
+
+void Cache::evict()
+{
+    LruList::iterator iter = mLru.end();
+
+    while (mStats.mSize > mStats.mBudget && iter != mLru.begin())
+    {
+        --iter;
+
+        LoadedMap::iterator it = mLoadedMap.find(*iter);
+        assert(it != mLoadedMap.end());
+
+        // Files still referenced elsewhere would not be freed, and would be loaded twice if
+        // requested again
+        if (!it->second.mFile.unique())
+            continue;
+
+        mStats.mSize -= it->second.mFile->getSize();
+        --mStats.mFiles;
+        ++mStats.mEvictions;
+
+        mLoadedMap.erase(it);
+        iter = mLru.erase(iter);
+    }
+}
+
+void Cache::setBudget(size_t budget)
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    mStats.mBudget = budget;
+    evict();
+}
+
+void Cache::setDiskCache(DiskCache *cache)
+{
+    // Files being loaded may still use the old one
+    mWorkQueue.reset();
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    // Files still queued may have been opened from the old one
+    for (LoadedMap::iterator it = mLoadedMap.begin(); it != mLoadedMap.end(); )
+    {
+        if (it->second.mState == Entry::State_Queued)
+            mLoadedMap.erase(it++);
+        else
+            ++it;
+    }
+
+    mDiskCache.reset(cache);
+}
+
+Cache::Stats Cache::getStats() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    Stats stats = mStats;
+    if (mDiskCache)
+    {
+        stats.mDiskHits = mDiskCache->getHitCount();
+        stats.mDiskMisses = mDiskCache->getMissCount();
+    }
+
+    return stats;
+}
+
+void Cache::clear()
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+
+    for (LruList::iterator iter = mLru.begin(); iter != mLru.end(); )
+    {
+        LoadedMap::iterator it = mLoadedMap.find(*iter);
+
+        if (it->second.mFile.unique())
+        {
+            mStats.mSize -= it->second.mFile->getSize();
+            --mStats.mFiles;
+            mLoadedMap.erase(it);
+            iter = mLru.erase(iter);
+        }
+        else
+            ++iter;
+    }
+
+    mStats.mHits = mStats.mMisses = mStats.mPending = mStats.mEvictions = 0;
 }
 
 }
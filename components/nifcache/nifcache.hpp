@@ -4,24 +4,62 @@
 #include <components/nif/niffile.hpp>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
+#include <list>
 #include <map>
 
+#include "diskcache.hpp"
+
+namespace Misc
+{
+    class WorkQueue;
+}
+
 namespace Nif
 {
 
     typedef boost::shared_ptr<Nif::NIFFile> NIFFilePtr;
 
     /// @brief A basic resource manager for NIF files
+    ///
+    /// Loaded files are kept in least recently used order and dropped once their combined size
+    /// exceeds the budget.
+    ///
+    /// Files are opened on the thread calling load() or loadInBackground(), which must be one
+    /// that may use Ogre resources; worker threads only parse streams opened already. The other
+    /// functions may be called from any thread.
     class Cache
     {
     public:
-        Cache();
+        struct Stats
+        {
+            size_t mHits;    ///< requests for files that were loaded already
+            size_t mMisses;  ///< requests for files that were neither loaded nor loading
+            size_t mPending; ///< requests for files still queued or being loaded in the background
+            size_t mEvictions;
+            size_t mFiles;   ///< files currently cached
+            size_t mSize;    ///< combined size of the cached files in bytes
+            size_t mBudget;
+            size_t mDiskHits;   ///< files read from the disk cache
+            size_t mDiskMisses; ///< compressed files read from the VFS while a disk cache was set
+
+            Stats();
+        };
+
+        /// @param budget Combined size of the cached files in bytes above which the least
+        ///        recently used ones are unloaded.
+        Cache(size_t budget = 128*1024*1024);
 
-        /// Queue this file for background loading. A worker thread will start loading the file.
+        ~Cache();
+
+        /// Open this file and queue it for background loading. A worker thread will parse the file.
         /// To get the loaded NIFFilePtr, use the load method, which will wait until the worker thread is finished
         /// and then return the loaded file.
-        //void loadInBackground (const std::string& file);
+        /// @note Errors are reported when the file is requested through load.
+        void loadInBackground (const std::string& file);
 
         /// Read and parse the given file. May retrieve from cache if this file has been used previously.
         /// @note If the file is currently loading in the background, this function will block until
@@ -30,6 +68,19 @@ namespace Nif
         ///       When all external SharedPtrs to a file are released, the cache may decide to unload the file.
         NIFFilePtr load (const std::string& filename);
 
+        void setBudget (size_t budget);
+
+        /// Read files through \a cache from now on. Ownership passes to the Cache.
+        void setDiskCache (DiskCache *cache);
+
+        Stats getStats() const;
+
+        /// Unload all files that are not in use and reset the statistics.
+        void clear();
+
+        /// Key used for \a filename: lower case with '\\' as the separator.
+        static std::string normalize (const std::string& filename);
+
         /// Return instance of this class.
         static Cache& getInstance();
         static Cache* getInstancePtr();
@@ -40,9 +91,50 @@ namespace Nif
         Cache(const Cache&);
         Cache& operator =(const Cache&);
 
-        typedef std::map<std::string, NIFFilePtr> LoadedMap;
+        class BackgroundLoad;
+
+        typedef std::list<std::string> LruList;
+
+        struct Entry
+        {
+            enum State
+            {
+                State_Queued,  ///< waiting for a worker thread
+                State_Loading,
+                State_Loaded
+            };
+
+            State mState;
+            Ogre::DataStreamPtr mStream; ///< only set while queued
+            NIFFilePtr mFile;
+            LruList::iterator mLru; ///< only valid if loaded
+        };
+
+        typedef std::map<std::string, Entry> LoadedMap;
 
+        mutable boost::mutex mMutex;
+        boost::condition_variable mLoaded; ///< notified whenever a load finishes or fails
         LoadedMap mLoadedMap;
+        LruList mLru; ///< most recently used first
+        Stats mStats;
+
+        boost::scoped_ptr<DiskCache> mDiskCache;
+        boost::scoped_ptr<Misc::WorkQueue> mWorkQueue; ///< created on first use
+
+        /// Open \a filename through the disk cache if one is set, otherwise through Ogre.
+        Ogre::DataStreamPtr open (const std::string& filename);
+
+        /// Parse the file from \a stream, opening it first if it is null, and add it to the cache.
+        /// The entry for \a key must be marked as loading.
+        NIFFilePtr loadFile (const std::string& key, const std::string& filename, Ogre::DataStreamPtr stream);
+
+        /// Parse the file unless it has been requested by load() in the meantime.
+        void loadQueued (const std::string& key, const std::string& filename);
+
+        /// Unload least recently used files that are not in use until the budget is met.
+        ///
+        /// \note mMutex must be locked.
+        void evict();
     };
 
 }
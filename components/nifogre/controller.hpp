@@ -11,55 +11,70 @@ namespace NifOgre
     class ValueInterpolator
     {
     protected:
-        float interpKey(const Nif::FloatKeyMap::MapType &keys, float time, float def=0.f) const
+        /// Find the keys around \a time and blend their values linearly.
+        ///
+        /// \param cursor Per-user search position, see Nif::KeyMapT::findKey.
+        /// \note \a keys must not be empty.
+        template<typename KeyMap>
+        static void findKeys(const KeyMap &keys, float time, size_t &cursor, size_t &index, float &blend)
         {
-            if (keys.size() == 0)
-                return def;
-
-            if(time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
-
-            Nif::FloatKeyMap::MapType::const_iterator it = keys.lower_bound(time);
-            if (it != keys.end())
+            if(time <= keys.mTimes.front())
             {
-                float aTime = it->first;
-                const Nif::FloatKey* aKey = &it->second;
-
-                assert (it != keys.begin()); // Shouldn't happen, was checked at beginning of this function
-
-                Nif::FloatKeyMap::MapType::const_iterator last = --it;
-                float aLastTime = last->first;
-                const Nif::FloatKey* aLastKey = &last->second;
+                index = 0;
+                blend = 0.f;
+                return;
+            }
 
-                float a = (time - aLastTime) / (aTime - aLastTime);
-                return aLastKey->mValue + ((aKey->mValue - aLastKey->mValue) * a);
+            index = keys.findKey(time, cursor);
+            if(index == keys.mTimes.size())
+            {
+                index = keys.mTimes.size()-1;
+                blend = 0.f;
+                return;
             }
-            else
-                return keys.rbegin()->second.mValue;
+
+            // The first key is handled above, so this is at least 1
+            float lastTime = keys.mTimes[--index];
+            blend = (time - lastTime) / (keys.mTimes[index+1] - lastTime);
         }
 
-        Ogre::Vector3 interpKey(const Nif::Vector3KeyMap::MapType &keys, float time) const
+        float interpKey(const Nif::FloatKeyMap &keys, float time, size_t &cursor, float def=0.f) const
         {
-            if(time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
+            if (keys.mKeys.empty())
+                return def;
 
-            Nif::Vector3KeyMap::MapType::const_iterator it = keys.lower_bound(time);
-            if (it != keys.end())
-            {
-                float aTime = it->first;
-                const Nif::Vector3Key* aKey = &it->second;
+            size_t index;
+            float a;
+            findKeys(keys, time, cursor, index, a);
 
-                assert (it != keys.begin()); // Shouldn't happen, was checked at beginning of this function
+            float value = keys.mKeys[index].mValue;
+            if(a == 0.f)
+                return value;
+            return value + ((keys.mKeys[index+1].mValue - value) * a);
+        }
 
-                Nif::Vector3KeyMap::MapType::const_iterator last = --it;
-                float aLastTime = last->first;
-                const Nif::Vector3Key* aLastKey = &last->second;
+        Ogre::Vector3 interpKey(const Nif::Vector3KeyMap &keys, float time, size_t &cursor) const
+        {
+            size_t index;
+            float a;
+            findKeys(keys, time, cursor, index, a);
+
+            const Ogre::Vector3 &value = keys.mKeys[index].mValue;
+            if(a == 0.f)
+                return value;
+            return value + ((keys.mKeys[index+1].mValue - value) * a);
+        }
 
-                float a = (time - aLastTime) / (aTime - aLastTime);
-                return aLastKey->mValue + ((aKey->mValue - aLastKey->mValue) * a);
-            }
-            else
-                return keys.rbegin()->second.mValue;
+        Ogre::Quaternion interpKey(const Nif::QuaternionKeyMap &keys, float time, size_t &cursor) const
+        {
+            size_t index;
+            float a;
+            findKeys(keys, time, cursor, index, a);
+
+            const Ogre::Quaternion &value = keys.mKeys[index].mValue;
+            if(a == 0.f)
+                return value;
+            return Ogre::Quaternion::nlerp(a, value, keys.mKeys[index+1].mValue);
         }
     };
 
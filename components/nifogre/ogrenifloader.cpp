@@ -270,12 +270,14 @@ public:
     private:
         Ogre::MovableObject* mMovable;
         Nif::FloatKeyMap mData;
+        size_t mCursor;
         MaterialControllerManager* mMaterialControllerMgr;
 
     public:
         Value(Ogre::MovableObject *movable, const Nif::NiFloatData *data, MaterialControllerManager* materialControllerMgr)
           : mMovable(movable)
           , mData(data->mKeyList)
+          , mCursor(0)
           , mMaterialControllerMgr(materialControllerMgr)
         {
         }
@@ -288,7 +290,7 @@ public:
 
         virtual void setValue(Ogre::Real time)
         {
-            float value = interpKey(mData.mKeys, time);
+            float value = interpKey(mData, time, mCursor);
             Ogre::MaterialPtr mat = mMaterialControllerMgr->getWritableMaterial(mMovable);
             Ogre::Material::TechniqueIterator techs = mat->getTechniqueIterator();
             while(techs.hasMoreElements())
@@ -317,12 +319,14 @@ public:
     private:
         Ogre::MovableObject* mMovable;
         Nif::Vector3KeyMap mData;
+        size_t mCursor;
         MaterialControllerManager* mMaterialControllerMgr;
 
     public:
         Value(Ogre::MovableObject *movable, const Nif::NiPosData *data, MaterialControllerManager* materialControllerMgr)
           : mMovable(movable)
           , mData(data->mKeyList)
+          , mCursor(0)
           , mMaterialControllerMgr(materialControllerMgr)
         {
         }
@@ -335,7 +339,7 @@ public:
 
         virtual void setValue(Ogre::Real time)
         {
-            Ogre::Vector3 value = interpKey(mData.mKeys, time);
+            Ogre::Vector3 value = interpKey(mData, time, mCursor);
             Ogre::MaterialPtr mat = mMaterialControllerMgr->getWritableMaterial(mMovable);
             Ogre::Material::TechniqueIterator techs = mat->getTechniqueIterator();
             while(techs.hasMoreElements())
@@ -449,37 +453,19 @@ public:
         const Nif::FloatKeyMap* mScales;
         Nif::NIFFilePtr mNif; // Hold a SharedPtr to make sure key lists stay valid
 
-        using ValueInterpolator::interpKey;
-
-        static Ogre::Quaternion interpKey(const Nif::QuaternionKeyMap::MapType &keys, float time)
-        {
-            if(time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
-
-            Nif::QuaternionKeyMap::MapType::const_iterator it = keys.lower_bound(time);
-            if (it != keys.end())
-            {
-                float aTime = it->first;
-                const Nif::QuaternionKey* aKey = &it->second;
-
-                assert (it != keys.begin()); // Shouldn't happen, was checked at beginning of this function
-
-                Nif::QuaternionKeyMap::MapType::const_iterator last = --it;
-                float aLastTime = last->first;
-                const Nif::QuaternionKey* aLastKey = &last->second;
-
-                float a = (time - aLastTime) / (aTime - aLastTime);
-                return Ogre::Quaternion::nlerp(a, aLastKey->mValue, aKey->mValue);
-            }
-            else
-                return keys.rbegin()->second.mValue;
-        }
+        // Last key found in each list, playback usually continues from there
+        mutable size_t mRotationCursor;
+        mutable size_t mXRotationCursor;
+        mutable size_t mYRotationCursor;
+        mutable size_t mZRotationCursor;
+        mutable size_t mTranslationCursor;
+        mutable size_t mScaleCursor;
 
         Ogre::Quaternion getXYZRotation(float time) const
         {
-            float xrot = interpKey(mXRotations->mKeys, time);
-            float yrot = interpKey(mYRotations->mKeys, time);
-            float zrot = interpKey(mZRotations->mKeys, time);
+            float xrot = interpKey(*mXRotations, time, mXRotationCursor);
+            float yrot = interpKey(*mYRotations, time, mYRotationCursor);
+            float zrot = interpKey(*mZRotations, time, mZRotationCursor);
             Ogre::Quaternion xr(Ogre::Radian(xrot), Ogre::Vector3::UNIT_X);
             Ogre::Quaternion yr(Ogre::Radian(yrot), Ogre::Vector3::UNIT_Y);
             Ogre::Quaternion zr(Ogre::Radian(zrot), Ogre::Vector3::UNIT_Z);
@@ -497,12 +483,18 @@ public:
           , mTranslations(&data->mTranslations)
           , mScales(&data->mScales)
           , mNif(nif)
+          , mRotationCursor(0)
+          , mXRotationCursor(0)
+          , mYRotationCursor(0)
+          , mZRotationCursor(0)
+          , mTranslationCursor(0)
+          , mScaleCursor(0)
         { }
 
         virtual Ogre::Quaternion getRotation(float time) const
         {
             if(mRotations->mKeys.size() > 0)
-                return interpKey(mRotations->mKeys, time);
+                return interpKey(*mRotations, time, mRotationCursor);
             else if (!mXRotations->mKeys.empty() || !mYRotations->mKeys.empty() || !mZRotations->mKeys.empty())
                 return getXYZRotation(time);
             return mNode->getOrientation();
@@ -511,14 +503,14 @@ public:
         virtual Ogre::Vector3 getTranslation(float time) const
         {
             if(mTranslations->mKeys.size() > 0)
-                return interpKey(mTranslations->mKeys, time);
+                return interpKey(*mTranslations, time, mTranslationCursor);
             return mNode->getPosition();
         }
 
         virtual Ogre::Vector3 getScale(float time) const
         {
             if(mScales->mKeys.size() > 0)
-                return Ogre::Vector3(interpKey(mScales->mKeys, time));
+                return Ogre::Vector3(interpKey(*mScales, time, mScaleCursor));
             return mNode->getScale();
         }
 
@@ -531,13 +523,13 @@ public:
         virtual void setValue(Ogre::Real time)
         {
             if(mRotations->mKeys.size() > 0)
-                mNode->setOrientation(interpKey(mRotations->mKeys, time));
+                mNode->setOrientation(interpKey(*mRotations, time, mRotationCursor));
             else if (!mXRotations->mKeys.empty() || !mYRotations->mKeys.empty() || !mZRotations->mKeys.empty())
                 mNode->setOrientation(getXYZRotation(time));
             if(mTranslations->mKeys.size() > 0)
-                mNode->setPosition(interpKey(mTranslations->mKeys, time));
+                mNode->setPosition(interpKey(*mTranslations, time, mTranslationCursor));
             if(mScales->mKeys.size() > 0)
-                mNode->setScale(Ogre::Vector3(interpKey(mScales->mKeys, time)));
+                mNode->setScale(Ogre::Vector3(interpKey(*mScales, time, mScaleCursor)));
         }
     };
 
@@ -555,6 +547,7 @@ public:
         Nif::FloatKeyMap mVTrans;
         Nif::FloatKeyMap mUScale;
         Nif::FloatKeyMap mVScale;
+        size_t mCursors[4];
         MaterialControllerManager* mMaterialControllerMgr;
 
     public:
@@ -565,7 +558,9 @@ public:
           , mUScale(data->mKeyList[2])
           , mVScale(data->mKeyList[3])
           , mMaterialControllerMgr(materialControllerMgr)
-        { }
+        {
+            std::fill(mCursors, mCursors+4, 0);
+        }
 
         virtual Ogre::Real getValue() const
         {
@@ -575,10 +570,10 @@ public:
 
         virtual void setValue(Ogre::Real value)
         {
-            float uTrans = interpKey(mUTrans.mKeys, value, 0.0f);
-            float vTrans = interpKey(mVTrans.mKeys, value, 0.0f);
-            float uScale = interpKey(mUScale.mKeys, value, 1.0f);
-            float vScale = interpKey(mVScale.mKeys, value, 1.0f);
+            float uTrans = interpKey(mUTrans, value, mCursors[0], 0.0f);
+            float vTrans = interpKey(mVTrans, value, mCursors[1], 0.0f);
+            float uScale = interpKey(mUScale, value, mCursors[2], 1.0f);
+            float vScale = interpKey(mVScale, value, mCursors[3], 1.0f);
 
             Ogre::MaterialPtr material = mMaterialControllerMgr->getWritableMaterial(mMovable);
 
@@ -639,6 +634,7 @@ public:
     private:
         Ogre::Entity *mEntity;
         std::vector<Nif::NiMorphData::MorphData> mMorphs;
+        std::vector<size_t> mCursors;
         size_t mControllerIndex;
 
         std::vector<Ogre::Vector3> mVertices;
@@ -647,6 +643,7 @@ public:
         Value(Ogre::Entity *ent, const Nif::NiMorphData *data, size_t controllerIndex)
           : mEntity(ent)
           , mMorphs(data->mMorphs)
+          , mCursors(data->mMorphs.size(), 0)
           , mControllerIndex(controllerIndex)
         {
         }
@@ -666,7 +663,7 @@ public:
             {
                 float val = 0;
                 if (!it->mData.mKeys.empty())
-                    val = interpKey(it->mData.mKeys, time);
+                    val = interpKey(it->mData, time, mCursors[i]);
                 val = std::max(0.f, std::min(1.f, val));
 
                 Ogre::String animationID = Ogre::StringConverter::toString(mControllerIndex)
@@ -906,17 +903,18 @@ private:
                 Ogre::ParticleAffector *affector = partsys->addAffector("ColourInterpolator");
                 size_t num_colors = std::min<size_t>(6, clrdata->mKeyMap.mKeys.size());
                 unsigned int i=0;
-                for (Nif::Vector4KeyMap::MapType::const_iterator it = clrdata->mKeyMap.mKeys.begin(); it != clrdata->mKeyMap.mKeys.end() && i < num_colors; ++it,++i)
+                for (; i < num_colors; ++i)
                 {
+                    const Ogre::Vector4 &value = clrdata->mKeyMap.mKeys[i].mValue;
                     Ogre::ColourValue color;
-                    color.r = it->second.mValue[0];
-                    color.g = it->second.mValue[1];
-                    color.b = it->second.mValue[2];
-                    color.a = it->second.mValue[3];
+                    color.r = value[0];
+                    color.g = value[1];
+                    color.b = value[2];
+                    color.a = value[3];
                     affector->setParameter("colour"+Ogre::StringConverter::toString(i),
                                            Ogre::StringConverter::toString(color));
                     affector->setParameter("time"+Ogre::StringConverter::toString(i),
-                                           Ogre::StringConverter::toString(it->first));
+                                           Ogre::StringConverter::toString(clrdata->mKeyMap.mTimes[i]));
                 }
             }
             else if(e->recType == Nif::RC_NiParticleRotation)
@@ -129,6 +129,8 @@ namespace ESM4
         // NOTE: must be called before calling getRecordHeader()
         void setRecHeaderSize(const std::size_t size);
 
+        inline std::size_t recHeaderSize() const { return mCtx.recHeaderSize; }
+
         inline void loadHeader() { mHeader.load(*this); }
         inline unsigned int esmVersion() const { return mHeader.mData.version.ui; }
         inline unsigned int numRecords() const { return mHeader.mData.records; }
@@ -150,6 +152,10 @@ namespace ESM4
         void setModIndex(int index) { mCtx.modIndex = (index << 24) & 0xff000000; }
         void updateModIndicies(const std::vector<std::string>& files);
 
+        // For reading records of this file with another reader later on
+        inline const std::vector<std::uint32_t>& modIndicies() const { return mHeader.mModIndicies; }
+        inline void setModIndicies(const std::vector<std::uint32_t>& indicies) { mHeader.mModIndicies = indicies; }
+
         // Maybe should throw an exception if called when not valid?
         const CellGrid& currCellGrid() const;
 
@@ -1,5 +1,24 @@
 #include "BulletShapeLoader.h"
 
+#include <algorithm>
+#include <vector>
+
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+
+namespace
+{
+    /// Orders shapes by when they were last asked for, least recently first
+    struct CompareLastUse
+    {
+        bool operator()(const OEngine::Physic::BulletShape* left,
+                        const OEngine::Physic::BulletShape* right) const
+        {
+            return left->mLastUse < right->mLastUse;
+        }
+    };
+}
+
 namespace OEngine {
 namespace Physic
 {
@@ -21,6 +40,7 @@ Ogre::Resource(creator, name, handle, group, isManual, loader)
     mRaycastingShape = NULL;
     mAutogenerated = true;
     mCollide = true;
+    mLastUse = 0;
     createParamDictionary("BulletShape");
 }
 
@@ -59,12 +79,54 @@ void BulletShape::unloadImpl()
     deleteShape(mRaycastingShape);
     mCollisionShape = NULL;
     mRaycastingShape = NULL;
+    mAnimatedShapes.clear();
+    mAnimatedRaycastingShapes.clear();
+}
+
+size_t BulletShape::getShapeSize(const btCollisionShape* shape)
+{
+    if(shape==NULL)
+        return 0;
+
+    if(shape->isCompound())
+    {
+        const btCompoundShape* ms = static_cast<const btCompoundShape*>(shape);
+        size_t size = sizeof(btCompoundShape) + ms->getNumChildShapes()*sizeof(btCompoundShapeChild);
+        for(int i=0; i <ms->getNumChildShapes();i++)
+            size += getShapeSize(ms->getChildShape(i));
+        return size;
+    }
+
+    if(const btBvhTriangleMeshShape* trishape = dynamic_cast<const btBvhTriangleMeshShape*>(shape))
+    {
+        size_t size = sizeof(btBvhTriangleMeshShape);
+
+        const unsigned char* vertices;
+        const unsigned char* indices;
+        int numVertices, vertexStride, indexStride, numFaces;
+        PHY_ScalarType vertexType, indexType;
+
+        const btStridingMeshInterface* mesh = trishape->getMeshInterface();
+        for(int part=0; part <mesh->getNumSubParts();part++)
+        {
+            mesh->getLockedReadOnlyVertexIndexBase(&vertices, numVertices, vertexType, vertexStride,
+                &indices, indexStride, numFaces, indexType, part);
+            size += numVertices*vertexStride + numFaces*indexStride;
+            mesh->unLockReadOnlyVertexBase(part);
+        }
+
+        if(const btOptimizedBvh* bvh = const_cast<btBvhTriangleMeshShape*>(trishape)->getOptimizedBvh())
+            size += bvh->calculateSerializeBufferSize();
+
+        return size;
+    }
+
+    return sizeof(btBoxShape);
 }
 
-//TODO:change this?
 size_t BulletShape::calculateSize() const
 {
-    return 1;
+    return sizeof(BulletShape) + getShapeSize(mCollisionShape) + getShapeSize(mRaycastingShape);
 }
 
 
@@ -84,6 +146,7 @@ BulletShapeManager &BulletShapeManager::getSingleton()
 }
 
 BulletShapeManager::BulletShapeManager()
+    : mUseCounter(0)
 {
     assert(!sThis);
     sThis = this;
@@ -131,10 +194,41 @@ BulletShapePtr BulletShapeManager::load(const Ogre::String &name, const Ogre::St
     if (textf.isNull())
         textf = create(name, group);
 
+    textf->mLastUse = ++mUseCounter;
     textf->load();
+
+    // Ogre only checks the budget when loading with some versions
+    checkUsage();
+
     return textf;
 }
 
+void BulletShapeManager::checkUsage()
+{
+    if (getMemoryUsage() <= getMemoryBudget())
+        return;
+
+    std::vector<BulletShape*> unused;
+
+    ResourceMapIterator iter = getResourceIterator();
+    while (iter.hasMoreElements())
+    {
+        const Ogre::ResourcePtr* resource = iter.peekNextValuePtr();
+        iter.moveNext();
+
+        // Only referenced from the resource system
+        if ((*resource)->isLoaded() && (*resource)->isReloadable() &&
+            resource->useCount() == Ogre::ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS)
+            unused.push_back(static_cast<BulletShape*>(resource->get()));
+    }
+
+    std::sort(unused.begin(), unused.end(), CompareLastUse());
+
+    for (std::vector<BulletShape*>::iterator it = unused.begin();
+         it != unused.end() && getMemoryUsage() > getMemoryBudget(); ++it)
+        (*it)->unload();
+}
+
 Ogre::Resource *BulletShapeManager::createImpl(const Ogre::String &name, Ogre::ResourceHandle handle,
     const Ogre::String &group, bool isManual, Ogre::ManualResourceLoader *loader,
     const Ogre::NameValuePairList *createParams)
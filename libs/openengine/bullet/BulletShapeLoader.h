@@ -22,6 +22,9 @@ protected:
 
     void deleteShape(btCollisionShape* shape);
 
+    /// Estimate of the memory used by \a shape and its triangle meshes and BVHs, in bytes
+    static size_t getShapeSize(const btCollisionShape* shape);
+
 public:
 
     BulletShape(Ogre::ResourceManager *creator, const Ogre::String &name,
@@ -48,6 +51,9 @@ public:
     Ogre::Quaternion mBoxRotation;
     //this flag indicate if the shape is used for collision or if it's for raycasting only.
     bool mCollide;
+
+    /// When the shape was last asked for from the BulletShapeManager (see BulletShapeManager::load)
+    unsigned long mLastUse;
 };
 
 /**
@@ -73,6 +79,11 @@ typedef Ogre::SharedPtr<BulletShape> BulletShapePtr;
 *
 *Important Note: i have no idea of what happen if you try to load two time the same resource without unloading.
 *It won't crash, but it might lead to memory leaks(I don't know how Ogre handle this). So don't do it!
+*
+*Shapes stay loaded across cell changes. When the loaded shapes exceed the memory budget (see
+*Ogre::ResourceManager::setMemoryBudget), the ones that have not been asked for the longest and
+*are not referenced from anywhere else (e.g. by a RigidBody) are unloaded; they are reloaded the
+*next time they are asked for.
 */
 class BulletShapeManager : public Ogre::ResourceManager
 {
@@ -83,8 +94,13 @@ protected:
         const Ogre::String &group, bool isManual, Ogre::ManualResourceLoader *loader,
         const Ogre::NameValuePairList *createParams);
 
+    /// Unload least recently used shapes that are not in use until the budget is met.
+    virtual void checkUsage();
+
     static BulletShapeManager *sThis;
 
+    unsigned long mUseCounter;
+
 private:
     /** \brief Explicit private copy constructor. This is a forbidden operation.*/
     BulletShapeManager(const BulletShapeManager &);
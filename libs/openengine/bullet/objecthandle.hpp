@@ -0,0 +1,25 @@
+#ifndef OENGINE_BULLET_OBJECTHANDLE_H
+#define OENGINE_BULLET_OBJECTHANDLE_H
+
+#include <cstddef>
+
+namespace OEngine {
+namespace Physic
+{
+    /**
+     * Identifies an object of a PhysicEngine: the collision and raycasting bodies, the actor or the
+     * height field created under one name. The lower bits are the index of the object in the engine,
+     * the upper ones count how often that index has been reused, so that the handle of a removed
+     * object does not refer to an object added later. 0 is no object.
+     */
+    typedef unsigned int ObjectHandle;
+
+    const int sObjectIndexBits = 24;
+
+    inline std::size_t getObjectIndex(ObjectHandle handle)
+    {
+        return handle & ((1u<<sObjectIndexBits)-1);
+    }
+}}
+
+#endif
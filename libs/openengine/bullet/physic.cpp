@@ -1,5 +1,8 @@
 #include "physic.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <btBulletDynamicsCommon.h>
 #include <btBulletCollisionCommon.h>
 #include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
@@ -50,6 +53,21 @@ btCollisionShape *duplicateCollisionShape(btCollisionShape *shape)
     throw std::logic_error(std::string("Unhandled Bullet shape duplication: ")+shape->getName());
 }
 
+void setHandle(btCollisionObject *object, OEngine::Physic::ObjectHandle handle)
+{
+    object->setUserPointer(reinterpret_cast<void*>(static_cast<std::size_t>(handle)));
+}
+
+/// Orders ray hits by their distance
+struct CompareHits
+{
+    bool operator()(const std::pair<float, OEngine::Physic::ObjectHandle>& left,
+                    const std::pair<float, OEngine::Physic::ObjectHandle>& right) const
+    {
+        return left.first < right.first;
+    }
+};
+
 void deleteShape(btCollisionShape* shape)
 {
     if(shape!=NULL)
@@ -236,9 +254,16 @@ namespace Physic
 
 
 
+    PhysicEngine::PhysicObject::PhysicObject()
+        : mHandle(0), mCollisionBody(0), mRaycastingBody(0), mActor(0), mHeightField(0)
+    {
+    }
+
     PhysicEngine::PhysicEngine(BulletShapeLoader* shapeLoader) :
         mSceneMgr(NULL)
       , mDebugActive(0)
+      , mObjects(1)
+      , mNameLookups(0)
     {
         // Set up the collision configuration and dispatcher
         collisionConfiguration = new btDefaultCollisionConfiguration();
@@ -402,6 +427,10 @@ namespace Physic
 
         mHeightFieldMap [name] = hf;
 
+        PhysicObject& object = addObject(name);
+        object.mHeightField = body;
+        setHandle(body, object.mHandle);
+
         mDynamicsWorld->addRigidBody(body,CollisionType_HeightMap,
                                     CollisionType_Actor|CollisionType_Raycasting|CollisionType_Projectile);
     }
@@ -418,6 +447,12 @@ namespace Physic
 
         const HeightField& hf = it->second;
 
+        if (PhysicObject* object = findObject(getHandle(hf.mBody)))
+        {
+            object->mHeightField = 0;
+            removeObjectIfUnused(*object);
+        }
+
         mDynamicsWorld->removeRigidBody(hf.mBody);
         delete hf.mShape;
         delete hf.mBody;
@@ -489,6 +524,7 @@ namespace Physic
                 (0,0, collisionShape);
         RigidBody* body = new RigidBody(CI,name);
         body->mPlaceable = placeable;
+        body->mShape = shape;
 
         if (!raycasting && !shape->mAnimatedShapes.empty())
         {
@@ -512,6 +548,10 @@ namespace Physic
 
         adjustRigidBody(body, position, rotation, shape->mBoxTranslation * scale, shape->mBoxRotation);
 
+        PhysicObject& object = addObject(name);
+        (raycasting ? object.mRaycastingBody : object.mCollisionBody) = body;
+        setHandle(body, object.mHandle);
+
         if (!raycasting)
         {
             assert (mCollisionObjectMap.find(name) == mCollisionObjectMap.end());
@@ -531,6 +571,8 @@ namespace Physic
 
     void PhysicEngine::removeRigidBody(const std::string &name)
     {
+        ++mNameLookups;
+
         RigidBodyContainer::iterator it = mCollisionObjectMap.find(name);
         if (it != mCollisionObjectMap.end() )
         {
@@ -553,6 +595,13 @@ namespace Physic
 
     void PhysicEngine::deleteRigidBody(const std::string &name)
     {
+        ++mNameLookups;
+
+        PhysicObject *object = 0;
+        std::map<std::string, ObjectHandle>::const_iterator handle = mObjectHandles.find(name);
+        if (handle != mObjectHandles.end())
+            object = findObject(handle->second);
+
         RigidBodyContainer::iterator it = mCollisionObjectMap.find(name);
         if (it != mCollisionObjectMap.end() )
         {
@@ -567,6 +616,9 @@ namespace Physic
                 delete body;
             }
             mCollisionObjectMap.erase(it);
+
+            if (object)
+                object->mCollisionBody = 0;
         }
         it = mRaycastingObjectMap.find(name);
         if (it != mRaycastingObjectMap.end() )
@@ -582,10 +634,22 @@ namespace Physic
                 delete body;
             }
             mRaycastingObjectMap.erase(it);
+
+            if (object)
+                object->mRaycastingBody = 0;
         }
+
+        if (object)
+            removeObjectIfUnused(*object);
     }
 
     RigidBody* PhysicEngine::getRigidBody(const std::string &name, bool raycasting)
+    {
+        ++mNameLookups;
+        return findRigidBody(name, raycasting);
+    }
+
+    RigidBody* PhysicEngine::findRigidBody(const std::string &name, bool raycasting)
     {
         RigidBodyContainer* map = raycasting ? &mRaycastingObjectMap : &mCollisionObjectMap;
         RigidBodyContainer::iterator it = map->find(name);
@@ -635,7 +699,7 @@ namespace Physic
 
     class DeepestNotMeContactTestResultCallback : public btCollisionWorld::ContactResultCallback
     {
-        const std::string &mFilter;
+        ObjectHandle mFilter;
         // Store the real origin, since the shape's origin is its center
         btVector3 mOrigin;
 
@@ -644,7 +708,7 @@ namespace Physic
         btVector3 mContactPoint;
         btScalar mLeastDistSqr;
 
-        DeepestNotMeContactTestResultCallback(const std::string &filter, const btVector3 &origin)
+        DeepestNotMeContactTestResultCallback(ObjectHandle filter, const btVector3 &origin)
           : mFilter(filter), mOrigin(origin), mObject(0), mContactPoint(0,0,0),
             mLeastDistSqr(std::numeric_limits<float>::max())
         { }
@@ -655,7 +719,7 @@ namespace Physic
                                          const btCollisionObjectWrapper* col1Wrap,int partId1,int index1)
         {
             const RigidBody* body = dynamic_cast<const RigidBody*>(col1Wrap->m_collisionObject);
-            if(body && body->mName != mFilter)
+            if(body && (!mFilter || PhysicEngine::getHandle(body) != mFilter))
             {
                 btScalar distsqr = mOrigin.distance2(cp.getPositionWorldOnA());
                 if(!mObject || distsqr < mLeastDistSqr)
@@ -674,7 +738,7 @@ namespace Physic
                                          const btCollisionObject* col1, int partId1, int index1)
         {
             const RigidBody* body = dynamic_cast<const RigidBody*>(col1);
-            if(body && body->mName != mFilter)
+            if(body && (!mFilter || PhysicEngine::getHandle(body) != mFilter))
             {
                 btScalar distsqr = mOrigin.distance2(cp.getPositionWorldOnA());
                 if(!mObject || distsqr < mLeastDistSqr)
@@ -693,9 +757,11 @@ namespace Physic
 
     std::vector<std::string> PhysicEngine::getCollisions(const std::string& name, int collisionGroup, int collisionMask)
     {
-        RigidBody* body = getRigidBody(name);
+        ++mNameLookups;
+
+        RigidBody* body = findRigidBody(name, false);
         if (!body) // fall back to raycasting body if there is no collision body
-            body = getRigidBody(name, true);
+            body = findRigidBody(name, true);
         ContactTestResultCallback callback;
         callback.m_collisionFilterGroup = collisionGroup;
         callback.m_collisionFilterMask = collisionMask;
@@ -707,6 +773,13 @@ namespace Physic
     std::pair<const RigidBody*,btVector3> PhysicEngine::getFilteredContact(const std::string &filter,
                                                                            const btVector3 &origin,
                                                                            btCollisionObject *object)
+    {
+        return getFilteredContact(getHandle(filter), origin, object);
+    }
+
+    std::pair<const RigidBody*,btVector3> PhysicEngine::getFilteredContact(ObjectHandle filter,
+                                                                           const btVector3 &origin,
+                                                                           btCollisionObject *object)
     {
         DeepestNotMeContactTestResultCallback callback(filter, origin);
         callback.m_collisionFilterGroup = CollisionType_Actor;
@@ -725,34 +798,55 @@ namespace Physic
         }
     }
 
-    void PhysicEngine::addCharacter(const std::string &name, const std::string &mesh,
+    PhysicActor* PhysicEngine::addCharacter(const std::string &name, const std::string &mesh,
         const Ogre::Vector3 &position, float scale, const Ogre::Quaternion &rotation)
     {
         // Remove character with given name, so we don't make memory
         // leak when character would be added twice
-        removeCharacter(name);
+        PhysicActorContainer::iterator it = mActorMap.find(name);
+        if (it != mActorMap.end())
+            deleteCharacter(it);
 
         PhysicActor* newActor = new PhysicActor(name, mesh, this, position, rotation, scale);
 
         mActorMap[name] = newActor;
+
+        PhysicObject& object = addObject(name);
+        object.mActor = newActor;
+        setHandle(newActor->getCollisionBody(), object.mHandle);
+
+        return newActor;
     }
 
     void PhysicEngine::removeCharacter(const std::string &name)
     {
+        ++mNameLookups;
+
         PhysicActorContainer::iterator it = mActorMap.find(name);
         if (it != mActorMap.end() )
+            deleteCharacter(it);
+    }
+
+    void PhysicEngine::deleteCharacter(PhysicActorContainer::iterator iter)
+    {
+        PhysicActor* act = iter->second;
+        if(act != NULL)
         {
-            PhysicActor* act = it->second;
-            if(act != NULL)
+            if (PhysicObject* object = findObject(getHandle(act->getCollisionBody())))
             {
-                delete act;
+                object->mActor = 0;
+                removeObjectIfUnused(*object);
             }
-            mActorMap.erase(it);
+
+            delete act;
         }
+        mActorMap.erase(iter);
     }
 
     PhysicActor* PhysicEngine::getCharacter(const std::string &name)
     {
+        ++mNameLookups;
+
         PhysicActorContainer::iterator it = mActorMap.find(name);
         if (it != mActorMap.end() )
         {
@@ -765,6 +859,97 @@ namespace Physic
         }
     }
 
+    RigidBody* PhysicEngine::getRigidBody(ObjectHandle handle, bool raycasting)
+    {
+        PhysicObject* object = findObject(handle);
+        if (!object)
+            return NULL;
+        return raycasting ? object->mRaycastingBody : object->mCollisionBody;
+    }
+
+    PhysicActor* PhysicEngine::getCharacter(ObjectHandle handle)
+    {
+        PhysicObject* object = findObject(handle);
+        return object ? object->mActor : 0;
+    }
+
+    ObjectHandle PhysicEngine::getHandle(const std::string &name) const
+    {
+        ++mNameLookups;
+
+        std::map<std::string, ObjectHandle>::const_iterator it = mObjectHandles.find(name);
+        return it != mObjectHandles.end() ? it->second : 0;
+    }
+
+    ObjectHandle PhysicEngine::getHandle(const btCollisionObject *object)
+    {
+        return static_cast<ObjectHandle>(reinterpret_cast<std::size_t>(object->getUserPointer()));
+    }
+
+    const std::string& PhysicEngine::getName(ObjectHandle handle) const
+    {
+        static const std::string empty;
+
+        std::size_t index = getObjectIndex(handle);
+        if (index >= mObjects.size() || mObjects[index].mHandle != handle || !handle)
+            return empty;
+        return mObjects[index].mName;
+    }
+
+    std::size_t PhysicEngine::getNameLookupCount() const
+    {
+        return mNameLookups;
+    }
+
+    PhysicEngine::PhysicObject& PhysicEngine::addObject(const std::string &name)
+    {
+        std::map<std::string, ObjectHandle>::const_iterator it = mObjectHandles.find(name);
+        if (it != mObjectHandles.end())
+            return mObjects[getObjectIndex(it->second)];
+
+        std::size_t index;
+        if (!mFreeObjects.empty())
+        {
+            index = mFreeObjects.back();
+            mFreeObjects.pop_back();
+        }
+        else
+        {
+            if (mObjects.size() >= (1u<<sObjectIndexBits))
+                throw std::runtime_error("too many physics objects");
+
+            index = mObjects.size();
+            mObjects.push_back(PhysicObject());
+        }
+
+        PhysicObject& object = mObjects[index];
+        object.mName = name;
+        object.mHandle = static_cast<ObjectHandle>(index) | (object.mHandle & ~((1u<<sObjectIndexBits)-1));
+        mObjectHandles.insert(std::make_pair(name, object.mHandle));
+        return object;
+    }
+
+    PhysicEngine::PhysicObject* PhysicEngine::findObject(ObjectHandle handle)
+    {
+        std::size_t index = getObjectIndex(handle);
+        if (!handle || index >= mObjects.size() || mObjects[index].mHandle != handle)
+            return 0;
+        return &mObjects[index];
+    }
+
+    void PhysicEngine::removeObjectIfUnused(PhysicObject& object)
+    {
+        if (object.mCollisionBody || object.mRaycastingBody || object.mActor || object.mHeightField)
+            return;
+
+        mObjectHandles.erase(object.mName);
+        mFreeObjects.push_back(getObjectIndex(object.mHandle));
+
+        // keep only the reuse count, so that the next handle with this index is a different one
+        object.mHandle = (object.mHandle & ~((1u<<sObjectIndexBits)-1)) + (1u<<sObjectIndexBits);
+        object.mName.clear();
+    }
+
     std::pair<std::string,float> PhysicEngine::rayTest(const btVector3 &from, const btVector3 &to, bool raycastingObjectOnly, bool ignoreHeightMap, Ogre::Vector3* normal)
     {
         std::string name = "";
@@ -850,6 +1035,27 @@ namespace Physic
         return results2;
     }
 
+    std::vector< std::pair<float, ObjectHandle> > PhysicEngine::rayTestHandles(const btVector3& from, const btVector3& to, int filterGroup)
+    {
+        MyRayResultCallback resultCallback;
+        resultCallback.m_collisionFilterGroup = filterGroup;
+        resultCallback.m_collisionFilterMask = CollisionType_Raycasting|CollisionType_Actor|CollisionType_HeightMap;
+        mDynamicsWorld->rayTest(from, to, resultCallback);
+
+        std::vector< std::pair<float, ObjectHandle> > results;
+        results.reserve(resultCallback.results.size());
+
+        for (std::vector< std::pair<float, const btCollisionObject*> >::const_iterator it = resultCallback.results.begin();
+            it != resultCallback.results.end(); ++it)
+        {
+            results.push_back(std::make_pair(it->first, getHandle(it->second)));
+        }
+
+        std::sort(results.begin(), results.end(), CompareHits());
+
+        return results;
+    }
+
     void PhysicEngine::getObjectAABB(const std::string &mesh, float scale, btVector3 &min, btVector3 &max)
     {
         std::string sid = (boost::format("%07.3f") % scale).str();
@@ -3,10 +3,13 @@
 
 #include <BulletDynamics/Dynamics/btRigidBody.h>
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include <cstddef>
 #include <string>
 #include <list>
 #include <map>
+#include <vector>
 #include "BulletShapeLoader.h"
+#include "objecthandle.hpp"
 #include "BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h"
 #include <boost/shared_ptr.hpp>
 
@@ -66,6 +69,10 @@ namespace Physic
         // Hack: placeable objects (that can be picked up by the player) have different collision behaviour.
         // This variable needs to be passed to BulletNifLoader.
         bool mPlaceable;
+
+        // Keeps the shape this body was created from loaded, duplicates of animated shapes
+        // still point to its triangle meshes.
+        BulletShapePtr mShape;
     };
 
 
@@ -251,10 +258,15 @@ namespace Physic
          */
         RigidBody* getRigidBody(const std::string &name, bool raycasting=false);
 
+        /**
+         * Return a pointer to the body of the object with the given handle.
+         */
+        RigidBody* getRigidBody(ObjectHandle handle, bool raycasting=false);
+
         /**
          * Create and add a character to the scene, and add it to the ActorMap.
          */
-        void addCharacter(const std::string &name, const std::string &mesh,
+        PhysicActor* addCharacter(const std::string &name, const std::string &mesh,
         const Ogre::Vector3 &position, float scale, const Ogre::Quaternion &rotation);
 
         /**
@@ -267,6 +279,33 @@ namespace Physic
          */
         PhysicActor* getCharacter(const std::string &name);
 
+        /**
+         * Return a pointer to the character with the given handle
+         */
+        PhysicActor* getCharacter(ObjectHandle handle);
+
+        /**
+         * Return the handle of the object with the given name, or 0 if there is none.
+         */
+        ObjectHandle getHandle(const std::string &name) const;
+
+        /**
+         * Return the handle of the object a body belongs to, or 0 if it isn't one of the engine's.
+         * The handle is kept in the user pointer of the body.
+         */
+        static ObjectHandle getHandle(const btCollisionObject *object);
+
+        /**
+         * Return the name of the object with the given handle, or an empty string if there is none.
+         */
+        const std::string& getName(ObjectHandle handle) const;
+
+        /**
+         * Number of objects looked up by their name so far (getRigidBody, getCharacter, getHandle,
+         * getCollisions, removing objects). Lookups by handle are not counted.
+         */
+        std::size_t getNameLookupCount() const;
+
         /**
          * This step the simulation of a given time.
          */
@@ -302,6 +341,11 @@ namespace Physic
          */
         std::vector< std::pair<float, std::string> > rayTest2(const btVector3 &from, const btVector3 &to, int filterGroup=0xff);
 
+        /**
+         * Return the handles of all objects hit by a ray.
+         */
+        std::vector< std::pair<float, ObjectHandle> > rayTestHandles(const btVector3 &from, const btVector3 &to, int filterGroup=0xff);
+
         std::pair<bool, float> sphereCast (float radius, btVector3& from, btVector3& to);
         ///< @return (hit, relative distance)
 
@@ -313,6 +357,11 @@ namespace Physic
                                                                  const btVector3 &origin,
                                                                  btCollisionObject *object);
 
+        // Same as above, filtering out the object with the given handle
+        std::pair<const RigidBody*,btVector3> getFilteredContact(ObjectHandle filter,
+                                                                 const btVector3 &origin,
+                                                                 btCollisionObject *object);
+
         //Bullet Stuff
         btBroadphaseInterface* broadphase;
         btDefaultCollisionConfiguration* collisionConfiguration;
@@ -357,6 +406,37 @@ namespace Physic
         void removeDebugDraw(Ogre::SceneManager *sceneMgr);
 
     private:
+        /// The bodies an ObjectHandle refers to
+        struct PhysicObject
+        {
+            std::string mName;
+            ObjectHandle mHandle; ///< 0 while the index is not in use
+            RigidBody *mCollisionBody;
+            RigidBody *mRaycastingBody;
+            PhysicActor *mActor;
+            RigidBody *mHeightField;
+
+            PhysicObject();
+        };
+
+        std::vector<PhysicObject> mObjects; ///< by object index; index 0 is never used
+        std::vector<std::size_t> mFreeObjects;
+        std::map<std::string, ObjectHandle> mObjectHandles;
+        mutable std::size_t mNameLookups;
+
+        /// Return the object with the given name, adding one if there is none
+        PhysicObject& addObject(const std::string &name);
+
+        /// \return 0 if there is no object with \a handle
+        PhysicObject* findObject(ObjectHandle handle);
+
+        /// Free the index of \a object if none of its bodies are left
+        void removeObjectIfUnused(PhysicObject& object);
+
+        RigidBody* findRigidBody(const std::string &name, bool raycasting);
+
+        void deleteCharacter(PhysicActorContainer::iterator iter);
+
         PhysicEngine(const PhysicEngine&);
         PhysicEngine& operator=(const PhysicEngine&);
     };
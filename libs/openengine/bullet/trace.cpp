@@ -2,6 +2,7 @@
 #include "trace.h"
 
 #include <map>
+#include <vector>
 
 #include <btBulletDynamicsCommon.h>
 #include <btBulletCollisionCommon.h>
@@ -53,6 +54,47 @@ protected:
 };
 
 
+/// Collects the broadphase proxies overlapping a box
+class OverlapCallback : public btBroadphaseAabbCallback
+{
+public:
+    std::vector<btBroadphaseProxy*> mProxies;
+
+    virtual bool process(const btBroadphaseProxy* proxy)
+    {
+        mProxies.push_back(const_cast<btBroadphaseProxy*>(proxy));
+        return true;
+    }
+};
+
+/// Same as btCollisionWorld::convexSweepTest, which shares one traversal stack between all its
+/// callers. The broadphase is only read here, so sweeps can be done on several threads at once
+/// as long as no object is added, removed or moved meanwhile.
+static void convexSweep(btCollisionWorld *world, const btConvexShape *shape, const btTransform &from,
+                 const btTransform &to, btCollisionWorld::ConvexResultCallback &callback)
+{
+    btVector3 aabbMin, aabbMax, toMin, toMax;
+    shape->getAabb(from, aabbMin, aabbMax);
+    shape->getAabb(to, toMin, toMax);
+    aabbMin.setMin(toMin);
+    aabbMax.setMax(toMax);
+
+    OverlapCallback overlaps;
+    world->getBroadphase()->aabbTest(aabbMin, aabbMax, overlaps);
+
+    for (std::vector<btBroadphaseProxy*>::const_iterator it = overlaps.mProxies.begin();
+         it != overlaps.mProxies.end() && callback.m_closestHitFraction > btScalar(0.0); ++it)
+    {
+        if (!callback.needsCollision(*it))
+            continue;
+
+        btCollisionObject *object = static_cast<btCollisionObject*>((*it)->m_clientObject);
+        btCollisionWorld::objectQuerySingle(shape, from, to, object, object->getCollisionShape(),
+                                            object->getWorldTransform(), callback, btScalar(0.0));
+    }
+}
+
+
 void ActorTracer::doTrace(btCollisionObject *actor, const Ogre::Vector3 &start, const Ogre::Vector3 &end, const PhysicEngine *enginePass)
 {
     const btVector3 btstart(start.x, start.y, start.z);
@@ -71,8 +113,8 @@ void ActorTracer::doTrace(btCollisionObject *actor, const Ogre::Vector3 &start,
 
     btCollisionShape *shape = actor->getCollisionShape();
     assert(shape->isConvex());
-    enginePass->mDynamicsWorld->convexSweepTest(static_cast<btConvexShape*>(shape),
-                                               from, to, newTraceCallback);
+    convexSweep(enginePass->mDynamicsWorld, static_cast<btConvexShape*>(shape),
+                from, to, newTraceCallback);
 
     // Copy the hit data over to our trace results struct:
     if(newTraceCallback.hasHit())
@@ -112,7 +154,7 @@ void ActorTracer::findGround(const OEngine::Physic::PhysicActor* actor, const Og
     halfExtents[2] = 1.0f;
     btCylinderShapeZ base(halfExtents);
 
-    enginePass->mDynamicsWorld->convexSweepTest(&base, from, to, newTraceCallback);
+    convexSweep(enginePass->mDynamicsWorld, &base, from, to, newTraceCallback);
     if(newTraceCallback.hasHit())
     {
         const btVector3& tracehitnormal = newTraceCallback.m_hitNormalWorld;